@@ -41,12 +41,16 @@ for item in (project_dir / c_sources).rglob("*.c"):
     src.append(str(item.relative_to(current_dir)))
 
 # Set options to compile C library
+# No -march flags here: SSE2/AVX2/AVX-512 variants of the hot kernels are compiled
+# with per-function target attributes (see c/kernels.c) and selected at import time.
+# -pthread for the worker threads of the executor (see c/executor.c)
 ffibuilder.cdef(c_def)
 ffibuilder.set_source(
     f"{project_name}._c",
     headers,
     sources=src,
-    extra_compile_args=["-fno-omit-frame-pointer", "-Wall", "-Wextra", "-g"],
+    extra_compile_args=["-fno-omit-frame-pointer", "-Wall", "-Wextra", "-g", "-pthread"],
+    extra_link_args=["-pthread"],
 )
 
 # Compile C library
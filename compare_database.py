@@ -0,0 +1,44 @@
+import os
+import sqlite3
+import tempfile
+import time
+from collections.abc import Iterator
+from typing import Any
+
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.arrow import to_arrow
+from pysatl_tsp.core.data_providers import DataBaseDataProvider, SQLiteAdapter
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler
+
+
+class CloseHandler(Handler[tuple[Any, ...], float]):
+    def __init__(self, source: Handler[Any, tuple[Any, ...]] | None = None):
+        super().__init__(source)
+
+    def __iter__(self) -> Iterator[float]:
+        if self.source is None:
+            raise ValueError("Source is not set")
+        for row in self.source:
+            yield row[0]
+
+
+# A year of minute bars
+rows = 365 * 24 * 60
+database = os.path.join(tempfile.mkdtemp(), "bars.sqlite")
+with sqlite3.connect(database) as connection:
+    connection.execute("CREATE TABLE bars (ts INTEGER, close REAL)")
+    connection.executemany("INSERT INTO bars VALUES (?, ?)", ((i * 60, 100.0 + (i % 977) * 0.01) for i in range(rows)))
+
+provider = DataBaseDataProvider({"database": database}, "SELECT close FROM bars ORDER BY ts", SQLiteAdapter())
+
+start_time = time.monotonic()
+for i in provider | CloseHandler() | CMAHandler(length=20):
+    pass
+first_mark = time.monotonic()
+result = to_arrow(provider.column_source(batch_size=10_000) | CMAHandler(length=20), size_hint=rows)
+end_time = time.monotonic()
+
+print(f"Rows: {len(result)}")
+print(f"Work time with row-by-row fetching: {round(first_mark - start_time, 5)}s")
+print(f"Work time with batched columnar fetching: {round(end_time - first_mark, 5)}s")
+os.remove(database)
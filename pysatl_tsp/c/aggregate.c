@@ -0,0 +1,302 @@
+#include "aggregate.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Greatest common divisor of two positive numbers */
+static int64_t tsp_agg_gcd(int64_t a, int64_t b) {
+	while (b != 0) {
+		int64_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/* x divided by m, rounded towards minus infinity */
+static int64_t tsp_agg_floor_div(int64_t x, int64_t m) {
+	int64_t q = x / m;
+	if (x % m < 0) {
+		q--;
+	}
+	return q;
+}
+
+/* Non-negative remainder of x divided by m */
+static long tsp_agg_slot(int64_t x, long m) {
+	long r = (long)(x % m);
+	return r < 0 ? r + m : r;
+}
+
+/* Add x to the compensated sum of the window */
+static void tsp_agg_add(struct tsp_aggregator *a, double x) {
+	double t = a->sum + x;
+	if (fabs(a->sum) >= fabs(x)) {
+		a->sum_comp += (a->sum - t) + x;
+	} else {
+		a->sum_comp += (x - t) + a->sum;
+	}
+	a->sum = t;
+}
+
+/* Partials of the pane with the given id, which must be in the window */
+static const struct tsp_agg_pane *tsp_agg_pane_of(const struct tsp_aggregator *a, int64_t id) {
+	return &a->ring[tsp_agg_slot(id, a->panes)];
+}
+
+/*
+ * Creates an empty window aggregator
+ *
+ * units: Units of size, hop and origin (TSP_AGG_ELEMENTS or TSP_AGG_TIME)
+ * aggregates: Optional aggregates to compute (TSP_AGG_* flags)
+ * size: Length of a window
+ * hop: Distance between the starts of consecutive windows, size for tumbling windows
+ * origin: Position the windows are aligned to, only used for TSP_AGG_TIME
+ *
+ * return: Pointer to initialized aggregator, or NULL on failure
+ */
+struct tsp_aggregator *tsp_aggregator_init(int units, int aggregates, int64_t size, int64_t hop, int64_t origin) {
+	if ((units != TSP_AGG_ELEMENTS && units != TSP_AGG_TIME) || size < 1 || hop < 1) {
+		fprintf(stderr, "Invalid aggregator units %d, size %lld or hop %lld\n", units, (long long)size,
+			(long long)hop);
+		return NULL;
+	}
+	struct tsp_aggregator *obj = calloc(1, sizeof(struct tsp_aggregator));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize aggregator\n");
+		return NULL;
+	}
+	obj->units = units;
+	obj->aggregates = aggregates;
+	obj->size = size;
+	obj->hop = hop;
+	obj->origin = units == TSP_AGG_TIME ? origin : 0;
+	obj->pane = tsp_agg_gcd(size, hop);
+	obj->panes = (long)(size / obj->pane);
+	obj->hop_panes = (long)(hop / obj->pane);
+	obj->ring = malloc(obj->panes * sizeof(struct tsp_agg_pane));
+	obj->fifo = malloc(obj->panes * sizeof(int64_t));
+	obj->min_ids = malloc(obj->panes * sizeof(int64_t));
+	obj->max_ids = malloc(obj->panes * sizeof(int64_t));
+	if (obj->ring == NULL || obj->fifo == NULL || obj->min_ids == NULL || obj->max_ids == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize aggregator\n");
+		tsp_free_aggregator(obj);
+		return NULL;
+	}
+	tsp_aggregator_reset(obj);
+	return obj;
+}
+
+void tsp_free_aggregator(struct tsp_aggregator *a) {
+	free(a->ring);
+	free(a->fifo);
+	free(a->min_ids);
+	free(a->max_ids);
+	free(a);
+}
+
+/* Forget all points */
+void tsp_aggregator_reset(struct tsp_aggregator *a) {
+	for (long i = 0; i < a->panes; i++) {
+		a->ring[i].count = 0;
+	}
+	a->open.count = 0;
+	a->open_id = 0;
+	a->fifo_head = a->fifo_tail = 0;
+	a->min_head = a->min_tail = a->max_head = a->max_tail = 0;
+	a->count = 0;
+	a->sum = a->sum_comp = 0;
+	a->nonfinite = 0;
+	a->started = 0;
+}
+
+/*
+ * Gets the number of windows a single point or a flush can emit
+ *
+ * a: Aggregator
+ *
+ * return: Number of records out must have room for
+ */
+long tsp_aggregator_max_windows(const struct tsp_aggregator *a) {
+	return (a->panes + a->hop_panes - 1) / a->hop_panes + 1;
+}
+
+/* Sum of the window, from the pane sums while a pane with a non-finite sum is in it */
+static double tsp_agg_sum(const struct tsp_aggregator *a) {
+	if (a->nonfinite == 0) {
+		return a->sum + a->sum_comp;
+	}
+	double sum = 0;
+	for (uint64_t i = a->fifo_head; i < a->fifo_tail; i++) {
+		sum += tsp_agg_pane_of(a, a->fifo[i % a->panes])->sum;
+	}
+	return sum;
+}
+
+/* Aggregates of the window made of the panes from first_id on */
+static void tsp_agg_window(const struct tsp_aggregator *a, int64_t first_id, struct tsp_time_agg *out) {
+	out->start = a->origin + first_id * a->pane;
+	out->end = out->start + a->size;
+	out->count = a->count;
+	out->sum = tsp_agg_sum(a);
+	out->min = a->aggregates & TSP_AGG_MIN ? tsp_agg_pane_of(a, a->min_ids[a->min_head % a->panes])->min : NAN;
+	out->max = a->aggregates & TSP_AGG_MAX ? tsp_agg_pane_of(a, a->max_ids[a->max_head % a->panes])->max : NAN;
+	out->first = tsp_agg_pane_of(a, a->fifo[a->fifo_head % a->panes])->first;
+	out->last = tsp_agg_pane_of(a, a->fifo[(a->fifo_tail - 1) % a->panes])->last;
+}
+
+/* Close the open pane, return 1 if the window ending with it was written to out */
+static int tsp_agg_close(struct tsp_aggregator *a, struct tsp_time_agg *out) {
+	int64_t id = a->open_id;
+	int64_t leaving_id = id - a->panes;
+	struct tsp_agg_pane *slot = &a->ring[tsp_agg_slot(id, a->panes)];
+
+	// The pane stored in the slot leaves the window: subtract-on-evict
+	if (slot->count > 0) {
+		a->count -= slot->count;
+		if (a->count == 0) {
+			a->sum = a->sum_comp = 0;
+		} else if (isfinite(slot->sum)) {
+			tsp_agg_add(a, -slot->sum);
+		}
+		if (!isfinite(slot->sum)) {
+			a->nonfinite--;
+		}
+		a->fifo_head++;
+		if (a->min_tail > a->min_head && a->min_ids[a->min_head % a->panes] == leaving_id) {
+			a->min_head++;
+		}
+		if (a->max_tail > a->max_head && a->max_ids[a->max_head % a->panes] == leaving_id) {
+			a->max_head++;
+		}
+	}
+
+	*slot = a->open;
+	if (slot->count > 0) {
+		a->count += slot->count;
+		if (isfinite(slot->sum)) {
+			tsp_agg_add(a, slot->sum);
+		} else {
+			a->nonfinite++;
+		}
+		a->fifo[a->fifo_tail++ % a->panes] = id;
+		if (a->aggregates & TSP_AGG_MIN) {
+			while (a->min_tail > a->min_head &&
+			       tsp_agg_pane_of(a, a->min_ids[(a->min_tail - 1) % a->panes])->min >= slot->min) {
+				a->min_tail--;
+			}
+			a->min_ids[a->min_tail++ % a->panes] = id;
+		}
+		if (a->aggregates & TSP_AGG_MAX) {
+			while (a->max_tail > a->max_head &&
+			       tsp_agg_pane_of(a, a->max_ids[(a->max_tail - 1) % a->panes])->max <= slot->max) {
+				a->max_tail--;
+			}
+			a->max_ids[a->max_tail++ % a->panes] = id;
+		}
+	}
+	a->open.count = 0;
+	a->open_id++;
+
+	// Windows over elements that would start before the first element are incomplete
+	int64_t first_id = id + 1 - a->panes;
+	if (a->count > 0 && tsp_agg_slot(first_id, a->hop_panes) == 0 && (a->units == TSP_AGG_TIME || first_id >= 0)) {
+		tsp_agg_window(a, first_id, out);
+		return 1;
+	}
+	return 0;
+}
+
+/* Close panes until the pane with the given id is open, return the number of windows written to out */
+static long tsp_agg_advance(struct tsp_aggregator *a, int64_t id, struct tsp_time_agg *out) {
+	long emitted = 0;
+	while (a->open_id < id) {
+		if (a->count == 0 && a->open.count == 0) {
+			// All panes of the window are empty, skip the gap
+			a->open_id = id;
+			break;
+		}
+		emitted += tsp_agg_close(a, out + emitted);
+	}
+	return emitted;
+}
+
+/* Add a value to the open pane */
+static void tsp_agg_push(struct tsp_aggregator *a, double value) {
+	struct tsp_agg_pane *p = &a->open;
+	if (p->count == 0) {
+		p->sum = 0;
+		p->min = p->max = p->first = value;
+	} else {
+		p->min = value < p->min ? value : p->min;
+		p->max = value > p->max ? value : p->max;
+	}
+	p->count++;
+	p->sum += value;
+	p->last = value;
+}
+
+/*
+ * Adds points to the windows and writes the aggregates of the windows they complete
+ *
+ * Stops early when out has no room for the windows the next point could complete.
+ *
+ * a: Aggregator
+ * ts: Non-decreasing timestamps of the points, only read for TSP_AGG_TIME
+ * values: Values of the points
+ * n: Number of points
+ * out: Buffer receiving the aggregates of the completed windows
+ * out_size: Number of records out can hold, at least tsp_aggregator_max_windows
+ * consumed: Receives the number of points added
+ *
+ * return: Number of records written to out, or TSP_TW_UNORDERED if a timestamp is smaller than the previous one
+ */
+long tsp_aggregator_process(struct tsp_aggregator *a, const int64_t *ts, const double *values, long n,
+			    struct tsp_time_agg *out, long out_size, long *consumed) {
+	long max_windows = tsp_aggregator_max_windows(a);
+	long emitted = 0;
+	long i = 0;
+	for (; i < n && emitted + max_windows <= out_size; i++) {
+		if (a->units == TSP_AGG_TIME) {
+			if (a->started && ts[i] < a->last_ts) {
+				fprintf(stderr, "Timestamp %lld is before %lld\n", (long long)ts[i], (long long)a->last_ts);
+				*consumed = i;
+				return TSP_TW_UNORDERED;
+			}
+			int64_t id = tsp_agg_floor_div(ts[i] - a->origin, a->pane);
+			if (!a->started) {
+				a->open_id = id;
+			}
+			emitted += tsp_agg_advance(a, id, out + emitted);
+			a->last_ts = ts[i];
+		}
+		tsp_agg_push(a, values[i]);
+		a->started = 1;
+		if (a->units == TSP_AGG_ELEMENTS && a->open.count == a->pane) {
+			emitted += tsp_agg_close(a, out + emitted);
+		}
+	}
+	*consumed = i;
+	return emitted;
+}
+
+/*
+ * Ends the stream: emits the windows still open and forgets all points
+ *
+ * Windows over elements are only emitted complete, for them nothing is written.
+ *
+ * a: Aggregator
+ * out: Buffer of at least tsp_aggregator_max_windows records
+ *
+ * return: Number of records written to out
+ */
+long tsp_aggregator_flush(struct tsp_aggregator *a, struct tsp_time_agg *out) {
+	long emitted = 0;
+	if (a->units == TSP_AGG_TIME && a->started) {
+		while (a->count > 0 || a->open.count > 0) {
+			emitted += tsp_agg_close(a, out + emitted);
+		}
+	}
+	tsp_aggregator_reset(a);
+	return emitted;
+}
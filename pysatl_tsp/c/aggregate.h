@@ -0,0 +1,80 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+#include <stdint.h>
+#include "time_window.h"
+
+/* Partial aggregates of one pane */
+struct tsp_agg_pane {
+	long count;
+	double sum;
+	double min, max;
+	double first, last;
+};
+
+/*
+ * Tumbling and hopping window aggregation over element positions or timestamps
+ *
+ * Windows of size units start every hop units: [origin + k * hop, origin + k * hop + size).
+ * The axis is cut into panes of gcd(size, hop) units, every window is a run of
+ * size / pane consecutive panes and windows share their panes. Each point is added
+ * to the open pane once; when a pane closes it enters the window, the pane that
+ * falls out of it leaves:
+ * - count and sum are invertible, they are kept as running totals, the leaving pane
+ *   is subtracted (with Neumaier compensation so the sum doesn't drift); panes whose
+ *   sum is not finite stay out of the running sum, while the window holds any of them
+ *   its sum is recomputed from the pane sums
+ * - min and max are not, monotonic deques of pane ids give them in O(1) amortized
+ * - first and last come from a FIFO of non-empty panes
+ * A window is emitted when its last pane closes.
+ */
+struct tsp_aggregator {
+	int units;
+	int aggregates;		     // TSP_AGG_* flags of the optional aggregates
+	int64_t size;
+	int64_t hop;
+	int64_t origin;
+	int64_t pane;		     // Length of a pane in units
+	long panes;		     // Panes per window
+	long hop_panes;		     // Panes per hop
+	struct tsp_agg_pane *ring;   // Partials of the last panes panes, by pane id modulo panes
+	struct tsp_agg_pane open;    // Partials of the open pane
+	int64_t open_id;	     // Id of the open pane
+	int64_t *fifo;		     // Ids of the non-empty panes in the window, ring of panes slots
+	int64_t *min_ids;	     // Pane ids with increasing minimums, ring of panes slots
+	int64_t *max_ids;	     // Pane ids with decreasing maximums, ring of panes slots
+	uint64_t fifo_head, fifo_tail, min_head, min_tail, max_head, max_tail;
+	long count;		     // Points in the panes of the window
+	double sum;
+	double sum_comp;	     // Low-order bits lost by sum (Neumaier compensation)
+	long nonfinite;		     // Panes in the window whose sum is not finite (left out of sum)
+	int64_t last_ts;	     // Timestamp of the last point
+	int started;		     // Whether a point has been pushed
+};
+
+TSP_API_START
+/*
+ * Units of window sizes
+ *
+ * TSP_AGG_ELEMENTS - positions of the points, only complete windows are emitted
+ * TSP_AGG_TIME     - timestamps of the points, windows still open are emitted on flush
+ */
+#define TSP_AGG_ELEMENTS 0
+#define TSP_AGG_TIME 1
+
+/* Optional aggregates, count, sum, first and last are always computed */
+#define TSP_AGG_MIN 1
+#define TSP_AGG_MAX 2
+
+struct tsp_aggregator;
+
+struct tsp_aggregator *tsp_aggregator_init(int units, int aggregates, int64_t size, int64_t hop, int64_t origin);
+void tsp_free_aggregator(struct tsp_aggregator *a);
+void tsp_aggregator_reset(struct tsp_aggregator *a);
+long tsp_aggregator_max_windows(const struct tsp_aggregator *a);
+long tsp_aggregator_process(struct tsp_aggregator *a, const int64_t *ts, const double *values, long n,
+			    struct tsp_time_agg *out, long out_size, long *consumed);
+long tsp_aggregator_flush(struct tsp_aggregator *a, struct tsp_time_agg *out);
+TSP_API_END
+#endif /* AGGREGATE_H */
@@ -0,0 +1,343 @@
+#define PY_SSIZE_T_CLEAN
+#include "arrow.h"
+#include <Python.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Check that an array has the layout of a primitive float64 array */
+static int tsp_arrow_check_array(const struct ArrowArray *array) {
+	if (array->n_buffers != 2 || array->n_children != 0 || array->dictionary != NULL ||
+	    (array->length > 0 && array->buffers[1] == NULL)) {
+		fprintf(stderr, "Arrow array is not a primitive float64 array\n");
+		return -1;
+	}
+	return 0;
+}
+
+/* Check that a schema describes a float64 column ("g") */
+static int tsp_arrow_check_schema(const struct ArrowSchema *schema) {
+	if (schema->format == NULL || strcmp(schema->format, "g") != 0 || schema->n_children != 0) {
+		fprintf(stderr, "Arrow schema with format '%s' is not float64\n",
+			schema->format == NULL ? "" : schema->format);
+		return -1;
+	}
+	return 0;
+}
+
+/* Release the current array of the source */
+static void tsp_arrow_release_array(struct tsp_arrow_source *src) {
+	if (src->array.release != NULL) {
+		src->array.release(&src->array);
+		src->array.release = NULL;
+	}
+}
+
+static struct tsp_arrow_source *tsp_arrow_source_alloc(void) {
+	struct tsp_arrow_source *obj = calloc(1, sizeof(struct tsp_arrow_source));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize arrow source\n");
+	}
+	return obj;
+}
+
+/*
+ * Creates a source over an Arrow float64 array
+ * The array is moved into the source, the schema is only read
+ *
+ * return: Pointer to initialized source, or NULL on failure (the array is not moved)
+ */
+struct tsp_arrow_source *tsp_arrow_source_init(struct ArrowSchema *schema, struct ArrowArray *array) {
+	if (array->release == NULL || tsp_arrow_check_schema(schema) != 0 ||
+	    tsp_arrow_check_array(array) != 0) {
+		return NULL;
+	}
+	struct tsp_arrow_source *obj = tsp_arrow_source_alloc();
+	if (obj == NULL) {
+		return NULL;
+	}
+	obj->array = *array;
+	array->release = NULL;
+	return obj;
+}
+
+/*
+ * Creates a source over an Arrow stream of float64 arrays (e.g. a chunked column)
+ * The stream is moved into the source
+ *
+ * return: Pointer to initialized source, or NULL on failure (the stream is not moved)
+ */
+struct tsp_arrow_source *tsp_arrow_stream_source_init(struct ArrowArrayStream *stream) {
+	struct ArrowSchema schema;
+	if (stream->release == NULL || stream->get_schema(stream, &schema) != 0) {
+		fprintf(stderr, "Could not get schema of arrow stream\n");
+		return NULL;
+	}
+	int valid = tsp_arrow_check_schema(&schema);
+	schema.release(&schema);
+	if (valid != 0) {
+		return NULL;
+	}
+	struct tsp_arrow_source *obj = tsp_arrow_source_alloc();
+	if (obj == NULL) {
+		return NULL;
+	}
+	obj->stream = *stream;
+	stream->release = NULL;
+	return obj;
+}
+
+/* Release the array and the stream, free the source */
+void tsp_free_arrow_source(struct tsp_arrow_source *src) {
+	tsp_arrow_release_array(src);
+	if (src->stream.release != NULL) {
+		src->stream.release(&src->stream);
+	}
+	free(src);
+}
+
+/* Whether the stream failed, the data served before the failure is all there is */
+int tsp_arrow_source_failed(struct tsp_arrow_source *src) { return src->failed; }
+
+/* Move to the next non-empty array of the stream, return -1 at the end of data or on failure */
+static int tsp_arrow_next_array(struct tsp_arrow_source *src) {
+	while (src->array.release == NULL || src->pos == src->array.length) {
+		tsp_arrow_release_array(src);
+		src->pos = 0;
+		if (src->stream.release == NULL) {
+			return -1;
+		}
+		if (src->stream.get_next(&src->stream, &src->array) != 0) {
+			const char *error = src->stream.get_last_error(&src->stream);
+			fprintf(stderr, "Could not read arrow stream: %s\n", error == NULL ? "" : error);
+			src->array.release = NULL;
+			src->failed = 1;
+			return -1;
+		}
+		if (src->array.release == NULL) {
+			return -1;
+		}
+		if (tsp_arrow_check_array(&src->array) != 0) {
+			tsp_arrow_release_array(src);
+			src->failed = 1;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Fill function of the arrow source handler (see tsp_init_source)
+ * Arrays without nulls are served without copying
+ */
+int tsp_fill_arrow(struct tsp_handler *handler, double **block, int capacity) {
+	struct tsp_arrow_source *src = (struct tsp_arrow_source *)handler->data;
+	if (tsp_arrow_next_array(src) != 0) {
+		return 0;
+	}
+	struct ArrowArray *array = &src->array;
+	int64_t count = array->length - src->pos;
+	count = count < capacity ? count : capacity;
+	const double *values = (const double *)array->buffers[1] + array->offset + src->pos;
+	const uint8_t *validity = (const uint8_t *)array->buffers[0];
+	if (array->null_count == 0 || validity == NULL) {
+		*block = (double *)values;
+	} else {
+		double *out = *block;
+		int64_t bit = array->offset + src->pos;
+		for (int64_t i = 0; i < count; i++, bit++) {
+			out[i] = (validity[bit >> 3] >> (bit & 7)) & 1 ? values[i] : NAN;
+		}
+	}
+	src->pos += count;
+	return (int)count;
+}
+
+/*
+ * Values drained from a chain for export
+ *
+ * Every exported ArrowArray holds a reference and shares the buffers, the owner
+ * (e.g. the Python export object) holds one more. Consumers may release arrays
+ * from any thread, so the count is atomic.
+ */
+struct tsp_arrow_export {
+	const void *buffers[2];
+	double *values;
+	uint8_t *validity;
+	int64_t length;
+	int64_t null_count;
+	atomic_int refs;
+};
+
+/* Drop a reference, the buffers are freed with the last one */
+static void tsp_arrow_export_unref(struct tsp_arrow_export *data) {
+	if (atomic_fetch_sub(&data->refs, 1) == 1) {
+		free(data->values);
+		free(data->validity);
+		free(data);
+	}
+}
+
+static void tsp_arrow_release_export_array(struct ArrowArray *array) {
+	tsp_arrow_export_unref((struct tsp_arrow_export *)array->private_data);
+	array->release = NULL;
+}
+
+static void tsp_arrow_release_export_schema(struct ArrowSchema *schema) { schema->release = NULL; }
+
+/* Grow the export buffers to hold at least needed values */
+static int tsp_arrow_export_grow(struct tsp_arrow_export *data, long *capacity, long needed) {
+	long grown = *capacity;
+	while (grown < needed) {
+		grown *= 2;
+	}
+	if (grown == *capacity) {
+		return 0;
+	}
+	double *values = realloc(data->values, sizeof(double) * grown);
+	if (values == NULL) {
+		return -1;
+	}
+	data->values = values;
+	if (data->validity != NULL) {
+		uint8_t *validity = realloc(data->validity, (grown + 7) / 8);
+		if (validity == NULL) {
+			return -1;
+		}
+		memset(validity + (*capacity + 7) / 8, 0, (grown + 7) / 8 - (*capacity + 7) / 8);
+		data->validity = validity;
+	}
+	*capacity = grown;
+	return 0;
+}
+
+/* Values pulled from the chain per refill by tsp_arrow_export_chain */
+#define TSP_ARROW_EXPORT_BLOCK 4096
+
+/*
+ * Drains a native handler chain into buffers of an Arrow float64 array
+ *
+ * Missing values (inf, None in Python) become nulls, the validity bitmap is only
+ * allocated if there are any. Arrays exported with tsp_arrow_export_array share
+ * the buffers, consumers take them without copying.
+ *
+ * size_hint: Expected number of values, 0 if unknown
+ *
+ * return: Export holding one reference (drop it with tsp_arrow_export_free), or NULL on failure
+ */
+struct tsp_arrow_export *tsp_arrow_export_chain(struct tsp_handler *handler, long size_hint) {
+	struct tsp_arrow_export *data = calloc(1, sizeof(struct tsp_arrow_export));
+	long capacity = size_hint > 64 ? size_hint : 64;
+	if (data == NULL || (data->values = malloc(sizeof(double) * capacity)) == NULL) {
+		fprintf(stderr, "Could not allocate memory to export arrow array\n");
+		free(data);
+		return NULL;
+	}
+	atomic_init(&data->refs, 1);
+
+	long length = 0, n = 0;
+	double *next = NULL;
+	while ((next = tsp_next_block(handler, TSP_ARROW_EXPORT_BLOCK, &n)) != NULL) {
+		if (tsp_arrow_export_grow(data, &capacity, length + n) != 0) {
+			fprintf(stderr, "Could not allocate memory to export arrow array\n");
+			tsp_arrow_export_unref(data);
+			return NULL;
+		}
+		memcpy(data->values + length, next, sizeof(double) * n);
+		for (long i = length; i < length + n; i++) {
+			int missing = isinf(data->values[i]) && data->values[i] > 0;
+			if (missing && data->validity == NULL) {
+				// First null: all previous values are valid
+				data->validity = malloc((capacity + 7) / 8);
+				if (data->validity == NULL) {
+					fprintf(stderr, "Could not allocate memory to export arrow array\n");
+					tsp_arrow_export_unref(data);
+					return NULL;
+				}
+				memset(data->validity, 0, (capacity + 7) / 8);
+				for (long j = 0; j < i; j++) {
+					data->validity[j >> 3] |= (uint8_t)(1 << (j & 7));
+				}
+			}
+			if (missing) {
+				data->values[i] = 0.0;
+			} else if (data->validity != NULL) {
+				data->validity[i >> 3] |= (uint8_t)(1 << (i & 7));
+			}
+			data->null_count += missing;
+		}
+		length += n;
+	}
+	data->length = length;
+	data->buffers[0] = data->validity;
+	data->buffers[1] = data->values;
+	return data;
+}
+
+/*
+ * Fills a new schema and a new array over the exported buffers
+ * Every call gives an independent pair, each with its own release callback
+ */
+void tsp_arrow_export_array(struct tsp_arrow_export *data, struct ArrowSchema *schema,
+			    struct ArrowArray *array) {
+	atomic_fetch_add(&data->refs, 1);
+	*array = (struct ArrowArray){
+	    .length = data->length,
+	    .null_count = data->null_count,
+	    .offset = 0,
+	    .n_buffers = 2,
+	    .n_children = 0,
+	    .buffers = data->buffers,
+	    .children = NULL,
+	    .dictionary = NULL,
+	    .release = tsp_arrow_release_export_array,
+	    .private_data = data,
+	};
+	tsp_arrow_export_schema(schema);
+}
+
+/* Fills a new float64 schema */
+void tsp_arrow_export_schema(struct ArrowSchema *schema) {
+	*schema = (struct ArrowSchema){
+	    .format = "g",
+	    .name = "",
+	    .metadata = NULL,
+	    .flags = 2, // ARROW_FLAG_NULLABLE
+	    .n_children = 0,
+	    .children = NULL,
+	    .dictionary = NULL,
+	    .release = tsp_arrow_release_export_schema,
+	    .private_data = NULL,
+	};
+}
+
+long tsp_arrow_export_length(struct tsp_arrow_export *data) { return data->length; }
+
+long tsp_arrow_export_null_count(struct tsp_arrow_export *data) { return data->null_count; }
+
+/* Drop the owner's reference, arrays still held by consumers stay valid */
+void tsp_arrow_export_free(struct tsp_arrow_export *data) { tsp_arrow_export_unref(data); }
+
+/* Allocate released structures for capsules of the Arrow PyCapsule interface */
+struct ArrowSchema *tsp_arrow_schema_new(void) { return calloc(1, sizeof(struct ArrowSchema)); }
+
+struct ArrowArray *tsp_arrow_array_new(void) { return calloc(1, sizeof(struct ArrowArray)); }
+
+/* Capsule destructors: release the structure unless it was moved out by a consumer */
+void tsp_arrow_schema_capsule_free(PyObject *capsule) {
+	struct ArrowSchema *schema = PyCapsule_GetPointer(capsule, "arrow_schema");
+	if (schema != NULL && schema->release != NULL) {
+		schema->release(schema);
+	}
+	free(schema);
+}
+
+void tsp_arrow_array_capsule_free(PyObject *capsule) {
+	struct ArrowArray *array = PyCapsule_GetPointer(capsule, "arrow_array");
+	if (array != NULL && array->release != NULL) {
+		array->release(array);
+	}
+	free(array);
+}
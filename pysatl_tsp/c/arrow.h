@@ -0,0 +1,81 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef ARROW_H
+#define ARROW_H
+#include "handler.h"
+#include <stdint.h>
+
+TSP_API_START
+/*
+ * Arrow C Data Interface
+ * https://arrow.apache.org/docs/format/CDataInterface.html
+ */
+struct ArrowSchema {
+	const char *format;
+	const char *name;
+	const char *metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema **children;
+	struct ArrowSchema *dictionary;
+	void (*release)(struct ArrowSchema *);
+	void *private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void **buffers;
+	struct ArrowArray **children;
+	struct ArrowArray *dictionary;
+	void (*release)(struct ArrowArray *);
+	void *private_data;
+};
+
+struct ArrowArrayStream {
+	int (*get_schema)(struct ArrowArrayStream *, struct ArrowSchema *out);
+	int (*get_next)(struct ArrowArrayStream *, struct ArrowArray *out);
+	const char *(*get_last_error)(struct ArrowArrayStream *);
+	void (*release)(struct ArrowArrayStream *);
+	void *private_data;
+};
+
+/*
+ * Native source over an Arrow float64 array or a stream of them
+ *
+ * The source takes ownership of the array (Arrow move semantics: the producer's
+ * struct is marked released). Arrays without nulls are served to the handler chain
+ * directly from the Arrow buffer, nulls are served as NaN.
+ */
+struct tsp_arrow_source {
+	struct ArrowArray array;	  // Current array, released if array.release == NULL
+	struct ArrowArrayStream stream; // Stream of arrays, unused if stream.release == NULL
+	int64_t pos;			  // Next element of the current array
+	int failed;			  // 1 if the stream failed or gave an invalid array
+};
+
+struct tsp_arrow_source *tsp_arrow_source_init(struct ArrowSchema *schema, struct ArrowArray *array);
+struct tsp_arrow_source *tsp_arrow_stream_source_init(struct ArrowArrayStream *stream);
+void tsp_free_arrow_source(struct tsp_arrow_source *src);
+int tsp_arrow_source_failed(struct tsp_arrow_source *src);
+int tsp_fill_arrow(struct tsp_handler *handler, double **block, int capacity);
+
+struct tsp_arrow_export;
+
+struct tsp_arrow_export *tsp_arrow_export_chain(struct tsp_handler *handler, long size_hint);
+void tsp_arrow_export_array(struct tsp_arrow_export *data, struct ArrowSchema *schema,
+			    struct ArrowArray *array);
+void tsp_arrow_export_schema(struct ArrowSchema *schema);
+long tsp_arrow_export_length(struct tsp_arrow_export *data);
+long tsp_arrow_export_null_count(struct tsp_arrow_export *data);
+void tsp_arrow_export_free(struct tsp_arrow_export *data);
+
+struct ArrowSchema *tsp_arrow_schema_new(void);
+struct ArrowArray *tsp_arrow_array_new(void);
+void tsp_arrow_schema_capsule_free(PyObject *capsule);
+void tsp_arrow_array_capsule_free(PyObject *capsule);
+TSP_API_END
+#endif /* ARROW_H */
@@ -0,0 +1,108 @@
+#define PY_SSIZE_T_CLEAN
+#include "block_source.h"
+#include <Python.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct tsp_block_source {
+	PyObject *iter;	 // Iterator of blocks (borrowed, kept alive by the caller)
+	Py_buffer view;	 // Current block
+	int has_view;	 // 1 if view holds a block
+	Py_ssize_t len;	 // Values in the current block
+	Py_ssize_t pos;	 // Next value of the current block
+	int failed;	 // 1 if the iterator raised or gave an invalid block
+};
+
+/* Creates a block source without an iterator */
+struct tsp_block_source *tsp_block_source_init(void) {
+	struct tsp_block_source *obj = calloc(1, sizeof(struct tsp_block_source));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize block source\n");
+	}
+	return obj;
+}
+
+/* Release the current block, the GIL must be held */
+static void tsp_block_source_release(struct tsp_block_source *src) {
+	if (src->has_view) {
+		PyBuffer_Release(&src->view);
+		src->has_view = 0;
+	}
+	src->len = 0;
+	src->pos = 0;
+}
+
+/* Start serving blocks of another iterator (NULL to stop) */
+void tsp_block_source_set_iter(struct tsp_block_source *src, PyObject *iter) {
+	PyGILState_STATE gstate = PyGILState_Ensure();
+	tsp_block_source_release(src);
+	src->iter = iter;
+	src->failed = 0;
+	PyGILState_Release(gstate);
+}
+
+/* Free block source */
+void tsp_free_block_source(struct tsp_block_source *src) {
+	tsp_block_source_set_iter(src, NULL);
+	free(src);
+}
+
+/* Take the next non-empty block from the iterator, return -1 at the end of data */
+static int tsp_block_source_next(struct tsp_block_source *src) {
+	PyGILState_STATE gstate = PyGILState_Ensure();
+	tsp_block_source_release(src);
+	int res = -1;
+	PyObject *item = NULL;
+	while (src->iter != NULL && (item = PyIter_Next(src->iter)) != NULL) {
+		int status = PyObject_GetBuffer(item, &src->view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT);
+		Py_DECREF(item);
+		if (status != 0) {
+			PyErr_Clear();
+			fprintf(stderr, "Block is not a contiguous buffer\n");
+			src->failed = 1;
+			break;
+		}
+		src->has_view = 1;
+		if (src->view.itemsize != sizeof(double) || src->view.format == NULL ||
+		    strcmp(src->view.format, "d") != 0) {
+			fprintf(stderr, "Block is not a float64 buffer\n");
+			tsp_block_source_release(src);
+			src->failed = 1;
+			break;
+		}
+		src->len = src->view.len / (Py_ssize_t)sizeof(double);
+		if (src->len > 0) {
+			res = 0;
+			break;
+		}
+		tsp_block_source_release(src);
+	}
+	// The exception can't cross the chain: report it and let the caller check
+	// tsp_block_source_failed, instead of leaving it set for unrelated Python code
+	if (item == NULL && PyErr_Occurred()) {
+		PyErr_WriteUnraisable(src->iter);
+		src->failed = 1;
+	}
+	PyGILState_Release(gstate);
+	return res;
+}
+
+/* Whether the data ended because the iterator raised or gave an invalid block */
+int tsp_block_source_failed(struct tsp_block_source *src) { return src->failed; }
+
+/*
+ * Fill function of the block source handler (see tsp_init_source)
+ * Values are served from the current block without copying
+ */
+int tsp_fill_blocks(struct tsp_handler *handler, double **block, int capacity) {
+	struct tsp_block_source *src = (struct tsp_block_source *)handler->data;
+	if (src->pos == src->len && tsp_block_source_next(src) != 0) {
+		return 0;
+	}
+	Py_ssize_t count = src->len - src->pos;
+	count = count < capacity ? count : capacity;
+	*block = (double *)src->view.buf + src->pos;
+	src->pos += count;
+	return (int)count;
+}
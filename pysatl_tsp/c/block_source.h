@@ -0,0 +1,23 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef BLOCK_SOURCE_H
+#define BLOCK_SOURCE_H
+#include "handler.h"
+
+TSP_API_START
+/*
+ * Native source over a Python iterator of float64 blocks
+ *
+ * Every item of the iterator must support the buffer protocol with C-contiguous
+ * double elements (e.g. a numpy float64 array). The GIL is taken once per block,
+ * not once per value, and the values are served from the block without copying.
+ */
+struct tsp_block_source;
+
+struct tsp_block_source *tsp_block_source_init(void);
+void tsp_block_source_set_iter(struct tsp_block_source *src, PyObject *iter);
+void tsp_free_block_source(struct tsp_block_source *src);
+int tsp_block_source_failed(struct tsp_block_source *src);
+int tsp_fill_blocks(struct tsp_handler *handler, double **block, int capacity);
+TSP_API_END
+#endif /* BLOCK_SOURCE_H */
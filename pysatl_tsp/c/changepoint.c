@@ -0,0 +1,236 @@
+#include "changepoint.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Smallest variance of a segment, keeps the likelihood of constant segments finite */
+#define TSP_CP_MIN_VAR 1e-12
+
+/* Compute prefix sums of the values centered at their mean */
+static int tsp_cp_cost_init(struct tsp_cp_cost *c, int kind, const double *values, long n) {
+	c->kind = kind;
+	c->sum = malloc((n + 1) * sizeof(double));
+	c->sumsq = malloc((n + 1) * sizeof(double));
+	if (c->sum == NULL || c->sumsq == NULL) {
+		free(c->sum);
+		free(c->sumsq);
+		return -1;
+	}
+	double mean = 0;
+	for (long i = 0; i < n; i++) {
+		mean += (values[i] - mean) / (i + 1);
+	}
+	c->sum[0] = c->sumsq[0] = 0;
+	for (long i = 0; i < n; i++) {
+		double x = values[i] - mean;
+		c->sum[i + 1] = c->sum[i] + x;
+		c->sumsq[i + 1] = c->sumsq[i] + x * x;
+	}
+	return 0;
+}
+
+static void tsp_cp_cost_free(struct tsp_cp_cost *c) {
+	free(c->sum);
+	free(c->sumsq);
+}
+
+/* Cost of the segment [s, e) */
+static double tsp_cp_cost(const struct tsp_cp_cost *c, long s, long e) {
+	double n = (double)(e - s);
+	double sum = c->sum[e] - c->sum[s];
+	double sumsq = c->sumsq[e] - c->sumsq[s];
+	double rss = fmax(sumsq - sum * sum / n, 0);
+	switch (c->kind) {
+	case TSP_CP_L2:
+		return rss;
+	case TSP_CP_VARIANCE:
+		// Values are centered, the global mean is 0
+		return n * log(fmax(sumsq / n, TSP_CP_MIN_VAR));
+	case TSP_CP_NORMAL:
+		return n * log(fmax(rss / n, TSP_CP_MIN_VAR));
+	}
+	return 0;
+}
+
+static int tsp_cp_check(long n, int cost, long min_size) {
+	if (n < 0 || cost < TSP_CP_L2 || cost > TSP_CP_NORMAL || min_size < 1) {
+		fprintf(stderr, "Invalid changepoint cost %d or minimum segment size %ld\n", cost, min_size);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Finds the optimal segmentation with PELT (pruned exact linear time)
+ * A start is pruned only after a changepoint follows it, so the candidates are the points of
+ * the current segment: O(n * segment length), use tsp_binseg for long segments
+ *
+ * values: n values
+ * cost: Segment cost function (TSP_CP_*)
+ * penalty: Cost added per changepoint
+ * min_size: Minimum number of values in a segment
+ * out: Room for n / min_size changepoints
+ *
+ * return: Number of changepoints written to out in increasing order, or -1 on failure
+ */
+long tsp_pelt(const double *values, long n, int cost, double penalty, long min_size, long *out) {
+	if (tsp_cp_check(n, cost, min_size) != 0) {
+		return -1;
+	}
+	if (n < 2 * min_size) {
+		return 0;
+	}
+	struct tsp_cp_cost c;
+	double *best = malloc((n + 1) * sizeof(double)); // best[t]: optimal score of values[0..t)
+	long *last = malloc((n + 1) * sizeof(long));	 // last[t]: start of the last segment of best[t]
+	long *candidates = malloc((n + 1) * sizeof(long));
+	long *expiry = malloc((n + 1) * sizeof(long)); // Step a candidate is pruned at, 0 if it is not doomed
+	double *scores = malloc((n + 1) * sizeof(double));
+	if (best == NULL || last == NULL || candidates == NULL || expiry == NULL || scores == NULL ||
+	    tsp_cp_cost_init(&c, cost, values, n) != 0) {
+		fprintf(stderr, "Could not allocate memory for changepoint detection\n");
+		free(best);
+		free(last);
+		free(candidates);
+		free(expiry);
+		free(scores);
+		return -1;
+	}
+
+	best[0] = -penalty;
+	long count = 0;
+	for (long t = min_size; t <= n; t++) {
+		// Starts that leave at least min_size values for the first segment become candidates
+		long s = t - min_size;
+		if (s == 0 || s >= min_size) {
+			candidates[count] = s;
+			expiry[count++] = 0;
+		}
+		long kept = 0;
+		for (long i = 0; i < count; i++) {
+			if (expiry[i] == 0 || expiry[i] > t) {
+				candidates[kept] = candidates[i];
+				expiry[kept++] = expiry[i];
+			}
+		}
+		count = kept;
+
+		double score = DBL_MAX;
+		long argmin = 0;
+		for (long i = 0; i < count; i++) {
+			scores[i] = best[candidates[i]] + tsp_cp_cost(&c, candidates[i], t);
+			if (scores[i] + penalty < score) {
+				score = scores[i] + penalty;
+				argmin = candidates[i];
+			}
+		}
+		best[t] = score;
+		last[t] = argmin;
+		/*
+		 * A start that scores worse than best[t] without the penalty can't be optimal for
+		 * any end after t once t itself is a valid start, which is min_size steps later
+		 */
+		for (long i = 0; i < count; i++) {
+			if (expiry[i] == 0 && scores[i] > score) {
+				expiry[i] = t + min_size;
+			}
+		}
+	}
+
+	long found = 0;
+	for (long t = last[n]; t > 0; t = last[t]) {
+		out[found++] = t;
+	}
+	for (long i = 0; i < found / 2; i++) {
+		long tmp = out[i];
+		out[i] = out[found - 1 - i];
+		out[found - 1 - i] = tmp;
+	}
+	tsp_cp_cost_free(&c);
+	free(best);
+	free(last);
+	free(candidates);
+	free(expiry);
+	free(scores);
+	return found;
+}
+
+/* Segment of binary segmentation with its best split */
+struct tsp_cp_segment {
+	long start, end;
+	long split; // Best split point, -1 if the segment cannot be split
+	double gain;
+};
+
+static void tsp_cp_best_split(const struct tsp_cp_cost *c, struct tsp_cp_segment *seg, long min_size) {
+	seg->split = -1;
+	seg->gain = -DBL_MAX;
+	double whole = tsp_cp_cost(c, seg->start, seg->end);
+	for (long t = seg->start + min_size; t <= seg->end - min_size; t++) {
+		double gain = whole - tsp_cp_cost(c, seg->start, t) - tsp_cp_cost(c, t, seg->end);
+		if (gain > seg->gain) {
+			seg->gain = gain;
+			seg->split = t;
+		}
+	}
+}
+
+static int tsp_cp_compare(const void *a, const void *b) {
+	long x = *(const long *)a, y = *(const long *)b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * Finds changepoints with binary segmentation
+ * The segment whose best split reduces the cost most is split while the reduction exceeds
+ * the penalty, or until max_changepoints are found
+ *
+ * max_changepoints: Maximum number of changepoints, negative for no limit
+ * out: Room for n / min_size changepoints
+ *
+ * return: Number of changepoints written to out in increasing order, or -1 on failure
+ */
+long tsp_binseg(const double *values, long n, int cost, double penalty, long min_size, long max_changepoints,
+		long *out) {
+	if (tsp_cp_check(n, cost, min_size) != 0) {
+		return -1;
+	}
+	if (n < 2 * min_size || max_changepoints == 0) {
+		return 0;
+	}
+	struct tsp_cp_cost c;
+	long capacity = n / min_size + 1;
+	struct tsp_cp_segment *segments = malloc(capacity * sizeof(struct tsp_cp_segment));
+	if (segments == NULL || tsp_cp_cost_init(&c, cost, values, n) != 0) {
+		fprintf(stderr, "Could not allocate memory for changepoint detection\n");
+		free(segments);
+		return -1;
+	}
+
+	long count = 1, found = 0;
+	segments[0] = (struct tsp_cp_segment){.start = 0, .end = n};
+	tsp_cp_best_split(&c, &segments[0], min_size);
+	while (max_changepoints < 0 || found < max_changepoints) {
+		long pick = -1;
+		for (long i = 0; i < count; i++) {
+			if (segments[i].split >= 0 && (pick < 0 || segments[i].gain > segments[pick].gain)) {
+				pick = i;
+			}
+		}
+		if (pick < 0 || segments[pick].gain <= penalty) {
+			break;
+		}
+		long split = segments[pick].split;
+		out[found++] = split;
+		segments[count] = (struct tsp_cp_segment){.start = split, .end = segments[pick].end};
+		segments[pick].end = split;
+		tsp_cp_best_split(&c, &segments[pick], min_size);
+		tsp_cp_best_split(&c, &segments[count], min_size);
+		count++;
+	}
+	qsort(out, found, sizeof(long), tsp_cp_compare);
+	tsp_cp_cost_free(&c);
+	free(segments);
+	return found;
+}
@@ -0,0 +1,35 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef CHANGEPOINT_H
+#define CHANGEPOINT_H
+
+/*
+ * Offline changepoint detection
+ *
+ * A segmentation of values[0..n) into segments [s, e) is scored by the sum of segment
+ * costs plus a penalty per changepoint; the cost of a segment is computed in O(1)
+ * from prefix sums of the (centered) values and their squares.
+ */
+struct tsp_cp_cost {
+	int kind;      // Cost function (TSP_CP_*)
+	double *sum;   // sum[i]: sum of the first i centered values
+	double *sumsq; // sumsq[i]: sum of their squares
+};
+
+TSP_API_START
+/*
+ * Segment cost functions
+ *
+ * TSP_CP_L2       - squared deviations from the segment mean, detects mean shifts
+ * TSP_CP_VARIANCE - Gaussian likelihood with the global mean, detects variance shifts
+ * TSP_CP_NORMAL   - Gaussian likelihood with segment mean and variance, detects both
+ */
+#define TSP_CP_L2 0
+#define TSP_CP_VARIANCE 1
+#define TSP_CP_NORMAL 2
+
+long tsp_pelt(const double *values, long n, int cost, double penalty, long min_size, long *out);
+long tsp_binseg(const double *values, long n, int cost, double penalty, long min_size, long max_changepoints,
+		long *out);
+TSP_API_END
+#endif /* CHANGEPOINT_H */
@@ -0,0 +1,146 @@
+#include "condition.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Add x to the compensated sum */
+static void tsp_condition_add(struct tsp_condition *c, double x) {
+	double t = c->sum + x;
+	if (fabs(c->sum) >= fabs(x)) {
+		c->sum_comp += (c->sum - t) + x;
+	} else {
+		c->sum_comp += (x - t) + c->sum;
+	}
+	c->sum = t;
+}
+
+/*
+ * Add x to the sum (sign 1) or remove it (sign -1)
+ * Non-finite values are only counted, so they don't stay in the sum after leaving the window
+ */
+static void tsp_condition_update(struct tsp_condition *c, double x, int sign) {
+	if (isnan(x)) {
+		c->nan_count += sign;
+	} else if (isinf(x)) {
+		if (x > 0) {
+			c->pinf_count += sign;
+		} else {
+			c->ninf_count += sign;
+		}
+	} else {
+		tsp_condition_add(c, sign * x);
+	}
+}
+
+/* Sum of the window, non-finite values give what a plain sum of the window would */
+static double tsp_condition_sum(const struct tsp_condition *c) {
+	if (c->nan_count > 0 || (c->pinf_count > 0 && c->ninf_count > 0)) {
+		return NAN;
+	}
+	if (c->pinf_count > 0) {
+		return INFINITY;
+	}
+	if (c->ninf_count > 0) {
+		return -INFINITY;
+	}
+	return c->sum + c->sum_comp;
+}
+
+/* Whether the window satisfies the condition */
+static int tsp_condition_check(const struct tsp_condition *c) {
+	if (c->count == 0) {
+		return 0;
+	}
+	switch (c->kind) {
+	case TSP_COND_COUNT:
+		return c->count >= c->threshold;
+	case TSP_COND_SUM:
+	case TSP_COND_ABS_SUM:
+		return tsp_condition_sum(c) >= c->threshold;
+	case TSP_COND_SPAN:
+		return (double)(c->last_idx - c->first_idx) >= c->threshold;
+	case TSP_COND_CHANGE:
+		return fabs(c->last - c->first) >= c->threshold;
+	}
+	return 0;
+}
+
+/*
+ * Creates a take-condition for an empty window
+ *
+ * kind: Kind of the condition (TSP_COND_*)
+ * threshold: Value the aggregate of the window is compared with
+ *
+ * return: Pointer to initialized condition, or NULL on failure
+ */
+struct tsp_condition *tsp_condition_init(int kind, double threshold) {
+	if (kind < TSP_COND_COUNT || kind > TSP_COND_CHANGE) {
+		fprintf(stderr, "Unknown condition kind %d\n", kind);
+		return NULL;
+	}
+	struct tsp_condition *obj = malloc(sizeof(struct tsp_condition));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize condition\n");
+		return NULL;
+	}
+	obj->kind = kind;
+	obj->threshold = threshold;
+	tsp_condition_reset(obj);
+	return obj;
+}
+
+void tsp_free_condition(struct tsp_condition *c) { free(c); }
+
+/* Forget the window */
+void tsp_condition_reset(struct tsp_condition *c) {
+	c->count = 0;
+	c->sum = 0;
+	c->sum_comp = 0;
+	c->nan_count = 0;
+	c->pinf_count = 0;
+	c->ninf_count = 0;
+}
+
+/*
+ * Appends a value to the window
+ *
+ * return: 1 if the window satisfies the condition, 0 otherwise
+ */
+int tsp_condition_push(struct tsp_condition *c, double value, int64_t index) {
+	if (c->count == 0) {
+		c->first = value;
+		c->first_idx = index;
+	}
+	c->count++;
+	c->last = value;
+	c->last_idx = index;
+	if (c->kind == TSP_COND_SUM) {
+		tsp_condition_update(c, value, 1);
+	} else if (c->kind == TSP_COND_ABS_SUM) {
+		tsp_condition_update(c, fabs(value), 1);
+	}
+	return tsp_condition_check(c);
+}
+
+/*
+ * Removes the oldest value from the window
+ *
+ * value: The removed value
+ * front, front_index: The oldest value left in the window and its index, ignored if it is empty
+ */
+void tsp_condition_pop(struct tsp_condition *c, double value, double front, int64_t front_index) {
+	if (c->count == 0) {
+		return;
+	}
+	if (--c->count == 0) {
+		tsp_condition_reset(c);
+		return;
+	}
+	c->first = front;
+	c->first_idx = front_index;
+	if (c->kind == TSP_COND_SUM) {
+		tsp_condition_update(c, value, -1);
+	} else if (c->kind == TSP_COND_ABS_SUM) {
+		tsp_condition_update(c, fabs(value), -1);
+	}
+}
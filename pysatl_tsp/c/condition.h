@@ -0,0 +1,52 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef CONDITION_H
+#define CONDITION_H
+#include <stdint.h>
+
+/*
+ * Incremental take-condition of a sliding window
+ *
+ * The window itself is kept by the caller, the condition only keeps the aggregates
+ * it needs, updated in O(1) when a value enters or leaves the window.
+ */
+struct tsp_condition {
+	int kind;	   // Kind of the condition (TSP_COND_*)
+	double threshold;  // Value the aggregate is compared with
+	long count;	   // Values in the window
+	double sum;	   // Sum of finite values (or of absolute values for TSP_COND_ABS_SUM)
+	double sum_comp;   // Low-order bits lost by sum (Neumaier compensation)
+	long nan_count;	   // NaN values in the window, kept out of sum
+	long pinf_count;   // +inf values in the window, kept out of sum
+	long ninf_count;   // -inf values in the window, kept out of sum
+	double first;	   // Oldest value of the window
+	int64_t first_idx; // Index of the oldest value
+	double last;	   // Newest value of the window
+	int64_t last_idx;  // Index of the newest value
+};
+
+TSP_API_START
+/*
+ * Kinds of take-conditions, the window is taken when
+ *
+ * TSP_COND_COUNT   - it holds at least threshold values
+ * TSP_COND_SUM     - the sum of its values is at least threshold
+ * TSP_COND_ABS_SUM - the sum of absolute values is at least threshold
+ * TSP_COND_SPAN    - the newest index is at least threshold after the oldest one
+ * TSP_COND_CHANGE  - the newest value differs from the oldest one by at least threshold
+ */
+#define TSP_COND_COUNT 0
+#define TSP_COND_SUM 1
+#define TSP_COND_ABS_SUM 2
+#define TSP_COND_SPAN 3
+#define TSP_COND_CHANGE 4
+
+struct tsp_condition;
+
+struct tsp_condition *tsp_condition_init(int kind, double threshold);
+void tsp_free_condition(struct tsp_condition *c);
+void tsp_condition_reset(struct tsp_condition *c);
+int tsp_condition_push(struct tsp_condition *c, double value, int64_t index);
+void tsp_condition_pop(struct tsp_condition *c, double value, double front, int64_t front_index);
+TSP_API_END
+#endif /* CONDITION_H */
@@ -23,16 +23,21 @@
  * adjust - Bias correction:
  * When adjust=True, uses an adjusted weighting method that gives more weight to recent
  * observations.
+ *
+ * precision - Storage of the SMA warm-up window (TSP_PRECISION_*),
+ * the EMA state itself is always double.
  */
-struct tsp_ema_data *tsp_ema_data_init(int capacity, int sma, double alpha, int adjust) {
+struct tsp_ema_data *tsp_ema_data_init(int capacity, int sma, double alpha, int adjust,
+				       int precision) {
 	struct tsp_ema_data *obj = malloc(sizeof(struct tsp_ema_data));
 	if (obj == NULL) {
 		fprintf(stderr, "Could not allocate memory to initialize ema's data\n");
 		return NULL;
 	}
-	obj->queue = tsp_queue_init(capacity);
+	obj->queue = tsp_queue_init_precision(capacity, precision);
 	if (obj->queue == NULL) {
 		fprintf(stderr, "Could not allocate memory to initialize queue\n");
+		free(obj);
 		return NULL;
 	}
 
@@ -53,14 +58,19 @@ void tsp_free_ema_data(struct tsp_ema_data *q) {
 	free(p);
 }
 
+/* Start a new series, sma is the warm-up flag given to tsp_ema_data_init */
+void tsp_ema_data_reset(struct tsp_ema_data *q, int sma) {
+	tsp_queue_reset(q->queue);
+	q->sma = sma;
+	q->ema_numerator = 0;
+	q->ema_denominator = 0;
+}
+
 /*
  * Add value to EMA queue during SMA warm-up period
  */
-static int tsp_ema_data_put(struct tsp_ema_data *data, float value) {
-	struct tsp_queue *queue = data->queue;
-	queue->buffer[queue->tail] = value;
-	queue->tail = (queue->tail + 1) % queue->capacity;
-	return 0;
+static double tsp_ema_data_put(struct tsp_ema_data *data, double value) {
+	return tsp_queue_put(data->queue, value);
 }
 
 /*
@@ -70,7 +80,7 @@ static int tsp_ema_data_put(struct tsp_ema_data *data, float value) {
 static void tsp_clear_queue(struct tsp_queue *queue) {
 	queue->head = 0;
 	queue->tail = 0;
-	queue->sum = 0;
+	tsp_queue_sum_reset(queue);
 }
 
 /*
@@ -100,8 +110,7 @@ static int tsp_update_state(struct tsp_ema_data *data, double *value) {
 		if (data->queue->size < data->queue->capacity) {
 			// Growing window phase
 			data->queue->size++;
-			data->queue->sum += *value;
-			tsp_ema_data_put(data, *value);
+			tsp_queue_sum_push(data->queue, tsp_ema_data_put(data, *value));
 		}
 	}
 
@@ -114,7 +123,7 @@ static int tsp_update_state(struct tsp_ema_data *data, double *value) {
 	if (data->sma != 0) {
 		// Transition from SMA to EMA
 		if (data->queue->size != 0) {
-			double sma_value = data->queue->sum / data->queue->size;
+			double sma_value = tsp_queue_sum_value(data->queue) / data->queue->size;
 			tsp_clear_queue(data->queue);
 			data->ema_numerator = sma_value;
 			data->ema_denominator = 1;
@@ -164,3 +173,31 @@ double tsp_op_EMA(struct tsp_handler *handler, void *next) {
 
 	return ma; // Check for inf in Python
 }
+
+/*
+ * Exponential Moving Average operation over a block of values (batch operation of tsp_handler)
+ *
+ * The EMA recurrence is sequential in time, so a single series gains no SIMD lanes
+ * (the EMA kernel updates many series at once, see multiseries.c). In the steady state
+ * of the standard EMA the block is run in a tight loop over local state instead of
+ * one operation call per value, with the arithmetic of tsp_op_EMA.
+ */
+int tsp_batch_EMA(struct tsp_handler *handler, double *values, int n) {
+	struct tsp_ema_data *data = (struct tsp_ema_data *)handler->data;
+	int i = 0;
+
+	while (i < n && (data->sma != 0 || data->adjust != 0 || data->ema_denominator == 0 ||
+			 data->queue->size < data->queue->capacity)) {
+		values[i] = tsp_op_EMA(handler, (void *)&values[i]);
+		i++;
+	}
+
+	double numerator = data->ema_numerator;
+	double alpha = data->alpha;
+	for (; i < n; i++) {
+		numerator = (1 - alpha) * numerator + alpha * values[i];
+		values[i] = numerator / data->ema_denominator;
+	}
+	data->ema_numerator = numerator;
+	return 0;
+}
@@ -22,8 +22,11 @@ struct tsp_ema_data {
 	double ema_numerator;	 // Current EMA value before normalization
 	double ema_denominator;	 // Cumulative weight sum for proper normalization
 };
-struct tsp_ema_data *tsp_ema_data_init(int capacity, int sma, double alpha, int adjust);
+struct tsp_ema_data *tsp_ema_data_init(int capacity, int sma, double alpha, int adjust,
+				       int precision);
 void tsp_free_ema_data(struct tsp_ema_data *q);
+void tsp_ema_data_reset(struct tsp_ema_data *q, int sma);
 double tsp_op_EMA(struct tsp_handler *handler, void *next);
+int tsp_batch_EMA(struct tsp_handler *handler, double *values, int n);
 TSP_API_END
 #endif /* EMA_HANDLER_H */
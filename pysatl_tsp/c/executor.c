@@ -0,0 +1,201 @@
+#include "executor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Shared state of the workers of one tsp_executor_run */
+struct tsp_executor {
+	struct tsp_job *jobs;
+	struct tsp_deque *deques; // One per worker
+	int n_workers;
+};
+
+/* Argument of a worker thread */
+struct tsp_worker {
+	struct tsp_executor *ex;
+	int index;
+	int running; // Whether the thread was started
+};
+
+/* Job id with the size hint it is ordered by */
+struct tsp_job_order {
+	long size_hint;
+	long id;
+};
+
+/* Monotonic clock, nanoseconds */
+static int64_t tsp_executor_now(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+/* Take the next job of the owner, -1 if the deque is empty */
+static long tsp_deque_pop(struct tsp_deque *d) {
+	long id = -1;
+	pthread_mutex_lock(&d->lock);
+	if (d->head < d->tail) {
+		id = d->ids[d->head++];
+	}
+	pthread_mutex_unlock(&d->lock);
+	return id;
+}
+
+/* Take the last job of another worker, -1 if the deque is empty */
+static long tsp_deque_steal(struct tsp_deque *d) {
+	long id = -1;
+	pthread_mutex_lock(&d->lock);
+	if (d->head < d->tail) {
+		id = d->ids[--d->tail];
+	}
+	pthread_mutex_unlock(&d->lock);
+	return id;
+}
+
+/* Jobs left in a deque */
+static long tsp_deque_size(struct tsp_deque *d) {
+	pthread_mutex_lock(&d->lock);
+	long size = d->tail - d->head;
+	pthread_mutex_unlock(&d->lock);
+	return size;
+}
+
+/*
+ * Next job for a worker: its own, or one stolen from the worker with the most jobs left
+ * No jobs are added during a run, so once every deque is empty the worker is done
+ */
+static long tsp_executor_take(struct tsp_executor *ex, int index) {
+	long id = tsp_deque_pop(&ex->deques[index]);
+	while (id < 0) {
+		int victim = -1;
+		long most = 0;
+		for (int w = 0; w < ex->n_workers; w++) {
+			long size = tsp_deque_size(&ex->deques[w]);
+			if (w != index && size > most) {
+				victim = w;
+				most = size;
+			}
+		}
+		if (victim < 0) {
+			return -1;
+		}
+		id = tsp_deque_steal(&ex->deques[victim]);
+	}
+	return id;
+}
+
+/* Run jobs until there are none left */
+static void *tsp_executor_work(void *arg) {
+	struct tsp_worker *worker = arg;
+	struct tsp_executor *ex = worker->ex;
+	long id;
+	while ((id = tsp_executor_take(ex, worker->index)) >= 0) {
+		struct tsp_job *job = &ex->jobs[id];
+		job->worker = worker->index;
+		job->start_ns = tsp_executor_now();
+		job->values = tsp_drain_chain(job->chain, job->size_hint, &job->length);
+		job->end_ns = tsp_executor_now();
+		if (job->values == NULL) {
+			job->length = 0;
+		}
+	}
+	return NULL;
+}
+
+/* Orders jobs by decreasing size hint, submission order among equal hints */
+static int tsp_executor_compare(const void *a, const void *b) {
+	const struct tsp_job_order *x = a, *y = b;
+	if (x->size_hint != y->size_hint) {
+		return x->size_hint > y->size_hint ? -1 : 1;
+	}
+	return x->id < y->id ? -1 : x->id > y->id;
+}
+
+/*
+ * Runs independent handler chains to completion on a pool of worker threads
+ *
+ * The jobs are dealt round-robin to the workers in order of decreasing size hint,
+ * every worker runs its own jobs from the largest one and, when it has none left,
+ * steals the smallest job of the worker with the most jobs left. Uneven jobs are
+ * thereby balanced without a shared queue every worker contends on. The calling
+ * thread is worker 0, it should not hold the GIL (cffi releases it during the call).
+ *
+ * jobs: Jobs to run, their outputs, timings and workers are written back
+ * n_jobs: Number of jobs
+ * n_workers: Number of workers, including the calling thread
+ *
+ * return: Number of workers that ran, or -1 on failure
+ */
+int tsp_executor_run(struct tsp_job *jobs, long n_jobs, int n_workers) {
+	if (n_workers < 1) {
+		fprintf(stderr, "Invalid number of workers %d\n", n_workers);
+		return -1;
+	}
+	if (n_workers > n_jobs) {
+		n_workers = n_jobs > 0 ? (int)n_jobs : 1;
+	}
+	struct tsp_job_order *order = malloc(sizeof(struct tsp_job_order) * (n_jobs > 0 ? n_jobs : 1));
+	long *ids = malloc(sizeof(long) * (n_jobs > 0 ? n_jobs : 1));
+	struct tsp_deque *deques = malloc(sizeof(struct tsp_deque) * n_workers);
+	struct tsp_worker *workers = malloc(sizeof(struct tsp_worker) * n_workers);
+	pthread_t *threads = malloc(sizeof(pthread_t) * n_workers);
+	if (order == NULL || ids == NULL || deques == NULL || workers == NULL || threads == NULL) {
+		fprintf(stderr, "Could not allocate memory to run jobs\n");
+		free(order);
+		free(ids);
+		free(deques);
+		free(workers);
+		free(threads);
+		return -1;
+	}
+
+	for (long i = 0; i < n_jobs; i++) {
+		order[i].size_hint = jobs[i].size_hint;
+		order[i].id = i;
+		jobs[i].values = NULL;
+		jobs[i].length = 0;
+		jobs[i].start_ns = jobs[i].end_ns = 0;
+		jobs[i].worker = -1;
+	}
+	qsort(order, n_jobs, sizeof(struct tsp_job_order), tsp_executor_compare);
+
+	// Worker w gets the jobs w, w + n_workers, ... of the order, in a slice of ids
+	struct tsp_executor ex = {jobs, deques, n_workers};
+	long offset = 0;
+	for (int w = 0; w < n_workers; w++) {
+		struct tsp_deque *d = &deques[w];
+		pthread_mutex_init(&d->lock, NULL);
+		d->ids = ids + offset;
+		d->head = 0;
+		d->tail = 0;
+		for (long k = w; k < n_jobs; k += n_workers) {
+			d->ids[d->tail++] = order[k].id;
+		}
+		offset += d->tail;
+		workers[w].ex = &ex;
+		workers[w].index = w;
+	}
+
+	// A worker that can't be started leaves its jobs to be stolen
+	int started = 1;
+	for (int w = 1; w < n_workers; w++) {
+		workers[w].running = pthread_create(&threads[w], NULL, tsp_executor_work, &workers[w]) == 0;
+		started += workers[w].running;
+	}
+	tsp_executor_work(&workers[0]);
+	for (int w = 1; w < n_workers; w++) {
+		if (workers[w].running) {
+			pthread_join(threads[w], NULL);
+		}
+	}
+
+	for (int w = 0; w < n_workers; w++) {
+		pthread_mutex_destroy(&deques[w].lock);
+	}
+	free(order);
+	free(ids);
+	free(deques);
+	free(workers);
+	free(threads);
+	return started;
+}
@@ -0,0 +1,37 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+#include "handler.h"
+#include <pthread.h>
+#include <stdint.h>
+
+/* Job ids of one worker, the owner takes from head, thieves from tail */
+struct tsp_deque {
+	pthread_mutex_t lock;
+	long *ids;  // Slice of the shared id array
+	long head;  // Next job of the owner
+	long tail;  // One past the last job
+};
+
+TSP_API_START
+/*
+ * Independent pipeline run by tsp_executor_run
+ *
+ * The chain must not share handlers with the chain of another job. Chains with a
+ * native leaf source run without the GIL, chains reading a Python iterator take it
+ * for every block of the source.
+ */
+struct tsp_job {
+	struct tsp_handler *chain; // Handler chain drained to completion
+	long size_hint;		   // Expected number of output values, 0 if unknown
+	double *values;		   // Output values (free with tsp_free_values), NULL if the job failed
+	long length;		   // Number of output values
+	int64_t start_ns;	   // Monotonic clock when the job started, nanoseconds
+	int64_t end_ns;		   // Monotonic clock when the job ended, nanoseconds
+	int worker;		   // Index of the worker that ran the job
+};
+
+int tsp_executor_run(struct tsp_job *jobs, long n_jobs, int n_workers);
+TSP_API_END
+#endif /* EXECUTOR_H */
@@ -0,0 +1,252 @@
+#include "file_source.h"
+#include "parse.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Read the whole file into memory, used when the file can't be mapped */
+static char *tsp_csv_read_file(int fd, size_t size) {
+	char *data = malloc(size);
+	if (data == NULL) {
+		return NULL;
+	}
+	size_t done = 0;
+	while (done < size) {
+		ssize_t n = read(fd, data + done, size - done);
+		if (n <= 0) {
+			free(data);
+			return NULL;
+		}
+		done += (size_t)n;
+	}
+	return data;
+}
+
+/*
+ * Splits the row at p: returns the start of the next row and stores the end
+ * of this row, excluding the line terminator, to *row_end
+ */
+static const char *tsp_csv_split_row(const char *p, const char *end, const char **row_end) {
+	const char *nl = memchr(p, '\n', (size_t)(end - p));
+	const char *next = nl == NULL ? end : nl + 1;
+	if (nl == NULL) {
+		nl = end;
+	}
+	if (nl > p && nl[-1] == '\r') {
+		nl--;
+	}
+	*row_end = nl;
+	return next;
+}
+
+/* Check that the row at [p, row_end) contains only blanks */
+static int tsp_csv_row_blank(const char *p, const char *row_end) {
+	for (; p < row_end; p++) {
+		if (*p != ' ' && *p != '\t') {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Parses the field starting at p, which ends at the delimiter or at row_end
+ * Quoted numbers are accepted, anything else than blanks after the number gives NaN
+ * A blank field is missing and gives the missing value
+ */
+static double tsp_csv_parse_field(const char *p, const char *row_end, char delimiter,
+				  double missing) {
+	const char *field_end = memchr(p, delimiter, (size_t)(row_end - p));
+	if (field_end == NULL) {
+		field_end = row_end;
+	}
+	while (p < field_end && (*p == ' ' || *p == '\t')) {
+		p++;
+	}
+	if (p == field_end) {
+		return missing;
+	}
+	int quoted = p < field_end && *p == '"';
+	if (quoted) {
+		p++;
+	}
+	const char *next = NULL;
+	double value = tsp_parse_double(p, field_end, &next);
+	if (next == p) {
+		return NAN;
+	}
+	if (quoted && next < field_end && *next == '"') {
+		next++;
+	}
+	while (next < field_end && (*next == ' ' || *next == '\t')) {
+		next++;
+	}
+	return next == field_end ? value : NAN;
+}
+
+/* Return the start of the column-th field of the row, or NULL if the row is shorter */
+static const char *tsp_csv_find_field(const char *p, const char *row_end, int column, char delimiter) {
+	for (int i = 0; i < column; i++) {
+		const char *d = memchr(p, delimiter, (size_t)(row_end - p));
+		if (d == NULL) {
+			return NULL;
+		}
+		p = d + 1;
+	}
+	return p;
+}
+
+/*
+ * Opens a delimited text file as a native source
+ *
+ * path: Path to the file
+ * column: Zero-based column to read
+ * delimiter: Field delimiter
+ * skip_rows: Number of leading rows to skip (headers)
+ *
+ * return: Pointer to initialized source, or NULL on failure
+ */
+struct tsp_csv_source *tsp_csv_source_init(const char *path, int column, char delimiter,
+					   int skip_rows) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Could not open file %s\n", path);
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		fprintf(stderr, "Could not get size of file %s\n", path);
+		close(fd);
+		return NULL;
+	}
+
+	struct tsp_csv_source *obj = malloc(sizeof(struct tsp_csv_source));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize csv source\n");
+		close(fd);
+		return NULL;
+	}
+	obj->size = (size_t)st.st_size;
+	obj->data = NULL;
+	obj->mapped = 0;
+	if (obj->size > 0) {
+		void *map = mmap(NULL, obj->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			// Rows are parsed once from start to end
+			madvise(map, obj->size, MADV_SEQUENTIAL);
+			obj->data = map;
+			obj->mapped = 1;
+		} else {
+			obj->data = tsp_csv_read_file(fd, obj->size);
+			if (obj->data == NULL) {
+				fprintf(stderr, "Could not read file %s\n", path);
+				close(fd);
+				free(obj);
+				return NULL;
+			}
+		}
+	}
+	close(fd);
+
+	const char *end = obj->data + obj->size;
+	obj->body = obj->data;
+	const char *row_end = NULL;
+	for (int i = 0; i < skip_rows && obj->body < end; i++) {
+		obj->body = tsp_csv_split_row(obj->body, end, &row_end);
+	}
+	obj->pos = obj->body;
+	obj->column = column;
+	obj->delimiter = delimiter;
+	return obj;
+}
+
+/* Free csv source and unmap the file */
+void tsp_free_csv_source(struct tsp_csv_source *src) {
+	if (src->data != NULL) {
+		if (src->mapped) {
+			munmap((void *)src->data, src->size);
+		} else {
+			free((void *)src->data);
+		}
+	}
+	free(src);
+}
+
+/* Start reading again from the first row after the header */
+void tsp_csv_source_rewind(struct tsp_csv_source *src) { src->pos = src->body; }
+
+/* Count non-empty rows after the header */
+long tsp_csv_count_rows(struct tsp_csv_source *src) {
+	const char *end = src->data + src->size;
+	const char *row_end = NULL;
+	long rows = 0;
+	for (const char *p = src->body; p < end;) {
+		const char *next = tsp_csv_split_row(p, end, &row_end);
+		rows += !tsp_csv_row_blank(p, row_end);
+		p = next;
+	}
+	return rows;
+}
+
+/*
+ * Parses several columns at once, independently of the streaming position
+ * Missing fields are stored as NaN, like in other arrays drained from the library
+ *
+ * columns: Zero-based columns to read
+ * ncolumns: Number of columns
+ * out: Row-major output of max_rows * ncolumns values
+ * max_rows: Capacity of out in rows
+ *
+ * return: Number of rows written
+ */
+long tsp_csv_read_columns(struct tsp_csv_source *src, const int *columns, int ncolumns, double *out,
+			  long max_rows) {
+	const char *end = src->data + src->size;
+	const char *row_end = NULL;
+	long rows = 0;
+	for (const char *p = src->body, *next; p < end && rows < max_rows; p = next) {
+		next = tsp_csv_split_row(p, end, &row_end);
+		if (tsp_csv_row_blank(p, row_end)) {
+			continue;
+		}
+		for (int k = 0; k < ncolumns; k++) {
+			const char *field = tsp_csv_find_field(p, row_end, columns[k], src->delimiter);
+			out[rows * ncolumns + k] =
+			    field == NULL ? NAN : tsp_csv_parse_field(field, row_end, src->delimiter, NAN);
+		}
+		rows++;
+	}
+	return rows;
+}
+
+/*
+ * Fill function of the csv source handler (see tsp_init_source)
+ * Parses up to capacity rows of the selected column into the handler's buffer
+ * Missing fields (blank or beyond the end of the row) are passed to the chain as infinity,
+ * the value native handlers use for missing values
+ */
+int tsp_fill_csv(struct tsp_handler *handler, double **block, int capacity) {
+	struct tsp_csv_source *src = (struct tsp_csv_source *)handler->data;
+	const char *end = src->data + src->size;
+	const char *p = src->pos;
+	double *out = *block;
+	int count = 0;
+	const char *row_end = NULL;
+	while (p < end && count < capacity) {
+		const char *next = tsp_csv_split_row(p, end, &row_end);
+		if (!tsp_csv_row_blank(p, row_end)) {
+			const char *field = tsp_csv_find_field(p, row_end, src->column, src->delimiter);
+			out[count++] = field == NULL ? INFINITY
+						     : tsp_csv_parse_field(field, row_end, src->delimiter,
+									   INFINITY);
+		}
+		p = next;
+	}
+	src->pos = p;
+	return count;
+}
@@ -0,0 +1,36 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef FILE_SOURCE_H
+#define FILE_SOURCE_H
+#include "handler.h"
+#include <stddef.h>
+
+TSP_API_START
+/*
+ * Native source of numbers stored in a delimited text file (CSV, TSV, one value per line)
+ *
+ * The file is memory-mapped (read into memory if mapping is not possible) and parsed
+ * without Python: tsp_fill_csv feeds the selected column to the handler chain.
+ * Empty lines are skipped, missing or non-numeric fields are returned as NaN.
+ */
+struct tsp_csv_source {
+	const char *data; // File contents
+	size_t size;	  // File size in bytes
+	int mapped;	  // 1 if data is memory-mapped, 0 if it is a malloc'd copy
+	const char *body; // First row after the skipped header rows
+	const char *pos;  // Next row to parse
+	int column;	  // Zero-based column to read
+	char delimiter;	  // Field delimiter
+};
+
+struct tsp_csv_source *tsp_csv_source_init(const char *path, int column, char delimiter,
+					   int skip_rows);
+void tsp_free_csv_source(struct tsp_csv_source *src);
+void tsp_csv_source_rewind(struct tsp_csv_source *src);
+long tsp_csv_count_rows(struct tsp_csv_source *src);
+long tsp_csv_read_columns(struct tsp_csv_source *src, const int *columns, int ncolumns, double *out,
+			  long max_rows);
+
+int tsp_fill_csv(struct tsp_handler *handler, double **block, int capacity);
+TSP_API_END
+#endif /* FILE_SOURCE_H */
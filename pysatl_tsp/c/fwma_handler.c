@@ -1,5 +1,6 @@
 #include "fwma_handler.h"
 #include "handler.h"
+#include "kernels.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -44,11 +45,12 @@ static int tsp_create_fibonacci_sequence(struct tsp_fwma_data *data) {
  *
  * capacity: Maximum number of elements the structure can hold
  * asc: Ascending flag (purpose depends on implementation)
+ * precision: Storage of the price window (TSP_PRECISION_*), weights are always double
  *
  * return: Pointer to initialized structure, or NULL on failure
  *
  */
-struct tsp_fwma_data *tsp_fwma_data_init(int capacity, int asc) {
+struct tsp_fwma_data *tsp_fwma_data_init(int capacity, int asc, int precision) {
 	// Step 1: Allocate memory for the main structure
 	struct tsp_fwma_data *obj = malloc(sizeof(struct tsp_fwma_data));
 	if (obj == NULL) {
@@ -58,10 +60,10 @@ struct tsp_fwma_data *tsp_fwma_data_init(int capacity, int asc) {
 
 	// Step 2: Initialize the data queue
 	// The queue will store the actual data points for moving average calculation
-	obj->queue = tsp_queue_init(capacity);
+	obj->queue = tsp_queue_init_precision(capacity, precision);
 	if (obj->queue == NULL) {
 		fprintf(stderr, "Could not allocate memory to initialize queue\n");
-		// Note: obj is not freed here - potential memory leak
+		free(obj);
 		return NULL;
 	}
 
@@ -70,10 +72,25 @@ struct tsp_fwma_data *tsp_fwma_data_init(int capacity, int asc) {
 	obj->fib_sequence = malloc(sizeof(obj->fib_sequence[0]) * capacity);
 	if (obj->fib_sequence == NULL) {
 		fprintf(stderr, "Could not allocate memory to initialize fibonacci sequence\n");
-		// Note: Previous allocations are not freed - potential memory leak
+		tsp_free_queue((void *)obj->queue);
+		free(obj);
 		return NULL;
 	}
 
+	// Float32 windows are widened into this array, so that both precisions
+	// go through the same dot kernel and give the same results
+	obj->widened = NULL;
+	if (precision == TSP_PRECISION_F32) {
+		obj->widened = malloc(sizeof(obj->widened[0]) * capacity);
+		if (obj->widened == NULL) {
+			fprintf(stderr, "Could not allocate memory to initialize fwma window\n");
+			free(obj->fib_sequence);
+			tsp_free_queue((void *)obj->queue);
+			free(obj);
+			return NULL;
+		}
+	}
+
 	// Step 4: Initialize remaining fields
 	obj->fib_sum = 0.0; // Will store sum of Fibonacci weights
 	obj->asc = asc;	    // Store the ascending flag
@@ -90,23 +107,19 @@ void tsp_free_fwma_data(struct tsp_fwma_data *q) {
 	if (p->queue != NULL) {
 		tsp_free_queue((void *)p->queue);
 	}
+	free(p->fib_sequence);
+	free(p->widened);
 	free(p);
 }
 
-/* Add new value to FWMA data buffer */
-static int tsp_fwma_data_put(struct tsp_fwma_data *data, float value) {
-	struct tsp_queue *queue = data->queue;
-	queue->buffer[queue->tail] = value;
-	queue->tail = (queue->tail + 1) % queue->capacity;
-	return 0;
+/* Start a new series, the weights are kept */
+void tsp_fwma_data_reset(struct tsp_fwma_data *q) {
+	tsp_queue_reset(q->queue);
 }
 
-/* get value from FWMA data buffer */
-static double tsp_fwma_data_get(struct tsp_fwma_data *data) {
-	struct tsp_queue *queue = data->queue;
-	double value = queue->buffer[queue->head];
-	queue->head = (queue->head + 1) % queue->capacity;
-	return value;
+/* Add new value to FWMA data buffer */
+static double tsp_fwma_data_put(struct tsp_fwma_data *data, double value) {
+	return tsp_queue_put(data->queue, value);
 }
 
 /*
@@ -128,9 +141,9 @@ double tsp_op_FWMA(struct tsp_handler *handler, void *next) {
 	// Phase 1: Buffer filling (warm-up period)
 	// During initial calls, fill the buffer until we have enough data points
 	if (q->size < q->capacity) {
-		q->size++;			 // Track how many values we've collected
-		q->sum += *value;		 // Maintain running sum (unused in FWMA?)
-		tsp_fwma_data_put(data, *value); // Add value to circular buffer
+		double stored = tsp_fwma_data_put(data, *value); // Add value to circular buffer
+		q->size++;					  // Track how many values we've collected
+		q->sum += stored; // Maintain running sum (unused in FWMA?)
 	} else {
 		// Buffer is full - normal operation, just add the new value
 		tsp_fwma_data_put(data, *value);
@@ -142,9 +155,18 @@ double tsp_op_FWMA(struct tsp_handler *handler, void *next) {
 	}
 	// Phase 2: Calculate weighted average
 	// Multiply each data point in the buffer by its corresponding Fibonacci weight
-	for (int i = 0; i < q->capacity; i++) {
-		weighted_sum += data->fib_sequence[i] * tsp_fwma_data_get(data);
+	// The window is buffer[head..capacity) followed by buffer[0..head),
+	// both parts are contiguous and go to the vectorized dot kernel
+	const double *window = q->buffer;
+	if (q->precision == TSP_PRECISION_F32) {
+		for (int i = 0; i < q->capacity; i++) {
+			data->widened[i] = q->buffer_f32[i];
+		}
+		window = data->widened;
 	}
+	int first = q->capacity - q->head;
+	weighted_sum = tsp_kernel_dot(window + q->head, data->fib_sequence, first) +
+		       tsp_kernel_dot(window, data->fib_sequence + first, q->head);
 	q->head = (q->head + 1) % q->capacity;
 
 	return weighted_sum;
@@ -17,10 +17,12 @@ struct tsp_fwma_data {
 	double *fib_sequence;	 /* Pre-computed Fibonacci weights array */
 	double fib_sum;		 /* Sum of all Fibonacci weights for normalization */
 	int asc;		 /* Weight order: 1=ascending, 0=descending */
+	double *widened;	 /* Float32 window widened to double for the dot kernel */
 };
 
-struct tsp_fwma_data *tsp_fwma_data_init(int capacity, int asc);
+struct tsp_fwma_data *tsp_fwma_data_init(int capacity, int asc, int precision);
 void tsp_free_fwma_data(struct tsp_fwma_data *q);
+void tsp_fwma_data_reset(struct tsp_fwma_data *q);
 double tsp_op_FWMA(struct tsp_handler *handler, void *next);
 TSP_API_END
 #endif /* FWMA_HANDLER_H */
@@ -0,0 +1,546 @@
+#include "gorilla.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Widths of delta-of-delta values by the number of leading ones in the control bits */
+static const int tsp_gorilla_dod_bits[] = {0, 7, 9, 12, 32, 64};
+
+static int tsp_gorilla_clz(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_clzll(x);
+#else
+	int n = 0;
+	while (!(x & 0x8000000000000000ULL)) {
+		x <<= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+static int tsp_gorilla_ctz(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	while (!(x & 1)) {
+		x >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+/* Whether value fits into a signed field of width bits */
+static int tsp_gorilla_fits(int64_t value, int width) {
+	return value >= -((int64_t)1 << (width - 1)) && value < ((int64_t)1 << (width - 1));
+}
+
+/* Reset the state to the beginning of a chunk starting at timestamp first */
+static void tsp_gorilla_state_reset(struct tsp_gorilla_state *s, int64_t first) {
+	s->ts = first;
+	s->delta = 0;
+	s->value = 0;
+	s->lead = -1;
+	s->trail = 0;
+}
+
+/*
+ * Bit writer
+ */
+
+/* Make room for at least n more bytes */
+static int tsp_gorilla_reserve(struct tsp_gorilla_bits *b, size_t n) {
+	if (b->size + n <= b->capacity) {
+		return 0;
+	}
+	size_t capacity = b->capacity ? b->capacity * 2 : 4096;
+	while (capacity < b->size + n) {
+		capacity *= 2;
+	}
+	uint8_t *data = realloc(b->data, capacity);
+	if (data == NULL) {
+		return -1;
+	}
+	b->data = data;
+	b->capacity = capacity;
+	return 0;
+}
+
+/* Append the low n bits of value, n <= 32, room for 5 bytes must be reserved */
+static void tsp_gorilla_put(struct tsp_gorilla_bits *b, uint64_t value, int n) {
+	b->acc = (b->acc << n) | (value & ((1ULL << n) - 1));
+	b->nbits += n;
+	while (b->nbits >= 8) {
+		b->nbits -= 8;
+		b->data[b->size++] = (uint8_t)(b->acc >> b->nbits);
+	}
+}
+
+/* Append the low n bits of value, n <= 64 */
+static void tsp_gorilla_put_wide(struct tsp_gorilla_bits *b, uint64_t value, int n) {
+	if (n > 32) {
+		tsp_gorilla_put(b, value >> 32, n - 32);
+		tsp_gorilla_put(b, value, 32);
+	} else {
+		tsp_gorilla_put(b, value, n);
+	}
+}
+
+/* Encode one point, at most 27 bytes are written */
+static int tsp_gorilla_encode(struct tsp_gorilla_bits *b, struct tsp_gorilla_state *s, int64_t ts,
+			      double value) {
+	if (tsp_gorilla_reserve(b, 32) != 0) {
+		return -1;
+	}
+
+	int64_t delta = (int64_t)((uint64_t)ts - (uint64_t)s->ts);
+	int64_t dod = (int64_t)((uint64_t)delta - (uint64_t)s->delta);
+	if (dod == 0) {
+		tsp_gorilla_put(b, 0, 1);
+	} else {
+		int k = 1;
+		while (k < 5 && !tsp_gorilla_fits(dod, tsp_gorilla_dod_bits[k])) {
+			k++;
+		}
+		// k leading ones, terminated by a zero for all but the widest bucket
+		if (k < 5) {
+			tsp_gorilla_put(b, ((1ULL << k) - 1) << 1, k + 1);
+		} else {
+			tsp_gorilla_put(b, 0x1F, 5);
+		}
+		tsp_gorilla_put_wide(b, (uint64_t)dod, tsp_gorilla_dod_bits[k]);
+	}
+	s->ts = ts;
+	s->delta = delta;
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint64_t x = bits ^ s->value;
+	if (x == 0) {
+		tsp_gorilla_put(b, 0, 1);
+	} else {
+		int lead = tsp_gorilla_clz(x);
+		int trail = tsp_gorilla_ctz(x);
+		lead = lead > 31 ? 31 : lead;
+		if (s->lead >= 0 && lead >= s->lead && trail >= s->trail) {
+			tsp_gorilla_put(b, 2, 2);
+			tsp_gorilla_put_wide(b, x >> s->trail, 64 - s->lead - s->trail);
+		} else {
+			int length = 64 - lead - trail;
+			tsp_gorilla_put(b, 3, 2);
+			tsp_gorilla_put(b, lead, 5);
+			tsp_gorilla_put(b, length - 1, 6);
+			tsp_gorilla_put_wide(b, x >> trail, length);
+			s->lead = lead;
+			s->trail = trail;
+		}
+	}
+	s->value = bits;
+	return 0;
+}
+
+/*
+ * Bit reader
+ */
+
+/* 64 bits of the stream starting at bit pos, at least 57 of them are valid */
+static inline uint64_t tsp_gorilla_peek(const uint8_t *bits, uint64_t pos) {
+	uint64_t w;
+	memcpy(&w, bits + (pos >> 3), sizeof(w));
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	w = __builtin_bswap64(w);
+#elif !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+	const uint8_t *p = bits + (pos >> 3);
+	w = 0;
+	for (int i = 0; i < 8; i++) {
+		w = (w << 8) | p[i];
+	}
+#endif
+	return w << (pos & 7);
+}
+
+/* Read n bits, 1 <= n <= 32 */
+static inline uint64_t tsp_gorilla_get(const uint8_t *bits, uint64_t *pos, int n) {
+	uint64_t w = tsp_gorilla_peek(bits, *pos);
+	*pos += n;
+	return w >> (64 - n);
+}
+
+/* Read n bits, 1 <= n <= 64 */
+static inline uint64_t tsp_gorilla_get_wide(const uint8_t *bits, uint64_t *pos, int n) {
+	if (n > 32) {
+		uint64_t high = tsp_gorilla_get(bits, pos, n - 32);
+		return (high << 32) | tsp_gorilla_get(bits, pos, 32);
+	}
+	return tsp_gorilla_get(bits, pos, n);
+}
+
+/* Most bits of one point: '11111' + 64 bits of timestamp, '11' + 5 + 6 + 64 bits of value */
+#define TSP_GORILLA_MAX_POINT_BITS 146
+
+/* Decode the point at *pos into s, return -1 if the bits can't come from the encoder */
+static inline int tsp_gorilla_decode_point(const uint8_t *bits, uint64_t *pos,
+					   struct tsp_gorilla_state *s) {
+	uint64_t w = tsp_gorilla_peek(bits, *pos);
+	if (w >> 63) {
+		int k = tsp_gorilla_clz(~w | 1);
+		k = k > 5 ? 5 : k;
+		int width = tsp_gorilla_dod_bits[k];
+		*pos += k < 5 ? k + 1 : 5;
+		uint64_t raw = tsp_gorilla_get_wide(bits, pos, width);
+		// Sign-extend the field
+		int64_t dod = width == 64 ? (int64_t)raw : (int64_t)(raw << (64 - width)) >> (64 - width);
+		s->delta = (int64_t)((uint64_t)s->delta + (uint64_t)dod);
+	} else {
+		*pos += 1;
+	}
+	s->ts = (int64_t)((uint64_t)s->ts + (uint64_t)s->delta);
+
+	w = tsp_gorilla_peek(bits, *pos);
+	if (w >> 63) {
+		*pos += 2;
+		if ((w >> 62) & 1) {
+			s->lead = (int)tsp_gorilla_get(bits, pos, 5);
+			int length = (int)tsp_gorilla_get(bits, pos, 6) + 1;
+			if (s->lead + length > 64) {
+				return -1;
+			}
+			s->trail = 64 - s->lead - length;
+		} else if (s->lead < 0) {
+			return -1;
+		}
+		s->value ^= tsp_gorilla_get_wide(bits, pos, 64 - s->lead - s->trail) << s->trail;
+	} else {
+		*pos += 1;
+	}
+	return 0;
+}
+
+/*
+ * Decode n points of the current chunk, ts and values may be NULL
+ * The state is kept in locals, the loop is the hot path of the reader.
+ * Points that may reach the padding are decoded from a zero-extended copy of the
+ * end of the chunk, so a corrupt stream can't make the reader leave the chunk.
+ *
+ * return: 0 on success, -1 if the chunk is corrupt
+ */
+static int tsp_gorilla_decode(struct tsp_gorilla_reader *r, int64_t *ts, double *values, long n) {
+	const uint8_t *bits = r->bits;
+	uint64_t pos = r->pos;
+	uint64_t limit = ((uint64_t)r->bytes - 8) * 8; // Bits before the padding
+	struct tsp_gorilla_state s = r->state;
+	uint8_t tail[64];
+	for (long i = 0; i < n; i++) {
+		if (pos + TSP_GORILLA_MAX_POINT_BITS <= limit) {
+			if (tsp_gorilla_decode_point(bits, &pos, &s) != 0) {
+				return -1;
+			}
+		} else {
+			// Less than 28 bytes are left, the point and the peeks past it fit in tail
+			uint64_t first = pos >> 3;
+			uint64_t local = pos & 7;
+			memset(tail, 0, sizeof(tail));
+			memcpy(tail, bits + first, r->bytes - first);
+			if (tsp_gorilla_decode_point(tail, &local, &s) != 0 || first * 8 + local > limit) {
+				return -1;
+			}
+			pos = first * 8 + local;
+		}
+
+		if (ts != NULL) {
+			ts[i] = s.ts;
+		}
+		if (values != NULL) {
+			memcpy(&values[i], &s.value, sizeof(double));
+		}
+	}
+	r->pos = pos;
+	r->state = s;
+	r->left -= n;
+	return 0;
+}
+
+/*
+ * Writer
+ */
+
+/* Write the pending chunk */
+static int tsp_gorilla_flush_chunk(struct tsp_gorilla_writer *w) {
+	if (w->chunk.points == 0) {
+		return 0;
+	}
+	struct tsp_gorilla_bits *b = &w->bits;
+	if (tsp_gorilla_reserve(b, 9) != 0) {
+		return -1;
+	}
+	if (b->nbits > 0) {
+		b->data[b->size++] = (uint8_t)(b->acc << (8 - b->nbits));
+	}
+	memset(b->data + b->size, 0, 8);
+	b->size += 8;
+	w->chunk.bytes = b->size;
+	if (fwrite(&w->chunk, sizeof(w->chunk), 1, w->file) != 1 ||
+	    fwrite(b->data, 1, b->size, w->file) != b->size) {
+		return -1;
+	}
+	w->points += w->chunk.points;
+	w->chunk.points = 0;
+	b->size = 0;
+	b->acc = 0;
+	b->nbits = 0;
+	return 0;
+}
+
+/*
+ * Creates a Gorilla file for writing
+ *
+ * path: Path to the file, an existing file is truncated
+ * chunk_points: Points per chunk
+ *
+ * return: Pointer to initialized writer, or NULL on failure
+ */
+struct tsp_gorilla_writer *tsp_gorilla_writer_open(const char *path, int chunk_points) {
+	if (chunk_points < 1) {
+		fprintf(stderr, "Gorilla file needs at least one point per chunk\n");
+		return NULL;
+	}
+	struct tsp_gorilla_writer *obj = calloc(1, sizeof(struct tsp_gorilla_writer));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize gorilla writer\n");
+		return NULL;
+	}
+	obj->chunk_points = chunk_points;
+	obj->file = fopen(path, "wb");
+	if (obj->file == NULL) {
+		fprintf(stderr, "Could not open file %s\n", path);
+		free(obj);
+		return NULL;
+	}
+	struct tsp_gorilla_header h = {.points = 0};
+	memcpy(h.magic, TSP_GORILLA_MAGIC, sizeof(h.magic));
+	if (fwrite(&h, sizeof(h), 1, obj->file) != 1) {
+		fprintf(stderr, "Could not write file %s\n", path);
+		fclose(obj->file);
+		free(obj);
+		return NULL;
+	}
+	return obj;
+}
+
+/*
+ * Appends n points
+ *
+ * ts: n timestamps, any order (regular ticks compress best)
+ * values: n values
+ *
+ * return: 0 on success, -1 on failure
+ */
+int tsp_gorilla_write(struct tsp_gorilla_writer *w, const int64_t *ts, const double *values, long n) {
+	for (long i = 0; i < n; i++) {
+		if (w->chunk.points == 0) {
+			w->chunk.first = ts[i];
+			tsp_gorilla_state_reset(&w->state, ts[i]);
+		}
+		if (tsp_gorilla_encode(&w->bits, &w->state, ts[i], values[i]) != 0) {
+			fprintf(stderr, "Could not allocate memory for gorilla chunk\n");
+			return -1;
+		}
+		w->chunk.last = ts[i];
+		if (++w->chunk.points == (uint32_t)w->chunk_points && tsp_gorilla_flush_chunk(w) != 0) {
+			fprintf(stderr, "Could not write gorilla chunk\n");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Drains a native handler chain into the file
+ * Timestamps are start, start + step, ... ; missing values (inf) are stored as NaN
+ *
+ * return: Number of written points, or -1 on failure
+ */
+long tsp_gorilla_drain(struct tsp_gorilla_writer *w, struct tsp_handler *handler, int64_t start,
+		       int64_t step) {
+	long count = 0;
+	double *next = NULL;
+	while ((next = tsp_next_chain(handler, 4096)) != NULL) {
+		double value = isinf(*next) && *next > 0 ? NAN : *next;
+		int64_t ts = start + step * count;
+		if (tsp_gorilla_write(w, &ts, &value, 1) != 0) {
+			return -1;
+		}
+		count++;
+	}
+	return count;
+}
+
+/*
+ * Writes the pending chunk and the number of points, closes the file, frees the writer
+ *
+ * return: 0 on success, -1 on failure
+ */
+int tsp_gorilla_writer_close(struct tsp_gorilla_writer *w) {
+	int res = tsp_gorilla_flush_chunk(w);
+	struct tsp_gorilla_header h = {.points = w->points};
+	memcpy(h.magic, TSP_GORILLA_MAGIC, sizeof(h.magic));
+	if (res == 0 && (fseek(w->file, 0, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, w->file) != 1)) {
+		res = -1;
+	}
+	if (fclose(w->file) != 0) {
+		res = -1;
+	}
+	if (res != 0) {
+		fprintf(stderr, "Could not write gorilla file\n");
+	}
+	free(w->bits.data);
+	free(w);
+	return res;
+}
+
+/*
+ * Reader
+ */
+
+/* Validates the chunk headers of a mapped file and counts points */
+static int tsp_gorilla_parse(struct tsp_gorilla_reader *r) {
+	struct tsp_gorilla_header h;
+	if (r->size < sizeof(h)) {
+		return -1;
+	}
+	memcpy(&h, r->data, sizeof(h));
+	if (memcmp(h.magic, TSP_GORILLA_MAGIC, 8) != 0) {
+		return -1;
+	}
+	uint64_t points = 0;
+	size_t offset = sizeof(h);
+	while (offset < r->size) {
+		struct tsp_gorilla_chunk c;
+		if (r->size - offset < sizeof(c)) {
+			return -1;
+		}
+		memcpy(&c, r->data + offset, sizeof(c));
+		offset += sizeof(c);
+		if (c.points == 0 || c.bytes < 8 || r->size - offset < c.bytes) {
+			return -1;
+		}
+		offset += c.bytes;
+		points += c.points;
+	}
+	if (points != h.points) {
+		return -1;
+	}
+	r->points = points;
+	return 0;
+}
+
+/*
+ * Opens a Gorilla file for reading, the file is memory-mapped
+ *
+ * return: Pointer to initialized reader, or NULL on failure
+ */
+struct tsp_gorilla_reader *tsp_gorilla_open(const char *path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Could not open file %s\n", path);
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		fprintf(stderr, "Could not read file %s\n", path);
+		close(fd);
+		return NULL;
+	}
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Could not map file %s\n", path);
+		return NULL;
+	}
+
+	struct tsp_gorilla_reader *obj = malloc(sizeof(struct tsp_gorilla_reader));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize gorilla reader\n");
+		munmap(map, st.st_size);
+		return NULL;
+	}
+	obj->data = map;
+	obj->size = st.st_size;
+	if (tsp_gorilla_parse(obj) != 0) {
+		fprintf(stderr, "File %s is not a valid gorilla file\n", path);
+		tsp_gorilla_close(obj);
+		return NULL;
+	}
+	tsp_gorilla_rewind(obj);
+	return obj;
+}
+
+/* Unmap the file and free the reader */
+void tsp_gorilla_close(struct tsp_gorilla_reader *r) {
+	munmap((void *)r->data, r->size);
+	free(r);
+}
+
+long tsp_gorilla_points(struct tsp_gorilla_reader *r) { return r->points; }
+
+/* Start decoding from the first point */
+void tsp_gorilla_rewind(struct tsp_gorilla_reader *r) {
+	r->next = sizeof(struct tsp_gorilla_header);
+	r->left = 0;
+	r->failed = 0;
+}
+
+/* Whether decoding stopped at a corrupt chunk */
+int tsp_gorilla_failed(struct tsp_gorilla_reader *r) { return r->failed; }
+
+/* Move to the next chunk, returns 0 at the end of the file */
+static int tsp_gorilla_next_chunk(struct tsp_gorilla_reader *r) {
+	if (r->next >= r->size) {
+		return 0;
+	}
+	struct tsp_gorilla_chunk c;
+	memcpy(&c, r->data + r->next, sizeof(c));
+	r->bits = (const uint8_t *)r->data + r->next + sizeof(c);
+	r->bytes = c.bytes;
+	r->pos = 0;
+	r->left = c.points;
+	tsp_gorilla_state_reset(&r->state, c.first);
+	r->next += sizeof(c) + c.bytes;
+	return 1;
+}
+
+/*
+ * Decodes the next n points, ts or values may be NULL to skip them
+ * A corrupt chunk ends the data until the reader is rewound, see tsp_gorilla_failed
+ *
+ * return: Number of decoded points, less than n at the end of the file or at a corrupt chunk
+ */
+long tsp_gorilla_read(struct tsp_gorilla_reader *r, int64_t *ts, double *values, long n) {
+	long done = 0;
+	while (done < n && !r->failed && (r->left > 0 || tsp_gorilla_next_chunk(r))) {
+		long count = r->left < n - done ? r->left : n - done;
+		if (tsp_gorilla_decode(r, ts != NULL ? ts + done : NULL,
+				       values != NULL ? values + done : NULL, count) != 0) {
+			fprintf(stderr, "Gorilla chunk is corrupt\n");
+			r->failed = 1;
+			break;
+		}
+		done += count;
+	}
+	return done;
+}
+
+/*
+ * Fill function of the gorilla source handler (see tsp_init_source)
+ * Values are decoded straight into the handler's buffer
+ */
+int tsp_fill_gorilla(struct tsp_handler *handler, double **block, int capacity) {
+	struct tsp_gorilla_reader *r = (struct tsp_gorilla_reader *)handler->data;
+	return (int)tsp_gorilla_read(r, NULL, *block, capacity);
+}
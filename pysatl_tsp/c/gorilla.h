@@ -0,0 +1,110 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef GORILLA_H
+#define GORILLA_H
+#include "handler.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Gorilla-compressed tick file
+ *
+ * [header][chunk 0]...[chunk k], native byte order
+ *
+ * header: tsp_gorilla_header, points is written when the file is closed
+ * chunk:  tsp_gorilla_chunk, then bytes of the bit stream (big-endian bit order,
+ *         followed by 8 zero bytes so the decoder can always load 64 bits)
+ *
+ * Every chunk is decoded on its own, its state starts from the first timestamp of
+ * the chunk, a zero delta and a zero value. Per point the stream holds:
+ *
+ * timestamp, delta-of-delta D of the int64 timestamps (wrapping arithmetic):
+ *   '0'                  D == 0
+ *   '10'    + 7 bits     D in [-64, 63]
+ *   '110'   + 9 bits     D in [-256, 255]
+ *   '1110'  + 12 bits    D in [-2048, 2047]
+ *   '11110' + 32 bits    D in [-2^31, 2^31 - 1]
+ *   '11111' + 64 bits    otherwise
+ *
+ * value, XOR X of the double with the previous value:
+ *   '0'                                     X == 0
+ *   '10' + meaningful bits                  leading/trailing zeros of X cover the
+ *                                           previous meaningful window, which is reused
+ *   '11' + 5 bits leading zeros (up to 31)
+ *        + 6 bits meaningful length - 1 + meaningful bits
+ *
+ * Regular ticks take 1 bit per timestamp, slowly changing prices a few bits per value.
+ */
+#define TSP_GORILLA_MAGIC "TSPGRL01"
+
+struct tsp_gorilla_header {
+	char magic[8];
+	uint64_t points; // Total points in the file
+};
+
+struct tsp_gorilla_chunk {
+	uint32_t points; // Points in the chunk
+	uint32_t bytes;	 // Size of the bit stream, including the padding
+	int64_t first;	 // First timestamp of the chunk
+	int64_t last;	 // Last timestamp of the chunk
+};
+
+/* Bit stream of the pending chunk */
+struct tsp_gorilla_bits {
+	uint8_t *data;
+	size_t size;	 // Complete bytes in data
+	size_t capacity; // Allocated bytes
+	uint64_t acc;	 // Pending bits, in the low bits
+	int nbits;	 // Number of pending bits, less than 8 between writes
+};
+
+/* Encoder state, shared by the writer and the reader */
+struct tsp_gorilla_state {
+	int64_t ts;	// Previous timestamp
+	int64_t delta;	// Previous delta of timestamps
+	uint64_t value; // Bits of the previous value
+	int lead;	// Leading zeros of the previous meaningful window, -1 before the first one
+	int trail;	// Trailing zeros of the previous meaningful window
+};
+
+/* Writer of a Gorilla file, points are encoded into the pending chunk until it is full */
+struct tsp_gorilla_writer {
+	FILE *file;
+	int chunk_points;
+	struct tsp_gorilla_bits bits;
+	struct tsp_gorilla_state state;
+	struct tsp_gorilla_chunk chunk; // Header of the pending chunk
+	uint64_t points;		// Points in written chunks
+};
+
+/* Memory-mapped Gorilla reader, also a native source (see tsp_fill_gorilla) */
+struct tsp_gorilla_reader {
+	const char *data;
+	size_t size;
+	long points;			// Total points
+	size_t next;			// Offset of the next chunk
+	const uint8_t *bits;		// Bit stream of the current chunk
+	uint32_t bytes;			// Size of the bit stream, including the padding
+	uint64_t pos;			// Position in bits of the next point
+	long left;			// Points left in the current chunk
+	struct tsp_gorilla_state state; // Decoder state of the current chunk
+	int failed;			// 1 if a chunk failed to decode
+};
+
+TSP_API_START
+struct tsp_gorilla_writer *tsp_gorilla_writer_open(const char *path, int chunk_points);
+int tsp_gorilla_write(struct tsp_gorilla_writer *w, const int64_t *ts, const double *values, long n);
+long tsp_gorilla_drain(struct tsp_gorilla_writer *w, struct tsp_handler *handler, int64_t start,
+		       int64_t step);
+int tsp_gorilla_writer_close(struct tsp_gorilla_writer *w);
+
+struct tsp_gorilla_reader *tsp_gorilla_open(const char *path);
+void tsp_gorilla_close(struct tsp_gorilla_reader *r);
+long tsp_gorilla_points(struct tsp_gorilla_reader *r);
+void tsp_gorilla_rewind(struct tsp_gorilla_reader *r);
+int tsp_gorilla_failed(struct tsp_gorilla_reader *r);
+long tsp_gorilla_read(struct tsp_gorilla_reader *r, int64_t *ts, double *values, long n);
+
+int tsp_fill_gorilla(struct tsp_handler *handler, double **block, int capacity);
+TSP_API_END
+#endif /* GORILLA_H */
@@ -1,7 +1,9 @@
 #define PY_SSIZE_T_CLEAN
 #include "handler.h"
 #include <Python.h>
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 /*
  * Creates and initializes a TSP handler with given components
@@ -22,9 +24,54 @@ struct tsp_handler *tsp_init_handler(void *data, struct tsp_handler *src,
 	obj->buf_start = 0;
 	obj->buf_end = 0;
 	obj->buffer = NULL;
+	obj->buf_capacity = 0;
+	obj->fill = NULL;
+	obj->block = NULL;
+	obj->batch = NULL;
 	return obj;
 }
 
+/*
+ * Creates a native leaf source handler
+ * Values produced by fill go to the next handler of the chain as is
+ * See also handler.h
+ */
+struct tsp_handler *tsp_init_source(void *data,
+				    int (*fill)(struct tsp_handler *handler, double **block, int capacity)) {
+	struct tsp_handler *obj = tsp_init_handler(data, NULL, NULL, NULL);
+	if (obj == NULL) {
+		return NULL;
+	}
+	obj->fill = fill;
+	return obj;
+}
+
+/*
+ * Make the handler's buffer hold at least capacity values
+ * Callers may pass different capacities (e.g. Python iteration and native drains),
+ * so the buffer is grown on demand, buffered values are kept
+ */
+static int tsp_reserve_buffer(struct tsp_handler *handler, int capacity) {
+	if (handler->buffer != NULL && handler->buf_capacity >= capacity) {
+		return 0;
+	}
+	void *buffer = realloc(handler->buffer, capacity * sizeof(double));
+	if (buffer == NULL) {
+		fprintf(stderr, "Could not allocate memory for handler buffer\n");
+		return -1;
+	}
+	handler->buffer = buffer;
+	handler->buf_capacity = capacity;
+	return 0;
+}
+
+/* Drop buffered values, so that the next call starts with fresh data */
+void tsp_reset_handler(struct tsp_handler *handler) {
+	handler->buf_start = 0;
+	handler->buf_end = 0;
+	handler->block = NULL;
+}
+
 void tsp_free_handler(struct tsp_handler *handler) {
 	if (handler->buffer != NULL) {
 		free(handler->buffer);
@@ -32,18 +79,33 @@ void tsp_free_handler(struct tsp_handler *handler) {
 	free(handler);
 }
 
-/* Init circular queue
+/* Init circular queue of doubles
  * See also handler.h
  */
 struct tsp_queue *tsp_queue_init(int capacity) {
+	return tsp_queue_init_precision(capacity, TSP_PRECISION_F64);
+}
+
+/* Init circular queue with the given storage precision
+ * See also handler.h
+ */
+struct tsp_queue *tsp_queue_init_precision(int capacity, int precision) {
 	struct tsp_queue *obj = malloc(sizeof(struct tsp_queue));
 	if (obj == NULL) {
 		fprintf(stderr, "Could not allocate memory to initialize Queue\n");
 		return NULL;
 	}
-	obj->buffer = malloc(capacity * sizeof(obj->buffer[0]));
-	if (!obj->buffer) {
+	obj->buffer = NULL;
+	obj->buffer_f32 = NULL;
+	obj->precision = precision;
+	if (precision == TSP_PRECISION_F32) {
+		obj->buffer_f32 = malloc(capacity * sizeof(obj->buffer_f32[0]));
+	} else {
+		obj->buffer = malloc(capacity * sizeof(obj->buffer[0]));
+	}
+	if (obj->buffer == NULL && obj->buffer_f32 == NULL) {
 		fprintf(stderr, "Could not allocate memory for Queue\n");
+		free(obj);
 		return NULL;
 	}
 	obj->capacity = capacity;
@@ -51,6 +113,8 @@ struct tsp_queue *tsp_queue_init(int capacity) {
 	obj->tail = 0;
 	obj->size = 0;
 	obj->sum = 0;
+	obj->sum_mode = TSP_SUM_NAIVE;
+	tsp_queue_sum_reset(obj);
 	return obj;
 }
 
@@ -59,9 +123,188 @@ void tsp_free_queue(void *q) {
 	if (p->buffer != NULL) {
 		free(p->buffer);
 	}
+	if (p->buffer_f32 != NULL) {
+		free(p->buffer_f32);
+	}
 	free(p);
 }
 
+/*
+ * Circular queue insertion operation
+ * Adds value to tail and advances tail pointer with wrap-around
+ * Returns the value as it was stored, so that accumulators can account
+ * exactly the same value that will be evicted later
+ */
+double tsp_queue_put(struct tsp_queue *q, double value) {
+	if (q->precision == TSP_PRECISION_F32) {
+		float stored = (float)value;
+		q->buffer_f32[q->tail] = stored;
+		value = stored;
+	} else {
+		q->buffer[q->tail] = value;
+	}
+	q->tail = (q->tail + 1) % q->capacity;
+	return value;
+}
+
+/*
+ * Circular queue extraction operation
+ * Retrieves value from head and advances head pointer with wrap-around
+ */
+double tsp_queue_get(struct tsp_queue *q) {
+	double value;
+	if (q->precision == TSP_PRECISION_F32) {
+		value = q->buffer_f32[q->head];
+	} else {
+		value = q->buffer[q->head];
+	}
+	q->head = (q->head + 1) % q->capacity;
+	return value;
+}
+
+/*
+ * Neumaier's variant of Kahan summation: adds value to *sum and keeps
+ * the rounding error in *comp, so that *sum + *comp stays accurate
+ * even when the magnitude of value exceeds the magnitude of *sum
+ */
+static void tsp_neumaier_add(double *sum, double *comp, double value) {
+	double t = *sum + value;
+	if (fabs(*sum) >= fabs(value)) {
+		*comp += (*sum - t) + value;
+	} else {
+		*comp += (value - t) + *sum;
+	}
+	*sum = t;
+}
+
+/*
+ * In TSP_SUM_RESUM mode every pushed value also goes to the shadow sum.
+ * After capacity pushes the window holds exactly the values of the shadow
+ * epoch, so the drifting running sum is replaced by the shadow one.
+ */
+static void tsp_queue_shadow_push(struct tsp_queue *q, double value) {
+	tsp_neumaier_add(&q->shadow_sum, &q->shadow_comp, value);
+	q->shadow_count++;
+	if (q->shadow_count >= q->capacity) {
+		q->sum = q->shadow_sum + q->shadow_comp;
+		q->shadow_sum = 0;
+		q->shadow_comp = 0;
+		q->shadow_count = 0;
+	}
+}
+
+/* Select accumulation mode of the running sum, see TSP_SUM_* in handler.h */
+void tsp_queue_set_sum_mode(struct tsp_queue *q, int mode) {
+	q->sum_mode = mode;
+	tsp_queue_sum_reset(q);
+}
+
+/* Empty the queue, keeping its capacity, precision and sum mode */
+void tsp_queue_reset(struct tsp_queue *q) {
+	q->head = 0;
+	q->tail = 0;
+	q->size = 0;
+	tsp_queue_sum_reset(q);
+}
+
+/* Reset running sum and its compensation terms */
+void tsp_queue_sum_reset(struct tsp_queue *q) {
+	q->sum = 0;
+	q->sum_comp = 0;
+	q->shadow_sum = 0;
+	q->shadow_comp = 0;
+	q->shadow_count = 0;
+}
+
+/* Account a value entering the window while the queue is growing */
+void tsp_queue_sum_push(struct tsp_queue *q, double value) {
+	switch (q->sum_mode) {
+	case TSP_SUM_KAHAN:
+		tsp_neumaier_add(&q->sum, &q->sum_comp, value);
+		break;
+	case TSP_SUM_RESUM:
+		q->sum += value;
+		tsp_queue_shadow_push(q, value);
+		break;
+	default:
+		q->sum += value;
+	}
+}
+
+/* Account a value entering the full window in place of the evicted one */
+void tsp_queue_sum_replace(struct tsp_queue *q, double added, double removed) {
+	switch (q->sum_mode) {
+	case TSP_SUM_KAHAN:
+		tsp_neumaier_add(&q->sum, &q->sum_comp, added);
+		tsp_neumaier_add(&q->sum, &q->sum_comp, -removed);
+		break;
+	case TSP_SUM_RESUM:
+		q->sum += (added - removed);
+		tsp_queue_shadow_push(q, added);
+		break;
+	default:
+		q->sum += (added - removed);
+	}
+}
+
+/* Current value of the running sum */
+double tsp_queue_sum_value(struct tsp_queue *q) {
+	if (q->sum_mode == TSP_SUM_KAHAN) {
+		return q->sum + q->sum_comp;
+	}
+	return q->sum;
+}
+
+/*
+ * Apply the handler's operation to n values in place
+ * Handlers with a batch operation process the whole block in one call
+ */
+static void tsp_apply_operation(struct tsp_handler *handler, double *values, int n) {
+	if (handler->batch != NULL) {
+		handler->batch(handler, values, n);
+		return;
+	}
+	for (int i = 0; i < n; i++) {
+		double tmp = values[i];
+		values[i] = handler->operation(handler, (void *)&tmp);
+	}
+}
+
+/* tsp_next_source returns the next element of a native leaf source */
+static double *tsp_next_source(struct tsp_handler *handler, int capacity) {
+	// return next element, if block is not empty
+	if (handler->buf_start != handler->buf_end) {
+		return &handler->block[handler->buf_start++];
+	}
+
+	// create buffer, if it doesn't exist or is too small
+	if (tsp_reserve_buffer(handler, capacity) != 0) {
+		return NULL;
+	}
+
+	double *block = (double *)handler->buffer;
+	int count = handler->fill(handler, &block, capacity);
+	handler->buf_start = 0;
+	handler->buf_end = count > 0 ? count : 0;
+	if (handler->buf_end == 0) {
+		handler->block = NULL;
+		return NULL;
+	}
+
+	// Sources may have an operation of their own, apply it out of place,
+	// because the block can point to read-only memory
+	if (handler->operation != NULL) {
+		double *res = (double *)handler->buffer;
+		if (block != res) {
+			memcpy(res, block, sizeof(double) * handler->buf_end);
+		}
+		tsp_apply_operation(handler, res, handler->buf_end);
+		block = res;
+	}
+	handler->block = block;
+	return &block[handler->buf_start++];
+}
+
 /* tsp_next_buffer apply operation to the next element from the iterator */
 double *tsp_next_buffer(struct tsp_handler *handler, int capacity) {
 	// check handler existence
@@ -70,6 +313,11 @@ double *tsp_next_buffer(struct tsp_handler *handler, int capacity) {
 		return NULL;
 	}
 
+	// native sources don't need the Python iterator and the GIL
+	if (handler->fill != NULL) {
+		return tsp_next_source(handler, capacity);
+	}
+
 	double *res = NULL;
 	// return next element, if buffer is not empty
 	if (handler->buf_start != handler->buf_end) {
@@ -77,9 +325,9 @@ double *tsp_next_buffer(struct tsp_handler *handler, int capacity) {
 		return &res[handler->buf_start++];
 	}
 
-	// create buffer, if it doesn't exist
-	if (handler->buffer == NULL) {
-		handler->buffer = (void *)malloc(capacity * sizeof(double));
+	// create buffer, if it doesn't exist or is too small
+	if (tsp_reserve_buffer(handler, capacity) != 0) {
+		return NULL;
 	}
 
 	// Setting up future work with Python iterator
@@ -94,9 +342,7 @@ double *tsp_next_buffer(struct tsp_handler *handler, int capacity) {
 	handler->buf_end = 0;
 	for (int j = 0; j < capacity; j++) {
 		if ((pItem = PyIter_Next(pIterator)) != NULL) {
-			double tmp = PyFloat_AsDouble(pItem);
-			tmp = handler->operation(handler, (void *)&tmp);
-			res[handler->buf_end++] = tmp;
+			res[handler->buf_end++] = PyFloat_AsDouble(pItem);
 			Py_DECREF(pItem);
 		} else {
 			break;
@@ -104,6 +350,7 @@ double *tsp_next_buffer(struct tsp_handler *handler, int capacity) {
 	}
 	Py_DECREF(pIterator);
 	PyGILState_Release(gstate);
+	tsp_apply_operation(handler, res, handler->buf_end);
 
 	// return NULL, if we don't get elements from iterator
 	if (handler->buf_start == handler->buf_end) {
@@ -121,16 +368,16 @@ double *tsp_next_chain(struct tsp_handler *handler, int capacity) {
 		// Find handler(NULL, float)
 		return tsp_next_buffer(handler, capacity);
 	} else {
-		// create buffer, if it doesn't exist
-		if (handler->buffer == NULL) {
-			handler->buffer = (void *)malloc(capacity * sizeof(double));
-		}
-
 		// return next element, if buffer is not empty
-		double *res = (double *)handler->buffer;
 		if (handler->buf_start != handler->buf_end) {
-			return &res[handler->buf_start++];
+			return &((double *)handler->buffer)[handler->buf_start++];
+		}
+
+		// create buffer, if it doesn't exist or is too small
+		if (tsp_reserve_buffer(handler, capacity) != 0) {
+			return NULL;
 		}
+		double *res = (double *)handler->buffer;
 
 		// Apply operation to the previous results
 		handler->buf_start = 0;
@@ -138,13 +385,12 @@ double *tsp_next_chain(struct tsp_handler *handler, int capacity) {
 		for (int i = 0; i < capacity; i++) {
 			double *prev = tsp_next_chain(handler->src, capacity);
 			if (prev != NULL) {
-				double tmp = prev[0];
-				tmp = handler->operation(handler, (void *)&tmp);
-				res[handler->buf_end++] = tmp;
+				res[handler->buf_end++] = prev[0];
 			} else {
 				break;
 			}
 		}
+		tsp_apply_operation(handler, res, handler->buf_end);
 
 		// return NULL, if we don't have elements in buffer
 		if (handler->buf_start == handler->buf_end) {
@@ -153,3 +399,123 @@ double *tsp_next_chain(struct tsp_handler *handler, int capacity) {
 		return &res[handler->buf_start++];
 	}
 }
+
+/*
+ * tsp_apply_batch applies the handler's own operation to n values pushed by the caller
+ * Used when the data is not pulled by the chain but arrives in batches,
+ * e.g. from an asyncio source. Sources of the handler are not involved.
+ * in and out may point to the same memory
+ */
+int tsp_apply_batch(struct tsp_handler *handler, const double *in, int n, double *out) {
+	if (handler == NULL || handler->operation == NULL) {
+		fprintf(stderr, "Handler has no operation to apply\n");
+		return -1;
+	}
+	if (out != in) {
+		memmove(out, in, sizeof(double) * n);
+	}
+	tsp_apply_operation(handler, out, n);
+	return 0;
+}
+
+/*
+ * tsp_next_block returns the rest of the handler's current block, pulling a new one when it is empty
+ * Consumers of whole chains take blocks instead of one value per tsp_next_chain call
+ *
+ * count: Receives the number of values, 0 at the end of data
+ *
+ * return: Pointer to count values, valid until the next call, or NULL at the end of data
+ */
+double *tsp_next_block(struct tsp_handler *handler, int capacity, long *count) {
+	double *next = tsp_next_chain(handler, capacity);
+	if (next == NULL) {
+		*count = 0;
+		return NULL;
+	}
+	// The returned value is followed by the rest of the handler's block, take it all
+	*count = 1 + handler->buf_end - handler->buf_start;
+	handler->buf_start = handler->buf_end;
+	return next;
+}
+
+/* Values pulled from the chain per refill by tsp_drain_into */
+#define TSP_DRAIN_BLOCK 4096
+
+/*
+ * tsp_drain_into runs a chain to completion and hands its results to a sink, block by block
+ * Missing values (inf, None in Python) are stored as NaN
+ *
+ * reserve: Makes room for n more values in the sink, returns where to write them or NULL on failure
+ * sink: State passed to reserve
+ *
+ * return: Number of values, or -1 if the sink could not take them
+ */
+long tsp_drain_into(struct tsp_handler *handler, double *(*reserve)(void *sink, long n), void *sink) {
+	long count = 0, n = 0;
+	double *next = NULL;
+	while ((next = tsp_next_block(handler, TSP_DRAIN_BLOCK, &n)) != NULL) {
+		double *out = reserve(sink, n);
+		if (out == NULL) {
+			return -1;
+		}
+		for (long i = 0; i < n; i++) {
+			out[i] = isinf(next[i]) && next[i] > 0 ? NAN : next[i];
+		}
+		count += n;
+	}
+	return count;
+}
+
+/* Growable heap array filled by tsp_drain_chain */
+struct tsp_drain_array {
+	double *values;
+	long size;
+	long capacity;
+};
+
+static double *tsp_drain_array_reserve(void *sink, long n) {
+	struct tsp_drain_array *a = sink;
+	if (a->size + n > a->capacity) {
+		long capacity = a->capacity;
+		while (a->size + n > capacity) {
+			capacity *= 2;
+		}
+		double *grown = realloc(a->values, sizeof(double) * capacity);
+		if (grown == NULL) {
+			return NULL;
+		}
+		a->values = grown;
+		a->capacity = capacity;
+	}
+	a->size += n;
+	return a->values + a->size - n;
+}
+
+/*
+ * tsp_drain_chain runs a chain to completion and collects its results
+ * Missing values (inf, None in Python) are stored as NaN
+ *
+ * size_hint: Expected number of values, 0 if unknown, the array grows by doubling
+ * length: Receives the number of values
+ *
+ * return: Array of values (free it with tsp_free_values), or NULL on failure
+ */
+double *tsp_drain_chain(struct tsp_handler *handler, long size_hint, long *length) {
+	struct tsp_drain_array a = {NULL, 0, size_hint > TSP_DRAIN_BLOCK ? size_hint : TSP_DRAIN_BLOCK};
+	a.values = malloc(sizeof(double) * a.capacity);
+	if (a.values == NULL || tsp_drain_into(handler, tsp_drain_array_reserve, &a) < 0) {
+		fprintf(stderr, "Could not allocate memory to drain handler\n");
+		free(a.values);
+		return NULL;
+	}
+
+	// Give the unused tail back
+	if (a.size < a.capacity) {
+		double *shrunk = realloc(a.values, sizeof(double) * (a.size > 0 ? a.size : 1));
+		a.values = shrunk != NULL ? shrunk : a.values;
+	}
+	*length = a.size;
+	return a.values;
+}
+
+void tsp_free_values(double *values) { free(values); }
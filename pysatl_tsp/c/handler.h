@@ -11,6 +11,16 @@ typedef struct _object PyObject;
  *
  * This versatile structure supports both C and Python execution environments
  * and can operate in different modes: buffered processing and chaining processing.
+ *
+ * A handler with fill != NULL is a native leaf source: instead of reading py_iter
+ * it asks fill for the next block of at most capacity values. fill either writes
+ * into *block (preset to the handler's buffer) or points *block to its own memory,
+ * e.g. a memory-mapped column, which is then served without copying. fill returns
+ * the number of values in the block, 0 at the end of data.
+ *
+ * A handler with batch != NULL applies its operation to a whole block of values in place
+ * instead of calling operation once per value, e.g. to use vectorized kernels.
+ * Results must be the same as those of operation.
  */
 struct tsp_handler {
 	void *data;		 // Primary data payload (queue, parameters, etc)
@@ -20,30 +30,81 @@ struct tsp_handler {
 	struct tsp_handler *src; // Source handler for pipeline
 	double (*operation)(struct tsp_handler *handler, void *); // Core computation function
 	PyObject *py_iter; // Python iterator object for Python integration
+	int (*fill)(struct tsp_handler *handler, double **block, int capacity); // Native leaf source
+	double *block;	   // Block currently served by the native source (not owned)
+	int buf_capacity;  // Number of values buffer can hold
+	int (*batch)(struct tsp_handler *handler, double *values, int n); // Block form of operation
 };
 
+/*
+ * Accumulation modes for the running sum of tsp_queue
+ *
+ * TSP_SUM_NAIVE - plain floating-point update, fastest but drifts over long runs
+ * TSP_SUM_KAHAN - Neumaier compensated summation, error stays bounded by the window
+ * TSP_SUM_RESUM - naive update, replaced by an exactly re-summed shadow sum
+ *                 once per window length (amortized O(1), no rescans)
+ */
+#define TSP_SUM_NAIVE 0
+#define TSP_SUM_KAHAN 1
+#define TSP_SUM_RESUM 2
+
+/*
+ * Storage precision of tsp_queue elements
+ *
+ * TSP_PRECISION_F64 - elements are stored as double
+ * TSP_PRECISION_F32 - elements are stored as float (half the memory of the window),
+ *                     accumulators stay double and see values exactly as stored
+ */
+#define TSP_PRECISION_F64 0
+#define TSP_PRECISION_F32 1
+
 /*
  * Circular buffer queue for TSP algorithm calculations
- * Uses double precision floating-point numbers as elements
+ * Elements are stored as double or float depending on precision,
+ * use tsp_queue_put/tsp_queue_get to access them
  */
 struct tsp_queue {
-	double *buffer; // Storage for queue elements
-	int capacity;	// Max elements the queue can contain
-	int head;	// Read position (oldest element)
-	int tail;	// Write position (next empty slot)
-	int size;	// Current element count
-	double sum;	// Precomputed sum for efficient average calculations
+	double *buffer;	    // Storage for queue elements (TSP_PRECISION_F64)
+	float *buffer_f32;  // Storage for queue elements (TSP_PRECISION_F32)
+	int precision;	    // Storage precision (TSP_PRECISION_*)
+	int capacity;	    // Max elements the queue can contain
+	int head;	    // Read position (oldest element)
+	int tail;	    // Write position (next empty slot)
+	int size;	    // Current element count
+	double sum;	    // Precomputed sum for efficient average calculations
+	int sum_mode;	    // Accumulation mode for sum (TSP_SUM_*)
+	double sum_comp;    // Low-order bits lost by sum (TSP_SUM_KAHAN)
+	double shadow_sum;  // Compensated sum of values pushed in the current epoch (TSP_SUM_RESUM)
+	double shadow_comp; // Compensation term of shadow_sum
+	int shadow_count;   // Values pushed in the current epoch
 };
 
 struct tsp_queue *tsp_queue_init(int capacity);
+struct tsp_queue *tsp_queue_init_precision(int capacity, int precision);
 void tsp_free_queue(void *q);
+double tsp_queue_put(struct tsp_queue *q, double value);
+double tsp_queue_get(struct tsp_queue *q);
+void tsp_queue_set_sum_mode(struct tsp_queue *q, int mode);
+void tsp_queue_sum_push(struct tsp_queue *q, double value);
+void tsp_queue_sum_replace(struct tsp_queue *q, double added, double removed);
+double tsp_queue_sum_value(struct tsp_queue *q);
+void tsp_queue_sum_reset(struct tsp_queue *q);
+void tsp_queue_reset(struct tsp_queue *q);
 
 struct tsp_handler *tsp_init_handler(void *data, struct tsp_handler *src,
 				     double (*operation)(struct tsp_handler *handler, void *),
 				     void *pyobj);
+struct tsp_handler *tsp_init_source(void *data,
+				    int (*fill)(struct tsp_handler *handler, double **block, int capacity));
 void tsp_free_handler(struct tsp_handler *handler);
+void tsp_reset_handler(struct tsp_handler *handler);
 
 double *tsp_next_buffer(struct tsp_handler *handler, int capacity);
 double *tsp_next_chain(struct tsp_handler *handler, int capacity);
+int tsp_apply_batch(struct tsp_handler *handler, const double *in, int n, double *out);
+double *tsp_next_block(struct tsp_handler *handler, int capacity, long *count);
+long tsp_drain_into(struct tsp_handler *handler, double *(*reserve)(void *sink, long n), void *sink);
+double *tsp_drain_chain(struct tsp_handler *handler, long size_hint, long *length);
+void tsp_free_values(double *values);
 TSP_API_END
 #endif /* HANDLER_H */
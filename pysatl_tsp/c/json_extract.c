@@ -0,0 +1,405 @@
+#include "json_extract.h"
+#include "parse.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Maximum number of paths of one extractor, paths are tracked in a bit mask */
+#define TSP_JSON_MAX_PATHS 64
+
+/* State of one message scan */
+struct tsp_json_scan {
+	struct tsp_json_extractor *ext;
+	const char *end;
+	double *floats;
+	int64_t *ints;
+	uint64_t pending; // Paths not found yet
+};
+
+static const char *tsp_json_skip_ws(const char *p, const char *end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+		p++;
+	}
+	return p;
+}
+
+/* p points to an opening quote, return the closing quote or NULL */
+static const char *tsp_json_string_end(const char *p, const char *end) {
+	for (p++; p < end; p++) {
+		p = memchr(p, '"', (size_t)(end - p));
+		if (p == NULL) {
+			return NULL;
+		}
+		// The quote is escaped if preceded by an odd number of backslashes
+		const char *q = p;
+		while (q[-1] == '\\') {
+			q--;
+		}
+		if ((p - q) % 2 == 0) {
+			return p;
+		}
+	}
+	return NULL;
+}
+
+/* Skip any value, return the first character after it or NULL on malformed input */
+static const char *tsp_json_skip_value(const char *p, const char *end) {
+	if (p >= end) {
+		return NULL;
+	}
+	if (*p == '"') {
+		p = tsp_json_string_end(p, end);
+		return p == NULL ? NULL : p + 1;
+	}
+	if (*p == '{' || *p == '[') {
+		int depth = 0;
+		for (; p < end; p++) {
+			if (*p == '"') {
+				p = tsp_json_string_end(p, end);
+				if (p == NULL) {
+					return NULL;
+				}
+			} else if (*p == '{' || *p == '[') {
+				depth++;
+			} else if (*p == '}' || *p == ']') {
+				if (--depth == 0) {
+					return p + 1;
+				}
+			}
+		}
+		return NULL;
+	}
+	while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' &&
+	       *p != '\r' && *p != '\t') {
+		p++;
+	}
+	return p;
+}
+
+/*
+ * Parse an integer, falling back to a double for fractions and exponents
+ *
+ * return: 0 on success, -1 if there is no number or it is out of the int64 range
+ */
+static int tsp_json_parse_int(const char *p, const char *end, int64_t *out) {
+	const char *start = p;
+	int negative = p < end && *p == '-';
+	p += negative;
+	// The magnitude of INT64_MIN is one more than INT64_MAX
+	uint64_t limit = (uint64_t)INT64_MAX + (uint64_t)negative;
+	uint64_t value = 0;
+	const char *digits = p;
+	while (p < end && *p >= '0' && *p <= '9') {
+		uint64_t digit = (uint64_t)(*p - '0');
+		if (value > (limit - digit) / 10) {
+			return -1;
+		}
+		value = value * 10 + digit;
+		p++;
+	}
+	if (p == digits || (p < end && (*p == '.' || *p == 'e' || *p == 'E'))) {
+		const char *next = NULL;
+		double d = tsp_parse_double(start, end, &next);
+		// -2^63 is exact, 2^63 is the first double past INT64_MAX
+		if (next == start || !(d >= -0x1p63 && d < 0x1p63)) {
+			return -1;
+		}
+		*out = (int64_t)d;
+		return 0;
+	}
+	*out = !negative ? (int64_t)value : value == limit ? INT64_MIN : -(int64_t)value;
+	return 0;
+}
+
+/*
+ * Store the leaf value of path k that spans [p, value_end), numbers may be encoded as strings
+ * The path stays pending if the value is not a number, boolean or null
+ */
+static void tsp_json_leaf(struct tsp_json_scan *scan, int k, const char *p, const char *value_end) {
+	struct tsp_json_extractor *ext = scan->ext;
+	if (*p == '{' || *p == '[') {
+		return;
+	}
+	const char *start = p, *stop = value_end, *next = NULL;
+	if (*p == '"') {
+		start = p + 1;
+		stop = value_end - 1;
+	}
+	int column = ext->columns[k];
+	if (ext->types[k] == TSP_JSON_INT64) {
+		int64_t value = TSP_JSON_MISSING_INT;
+		if (*p == 't' || *p == 'f') {
+			value = *p == 't';
+		} else if (*p != 'n' && tsp_json_parse_int(start, stop, &value) != 0) {
+			return;
+		}
+		scan->ints[column] = value;
+	} else {
+		double value = NAN;
+		if (*p == 't' || *p == 'f') {
+			value = *p == 't';
+		} else if (*p != 'n') {
+			value = tsp_parse_double(start, stop, &next);
+			if (next == start) {
+				return;
+			}
+		}
+		scan->floats[column] = value;
+	}
+	scan->pending &= ~((uint64_t)1 << k);
+}
+
+/* Scan the value at p, active are the paths whose first depth keys lead here */
+static const char *tsp_json_walk(struct tsp_json_scan *scan, const char *p, int depth,
+				 uint64_t active) {
+	struct tsp_json_extractor *ext = scan->ext;
+	uint64_t deeper = 0;
+	const char *value_end = NULL;
+	for (int k = 0; k < ext->npaths; k++) {
+		if (!(active >> k & 1)) {
+			continue;
+		}
+		if (ext->nkeys[k] != depth) {
+			deeper |= (uint64_t)1 << k;
+			continue;
+		}
+		// Every path ending here gets the value, even duplicates and prefixes of other paths
+		if (value_end == NULL) {
+			value_end = tsp_json_skip_value(p, scan->end);
+			if (value_end == NULL) {
+				return NULL;
+			}
+		}
+		tsp_json_leaf(scan, k, p, value_end);
+	}
+	if (deeper == 0 || (*p != '{' && *p != '[')) {
+		return value_end != NULL ? value_end : tsp_json_skip_value(p, scan->end);
+	}
+
+	int is_object = *p == '{';
+	char close = is_object ? '}' : ']';
+	p = tsp_json_skip_ws(p + 1, scan->end);
+	if (p < scan->end && *p == close) {
+		return p + 1;
+	}
+	for (long index = 0;; index++) {
+		uint64_t matched = 0;
+		if (is_object) {
+			if (p >= scan->end || *p != '"') {
+				return NULL;
+			}
+			const char *key_end = tsp_json_string_end(p, scan->end);
+			if (key_end == NULL) {
+				return NULL;
+			}
+			size_t len = (size_t)(key_end - p - 1);
+			for (int k = 0; k < ext->npaths; k++) {
+				struct tsp_json_key *key = &ext->keys[k][depth];
+				if ((deeper >> k & 1) && key->name != NULL && key->len == len &&
+				    memcmp(key->name, p + 1, len) == 0) {
+					matched |= (uint64_t)1 << k;
+				}
+			}
+			p = tsp_json_skip_ws(key_end + 1, scan->end);
+			if (p >= scan->end || *p != ':') {
+				return NULL;
+			}
+			p = tsp_json_skip_ws(p + 1, scan->end);
+		} else {
+			for (int k = 0; k < ext->npaths; k++) {
+				if ((deeper >> k & 1) && ext->keys[k][depth].index == index) {
+					matched |= (uint64_t)1 << k;
+				}
+			}
+		}
+		p = matched ? tsp_json_walk(scan, p, depth + 1, matched)
+			    : tsp_json_skip_value(p, scan->end);
+		if (p == NULL || scan->pending == 0) {
+			return p;
+		}
+		p = tsp_json_skip_ws(p, scan->end);
+		if (p < scan->end && *p == close) {
+			return p + 1;
+		}
+		if (p >= scan->end || *p != ',') {
+			return NULL;
+		}
+		p = tsp_json_skip_ws(p + 1, scan->end);
+	}
+}
+
+/* Free the path arrays of the first npaths paths */
+static void tsp_json_free_paths(struct tsp_json_extractor *ext, int npaths) {
+	for (int k = 0; k < npaths; k++) {
+		for (int j = 0; j < ext->nkeys[k]; j++) {
+			free(ext->keys[k][j].name);
+		}
+		free(ext->keys[k]);
+	}
+}
+
+/* Split a dotted path into keys, numeric segments also match array indices */
+static int tsp_json_split_path(struct tsp_json_extractor *ext, int k, const char *path) {
+	int nkeys = 1;
+	for (const char *c = path; *c != '\0'; c++) {
+		nkeys += *c == '.';
+	}
+	ext->keys[k] = calloc(nkeys, sizeof(struct tsp_json_key));
+	if (ext->keys[k] == NULL) {
+		return -1;
+	}
+	ext->nkeys[k] = nkeys;
+	const char *start = path;
+	for (int j = 0; j < nkeys; j++) {
+		const char *stop = strchr(start, '.');
+		size_t len = stop == NULL ? strlen(start) : (size_t)(stop - start);
+		struct tsp_json_key *key = &ext->keys[k][j];
+		key->index = -1;
+		key->name = malloc(len + 1);
+		if (key->name == NULL) {
+			return -1;
+		}
+		memcpy(key->name, start, len);
+		key->name[len] = '\0';
+		key->len = len;
+		if (len > 0 && strspn(key->name, "0123456789") == len) {
+			key->index = strtol(key->name, NULL, 10);
+		}
+		start += len + 1;
+	}
+	return 0;
+}
+
+/*
+ * Creates an extractor
+ *
+ * paths: Dotted paths of the fields, e.g. "data.lastPrice" or "data.0.p"
+ * types: Output type of every path (TSP_JSON_FLOAT64 or TSP_JSON_INT64)
+ * npaths: Number of paths, at most 64
+ *
+ * return: Pointer to initialized extractor, or NULL on failure
+ */
+struct tsp_json_extractor *tsp_json_extractor_init(const char **paths, const int *types, int npaths) {
+	if (npaths < 1 || npaths > TSP_JSON_MAX_PATHS) {
+		fprintf(stderr, "JSON extractor needs between 1 and %d paths\n", TSP_JSON_MAX_PATHS);
+		return NULL;
+	}
+	struct tsp_json_extractor *obj = calloc(1, sizeof(struct tsp_json_extractor));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize json extractor\n");
+		return NULL;
+	}
+	obj->nkeys = calloc(npaths, sizeof(int));
+	obj->keys = calloc(npaths, sizeof(struct tsp_json_key *));
+	obj->types = calloc(npaths, sizeof(int));
+	obj->columns = calloc(npaths, sizeof(int));
+	if (obj->nkeys == NULL || obj->keys == NULL || obj->types == NULL || obj->columns == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize json extractor\n");
+		tsp_free_json_extractor(obj);
+		return NULL;
+	}
+	for (int k = 0; k < npaths; k++) {
+		obj->npaths = k + 1;
+		if (tsp_json_split_path(obj, k, paths[k]) != 0) {
+			fprintf(stderr, "Could not allocate memory for json path\n");
+			tsp_free_json_extractor(obj);
+			return NULL;
+		}
+		obj->types[k] = types[k] == TSP_JSON_INT64 ? TSP_JSON_INT64 : TSP_JSON_FLOAT64;
+		obj->columns[k] = obj->types[k] == TSP_JSON_INT64 ? obj->nint++ : obj->nfloat++;
+	}
+	return obj;
+}
+
+/* Free extractor */
+void tsp_free_json_extractor(struct tsp_json_extractor *ext) {
+	if (ext->keys != NULL) {
+		tsp_json_free_paths(ext, ext->npaths);
+	}
+	free(ext->nkeys);
+	free(ext->keys);
+	free(ext->types);
+	free(ext->columns);
+	free(ext);
+}
+
+/*
+ * Extracts the fields of one message
+ *
+ * floats: Output of nfloat float64 columns, NaN for missing fields
+ * ints: Output of nint int64 columns, TSP_JSON_MISSING_INT for missing fields
+ *
+ * return: Number of found fields, -1 if the message is malformed before all are found
+ */
+int tsp_json_extract(struct tsp_json_extractor *ext, const char *data, size_t len, double *floats,
+		     int64_t *ints) {
+	for (int j = 0; j < ext->nfloat; j++) {
+		floats[j] = NAN;
+	}
+	for (int j = 0; j < ext->nint; j++) {
+		ints[j] = TSP_JSON_MISSING_INT;
+	}
+	struct tsp_json_scan scan = {
+	    .ext = ext,
+	    .end = data + len,
+	    .floats = floats,
+	    .ints = ints,
+	    .pending = ext->npaths == 64 ? ~(uint64_t)0 : ((uint64_t)1 << ext->npaths) - 1,
+	};
+	const char *p = tsp_json_skip_ws(data, scan.end);
+	uint64_t all = scan.pending;
+	if (p == scan.end || tsp_json_walk(&scan, p, 0, all) == NULL) {
+		if (scan.pending != 0) {
+			return -1;
+		}
+	}
+	return ext->npaths - __builtin_popcountll(scan.pending);
+}
+
+/* Extract one message into the next row, return 1 if the row is kept */
+static int tsp_json_extract_row(struct tsp_json_extractor *ext, const char *data, size_t len,
+				double *floats, int64_t *ints, long row, int require_all) {
+	int found = tsp_json_extract(ext, data, len, floats + row * ext->nfloat, ints + row * ext->nint);
+	return require_all ? found == ext->npaths : found > 0;
+}
+
+/*
+ * Extracts the fields of messages separated by NUL characters into row-major columns
+ * (JSON text can't contain a raw NUL, so a batch is passed as one buffer)
+ * Messages without any of the fields (all of them if require_all) are skipped
+ *
+ * floats: Output of nfloat values per message
+ * ints: Output of nint values per message
+ *
+ * return: Number of written rows
+ */
+long tsp_json_extract_joined(struct tsp_json_extractor *ext, const char *data, size_t len,
+			     double *floats, int64_t *ints, int require_all) {
+	const char *end = data + len;
+	long rows = 0;
+	for (const char *p = data; p <= end;) {
+		const char *stop = memchr(p, '\0', (size_t)(end - p));
+		if (stop == NULL) {
+			stop = end;
+		}
+		rows += tsp_json_extract_row(ext, p, (size_t)(stop - p), floats, ints, rows, require_all);
+		p = stop + 1;
+	}
+	return rows;
+}
+
+/*
+ * Same as tsp_json_extract_joined for messages taken from a tsp_ring
+ * The messages are freed
+ */
+long tsp_json_extract_ring(struct tsp_json_extractor *ext, struct tsp_ring_msg **msgs, long n,
+			   double *floats, int64_t *ints, int require_all) {
+	long rows = 0;
+	for (long i = 0; i < n; i++) {
+		rows += tsp_json_extract_row(ext, msgs[i]->data, msgs[i]->len, floats, ints, rows,
+					     require_all);
+		tsp_ring_free_msg(msgs[i]);
+	}
+	return rows;
+}
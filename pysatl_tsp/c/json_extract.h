@@ -0,0 +1,47 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef JSON_EXTRACT_H
+#define JSON_EXTRACT_H
+#include "ring.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Key or array index of a JSON path */
+struct tsp_json_key {
+	char *name;  // Object key (not unescaped), NULL for array index
+	size_t len;  // Length of name
+	long index;  // Array index, -1 for object key
+};
+
+/*
+ * Extractor of numeric fields from JSON messages
+ *
+ * Messages are scanned once, values outside of the requested paths are skipped
+ * without being parsed, scanning stops when all paths are found.
+ */
+struct tsp_json_extractor {
+	int npaths;
+	int *nkeys;		   // Number of keys of every path
+	struct tsp_json_key **keys; // Keys of every path
+	int *types;		   // Output type of every path (TSP_JSON_*)
+	int *columns;		   // Column of every path among the columns of its type
+	int nfloat;		   // Number of float64 columns
+	int nint;		   // Number of int64 columns
+};
+
+TSP_API_START
+#define TSP_JSON_FLOAT64 0
+#define TSP_JSON_INT64 1
+/* Value of int64 columns for missing fields, float64 columns get NaN */
+#define TSP_JSON_MISSING_INT -9223372036854775807
+
+struct tsp_json_extractor *tsp_json_extractor_init(const char **paths, const int *types, int npaths);
+void tsp_free_json_extractor(struct tsp_json_extractor *ext);
+int tsp_json_extract(struct tsp_json_extractor *ext, const char *data, size_t len, double *floats,
+		     int64_t *ints);
+long tsp_json_extract_joined(struct tsp_json_extractor *ext, const char *data, size_t len,
+			     double *floats, int64_t *ints, int require_all);
+long tsp_json_extract_ring(struct tsp_json_extractor *ext, struct tsp_ring_msg **msgs, long n,
+			   double *floats, int64_t *ints, int require_all);
+TSP_API_END
+#endif /* JSON_EXTRACT_H */
@@ -0,0 +1,430 @@
+#include "kernels.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TSP_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Min/max of a range containing NaN is NaN in every variant, like in numpy
+ * (comparisons alone would give a different answer per vector width)
+ */
+static inline void tsp_minmax_store(int nan, double mn, double mx, double *min, double *max) {
+	*min = nan ? NAN : mn;
+	*max = nan ? NAN : mx;
+}
+
+/*
+ * Generic kernels
+ *
+ * Plain C loops, used on non-x86 hosts and as the reference implementation.
+ * Multiple accumulators let the compiler keep several additions in flight.
+ */
+static double tsp_sum_generic(const double *x, long n) {
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		s0 += x[i];
+		s1 += x[i + 1];
+		s2 += x[i + 2];
+		s3 += x[i + 3];
+	}
+	for (; i < n; i++) {
+		s0 += x[i];
+	}
+	return (s0 + s1) + (s2 + s3);
+}
+
+static double tsp_dot_generic(const double *x, const double *w, long n) {
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		s0 += x[i] * w[i];
+		s1 += x[i + 1] * w[i + 1];
+		s2 += x[i + 2] * w[i + 2];
+		s3 += x[i + 3] * w[i + 3];
+	}
+	for (; i < n; i++) {
+		s0 += x[i] * w[i];
+	}
+	return (s0 + s1) + (s2 + s3);
+}
+
+static void tsp_minmax_generic(const double *x, long n, double *min, double *max) {
+	double mn = x[0], mx = x[0];
+	int nan = isnan(x[0]);
+	for (long i = 1; i < n; i++) {
+		mn = x[i] < mn ? x[i] : mn;
+		mx = x[i] > mx ? x[i] : mx;
+		nan |= isnan(x[i]);
+	}
+	tsp_minmax_store(nan, mn, mx, min, max);
+}
+
+static void tsp_ma_generic(double *sum, const double *added, const double *removed, long n) {
+	for (long i = 0; i < n; i++) {
+		sum[i] += added[i] - removed[i];
+	}
+}
+
+static void tsp_ema_generic(double *state, const double *x, double alpha, long n) {
+	for (long i = 0; i < n; i++) {
+		state[i] += alpha * (x[i] - state[i]);
+	}
+}
+
+static const struct tsp_kernels tsp_kernels_generic = {
+    "generic", tsp_sum_generic, tsp_dot_generic, tsp_minmax_generic, tsp_ma_generic, tsp_ema_generic,
+};
+
+#ifdef TSP_X86_DISPATCH
+/*
+ * SSE2 kernels (2 doubles per register)
+ */
+__attribute__((target("sse2"))) static double tsp_sum_sse2(const double *x, long n) {
+	__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+	long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		a0 = _mm_add_pd(a0, _mm_loadu_pd(x + i));
+		a1 = _mm_add_pd(a1, _mm_loadu_pd(x + i + 2));
+	}
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(a0, a1));
+	double s = lanes[0] + lanes[1];
+	for (; i < n; i++) {
+		s += x[i];
+	}
+	return s;
+}
+
+__attribute__((target("sse2"))) static double tsp_dot_sse2(const double *x, const double *w, long n) {
+	__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+	long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		a0 = _mm_add_pd(a0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(w + i)));
+		a1 = _mm_add_pd(a1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(w + i + 2)));
+	}
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(a0, a1));
+	double s = lanes[0] + lanes[1];
+	for (; i < n; i++) {
+		s += x[i] * w[i];
+	}
+	return s;
+}
+
+__attribute__((target("sse2"))) static void tsp_minmax_sse2(const double *x, long n, double *min,
+							    double *max) {
+	long i = 0;
+	double mn = x[0], mx = x[0];
+	int nan = 0;
+	if (n >= 2) {
+		__m128d vmn = _mm_loadu_pd(x), vmx = vmn;
+		__m128d vnan = _mm_cmpunord_pd(vmn, vmn);
+		for (i = 2; i + 2 <= n; i += 2) {
+			__m128d v = _mm_loadu_pd(x + i);
+			vmn = _mm_min_pd(vmn, v);
+			vmx = _mm_max_pd(vmx, v);
+			vnan = _mm_or_pd(vnan, _mm_cmpunord_pd(v, v));
+		}
+		double lo[2], hi[2];
+		_mm_storeu_pd(lo, vmn);
+		_mm_storeu_pd(hi, vmx);
+		mn = lo[0] < lo[1] ? lo[0] : lo[1];
+		mx = hi[0] > hi[1] ? hi[0] : hi[1];
+		nan = _mm_movemask_pd(vnan) != 0;
+	}
+	for (; i < n; i++) {
+		mn = x[i] < mn ? x[i] : mn;
+		mx = x[i] > mx ? x[i] : mx;
+		nan |= isnan(x[i]);
+	}
+	tsp_minmax_store(nan, mn, mx, min, max);
+}
+
+__attribute__((target("sse2"))) static void tsp_ma_sse2(double *sum, const double *added,
+							const double *removed, long n) {
+	long i = 0;
+	for (; i + 2 <= n; i += 2) {
+		__m128d d = _mm_sub_pd(_mm_loadu_pd(added + i), _mm_loadu_pd(removed + i));
+		_mm_storeu_pd(sum + i, _mm_add_pd(_mm_loadu_pd(sum + i), d));
+	}
+	for (; i < n; i++) {
+		sum[i] += added[i] - removed[i];
+	}
+}
+
+__attribute__((target("sse2"))) static void tsp_ema_sse2(double *state, const double *x, double alpha,
+							 long n) {
+	__m128d a = _mm_set1_pd(alpha);
+	long i = 0;
+	for (; i + 2 <= n; i += 2) {
+		__m128d s = _mm_loadu_pd(state + i);
+		__m128d d = _mm_sub_pd(_mm_loadu_pd(x + i), s);
+		_mm_storeu_pd(state + i, _mm_add_pd(s, _mm_mul_pd(a, d)));
+	}
+	for (; i < n; i++) {
+		state[i] += alpha * (x[i] - state[i]);
+	}
+}
+
+static const struct tsp_kernels tsp_kernels_sse2 = {
+    "sse2", tsp_sum_sse2, tsp_dot_sse2, tsp_minmax_sse2, tsp_ma_sse2, tsp_ema_sse2,
+};
+
+/*
+ * AVX2 kernels (4 doubles per register, fused multiply-add)
+ */
+__attribute__((target("avx2,fma"))) static double tsp_sum_avx2(const double *x, long n) {
+	__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i + 8 <= n; i += 8) {
+		a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+		a1 = _mm256_add_pd(a1, _mm256_loadu_pd(x + i + 4));
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(a0, a1));
+	double s = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for (; i < n; i++) {
+		s += x[i];
+	}
+	return s;
+}
+
+__attribute__((target("avx2,fma"))) static double tsp_dot_avx2(const double *x, const double *w, long n) {
+	__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i + 8 <= n; i += 8) {
+		a0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(w + i), a0);
+		a1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(w + i + 4), a1);
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(a0, a1));
+	double s = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for (; i < n; i++) {
+		s += x[i] * w[i];
+	}
+	return s;
+}
+
+__attribute__((target("avx2,fma"))) static void tsp_minmax_avx2(const double *x, long n, double *min,
+								double *max) {
+	long i = 0;
+	double mn = x[0], mx = x[0];
+	int nan = 0;
+	if (n >= 4) {
+		__m256d vmn = _mm256_loadu_pd(x), vmx = vmn;
+		__m256d vnan = _mm256_cmp_pd(vmn, vmn, _CMP_UNORD_Q);
+		for (i = 4; i + 4 <= n; i += 4) {
+			__m256d v = _mm256_loadu_pd(x + i);
+			vmn = _mm256_min_pd(vmn, v);
+			vmx = _mm256_max_pd(vmx, v);
+			vnan = _mm256_or_pd(vnan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+		}
+		double lo[4], hi[4];
+		_mm256_storeu_pd(lo, vmn);
+		_mm256_storeu_pd(hi, vmx);
+		mn = lo[0];
+		mx = hi[0];
+		for (int k = 1; k < 4; k++) {
+			mn = lo[k] < mn ? lo[k] : mn;
+			mx = hi[k] > mx ? hi[k] : mx;
+		}
+		nan = _mm256_movemask_pd(vnan) != 0;
+	}
+	for (; i < n; i++) {
+		mn = x[i] < mn ? x[i] : mn;
+		mx = x[i] > mx ? x[i] : mx;
+		nan |= isnan(x[i]);
+	}
+	tsp_minmax_store(nan, mn, mx, min, max);
+}
+
+__attribute__((target("avx2,fma"))) static void tsp_ma_avx2(double *sum, const double *added,
+							    const double *removed, long n) {
+	long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256d d = _mm256_sub_pd(_mm256_loadu_pd(added + i), _mm256_loadu_pd(removed + i));
+		_mm256_storeu_pd(sum + i, _mm256_add_pd(_mm256_loadu_pd(sum + i), d));
+	}
+	for (; i < n; i++) {
+		sum[i] += added[i] - removed[i];
+	}
+}
+
+__attribute__((target("avx2,fma"))) static void tsp_ema_avx2(double *state, const double *x, double alpha,
+							     long n) {
+	__m256d a = _mm256_set1_pd(alpha);
+	long i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256d s = _mm256_loadu_pd(state + i);
+		__m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), s);
+		_mm256_storeu_pd(state + i, _mm256_fmadd_pd(a, d, s));
+	}
+	for (; i < n; i++) {
+		state[i] += alpha * (x[i] - state[i]);
+	}
+}
+
+static const struct tsp_kernels tsp_kernels_avx2 = {
+    "avx2", tsp_sum_avx2, tsp_dot_avx2, tsp_minmax_avx2, tsp_ma_avx2, tsp_ema_avx2,
+};
+
+/*
+ * AVX-512 kernels (8 doubles per register, masked tails)
+ */
+__attribute__((target("avx512f"))) static double tsp_sum_avx512(const double *x, long n) {
+	__m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i + 16 <= n; i += 16) {
+		a0 = _mm512_add_pd(a0, _mm512_loadu_pd(x + i));
+		a1 = _mm512_add_pd(a1, _mm512_loadu_pd(x + i + 8));
+	}
+	for (; i < n; i += 8) {
+		__mmask8 m = (n - i) >= 8 ? 0xFF : (__mmask8)((1u << (n - i)) - 1);
+		a0 = _mm512_add_pd(a0, _mm512_maskz_loadu_pd(m, x + i));
+	}
+	return _mm512_reduce_add_pd(_mm512_add_pd(a0, a1));
+}
+
+__attribute__((target("avx512f"))) static double tsp_dot_avx512(const double *x, const double *w, long n) {
+	__m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i + 16 <= n; i += 16) {
+		a0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(w + i), a0);
+		a1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(w + i + 8), a1);
+	}
+	for (; i < n; i += 8) {
+		__mmask8 m = (n - i) >= 8 ? 0xFF : (__mmask8)((1u << (n - i)) - 1);
+		a0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, w + i), a0);
+	}
+	return _mm512_reduce_add_pd(_mm512_add_pd(a0, a1));
+}
+
+__attribute__((target("avx512f"))) static void tsp_minmax_avx512(const double *x, long n, double *min,
+								 double *max) {
+	__m512d vmn = _mm512_set1_pd(x[0]), vmx = vmn;
+	__mmask8 nan = 0;
+	for (long i = 0; i < n; i += 8) {
+		__mmask8 m = (n - i) >= 8 ? 0xFF : (__mmask8)((1u << (n - i)) - 1);
+		// Lanes outside the tail mask keep x[0], which is already accounted
+		__m512d v = _mm512_mask_loadu_pd(_mm512_set1_pd(x[0]), m, x + i);
+		vmn = _mm512_min_pd(vmn, v);
+		vmx = _mm512_max_pd(vmx, v);
+		nan |= _mm512_cmp_pd_mask(v, v, _CMP_UNORD_Q);
+	}
+	tsp_minmax_store(nan != 0, _mm512_reduce_min_pd(vmn), _mm512_reduce_max_pd(vmx), min, max);
+}
+
+__attribute__((target("avx512f"))) static void tsp_ma_avx512(double *sum, const double *added,
+							     const double *removed, long n) {
+	for (long i = 0; i < n; i += 8) {
+		__mmask8 m = (n - i) >= 8 ? 0xFF : (__mmask8)((1u << (n - i)) - 1);
+		__m512d d = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, added + i),
+					  _mm512_maskz_loadu_pd(m, removed + i));
+		_mm512_mask_storeu_pd(sum + i, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, sum + i), d));
+	}
+}
+
+__attribute__((target("avx512f"))) static void tsp_ema_avx512(double *state, const double *x,
+							      double alpha, long n) {
+	__m512d a = _mm512_set1_pd(alpha);
+	for (long i = 0; i < n; i += 8) {
+		__mmask8 m = (n - i) >= 8 ? 0xFF : (__mmask8)((1u << (n - i)) - 1);
+		__m512d s = _mm512_maskz_loadu_pd(m, state + i);
+		__m512d d = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, x + i), s);
+		_mm512_mask_storeu_pd(state + i, m, _mm512_fmadd_pd(a, d, s));
+	}
+}
+
+static const struct tsp_kernels tsp_kernels_avx512 = {
+    "avx512", tsp_sum_avx512, tsp_dot_avx512, tsp_minmax_avx512, tsp_ma_avx512, tsp_ema_avx512,
+};
+#endif /* TSP_X86_DISPATCH */
+
+const struct tsp_kernels *tsp_active_kernels = &tsp_kernels_generic;
+
+/* Find kernel table by ISA name, NULL if it is unknown or unsupported by the CPU */
+static const struct tsp_kernels *tsp_kernels_lookup(const char *isa) {
+	if (strcmp(isa, "generic") == 0) {
+		return &tsp_kernels_generic;
+	}
+#ifdef TSP_X86_DISPATCH
+	__builtin_cpu_init();
+	if (strcmp(isa, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+		return &tsp_kernels_sse2;
+	}
+	if (strcmp(isa, "avx2") == 0 && __builtin_cpu_supports("avx2") &&
+	    __builtin_cpu_supports("fma")) {
+		return &tsp_kernels_avx2;
+	}
+	if (strcmp(isa, "avx512") == 0 && __builtin_cpu_supports("avx512f")) {
+		return &tsp_kernels_avx512;
+	}
+#endif
+	return NULL;
+}
+
+/* Whether the variant isa can run on this CPU */
+int tsp_kernels_supported(const char *isa) { return tsp_kernels_lookup(isa) != NULL; }
+
+/*
+ * Switch kernels to the variant isa
+ * Returns 0 on success and -1 if the variant is unknown or unsupported
+ */
+int tsp_kernels_select(const char *isa) {
+	const struct tsp_kernels *kernels = tsp_kernels_lookup(isa);
+	if (kernels == NULL) {
+		return -1;
+	}
+	tsp_active_kernels = kernels;
+	return 0;
+}
+
+const char *tsp_kernels_isa(void) { return tsp_active_kernels->isa; }
+
+/*
+ * Select kernels when the library is loaded (at import time of the Python module)
+ * PYSATL_TSP_ISA forces a variant, e.g. to benchmark generic code on an AVX-512 host
+ * Compilers without constructor support keep the generic kernels
+ */
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((constructor))
+#endif
+static void tsp_kernels_init(void) {
+	const char *forced = getenv("PYSATL_TSP_ISA");
+	if (forced != NULL && forced[0] != '\0') {
+		if (tsp_kernels_select(forced) == 0) {
+			return;
+		}
+		fprintf(stderr, "PYSATL_TSP_ISA=%s is unknown or not supported, detecting\n", forced);
+	}
+	const char *preferred[] = {"avx512", "avx2", "sse2"};
+	for (int i = 0; i < 3; i++) {
+		if (tsp_kernels_select(preferred[i]) == 0) {
+			return;
+		}
+	}
+}
+
+double tsp_kernel_sum(const double *x, long n) { return tsp_active_kernels->sum(x, n); }
+
+double tsp_kernel_dot(const double *x, const double *w, long n) {
+	return tsp_active_kernels->dot(x, w, n);
+}
+
+void tsp_kernel_minmax(const double *x, long n, double *min, double *max) {
+	tsp_active_kernels->minmax(x, n, min, max);
+}
+
+void tsp_kernel_ma(double *sum, const double *added, const double *removed, long n) {
+	tsp_active_kernels->ma(sum, added, removed, n);
+}
+
+void tsp_kernel_ema(double *state, const double *x, double alpha, long n) {
+	tsp_active_kernels->ema(state, x, alpha, n);
+}
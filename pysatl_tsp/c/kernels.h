@@ -0,0 +1,42 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef KERNELS_H
+#define KERNELS_H
+
+/*
+ * Table of hot numeric kernels
+ *
+ * Every instruction set variant (generic, SSE2, AVX2, AVX-512) fills the same table.
+ * The best variant supported by the CPU is selected once, when the library is loaded,
+ * and can be overridden with the PYSATL_TSP_ISA environment variable
+ * (generic, sse2, avx2 or avx512) or with tsp_kernels_select().
+ */
+struct tsp_kernels {
+	const char *isa; // Name of the instruction set variant
+	// Sum of n values (window re-summation, batch moving averages)
+	double (*sum)(const double *x, long n);
+	// Weighted sum of n values (weighted moving averages)
+	double (*dot)(const double *x, const double *w, long n);
+	// Minimum and maximum of n > 0 values (rolling min/max, aggregates), NaN if any value is NaN
+	void (*minmax)(const double *x, long n, double *min, double *max);
+	// Moving average update of n independent series: sum[i] += added[i] - removed[i]
+	void (*ma)(double *sum, const double *added, const double *removed, long n);
+	// EMA update of n independent series: state[i] += alpha * (x[i] - state[i])
+	void (*ema)(double *state, const double *x, double alpha, long n);
+};
+
+/* Currently selected kernel table, never NULL */
+extern const struct tsp_kernels *tsp_active_kernels;
+
+TSP_API_START
+const char *tsp_kernels_isa(void);
+int tsp_kernels_select(const char *isa);
+int tsp_kernels_supported(const char *isa);
+
+double tsp_kernel_sum(const double *x, long n);
+double tsp_kernel_dot(const double *x, const double *w, long n);
+void tsp_kernel_minmax(const double *x, long n, double *min, double *max);
+void tsp_kernel_ma(double *sum, const double *added, const double *removed, long n);
+void tsp_kernel_ema(double *state, const double *x, double alpha, long n);
+TSP_API_END
+#endif /* KERNELS_H */
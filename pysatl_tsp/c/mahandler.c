@@ -1,33 +1,16 @@
 #include "mahandler.h"
 #include "handler.h"
+#include "kernels.h"
 #include <stdio.h>
 #include <stdlib.h>
-
-/*
- * Circular queue insertion operation
- * Adds value to tail and advances tail pointer with wrap-around
- */
-static int tsp_queue_put(struct tsp_queue *q, float value) {
-	q->buffer[q->tail] = value;
-	q->tail = (q->tail + 1) % q->capacity;
-	return 0;
-}
-
-/*
- * Circular queue extraction operation
- * Retrieves value from head and advances head pointer with wrap-around
- */
-static double tsp_queue_get(struct tsp_queue *q) {
-	double value = q->buffer[q->head];
-	q->head = (q->head + 1) % q->capacity;
-	return value;
-}
+#include <string.h>
 
 /*
  * Moving Average operation
  *
  * Implements a moving average algorithm by maintaining a running sum
  * Efficiently maintains running average using circular buffer
+ * Accuracy of the running sum is controlled by the queue's sum_mode
  *
  * Behavior phases:
  * 1. Warm-up: Queue fills until reaching capacity (increasing window size)
@@ -40,15 +23,59 @@ double tsp_op_MA(struct tsp_handler *handler, void *next) {
 	if (q->size < q->capacity) {
 		// Initial filling phase - queue not yet at capacity
 		q->size++;
-		q->sum += *value;
-		tsp_queue_put(q, *value);
+		tsp_queue_sum_push(q, tsp_queue_put(q, *value));
 	} else {
 		// Queue is full - replace oldest value
 		double old = tsp_queue_get(q);
-		tsp_queue_put(q, *value);
-		q->sum += (*value - old); // Efficient sum update
+		double stored = tsp_queue_put(q, *value);
+		tsp_queue_sum_replace(q, stored, old); // Efficient sum update
 	}
 
-	double ma = q->sum / q->size;
+	double ma = tsp_queue_sum_value(q) / q->size;
 	return ma;
 }
+
+/* Values whose window updates are computed by one call of the MA kernel */
+#define TSP_MA_BATCH_BLOCK 256
+
+/*
+ * Moving Average operation over a block of values (batch operation of tsp_handler)
+ *
+ * Once the window is full, value i of a block evicts the value head + i of the ring,
+ * so the updates added - removed of a whole run are computed by the vectorized
+ * MA kernel, and only the prefix sum over them stays sequential.
+ * The arithmetic is the one of tsp_op_MA, so results are identical.
+ * The warm-up, float32 windows and compensated sum modes go through tsp_op_MA.
+ */
+int tsp_batch_MA(struct tsp_handler *handler, double *values, int n) {
+	struct tsp_queue *q = (struct tsp_queue *)handler->data;
+	double updates[TSP_MA_BATCH_BLOCK];
+	int i = 0;
+
+	while (i < n && (q->size < q->capacity || q->precision != TSP_PRECISION_F64 ||
+			 q->sum_mode != TSP_SUM_NAIVE)) {
+		values[i] = tsp_op_MA(handler, (void *)&values[i]);
+		i++;
+	}
+
+	while (i < n) {
+		// Evicted values are contiguous up to the end of the ring
+		int m = q->capacity - q->head;
+		m = m < n - i ? m : n - i;
+		m = m < TSP_MA_BATCH_BLOCK ? m : TSP_MA_BATCH_BLOCK;
+		double *window = q->buffer + q->head;
+
+		memset(updates, 0, sizeof(double) * m);
+		tsp_kernel_ma(updates, values + i, window, m);
+		memcpy(window, values + i, sizeof(double) * m);
+		q->head = (q->head + m) % q->capacity;
+		q->tail = q->head;
+
+		for (int j = 0; j < m; j++) {
+			q->sum += updates[j];
+			values[i + j] = q->sum / q->size;
+		}
+		i += m;
+	}
+	return 0;
+}
@@ -5,5 +5,6 @@
 #include "handler.h"
 TSP_API_START
 double tsp_op_MA(struct tsp_handler *handler, void *next);
+int tsp_batch_MA(struct tsp_handler *handler, double *values, int n);
 TSP_API_END
 #endif /* MA_HANDLER_H */
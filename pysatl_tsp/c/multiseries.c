@@ -0,0 +1,242 @@
+#include "multiseries.h"
+#include "kernels.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Creates an engine computing a set of indicators for many series
+ *
+ * n_series: Number of series
+ * n_indicators: Number of indicators computed for every series
+ * kinds: Kind of every indicator (TSP_MS_*)
+ * lengths: Period of every indicator
+ *
+ * return: Pointer to initialized engine, or NULL on failure
+ */
+struct tsp_multiseries *tsp_multiseries_init(long n_series, long n_indicators, const int *kinds, const long *lengths) {
+	if (n_series < 1 || n_indicators < 0) {
+		fprintf(stderr, "Invalid number of series %ld or indicators %ld\n", n_series, n_indicators);
+		return NULL;
+	}
+	long depth = 1;
+	for (long k = 0; k < n_indicators; k++) {
+		if (kinds[k] < TSP_MS_SMA || kinds[k] > TSP_MS_WMA || lengths[k] < 1) {
+			fprintf(stderr, "Invalid indicator kind %d or length %ld\n", kinds[k], lengths[k]);
+			return NULL;
+		}
+		depth = lengths[k] > depth ? lengths[k] : depth;
+	}
+	struct tsp_multiseries *obj = calloc(1, sizeof(struct tsp_multiseries));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize multi-series engine\n");
+		return NULL;
+	}
+	obj->n_series = n_series;
+	obj->n_indicators = n_indicators;
+	obj->depth = depth;
+	obj->indicators = calloc(n_indicators > 0 ? n_indicators : 1, sizeof(struct tsp_ms_indicator));
+	obj->ring = malloc(depth * n_series * sizeof(double));
+	obj->clean = malloc((depth + 1) * n_series * sizeof(double));
+	obj->row_bad = malloc((depth + 1) * sizeof(long));
+	int failed = obj->indicators == NULL || obj->ring == NULL || obj->clean == NULL || obj->row_bad == NULL;
+	for (long k = 0; !failed && k < n_indicators; k++) {
+		struct tsp_ms_indicator *ind = &obj->indicators[k];
+		ind->kind = kinds[k];
+		ind->length = lengths[k];
+		ind->sum = malloc(n_series * sizeof(double));
+		ind->num = malloc(n_series * sizeof(double));
+		ind->ema = malloc(n_series * sizeof(double));
+		ind->bad = malloc(n_series * sizeof(long));
+		failed = ind->sum == NULL || ind->num == NULL || ind->ema == NULL || ind->bad == NULL;
+	}
+	if (failed) {
+		fprintf(stderr, "Could not allocate memory to initialize multi-series engine\n");
+		tsp_free_multiseries(obj);
+		return NULL;
+	}
+	tsp_multiseries_reset(obj);
+	return obj;
+}
+
+void tsp_free_multiseries(struct tsp_multiseries *m) {
+	if (m->indicators != NULL) {
+		for (long k = 0; k < m->n_indicators; k++) {
+			free(m->indicators[k].sum);
+			free(m->indicators[k].num);
+			free(m->indicators[k].ema);
+			free(m->indicators[k].bad);
+		}
+	}
+	free(m->indicators);
+	free(m->ring);
+	free(m->clean);
+	free(m->row_bad);
+	free(m);
+}
+
+/* Forget all values of all series */
+void tsp_multiseries_reset(struct tsp_multiseries *m) {
+	size_t row = m->n_series * sizeof(double);
+	// Rows not written yet are read as the values leaving warming-up windows
+	memset(m->ring, 0, m->depth * row);
+	memset(m->clean, 0, m->depth * row);
+	memset(m->row_bad, 0, m->depth * sizeof(long));
+	for (long k = 0; k < m->n_indicators; k++) {
+		memset(m->indicators[k].sum, 0, row);
+		memset(m->indicators[k].num, 0, row);
+		memset(m->indicators[k].ema, 0, row);
+		memset(m->indicators[k].bad, 0, m->n_series * sizeof(long));
+		m->indicators[k].bad_all = 0;
+		m->indicators[k].decay = 1;
+	}
+	m->steps = 0;
+}
+
+/* Write scale * state to out for every series, or NaN while the indicator warms up */
+static void tsp_ms_output(const double *state, double scale, long n, int ready, double *out) {
+	if (!ready) {
+		for (long i = 0; i < n; i++) {
+			out[i] = NAN;
+		}
+		return;
+	}
+	for (long i = 0; i < n; i++) {
+		out[i] = state[i] * scale;
+	}
+}
+
+/*
+ * Recompute SMA or WMA of the series whose window holds non-finite values
+ * The window of series i is x[i] and the values of the length - 1 previous rows of the ring
+ */
+static void tsp_ms_recompute(const struct tsp_multiseries *m, const struct tsp_ms_indicator *ind, const double *x,
+			     double *out) {
+	long n = m->n_series;
+	long slot = m->steps % m->depth;
+	double length = (double)ind->length;
+	for (long i = 0; i < n; i++) {
+		if (ind->bad[i] == 0) {
+			continue;
+		}
+		double total = ind->kind == TSP_MS_WMA ? length * x[i] : x[i];
+		for (long age = 1; age < ind->length; age++) {
+			double value = m->ring[((slot - age) % m->depth + m->depth) % m->depth * n + i];
+			total += ind->kind == TSP_MS_WMA ? (length - age) * value : value;
+		}
+		out[i] = ind->kind == TSP_MS_WMA ? total * 2 / (length * (length + 1)) : total / length;
+	}
+}
+
+/*
+ * Re-sum the running sums of SMA or WMA from the clean ring once every length timestamps
+ * The updates round a little at every step, re-summing keeps the error bounded by one window
+ */
+static void tsp_ms_resum(const struct tsp_multiseries *m, struct tsp_ms_indicator *ind) {
+	if ((m->steps + 1) % ind->length != 0) {
+		return;
+	}
+	long n = m->n_series;
+	long slot = m->steps % m->depth;
+	memset(ind->sum, 0, n * sizeof(double));
+	memset(ind->num, 0, n * sizeof(double));
+	for (long age = 0; age < ind->length; age++) {
+		// The entering row is not in the ring yet, it follows the rows of the ring
+		long row = age == 0 ? m->depth : ((slot - age) % m->depth + m->depth) % m->depth;
+		const double *values = m->clean + row * n;
+		double weight = (double)(ind->length - age);
+		for (long i = 0; i < n; i++) {
+			ind->sum[i] += values[i];
+			ind->num[i] += weight * values[i];
+		}
+	}
+}
+
+/* Advance an indicator of all series by one timestamp, the value leaving its window is in the given row */
+static void tsp_ms_step(struct tsp_multiseries *m, struct tsp_ms_indicator *ind, const double *x, long row,
+			double *out) {
+	long n = m->n_series, t = m->steps;
+	double length = (double)ind->length;
+	int ready = t + 1 >= ind->length;
+	const double *x_clean = m->clean + m->depth * n, *removed = m->ring + row * n;
+	const double *removed_clean = m->clean + row * n;
+	long entering_bad = m->row_bad[m->depth], leaving_bad = m->row_bad[row];
+	if ((ind->kind == TSP_MS_SMA || ind->kind == TSP_MS_WMA) && (entering_bad > 0 || leaving_bad > 0)) {
+		// Non-finite values stay out of the running sums, they are counted instead
+		for (long i = 0; i < n; i++) {
+			ind->bad[i] += !isfinite(x[i]) - !isfinite(removed[i]);
+		}
+		ind->bad_all += entering_bad - leaving_bad;
+	}
+	switch (ind->kind) {
+	case TSP_MS_SMA:
+		tsp_kernel_ma(ind->sum, x_clean, removed_clean, n);
+		tsp_ms_resum(m, ind);
+		tsp_ms_output(ind->sum, 1 / length, n, ready, out);
+		break;
+	case TSP_MS_WMA:
+		// Shifting the window lowers the weight of every value by one: num -= sum
+		for (long i = 0; i < n; i++) {
+			ind->num[i] += length * x_clean[i] - ind->sum[i];
+		}
+		tsp_kernel_ma(ind->sum, x_clean, removed_clean, n);
+		tsp_ms_resum(m, ind);
+		tsp_ms_output(ind->num, 2 / (length * (length + 1)), n, ready, out);
+		break;
+	case TSP_MS_EMA:
+		if (t + 1 < ind->length) {
+			tsp_kernel_ma(ind->sum, x, removed, n);
+		} else if (t + 1 == ind->length) {
+			for (long i = 0; i < n; i++) {
+				ind->ema[i] = (ind->sum[i] + x[i]) / length;
+			}
+		} else {
+			tsp_kernel_ema(ind->ema, x, 2 / (length + 1), n);
+		}
+		tsp_ms_output(ind->ema, 1, n, ready, out);
+		break;
+	case TSP_MS_RMA:
+		// The EMA starts from zero, dividing by 1 - decay removes the weight of that start
+		tsp_kernel_ema(ind->ema, x, 1 / length, n);
+		ind->decay *= 1 - 1 / length;
+		tsp_ms_output(ind->ema, 1 / (1 - ind->decay), n, ready, out);
+		break;
+	}
+	if (ready && ind->bad_all > 0 && (ind->kind == TSP_MS_SMA || ind->kind == TSP_MS_WMA)) {
+		tsp_ms_recompute(m, ind, x, out);
+	}
+}
+
+/*
+ * Advances all series by a number of timestamps
+ *
+ * m: Engine
+ * values: n_steps rows of n_series values, the values of all series at one timestamp per row
+ * n_steps: Number of timestamps
+ * out: Receives n_steps x n_indicators rows of n_series indicator values, NaN while an indicator warms up
+ */
+void tsp_multiseries_process(struct tsp_multiseries *m, const double *values, long n_steps, double *out) {
+	long n = m->n_series;
+	for (long s = 0; s < n_steps; s++, m->steps++) {
+		const double *x = values + s * n;
+		long slot = m->steps % m->depth;
+		double *x_clean = m->clean + m->depth * n;
+		long bad = 0;
+		for (long i = 0; i < n; i++) {
+			int finite = isfinite(x[i]);
+			x_clean[i] = finite ? x[i] : 0;
+			bad += !finite;
+		}
+		m->row_bad[m->depth] = bad;
+		for (long k = 0; k < m->n_indicators; k++) {
+			struct tsp_ms_indicator *ind = &m->indicators[k];
+			// Row of the value leaving the window, still zero while the window fills
+			long row = (slot - ind->length % m->depth + m->depth) % m->depth;
+			tsp_ms_step(m, ind, x, row, out + (s * m->n_indicators + k) * n);
+		}
+		memcpy(m->ring + slot * n, x, n * sizeof(double));
+		memcpy(m->clean + slot * n, x_clean, n * sizeof(double));
+		m->row_bad[slot] = bad;
+	}
+}
@@ -0,0 +1,63 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef MULTISERIES_H
+#define MULTISERIES_H
+
+/* Per-series state of one indicator, every array holds one value per series */
+struct tsp_ms_indicator {
+	int kind;     // Kind of the indicator (TSP_MS_*)
+	long length;  // Period of the indicator
+	double *sum;  // Running sum of the window (SMA, WMA, EMA warm-up)
+	double *num;  // Weighted sum of the window (WMA)
+	double *ema;  // Smoothed value (EMA, RMA)
+	long *bad;    // Non-finite values in the window, left out of sum and num (SMA, WMA)
+	long bad_all; // Non-finite values in the windows of all series
+	double decay; // Weight of the zero the RMA started from, (1 - 1 / length)^steps
+};
+
+/*
+ * Indicators of many series advanced together, one timestamp at a time
+ *
+ * State is kept as structure of arrays: for every indicator one array per state
+ * variable, indexed by series, so a timestamp is a handful of loops over contiguous
+ * arrays that the vector kernels (tsp_kernel_ma, tsp_kernel_ema) process with SIMD.
+ * The windows of SMA and WMA share one ring of the last values of all series, a row
+ * per timestamp, as deep as the longest window. Their running sums only hold the finite
+ * values of the window, non-finite ones are counted; while a window holds any of them,
+ * the indicator of that series is recomputed from the ring. Once every length timestamps
+ * the running sums are re-summed from the ring, so rounding errors of the updates don't
+ * accumulate over long runs.
+ */
+struct tsp_multiseries {
+	long n_series;
+	long n_indicators;
+	struct tsp_ms_indicator *indicators;
+	long depth;    // Rows of the ring, the longest window
+	double *ring;  // Row t % depth holds the values of all series at timestamp t
+	double *clean; // Rows of ring with non-finite values replaced by zeros, then the entering row
+	long *row_bad; // Non-finite values of every row of clean
+	long steps;    // Timestamps processed
+};
+
+TSP_API_START
+/*
+ * Kinds of indicators, matching the single-series handlers on data without missing values
+ *
+ * TSP_MS_SMA - simple moving average of length values
+ * TSP_MS_EMA - exponential moving average, alpha = 2 / (length + 1), seeded with the SMA of the first length values
+ * TSP_MS_RMA - Wilder's moving average, bias-corrected EMA with alpha = 1 / length
+ * TSP_MS_WMA - linearly weighted moving average, the newest value has weight length
+ */
+#define TSP_MS_SMA 0
+#define TSP_MS_EMA 1
+#define TSP_MS_RMA 2
+#define TSP_MS_WMA 3
+
+struct tsp_multiseries;
+
+struct tsp_multiseries *tsp_multiseries_init(long n_series, long n_indicators, const int *kinds, const long *lengths);
+void tsp_free_multiseries(struct tsp_multiseries *m);
+void tsp_multiseries_reset(struct tsp_multiseries *m);
+void tsp_multiseries_process(struct tsp_multiseries *m, const double *values, long n_steps, double *out);
+TSP_API_END
+#endif /* MULTISERIES_H */
@@ -0,0 +1,145 @@
+#include "parse.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Powers of ten that are exactly representable as double
+static const double tsp_pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+				   1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+				   1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/* Longest number text copied to the stack for strtod, longer ones go to the heap */
+#define TSP_PARSE_MAX_TEXT 64
+
+/* Slow path: copy the number into a NUL-terminated buffer and use strtod */
+static double tsp_parse_slow(const char *start, const char *end, const char **next) {
+	char local[TSP_PARSE_MAX_TEXT + 1];
+	size_t len = (size_t)(end - start);
+	char *text = local;
+	if (len > TSP_PARSE_MAX_TEXT) {
+		text = malloc(len + 1);
+		if (text == NULL) {
+			*next = start;
+			return NAN;
+		}
+	}
+	memcpy(text, start, len);
+	text[len] = '\0';
+	char *stop = NULL;
+	double value = strtod(text, &stop);
+	*next = start + (stop - text);
+	if (stop == text) {
+		value = NAN;
+	}
+	if (text != local) {
+		free(text);
+	}
+	return value;
+}
+
+/* Matches case-insensitive word at p, returns its length or 0 */
+static size_t tsp_parse_word(const char *p, const char *end, const char *word) {
+	size_t len = strlen(word);
+	if ((size_t)(end - p) >= len && strncasecmp(p, word, len) == 0) {
+		return len;
+	}
+	return 0;
+}
+
+double tsp_parse_double(const char *p, const char *end, const char **next) {
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		p++;
+	}
+	const char *start = p;
+	*next = start;
+
+	int negative = 0;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	// Special values
+	if (p < end && (*p == 'n' || *p == 'N' || *p == 'i' || *p == 'I')) {
+		size_t len = tsp_parse_word(p, end, "nan");
+		if (len != 0) {
+			*next = p + len;
+			return NAN;
+		}
+		len = tsp_parse_word(p, end, "infinity");
+		if (len == 0) {
+			len = tsp_parse_word(p, end, "inf");
+		}
+		if (len != 0) {
+			*next = p + len;
+			return negative ? -INFINITY : INFINITY;
+		}
+		return NAN;
+	}
+
+	// Mantissa: up to 19 significant digits fit into uint64_t
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	int any_digit = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+			if (mantissa != 0) {
+				digits++;
+			}
+		} else {
+			exponent++;
+		}
+		any_digit = 1;
+		p++;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				if (mantissa != 0) {
+					digits++;
+				}
+				exponent--;
+			}
+			any_digit = 1;
+			p++;
+		}
+	}
+	if (!any_digit) {
+		return NAN;
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char *e = p + 1;
+		int exp_negative = 0;
+		if (e < end && (*e == '-' || *e == '+')) {
+			exp_negative = *e == '-';
+			e++;
+		}
+		if (e < end && *e >= '0' && *e <= '9') {
+			int exp_value = 0;
+			while (e < end && *e >= '0' && *e <= '9') {
+				if (exp_value < 10000) {
+					exp_value = exp_value * 10 + (*e - '0');
+				}
+				e++;
+			}
+			exponent += exp_negative ? -exp_value : exp_value;
+			p = e;
+		}
+	}
+
+	// Clinger's fast path: both mantissa and the power of ten are exact doubles,
+	// so a single multiplication or division is correctly rounded
+	if (digits <= 15 && exponent >= -22 && exponent <= 22) {
+		double value = (double)mantissa;
+		value = exponent < 0 ? value / tsp_pow10[-exponent] : value * tsp_pow10[exponent];
+		*next = p;
+		return negative ? -value : value;
+	}
+	return tsp_parse_slow(start, p, next);
+}
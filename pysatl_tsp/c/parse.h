@@ -0,0 +1,18 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef PARSE_H
+#define PARSE_H
+
+TSP_API_START
+/*
+ * Parses a decimal floating-point number from [p, end)
+ *
+ * Leading spaces and tabs are skipped. Numbers with at most 19 significant digits
+ * and a small decimal exponent are converted exactly without strtod (Clinger's fast
+ * path), other numbers fall back to strtod. "nan", "inf" and "infinity" are accepted
+ * in any case. If no number is found, NaN is returned and *next is set to p.
+ * Otherwise *next points to the first character after the number.
+ */
+double tsp_parse_double(const char *p, const char *end, const char **next);
+TSP_API_END
+#endif /* PARSE_H */
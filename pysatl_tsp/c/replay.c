@@ -0,0 +1,140 @@
+#include "replay.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Monotonic clock, nanoseconds */
+static int64_t tsp_replay_now(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+/* Wait until the monotonic clock reaches due: sleep, then spin for the last spin_ns */
+static void tsp_replay_wait(int64_t due, int64_t spin_ns) {
+	int64_t left = due - tsp_replay_now();
+	if (left > spin_ns) {
+		int64_t sleep = left - spin_ns;
+		struct timespec t = {.tv_sec = sleep / 1000000000, .tv_nsec = sleep % 1000000000};
+		// An interrupted sleep goes on for the time it had left
+		while (nanosleep(&t, &t) != 0 && errno == EINTR) {
+		}
+	}
+	while (tsp_replay_now() < due) {
+	}
+}
+
+/*
+ * Creates a replay of the range selected in reader
+ *
+ * speed: Replay speed factor (1 is real time), 0 serves values as fast as possible
+ * ns_per_unit: Nanoseconds per unit of the recording timestamps
+ * spin_ns: Final part of every wait spent spinning, trades CPU for precision
+ *
+ * return: Pointer to initialized replay, or NULL on failure
+ */
+struct tsp_replay *tsp_replay_init(struct tsp_tsf_reader *reader, double speed, double ns_per_unit,
+				   int64_t spin_ns) {
+	if (speed < 0 || ns_per_unit <= 0 || spin_ns < 0) {
+		fprintf(stderr, "Replay speed, time unit and spin time must not be negative\n");
+		return NULL;
+	}
+	struct tsp_replay *obj = calloc(1, sizeof(struct tsp_replay));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize replay\n");
+		return NULL;
+	}
+	obj->reader = reader;
+	obj->scale = speed > 0 ? ns_per_unit / speed : 0;
+	obj->spin_ns = spin_ns;
+	return obj;
+}
+
+void tsp_free_replay(struct tsp_replay *replay) {
+	free(replay->ts);
+	free(replay);
+}
+
+/* Restart the schedule and the statistics, the next served value is due immediately */
+void tsp_replay_reset(struct tsp_replay *replay) {
+	replay->started = 0;
+	replay->emitted = 0;
+	replay->max_lag = 0;
+	replay->total_lag = 0;
+	replay->last_lag = 0;
+}
+
+/* Lag statistics of the served values, in nanoseconds */
+void tsp_replay_stats(struct tsp_replay *replay, long *emitted, int64_t *max_lag, double *mean_lag,
+		      int64_t *last_lag) {
+	*emitted = replay->emitted;
+	*max_lag = replay->max_lag;
+	*mean_lag = replay->emitted > 0 ? replay->total_lag / replay->emitted : 0;
+	*last_lag = replay->last_lag;
+}
+
+/* Due time of a timestamp */
+static int64_t tsp_replay_due(struct tsp_replay *replay, int64_t ts) {
+	return replay->start + (int64_t)((double)(ts - replay->first) * replay->scale);
+}
+
+/*
+ * Fill function of the replay source handler (see tsp_init_source)
+ * Waits until the next value is due and serves all values due by then
+ */
+int tsp_fill_replay(struct tsp_handler *handler, double **block, int capacity) {
+	struct tsp_replay *replay = (struct tsp_replay *)handler->data;
+	struct tsp_tsf_reader *r = replay->reader;
+	if (r->pos >= r->end) {
+		return 0;
+	}
+	if (replay->scale == 0) {
+		int count = tsp_tsf_next_block(r, block, capacity);
+		replay->emitted += count;
+		return count;
+	}
+
+	long n = r->end - r->pos < capacity ? r->end - r->pos : capacity;
+	if (n > replay->ts_capacity) {
+		int64_t *ts = realloc(replay->ts, sizeof(int64_t) * n);
+		if (ts == NULL) {
+			fprintf(stderr, "Could not allocate memory for replay timestamps\n");
+			return 0;
+		}
+		replay->ts = ts;
+		replay->ts_capacity = (int)n;
+	}
+	n = tsp_tsf_read_timestamps(r, r->pos, n, replay->ts);
+
+	int64_t now = tsp_replay_now();
+	if (!replay->started) {
+		replay->started = 1;
+		replay->first = replay->ts[0];
+		replay->start = now;
+	}
+	int64_t due = tsp_replay_due(replay, replay->ts[0]);
+	if (due > now) {
+		tsp_replay_wait(due, replay->spin_ns);
+		now = tsp_replay_now();
+	}
+
+	// Serve the values that are due, the block never crosses a chunk
+	long due_count = 1;
+	while (due_count < n && tsp_replay_due(replay, replay->ts[due_count]) <= now) {
+		due_count++;
+	}
+	long end = r->end;
+	r->end = r->pos + due_count;
+	int count = tsp_tsf_next_block(r, block, (int)due_count);
+	r->end = end;
+
+	for (int i = 0; i < count; i++) {
+		int64_t lag = now - tsp_replay_due(replay, replay->ts[i]);
+		replay->max_lag = lag > replay->max_lag ? lag : replay->max_lag;
+		replay->total_lag += (double)lag;
+		replay->last_lag = lag;
+	}
+	replay->emitted += count;
+	return count;
+}
@@ -0,0 +1,47 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef REPLAY_H
+#define REPLAY_H
+#include "handler.h"
+#include "tsf.h"
+#include <stdint.h>
+
+/*
+ * Paced replay of a TSF recording
+ *
+ * The replay serves the range selected in the reader (see tsp_tsf_select). With a
+ * positive speed a value is not served before its scheduled wall-clock time:
+ *
+ *   due(ts) = start + (ts - first) * ns_per_unit / speed
+ *
+ * where start is the monotonic time of the first served value and first its
+ * timestamp. The replay sleeps until shortly before the next due time and spins
+ * for the rest, then serves every value that is already due in one block. When the
+ * consumer falls behind, due values pile up and are served in larger blocks, and
+ * the delay of every value behind its due time is recorded as lag.
+ */
+struct tsp_replay {
+	struct tsp_tsf_reader *reader;
+	double scale;	     // Wall-clock nanoseconds per timestamp unit, 0 for no pacing
+	int64_t spin_ns;     // Final part of every wait spent spinning instead of sleeping
+	int started;	     // Whether the first value has been served
+	int64_t first;	     // Timestamp of the first served value
+	int64_t start;	     // Monotonic time of the first served value
+	int64_t *ts;	     // Timestamps of the next block
+	int ts_capacity;     // Allocated timestamps
+	long emitted;	     // Served values
+	int64_t max_lag;     // Largest lag of a served value, nanoseconds
+	double total_lag;    // Sum of lags, nanoseconds
+	int64_t last_lag;    // Lag of the last served value, nanoseconds
+};
+
+TSP_API_START
+struct tsp_replay *tsp_replay_init(struct tsp_tsf_reader *reader, double speed, double ns_per_unit,
+				   int64_t spin_ns);
+void tsp_free_replay(struct tsp_replay *replay);
+void tsp_replay_reset(struct tsp_replay *replay);
+void tsp_replay_stats(struct tsp_replay *replay, long *emitted, int64_t *max_lag, double *mean_lag,
+		      int64_t *last_lag);
+int tsp_fill_replay(struct tsp_handler *handler, double **block, int capacity);
+TSP_API_END
+#endif /* REPLAY_H */
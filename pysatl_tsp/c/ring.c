@@ -0,0 +1,215 @@
+#include "ring.h"
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Spins before the waiting side starts sleeping */
+#define TSP_RING_SPINS 128
+/* Longest sleep of the waiting side, ns */
+#define TSP_RING_MAX_SLEEP 1000000
+
+/* Backoff of a waiting side: spin, then sleep for exponentially growing periods */
+struct tsp_ring_wait {
+	int spins;
+	long sleep;
+	double deadline; // Monotonic time to give up, negative for no deadline
+};
+
+static double tsp_ring_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void tsp_ring_wait_init(struct tsp_ring_wait *w, double timeout) {
+	w->spins = 0;
+	w->sleep = 1000;
+	w->deadline = timeout < 0 ? -1.0 : tsp_ring_now() + timeout;
+}
+
+/* Wait a little, return -1 if the deadline has passed */
+static int tsp_ring_wait(struct tsp_ring_wait *w) {
+	if (w->deadline >= 0 && tsp_ring_now() >= w->deadline) {
+		return -1;
+	}
+	if (w->spins < TSP_RING_SPINS) {
+		w->spins++;
+		sched_yield();
+		return 0;
+	}
+	struct timespec ts = {0, w->sleep};
+	nanosleep(&ts, NULL);
+	w->sleep = w->sleep * 2 < TSP_RING_MAX_SLEEP ? w->sleep * 2 : TSP_RING_MAX_SLEEP;
+	return 0;
+}
+
+/*
+ * Creates a ring
+ *
+ * capacity: Maximum number of queued messages, rounded up to a power of two
+ * policy: Overflow policy (TSP_RING_*)
+ *
+ * return: Pointer to initialized ring, or NULL on failure
+ */
+struct tsp_ring *tsp_ring_init(long capacity, int policy) {
+	if (capacity < 1 || policy < TSP_RING_BLOCK || policy > TSP_RING_CONFLATE) {
+		fprintf(stderr, "Invalid ring capacity %ld or policy %d\n", capacity, policy);
+		return NULL;
+	}
+	struct tsp_ring *obj = aligned_alloc(64, sizeof(struct tsp_ring));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize ring\n");
+		return NULL;
+	}
+	uint64_t size = 1;
+	while (size < (uint64_t)capacity) {
+		size <<= 1;
+	}
+	obj->slots = calloc(size, sizeof(obj->slots[0]));
+	if (obj->slots == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize ring slots\n");
+		free(obj);
+		return NULL;
+	}
+	atomic_init(&obj->head, 0);
+	atomic_init(&obj->tail, 0);
+	atomic_init(&obj->closed, 0);
+	atomic_init(&obj->dropped, 0);
+	obj->capacity = size;
+	obj->mask = size - 1;
+	obj->policy = policy;
+	return obj;
+}
+
+/* Free the ring and all queued messages, both sides must be done with it */
+void tsp_free_ring(struct tsp_ring *ring) {
+	uint64_t tail = atomic_load(&ring->tail);
+	for (uint64_t i = atomic_load(&ring->head); i < tail; i++) {
+		free(atomic_load_explicit(&ring->slots[i & ring->mask], memory_order_relaxed));
+	}
+	free(ring->slots);
+	free(ring);
+}
+
+/* Wake up and fail blocked and future push/pop calls */
+void tsp_ring_close(struct tsp_ring *ring) { atomic_store(&ring->closed, 1); }
+
+/*
+ * Claims up to max messages starting at head, writes them to out
+ * Used by the consumer and by the producer to drop messages
+ *
+ * return: Number of claimed messages
+ */
+static int tsp_ring_claim(struct tsp_ring *ring, struct tsp_ring_msg **out, uint64_t max) {
+	uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	for (;;) {
+		uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+		uint64_t count = tail - head < max ? tail - head : max;
+		if (count == 0) {
+			return 0;
+		}
+		for (uint64_t i = 0; i < count; i++) {
+			out[i] = atomic_load_explicit(&ring->slots[(head + i) & ring->mask],
+						      memory_order_relaxed);
+		}
+		// On failure head is reloaded, the other side took some of these messages
+		if (atomic_compare_exchange_weak_explicit(&ring->head, &head, head + count,
+							  memory_order_acq_rel, memory_order_acquire)) {
+			return (int)count;
+		}
+	}
+}
+
+/* Drop up to max oldest messages, producer side */
+static void tsp_ring_drop(struct tsp_ring *ring, uint64_t max) {
+	struct tsp_ring_msg *dropped[64];
+	while (max > 0) {
+		int count = tsp_ring_claim(ring, dropped, max < 64 ? max : 64);
+		if (count == 0) {
+			return;
+		}
+		for (int i = 0; i < count; i++) {
+			free(dropped[i]);
+		}
+		atomic_fetch_add_explicit(&ring->dropped, count, memory_order_relaxed);
+		max -= count;
+	}
+}
+
+/*
+ * Copies a message into the ring, producer side
+ * With TSP_RING_BLOCK waits until there is free space
+ *
+ * return: 0 on success, -1 if the ring is closed or memory is exhausted
+ */
+int tsp_ring_push(struct tsp_ring *ring, const char *data, size_t len) {
+	if (atomic_load_explicit(&ring->closed, memory_order_relaxed)) {
+		return -1;
+	}
+	struct tsp_ring_msg *msg = malloc(sizeof(struct tsp_ring_msg) + len + 1);
+	if (msg == NULL) {
+		fprintf(stderr, "Could not allocate memory for ring message\n");
+		return -1;
+	}
+	msg->len = len;
+	memcpy(msg->data, data, len);
+	msg->data[len] = '\0';
+
+	uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	struct tsp_ring_wait wait;
+	tsp_ring_wait_init(&wait, -1.0);
+	while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) >= ring->capacity) {
+		if (atomic_load_explicit(&ring->closed, memory_order_relaxed)) {
+			free(msg);
+			return -1;
+		}
+		if (ring->policy == TSP_RING_DROP_OLDEST) {
+			tsp_ring_drop(ring, 1);
+		} else if (ring->policy == TSP_RING_CONFLATE) {
+			tsp_ring_drop(ring, ring->capacity);
+		} else {
+			tsp_ring_wait(&wait);
+		}
+	}
+	atomic_store_explicit(&ring->slots[tail & ring->mask], msg, memory_order_relaxed);
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return 0;
+}
+
+/*
+ * Takes up to max messages, consumer side
+ * Waits for at least one message for timeout seconds (negative - without limit)
+ * The messages belong to the caller and are freed with tsp_ring_free_msg
+ *
+ * return: Number of messages, 0 on timeout, -1 if the ring is closed and empty
+ */
+int tsp_ring_pop_batch(struct tsp_ring *ring, struct tsp_ring_msg **out, int max, double timeout) {
+	struct tsp_ring_wait wait;
+	tsp_ring_wait_init(&wait, timeout);
+	for (;;) {
+		int count = tsp_ring_claim(ring, out, (uint64_t)max);
+		if (count > 0) {
+			return count;
+		}
+		if (atomic_load_explicit(&ring->closed, memory_order_relaxed)) {
+			return -1;
+		}
+		if (tsp_ring_wait(&wait) != 0) {
+			return 0;
+		}
+	}
+}
+
+void tsp_ring_free_msg(struct tsp_ring_msg *msg) { free(msg); }
+
+/* Number of queued messages */
+long tsp_ring_size(struct tsp_ring *ring) {
+	uint64_t head = atomic_load(&ring->head);
+	return (long)(atomic_load(&ring->tail) - head);
+}
+
+/* Number of messages dropped by the overflow policy */
+long tsp_ring_dropped(struct tsp_ring *ring) { return (long)atomic_load(&ring->dropped); }
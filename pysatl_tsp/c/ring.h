@@ -0,0 +1,57 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef RING_H
+#define RING_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Bounded lock-free single-producer/single-consumer ring of messages
+ *
+ * head and tail only grow (64 bits never wrap in practice), slot i is i & mask.
+ * The producer publishes a slot by advancing tail (release), the consumer claims
+ * slots by a CAS on head after reading their pointers. The producer may claim the
+ * oldest slots the same way to drop them on overflow, so a slot is owned by whoever
+ * wins the CAS and the loser never dereferences the pointer it has read.
+ */
+struct tsp_ring {
+	_Alignas(64) _Atomic uint64_t head; // Next slot to consume
+	_Alignas(64) _Atomic uint64_t tail; // Next slot to produce
+	_Alignas(64) uint64_t capacity;	    // Number of slots, a power of two
+	uint64_t mask;			    // capacity - 1
+	int policy;			    // Overflow policy (TSP_RING_*)
+	_Atomic int closed;		    // Set by tsp_ring_close, wakes blocked calls
+	_Atomic uint64_t dropped;	    // Messages dropped by the overflow policy
+	struct tsp_ring_msg *_Atomic *slots;
+};
+
+TSP_API_START
+/*
+ * Overflow policies of tsp_ring
+ *
+ * TSP_RING_BLOCK       - the producer waits for free space (backpressure)
+ * TSP_RING_DROP_OLDEST - the oldest message is dropped to make room
+ * TSP_RING_CONFLATE    - the whole backlog is dropped, the consumer sees the newest message
+ */
+#define TSP_RING_BLOCK 0
+#define TSP_RING_DROP_OLDEST 1
+#define TSP_RING_CONFLATE 2
+
+/* Message copied into the ring, data is NUL-terminated */
+struct tsp_ring_msg {
+	size_t len;
+	char data[];
+};
+
+struct tsp_ring;
+
+struct tsp_ring *tsp_ring_init(long capacity, int policy);
+void tsp_free_ring(struct tsp_ring *ring);
+void tsp_ring_close(struct tsp_ring *ring);
+int tsp_ring_push(struct tsp_ring *ring, const char *data, size_t len);
+int tsp_ring_pop_batch(struct tsp_ring *ring, struct tsp_ring_msg **out, int max, double timeout);
+void tsp_ring_free_msg(struct tsp_ring_msg *msg);
+long tsp_ring_size(struct tsp_ring *ring);
+long tsp_ring_dropped(struct tsp_ring *ring);
+TSP_API_END
+#endif /* RING_H */
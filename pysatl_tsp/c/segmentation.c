@@ -0,0 +1,107 @@
+#include "segmentation.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Creates a segmentation rule
+ *
+ * kind: Kind of the rule (TSP_SEG_*)
+ * threshold: Detection threshold (segment size for TSP_SEG_MAX_SIZE)
+ * param: Drift of CUSUM or tolerance of Page-Hinkley, ignored by other rules
+ * max_size: Segment size that ends the segment regardless of the rule
+ *
+ * return: Pointer to initialized rule, or NULL on failure
+ */
+struct tsp_segmenter *tsp_segmenter_init(int kind, double threshold, double param, long max_size) {
+	if (kind < TSP_SEG_JUMP || kind > TSP_SEG_MAX_SIZE || max_size < 1) {
+		fprintf(stderr, "Invalid segmentation rule %d or maximum size %ld\n", kind, max_size);
+		return NULL;
+	}
+	struct tsp_segmenter *obj = malloc(sizeof(struct tsp_segmenter));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize segmentation rule\n");
+		return NULL;
+	}
+	obj->kind = kind;
+	obj->threshold = threshold;
+	obj->param = param;
+	obj->max_size = max_size;
+	tsp_segmenter_reset(obj);
+	return obj;
+}
+
+void tsp_free_segmenter(struct tsp_segmenter *s) { free(s); }
+
+/* Start a new segment */
+void tsp_segmenter_reset(struct tsp_segmenter *s) {
+	s->count = 0;
+	s->mean = 0;
+	s->prev = 0;
+	s->pos = s->neg = 0;
+	s->pos_min = s->neg_min = 0;
+}
+
+/* Whether the segment ends with value, the state is updated with it */
+static int tsp_segmenter_check(struct tsp_segmenter *s, double value) {
+	int end = 0;
+	switch (s->kind) {
+	case TSP_SEG_JUMP:
+		end = s->count > 0 && fabs(value - s->prev) > s->threshold;
+		break;
+	case TSP_SEG_CUSUM:
+		if (s->count > 0) {
+			double dev = value - s->mean;
+			s->pos = fmax(0, s->pos + dev - s->param);
+			s->neg = fmax(0, s->neg - dev - s->param);
+			end = s->pos > s->threshold || s->neg > s->threshold;
+		}
+		break;
+	case TSP_SEG_PAGE_HINKLEY: {
+		double mean = s->mean + (value - s->mean) / (s->count + 1);
+		s->pos += value - mean - s->param;
+		s->neg += mean - value - s->param;
+		s->pos_min = fmin(s->pos_min, s->pos);
+		s->neg_min = fmin(s->neg_min, s->neg);
+		end = s->pos - s->pos_min > s->threshold || s->neg - s->neg_min > s->threshold;
+		break;
+	}
+	case TSP_SEG_MAX_SIZE:
+		end = s->count + 1 >= s->threshold;
+		break;
+	}
+	s->count++;
+	s->mean += (value - s->mean) / s->count;
+	s->prev = value;
+	return end || s->count >= s->max_size;
+}
+
+/*
+ * Adds a value to the current segment
+ *
+ * return: 1 if the segment ends with the value (the next value starts a new one), 0 otherwise
+ */
+int tsp_segmenter_push(struct tsp_segmenter *s, double value) {
+	if (tsp_segmenter_check(s, value)) {
+		tsp_segmenter_reset(s);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Segments n values continuing the current segment
+ *
+ * ends: Room for n offsets, receives the offsets of values that end a segment
+ *
+ * return: Number of ended segments
+ */
+long tsp_segmenter_process(struct tsp_segmenter *s, const double *values, long n, long *ends) {
+	long count = 0;
+	for (long i = 0; i < n; i++) {
+		if (tsp_segmenter_push(s, values[i])) {
+			ends[count++] = i;
+		}
+	}
+	return count;
+}
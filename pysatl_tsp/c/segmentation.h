@@ -0,0 +1,50 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef SEGMENTATION_H
+#define SEGMENTATION_H
+
+/*
+ * Online segmentation rule
+ *
+ * Values of the current segment are pushed one by one, the rule decides after every
+ * value whether the segment ends with it. The rule then starts over for the next segment.
+ */
+struct tsp_segmenter {
+	int kind;	  // Kind of the rule (TSP_SEG_*)
+	double threshold; // Detection threshold
+	double param;	  // Drift of CUSUM, tolerance (delta) of Page-Hinkley
+	long max_size;	  // Segment size that ends the segment regardless of the rule
+	long count;	  // Values in the current segment
+	double mean;	  // Mean of the values in the current segment
+	double prev;	  // Last value of the current segment
+	double pos;	  // CUSUM: upper statistic; Page-Hinkley: cumulative upward deviation
+	double neg;	  // CUSUM: lower statistic; Page-Hinkley: cumulative downward deviation
+	double pos_min;	  // Page-Hinkley: minimum of pos
+	double neg_min;	  // Page-Hinkley: minimum of neg
+};
+
+TSP_API_START
+/*
+ * Kinds of segmentation rules, the segment ends with a value x when
+ *
+ * TSP_SEG_JUMP         - |x - previous value| > threshold
+ * TSP_SEG_CUSUM        - a two-sided CUSUM of deviations from the segment mean, less the
+ *                        drift, exceeds threshold
+ * TSP_SEG_PAGE_HINKLEY - the two-sided Page-Hinkley statistic with tolerance delta
+ *                        exceeds threshold
+ * TSP_SEG_MAX_SIZE     - the segment holds threshold values
+ */
+#define TSP_SEG_JUMP 0
+#define TSP_SEG_CUSUM 1
+#define TSP_SEG_PAGE_HINKLEY 2
+#define TSP_SEG_MAX_SIZE 3
+
+struct tsp_segmenter;
+
+struct tsp_segmenter *tsp_segmenter_init(int kind, double threshold, double param, long max_size);
+void tsp_free_segmenter(struct tsp_segmenter *s);
+void tsp_segmenter_reset(struct tsp_segmenter *s);
+int tsp_segmenter_push(struct tsp_segmenter *s, double value);
+long tsp_segmenter_process(struct tsp_segmenter *s, const double *values, long n, long *ends);
+TSP_API_END
+#endif /* SEGMENTATION_H */
@@ -0,0 +1,118 @@
+#include "spill.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Smallest capacity of a spill buffer, 1 MiB */
+#define TSP_SPILL_MIN_CAPACITY 131072
+
+/* Resize the file and map it again with room for capacity values */
+static int tsp_spill_reserve(struct tsp_spill *s, long capacity) {
+	if (capacity <= s->capacity) {
+		return 0;
+	}
+	long grown = s->capacity > 0 ? s->capacity : TSP_SPILL_MIN_CAPACITY;
+	while (grown < capacity) {
+		grown *= 2;
+	}
+	if (ftruncate(s->fd, (off_t)grown * sizeof(double)) != 0) {
+		return -1;
+	}
+	void *map = mmap(NULL, grown * sizeof(double), PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, 0);
+	if (map == MAP_FAILED) {
+		return -1;
+	}
+	if (s->data != NULL) {
+		munmap(s->data, s->capacity * sizeof(double));
+	}
+	s->data = map;
+	s->capacity = grown;
+	return 0;
+}
+
+/*
+ * Creates an empty spill buffer
+ *
+ * dir: Directory of the temporary file
+ * capacity: Expected number of values, 0 if unknown, the buffer grows by doubling
+ *
+ * return: Pointer to initialized buffer, or NULL on failure
+ */
+struct tsp_spill *tsp_spill_open(const char *dir, long capacity) {
+	struct tsp_spill *obj = calloc(1, sizeof(struct tsp_spill));
+	size_t len = strlen(dir) + sizeof("/tsp-spill-XXXXXX");
+	char *path = malloc(len);
+	if (obj == NULL || path == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize spill buffer\n");
+		free(obj);
+		free(path);
+		return NULL;
+	}
+	snprintf(path, len, "%s/tsp-spill-XXXXXX", dir);
+	obj->fd = mkstemp(path);
+	if (obj->fd < 0) {
+		fprintf(stderr, "Could not create spill file in %s\n", dir);
+		free(obj);
+		free(path);
+		return NULL;
+	}
+	unlink(path);
+	free(path);
+	if (tsp_spill_reserve(obj, capacity > 0 ? capacity : 1) != 0) {
+		fprintf(stderr, "Could not map spill file\n");
+		tsp_spill_close(obj);
+		return NULL;
+	}
+	return obj;
+}
+
+/* Unmap and delete the file, free the buffer */
+void tsp_spill_close(struct tsp_spill *s) {
+	if (s->data != NULL) {
+		munmap(s->data, s->capacity * sizeof(double));
+	}
+	close(s->fd);
+	free(s);
+}
+
+/*
+ * Appends n values
+ *
+ * return: 0 on success, -1 if the file cannot grow
+ */
+int tsp_spill_append(struct tsp_spill *s, const double *values, long n) {
+	if (tsp_spill_reserve(s, s->size + n) != 0) {
+		fprintf(stderr, "Could not grow spill file\n");
+		return -1;
+	}
+	memcpy(s->data + s->size, values, n * sizeof(double));
+	s->size += n;
+	return 0;
+}
+
+/* Grows the buffer by n values for tsp_drain_into */
+static double *tsp_spill_reserve_tail(void *sink, long n) {
+	struct tsp_spill *s = sink;
+	if (tsp_spill_reserve(s, s->size + n) != 0) {
+		fprintf(stderr, "Could not grow spill file\n");
+		return NULL;
+	}
+	s->size += n;
+	return s->data + s->size - n;
+}
+
+/*
+ * Runs a native chain to completion and appends its results
+ * Missing values (inf, None in Python) are stored as NaN
+ *
+ * return: Number of appended values, or -1 if the file cannot grow
+ */
+long tsp_spill_drain(struct tsp_spill *s, struct tsp_handler *handler) {
+	return tsp_drain_into(handler, tsp_spill_reserve_tail, s);
+}
+
+double *tsp_spill_data(struct tsp_spill *s) { return s->data; }
+
+long tsp_spill_size(struct tsp_spill *s) { return s->size; }
@@ -0,0 +1,33 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef SPILL_H
+#define SPILL_H
+#include "handler.h"
+#include <stddef.h>
+
+/*
+ * Growable array of doubles backed by a memory-mapped temporary file
+ *
+ * The file is unlinked as soon as it is created, its pages are written back to disk
+ * under memory pressure instead of taking RAM, and the space is freed when the buffer
+ * is closed. The mapping is replaced when the buffer grows, pointers to the data are
+ * valid until the next append.
+ */
+struct tsp_spill {
+	int fd;
+	double *data;
+	long size;     // Values in the buffer
+	long capacity; // Values the file and the mapping hold
+};
+
+TSP_API_START
+struct tsp_spill;
+
+struct tsp_spill *tsp_spill_open(const char *dir, long capacity);
+void tsp_spill_close(struct tsp_spill *s);
+int tsp_spill_append(struct tsp_spill *s, const double *values, long n);
+long tsp_spill_drain(struct tsp_spill *s, struct tsp_handler *handler);
+double *tsp_spill_data(struct tsp_spill *s);
+long tsp_spill_size(struct tsp_spill *s);
+TSP_API_END
+#endif /* SPILL_H */
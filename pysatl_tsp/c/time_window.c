@@ -0,0 +1,293 @@
+#include "time_window.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TSP_TW_INITIAL_CAPACITY 64
+
+/* Add x to the compensated sum */
+static void tsp_tw_add(struct tsp_time_window *w, double x) {
+	double t = w->sum + x;
+	if (fabs(w->sum) >= fabs(x)) {
+		w->sum_comp += (w->sum - t) + x;
+	} else {
+		w->sum_comp += (x - t) + w->sum;
+	}
+	w->sum = t;
+}
+
+/*
+ * Add x to the sum (sign 1) or remove it (sign -1)
+ * Non-finite values are only counted, so they don't stay in the sum after leaving the window
+ */
+static void tsp_tw_update(struct tsp_time_window *w, double x, int sign) {
+	if (isnan(x)) {
+		w->nan_count += sign;
+	} else if (isinf(x)) {
+		if (x > 0) {
+			w->pinf_count += sign;
+		} else {
+			w->ninf_count += sign;
+		}
+	} else {
+		tsp_tw_add(w, sign * x);
+	}
+}
+
+/* Sum of the window, non-finite values give what a plain sum of the window would */
+static double tsp_tw_sum(const struct tsp_time_window *w) {
+	if (w->nan_count > 0 || (w->pinf_count > 0 && w->ninf_count > 0)) {
+		return NAN;
+	}
+	if (w->pinf_count > 0) {
+		return INFINITY;
+	}
+	if (w->ninf_count > 0) {
+		return -INFINITY;
+	}
+	return w->sum + w->sum_comp;
+}
+
+/* Forget the sum of an emptied window */
+static void tsp_tw_clear_sum(struct tsp_time_window *w) {
+	w->sum = w->sum_comp = 0;
+	w->nan_count = w->pinf_count = w->ninf_count = 0;
+}
+
+/* Start of the bucket holding ts, rounded towards minus infinity */
+static int64_t tsp_tw_bucket(const struct tsp_time_window *w, int64_t ts) {
+	int64_t offset = ts - w->origin;
+	int64_t k = offset / w->duration;
+	if (offset % w->duration < 0) {
+		k--;
+	}
+	return w->origin + k * w->duration;
+}
+
+/* Copy the ring of positions src of capacity old slots into a ring of capacity slots */
+static uint64_t *tsp_tw_grow_ring(uint64_t *src, uint64_t old, uint64_t head, uint64_t tail,
+				  uint64_t capacity) {
+	uint64_t *dst = malloc(capacity * sizeof(uint64_t));
+	if (dst == NULL) {
+		return NULL;
+	}
+	for (uint64_t i = head; i < tail; i++) {
+		dst[i & (capacity - 1)] = src[i & (old - 1)];
+	}
+	return dst;
+}
+
+/* Double the capacity of the sliding window */
+static int tsp_tw_grow(struct tsp_time_window *w) {
+	uint64_t old = w->capacity, capacity = old * 2;
+	int64_t *ts = malloc(capacity * sizeof(int64_t));
+	double *values = malloc(capacity * sizeof(double));
+	uint64_t *min_pos = tsp_tw_grow_ring(w->min_pos, old, w->min_head, w->min_tail, capacity);
+	uint64_t *max_pos = tsp_tw_grow_ring(w->max_pos, old, w->max_head, w->max_tail, capacity);
+	if (ts == NULL || values == NULL || min_pos == NULL || max_pos == NULL) {
+		free(ts);
+		free(values);
+		free(min_pos);
+		free(max_pos);
+		return -1;
+	}
+	for (uint64_t i = w->head; i < w->tail; i++) {
+		ts[i & (capacity - 1)] = w->ts[i & (old - 1)];
+		values[i & (capacity - 1)] = w->values[i & (old - 1)];
+	}
+	free(w->ts);
+	free(w->values);
+	free(w->min_pos);
+	free(w->max_pos);
+	w->ts = ts;
+	w->values = values;
+	w->min_pos = min_pos;
+	w->max_pos = max_pos;
+	w->capacity = capacity;
+	return 0;
+}
+
+/*
+ * Creates an empty event-time window
+ *
+ * mode: Window mode (TSP_TW_*)
+ * duration: Length of the window in timestamp units
+ * origin: Timestamp the tumbling buckets are aligned to
+ *
+ * return: Pointer to initialized window, or NULL on failure
+ */
+struct tsp_time_window *tsp_time_window_init(int mode, int64_t duration, int64_t origin) {
+	if ((mode != TSP_TW_SLIDING && mode != TSP_TW_TUMBLING) || duration < 1) {
+		fprintf(stderr, "Invalid time window mode %d or duration %lld\n", mode, (long long)duration);
+		return NULL;
+	}
+	struct tsp_time_window *obj = calloc(1, sizeof(struct tsp_time_window));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize time window\n");
+		return NULL;
+	}
+	obj->mode = mode;
+	obj->duration = duration;
+	obj->origin = origin;
+	if (mode == TSP_TW_SLIDING) {
+		obj->capacity = TSP_TW_INITIAL_CAPACITY;
+		obj->ts = malloc(obj->capacity * sizeof(int64_t));
+		obj->values = malloc(obj->capacity * sizeof(double));
+		obj->min_pos = malloc(obj->capacity * sizeof(uint64_t));
+		obj->max_pos = malloc(obj->capacity * sizeof(uint64_t));
+		if (obj->ts == NULL || obj->values == NULL || obj->min_pos == NULL || obj->max_pos == NULL) {
+			fprintf(stderr, "Could not allocate memory to initialize time window\n");
+			tsp_free_time_window(obj);
+			return NULL;
+		}
+	}
+	tsp_time_window_reset(obj);
+	return obj;
+}
+
+void tsp_free_time_window(struct tsp_time_window *w) {
+	free(w->ts);
+	free(w->values);
+	free(w->min_pos);
+	free(w->max_pos);
+	free(w);
+}
+
+/* Forget all points */
+void tsp_time_window_reset(struct tsp_time_window *w) {
+	w->head = w->tail = 0;
+	w->min_head = w->min_tail = w->max_head = w->max_tail = 0;
+	w->count = 0;
+	tsp_tw_clear_sum(w);
+	w->started = 0;
+}
+
+/* Aggregates of the open tumbling bucket */
+static void tsp_tw_bucket_agg(const struct tsp_time_window *w, struct tsp_time_agg *out) {
+	out->start = w->bucket;
+	out->end = w->bucket + w->duration;
+	out->count = w->count;
+	out->sum = tsp_tw_sum(w);
+	out->min = w->min;
+	out->max = w->max;
+	out->first = w->first;
+	out->last = w->last;
+}
+
+/* Add a point to the tumbling window, return 1 if the previous bucket was closed into out */
+static int tsp_tw_push_tumbling(struct tsp_time_window *w, int64_t ts, double value, struct tsp_time_agg *out) {
+	int closed = 0;
+	int64_t bucket = tsp_tw_bucket(w, ts);
+	if (w->count > 0 && bucket != w->bucket) {
+		tsp_tw_bucket_agg(w, out);
+		closed = 1;
+		w->count = 0;
+		tsp_tw_clear_sum(w);
+	}
+	if (w->count == 0) {
+		w->bucket = bucket;
+		w->first = w->min = w->max = value;
+	}
+	w->count++;
+	tsp_tw_update(w, value, 1);
+	w->min = value < w->min ? value : w->min;
+	w->max = value > w->max ? value : w->max;
+	w->last = value;
+	return closed;
+}
+
+/* Add a point to the sliding window and write the window ending at it into out */
+static int tsp_tw_push_sliding(struct tsp_time_window *w, int64_t ts, double value, struct tsp_time_agg *out) {
+	uint64_t mask = w->capacity - 1;
+	// Evict points that are duration or more before ts
+	while (w->head < w->tail && w->ts[w->head & mask] <= ts - w->duration) {
+		tsp_tw_update(w, w->values[w->head & mask], -1);
+		w->count--;
+		w->head++;
+	}
+	if (w->count == 0) {
+		tsp_tw_clear_sum(w);
+	}
+	while (w->min_head < w->min_tail && w->min_pos[w->min_head & mask] < w->head) {
+		w->min_head++;
+	}
+	while (w->max_head < w->max_tail && w->max_pos[w->max_head & mask] < w->head) {
+		w->max_head++;
+	}
+	if (w->tail - w->head == w->capacity) {
+		if (tsp_tw_grow(w) != 0) {
+			return -1;
+		}
+		mask = w->capacity - 1;
+	}
+
+	uint64_t pos = w->tail++;
+	w->ts[pos & mask] = ts;
+	w->values[pos & mask] = value;
+	w->count++;
+	tsp_tw_update(w, value, 1);
+	while (w->min_tail > w->min_head && w->values[w->min_pos[(w->min_tail - 1) & mask] & mask] >= value) {
+		w->min_tail--;
+	}
+	w->min_pos[w->min_tail++ & mask] = pos;
+	while (w->max_tail > w->max_head && w->values[w->max_pos[(w->max_tail - 1) & mask] & mask] <= value) {
+		w->max_tail--;
+	}
+	w->max_pos[w->max_tail++ & mask] = pos;
+
+	out->start = ts - w->duration + 1;
+	out->end = ts + 1;
+	out->count = w->count;
+	out->sum = tsp_tw_sum(w);
+	out->min = w->values[w->min_pos[w->min_head & mask] & mask];
+	out->max = w->values[w->max_pos[w->max_head & mask] & mask];
+	out->first = w->values[w->head & mask];
+	out->last = value;
+	return 1;
+}
+
+/*
+ * Adds n points and writes the emitted windows
+ *
+ * ts: n non-decreasing timestamps, continuing the previous call
+ * values: n values
+ * out: Room for n windows
+ *
+ * return: Number of emitted windows, TSP_TW_UNORDERED if timestamps decrease, -1 if memory runs out
+ */
+long tsp_time_window_process(struct tsp_time_window *w, const int64_t *ts, const double *values, long n,
+			     struct tsp_time_agg *out) {
+	long emitted = 0;
+	for (long i = 0; i < n; i++) {
+		if (w->started && ts[i] < w->last_ts) {
+			fprintf(stderr, "Timestamp %lld is before %lld\n", (long long)ts[i], (long long)w->last_ts);
+			return TSP_TW_UNORDERED;
+		}
+		w->started = 1;
+		w->last_ts = ts[i];
+		int res = w->mode == TSP_TW_SLIDING ? tsp_tw_push_sliding(w, ts[i], values[i], out + emitted)
+						     : tsp_tw_push_tumbling(w, ts[i], values[i], out + emitted);
+		if (res < 0) {
+			fprintf(stderr, "Could not allocate memory for time window\n");
+			return -1;
+		}
+		emitted += res;
+	}
+	return emitted;
+}
+
+/*
+ * Closes the open tumbling bucket at the end of the stream
+ *
+ * return: 1 if a window was written into out, 0 otherwise
+ */
+int tsp_time_window_flush(struct tsp_time_window *w, struct tsp_time_agg *out) {
+	if (w->mode != TSP_TW_TUMBLING || w->count == 0) {
+		return 0;
+	}
+	tsp_tw_bucket_agg(w, out);
+	w->count = 0;
+	tsp_tw_clear_sum(w);
+	return 1;
+}
@@ -0,0 +1,77 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef TIME_WINDOW_H
+#define TIME_WINDOW_H
+#include <stdint.h>
+
+/*
+ * Event-time window over (timestamp, value) points with non-decreasing timestamps
+ *
+ * Sliding: after every point at t the window holds the points in (t - duration, t].
+ * Its points are kept in a growable ring, evicted from the front by time, with
+ * monotonic deques of positions for the minimum and the maximum, so every point
+ * is pushed and evicted once: O(1) amortized.
+ * Tumbling: points fall into buckets [k * duration, (k + 1) * duration) + origin,
+ * only the aggregates of the open bucket are kept.
+ */
+struct tsp_time_window {
+	int mode;
+	int64_t duration;
+	int64_t origin;	    // Alignment of tumbling buckets
+	uint64_t capacity;  // Slots of the rings, a power of two
+	uint64_t head;	    // Position of the oldest point in the window
+	uint64_t tail;	    // Position of the next point
+	int64_t *ts;	    // Timestamps by position & (capacity - 1)
+	double *values;	    // Values by position & (capacity - 1)
+	uint64_t *min_pos;  // Positions with increasing values, ring of capacity slots
+	uint64_t *max_pos;  // Positions with decreasing values, ring of capacity slots
+	uint64_t min_head, min_tail, max_head, max_tail;
+	long count;
+	double sum;
+	double sum_comp;    // Low-order bits lost by sum (Neumaier compensation)
+	long nan_count;	    // NaN values in the window, kept out of sum
+	long pinf_count;    // +inf values in the window, kept out of sum
+	long ninf_count;    // -inf values in the window, kept out of sum
+	double min, max;    // Extremes of the open tumbling bucket
+	double first;	    // Oldest value of the open tumbling bucket
+	double last;	    // Newest value of the open tumbling bucket
+	int64_t bucket;	    // Start of the open tumbling bucket
+	int64_t last_ts;    // Timestamp of the last point
+	int started;	    // Whether a point has been pushed
+};
+
+TSP_API_START
+/*
+ * Window modes
+ *
+ * TSP_TW_SLIDING  - one window per point, covering the preceding duration
+ * TSP_TW_TUMBLING - one window per non-empty bucket of duration
+ */
+#define TSP_TW_SLIDING 0
+#define TSP_TW_TUMBLING 1
+
+/* Result of tsp_time_window_process for a decreasing timestamp, -1 is a memory failure */
+#define TSP_TW_UNORDERED -2
+
+/* Aggregates of one emitted window, covering [start, end) */
+struct tsp_time_agg {
+	int64_t start;
+	int64_t end;
+	long count;
+	double sum;
+	double min;
+	double max;
+	double first;
+	double last;
+};
+
+struct tsp_time_window;
+
+struct tsp_time_window *tsp_time_window_init(int mode, int64_t duration, int64_t origin);
+void tsp_free_time_window(struct tsp_time_window *w);
+void tsp_time_window_reset(struct tsp_time_window *w);
+long tsp_time_window_process(struct tsp_time_window *w, const int64_t *ts, const double *values, long n,
+			     struct tsp_time_agg *out);
+int tsp_time_window_flush(struct tsp_time_window *w, struct tsp_time_agg *out);
+TSP_API_END
+#endif /* TIME_WINDOW_H */
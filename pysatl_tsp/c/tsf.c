@@ -0,0 +1,616 @@
+#include "tsf.h"
+#include "kernels.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Round size up to TSP_TSF_ALIGN */
+static uint64_t tsp_tsf_align(uint64_t size) {
+	return (size + TSP_TSF_ALIGN - 1) / TSP_TSF_ALIGN * TSP_TSF_ALIGN;
+}
+
+/* Size of the header with column types and padding */
+static uint64_t tsp_tsf_header_size(int ncolumns) {
+	return tsp_tsf_align(sizeof(struct tsp_tsf_header) + sizeof(uint32_t) * ncolumns);
+}
+
+/* Write size bytes and pad them with zeros up to TSP_TSF_ALIGN */
+static int tsp_tsf_write_aligned(struct tsp_tsf_writer *w, const void *data, uint64_t size) {
+	static const char zeros[TSP_TSF_ALIGN] = {0};
+	uint64_t padded = tsp_tsf_align(size);
+	if (fwrite(data, 1, size, w->file) != size ||
+	    fwrite(zeros, 1, padded - size, w->file) != padded - size) {
+		return -1;
+	}
+	w->offset += padded;
+	return 0;
+}
+
+/* Min and max of n values ignoring NaN, both are NaN if all values are NaN */
+static void tsp_tsf_minmax(const double *x, long n, double *min, double *max) {
+	// A NaN sum means NaN (or opposite infinities) inside, take the slow path only then
+	if (!isnan(tsp_kernel_sum(x, n))) {
+		tsp_kernel_minmax(x, n, min, max);
+		return;
+	}
+	double mn = NAN, mx = NAN;
+	for (long i = 0; i < n; i++) {
+		if (!isnan(x[i])) {
+			mn = isnan(mn) || x[i] < mn ? x[i] : mn;
+			mx = isnan(mx) || x[i] > mx ? x[i] : mx;
+		}
+	}
+	*min = mn;
+	*max = mx;
+}
+
+/* Min and max of n int64 values, converted to double for the stats */
+static void tsp_tsf_minmax_int64(const int64_t *x, long n, double *min, double *max) {
+	int64_t mn = x[0], mx = x[0];
+	for (long i = 1; i < n; i++) {
+		mn = x[i] < mn ? x[i] : mn;
+		mx = x[i] > mx ? x[i] : mx;
+	}
+	*min = (double)mn;
+	*max = (double)mx;
+}
+
+/* Write the pending chunk and add it to the index */
+static int tsp_tsf_flush_chunk(struct tsp_tsf_writer *w) {
+	if (w->rows == 0) {
+		return 0;
+	}
+	if (w->nchunks == w->index_capacity) {
+		long capacity = w->index_capacity * 2;
+		struct tsp_tsf_chunk *index = realloc(w->index, sizeof(index[0]) * capacity);
+		if (index == NULL) {
+			return -1;
+		}
+		w->index = index;
+		double *stats = realloc(w->stats, sizeof(stats[0]) * 2 * w->ncolumns * capacity);
+		if (stats == NULL) {
+			return -1;
+		}
+		w->stats = stats;
+		w->index_capacity = capacity;
+	}
+
+	struct tsp_tsf_chunk *chunk = &w->index[w->nchunks];
+	chunk->offset = w->offset;
+	chunk->rows = w->rows;
+	chunk->first = w->ts[0];
+	chunk->last = w->ts[w->rows - 1];
+	if (tsp_tsf_write_aligned(w, w->ts, sizeof(int64_t) * w->rows) != 0) {
+		return -1;
+	}
+
+	double *stats = &w->stats[2 * w->ncolumns * w->nchunks];
+	for (int j = 0; j < w->ncolumns; j++) {
+		uint64_t *column = &w->values[(long)j * w->chunk_rows];
+		if (w->types[j] == TSP_TSF_INT64) {
+			tsp_tsf_minmax_int64((const int64_t *)column, w->rows, &stats[2 * j],
+					     &stats[2 * j + 1]);
+		} else {
+			tsp_tsf_minmax((const double *)column, w->rows, &stats[2 * j], &stats[2 * j + 1]);
+		}
+		if (tsp_tsf_write_aligned(w, column, sizeof(uint64_t) * w->rows) != 0) {
+			return -1;
+		}
+	}
+	w->nchunks++;
+	w->rows = 0;
+	return 0;
+}
+
+/* Free writer memory without writing anything */
+static void tsp_tsf_writer_free(struct tsp_tsf_writer *w) {
+	free(w->types);
+	free(w->ts);
+	free(w->values);
+	free(w->index);
+	free(w->stats);
+	free(w);
+}
+
+/*
+ * Creates a TSF file for writing
+ *
+ * path: Path to the file, an existing file is truncated
+ * ncolumns: Number of value columns
+ * types: Column types (TSP_TSF_FLOAT64 or TSP_TSF_INT64)
+ * chunk_rows: Rows per chunk
+ *
+ * return: Pointer to initialized writer, or NULL on failure
+ */
+struct tsp_tsf_writer *tsp_tsf_writer_open(const char *path, int ncolumns, const int *types,
+					   int chunk_rows) {
+	if (ncolumns < 1 || chunk_rows < 1) {
+		fprintf(stderr, "TSF file needs at least one column and one row per chunk\n");
+		return NULL;
+	}
+	struct tsp_tsf_writer *obj = calloc(1, sizeof(struct tsp_tsf_writer));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize tsf writer\n");
+		return NULL;
+	}
+	obj->ncolumns = ncolumns;
+	obj->chunk_rows = chunk_rows;
+	obj->index_capacity = 16;
+	obj->last = INT64_MIN;
+	obj->types = malloc(sizeof(obj->types[0]) * ncolumns);
+	obj->ts = malloc(sizeof(obj->ts[0]) * chunk_rows);
+	obj->values = malloc(sizeof(obj->values[0]) * ncolumns * (size_t)chunk_rows);
+	obj->index = malloc(sizeof(obj->index[0]) * obj->index_capacity);
+	obj->stats = malloc(sizeof(obj->stats[0]) * 2 * ncolumns * obj->index_capacity);
+	if (obj->types == NULL || obj->ts == NULL || obj->values == NULL || obj->index == NULL ||
+	    obj->stats == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize tsf writer\n");
+		tsp_tsf_writer_free(obj);
+		return NULL;
+	}
+	for (int j = 0; j < ncolumns; j++) {
+		if (types[j] != TSP_TSF_FLOAT64 && types[j] != TSP_TSF_INT64) {
+			fprintf(stderr, "Unknown tsf column type %d\n", types[j]);
+			tsp_tsf_writer_free(obj);
+			return NULL;
+		}
+		obj->types[j] = types[j];
+	}
+
+	obj->file = fopen(path, "wb");
+	if (obj->file == NULL) {
+		fprintf(stderr, "Could not open file %s\n", path);
+		tsp_tsf_writer_free(obj);
+		return NULL;
+	}
+	char header[sizeof(struct tsp_tsf_header) + sizeof(uint32_t) * ncolumns];
+	struct tsp_tsf_header h = {.ncolumns = ncolumns, .chunk_rows = chunk_rows};
+	memcpy(h.magic, TSP_TSF_MAGIC, sizeof(h.magic));
+	memcpy(header, &h, sizeof(h));
+	memcpy(header + sizeof(h), obj->types, sizeof(uint32_t) * ncolumns);
+	if (tsp_tsf_write_aligned(obj, header, sizeof(header)) != 0) {
+		fprintf(stderr, "Could not write file %s\n", path);
+		fclose(obj->file);
+		tsp_tsf_writer_free(obj);
+		return NULL;
+	}
+	return obj;
+}
+
+/*
+ * Appends the timestamp of a row whose values are already in the pending chunk
+ *
+ * return: 0 on success, -1 on failure (decreasing timestamp or I/O error)
+ */
+static int tsp_tsf_commit_row(struct tsp_tsf_writer *w, int64_t ts) {
+	if (ts < w->last) {
+		fprintf(stderr, "TSF timestamps must be non-decreasing\n");
+		return -1;
+	}
+	w->last = ts;
+	w->ts[w->rows] = ts;
+	if (++w->rows == w->chunk_rows && tsp_tsf_flush_chunk(w) != 0) {
+		fprintf(stderr, "Could not write tsf chunk\n");
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Stores a value of a double column or an int64 column in the pending chunk
+ * Values of int64 columns are truncated, NaN, inf and values beyond the int64 range are rejected
+ *
+ * return: 0 on success, TSP_TSF_UNREPRESENTABLE if an int64 column cannot hold the value
+ */
+static int tsp_tsf_store_double(struct tsp_tsf_writer *w, int column, double value) {
+	uint64_t *slot = &w->values[(long)column * w->chunk_rows + w->rows];
+	if (w->types[column] == TSP_TSF_INT64) {
+		// -2^63 is exact in double, 2^63 is the first value past INT64_MAX
+		if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0)) {
+			fprintf(stderr, "Value %g cannot be stored in int64 column %d\n", value, column);
+			return TSP_TSF_UNREPRESENTABLE;
+		}
+		int64_t converted = (int64_t)value;
+		memcpy(slot, &converted, sizeof(*slot));
+	} else {
+		memcpy(slot, &value, sizeof(*slot));
+	}
+	return 0;
+}
+
+/*
+ * Appends n rows of double values
+ *
+ * ts: n non-decreasing timestamps
+ * values: n rows of ncolumns values (row-major), int64 columns are truncated
+ *
+ * return: 0 on success, TSP_TSF_UNREPRESENTABLE if an int64 column cannot hold a value,
+ *         -1 on other failures (decreasing timestamp or I/O error)
+ */
+int tsp_tsf_write_rows(struct tsp_tsf_writer *w, const int64_t *ts, const double *values, long n) {
+	for (long i = 0; i < n; i++) {
+		for (int j = 0; j < w->ncolumns; j++) {
+			if (tsp_tsf_store_double(w, j, values[i * w->ncolumns + j]) != 0) {
+				return TSP_TSF_UNREPRESENTABLE;
+			}
+		}
+		if (tsp_tsf_commit_row(w, ts[i]) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Appends n rows given column by column
+ *
+ * ts: n non-decreasing timestamps
+ * columns: ncolumns arrays of n values, double for float64 columns and int64_t for
+ *          int64 columns, so integers are stored exactly
+ *
+ * return: 0 on success, -1 on failure (decreasing timestamp or I/O error)
+ */
+int tsp_tsf_write_columns(struct tsp_tsf_writer *w, const int64_t *ts, const void *const *columns,
+			  long n) {
+	for (long i = 0; i < n; i++) {
+		for (int j = 0; j < w->ncolumns; j++) {
+			// Both column types are 8 bytes wide and stored bit for bit
+			memcpy(&w->values[(long)j * w->chunk_rows + w->rows],
+			       (const uint64_t *)columns[j] + i, sizeof(uint64_t));
+		}
+		if (tsp_tsf_commit_row(w, ts[i]) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Drains a native handler chain into a single-column file
+ * Timestamps are start, start + step, ... ; missing values (inf) are stored as NaN
+ *
+ * return: Number of written rows, TSP_TSF_UNREPRESENTABLE if the column is int64 and cannot hold
+ *         a value, or -1 on other failures
+ */
+long tsp_tsf_drain(struct tsp_tsf_writer *w, struct tsp_handler *handler, int64_t start,
+		   int64_t step) {
+	if (w->ncolumns != 1) {
+		fprintf(stderr, "Only single-column tsf files can be drained into\n");
+		return -1;
+	}
+	long count = 0;
+	double *next = NULL;
+	while ((next = tsp_next_chain(handler, w->chunk_rows < 4096 ? w->chunk_rows : 4096)) != NULL) {
+		if (tsp_tsf_store_double(w, 0, isinf(*next) && *next > 0 ? NAN : *next) != 0) {
+			return TSP_TSF_UNREPRESENTABLE;
+		}
+		if (tsp_tsf_commit_row(w, start + step * count) != 0) {
+			return -1;
+		}
+		count++;
+	}
+	return count;
+}
+
+/*
+ * Writes the pending chunk, the index and closes the file, frees the writer
+ *
+ * return: 0 on success, -1 on failure
+ */
+int tsp_tsf_writer_close(struct tsp_tsf_writer *w) {
+	int res = tsp_tsf_flush_chunk(w);
+	struct tsp_tsf_trailer trailer = {.index_offset = w->offset, .nchunks = w->nchunks};
+	memcpy(trailer.magic, TSP_TSF_MAGIC, sizeof(trailer.magic));
+	if (res == 0 &&
+	    (fwrite(w->index, sizeof(w->index[0]), w->nchunks, w->file) != (size_t)w->nchunks ||
+	     fwrite(w->stats, sizeof(double) * 2 * w->ncolumns, w->nchunks, w->file) !=
+		 (size_t)w->nchunks ||
+	     fwrite(&trailer, sizeof(trailer), 1, w->file) != 1)) {
+		res = -1;
+	}
+	if (fclose(w->file) != 0) {
+		res = -1;
+	}
+	if (res != 0) {
+		fprintf(stderr, "Could not write tsf file\n");
+	}
+	tsp_tsf_writer_free(w);
+	return res;
+}
+
+/* Validates the layout of a mapped file and fills the reader fields */
+static int tsp_tsf_parse(struct tsp_tsf_reader *r) {
+	struct tsp_tsf_header h;
+	struct tsp_tsf_trailer t;
+	if (r->size < sizeof(h) + sizeof(t)) {
+		return -1;
+	}
+	memcpy(&h, r->data, sizeof(h));
+	memcpy(&t, r->data + r->size - sizeof(t), sizeof(t));
+	if (memcmp(h.magic, TSP_TSF_MAGIC, 8) != 0 || memcmp(t.magic, TSP_TSF_MAGIC, 8) != 0 ||
+	    h.ncolumns == 0 || h.chunk_rows == 0 || t.index_offset % TSP_TSF_ALIGN != 0 ||
+	    t.index_offset > r->size - sizeof(t) ||
+	    tsp_tsf_header_size(h.ncolumns) > t.index_offset) {
+		return -1;
+	}
+	// The index and the stats fill the rest of the file, check the entry count
+	// against it before multiplying, so that a corrupt count can't overflow
+	uint64_t entry_size = sizeof(struct tsp_tsf_chunk) + sizeof(double) * 2 * h.ncolumns;
+	uint64_t available = r->size - sizeof(t) - t.index_offset;
+	if (t.nchunks > available / entry_size || entry_size * t.nchunks != available) {
+		return -1;
+	}
+	r->ncolumns = h.ncolumns;
+	r->chunk_rows = h.chunk_rows;
+	r->types = (const uint32_t *)(r->data + sizeof(h));
+	r->index = (const struct tsp_tsf_chunk *)(r->data + t.index_offset);
+	r->stats = (const double *)(r->index + t.nchunks);
+	r->nchunks = t.nchunks;
+	r->rows = 0;
+	uint64_t header_size = tsp_tsf_header_size(h.ncolumns);
+	for (long i = 0; i < r->nchunks; i++) {
+		const struct tsp_tsf_chunk *c = &r->index[i];
+		if (c->rows == 0 || c->rows > h.chunk_rows ||
+		    (i + 1 < r->nchunks && c->rows != h.chunk_rows)) {
+			return -1;
+		}
+		// Arrays of the chunk must be aligned and lie between the header and the index
+		uint64_t array_size = tsp_tsf_align(sizeof(double) * c->rows);
+		if (c->offset % TSP_TSF_ALIGN != 0 || c->offset < header_size ||
+		    c->offset > t.index_offset ||
+		    array_size > (t.index_offset - c->offset) / (r->ncolumns + 1)) {
+			return -1;
+		}
+		r->rows += c->rows;
+	}
+	return 0;
+}
+
+/*
+ * Opens a TSF file for reading, the file is memory-mapped
+ * All rows of column 0 are selected for tsp_fill_tsf
+ *
+ * return: Pointer to initialized reader, or NULL on failure
+ */
+struct tsp_tsf_reader *tsp_tsf_open(const char *path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Could not open file %s\n", path);
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		fprintf(stderr, "Could not read file %s\n", path);
+		close(fd);
+		return NULL;
+	}
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Could not map file %s\n", path);
+		return NULL;
+	}
+
+	struct tsp_tsf_reader *obj = malloc(sizeof(struct tsp_tsf_reader));
+	if (obj == NULL) {
+		fprintf(stderr, "Could not allocate memory to initialize tsf reader\n");
+		munmap(map, st.st_size);
+		return NULL;
+	}
+	obj->data = map;
+	obj->size = st.st_size;
+	if (tsp_tsf_parse(obj) != 0) {
+		fprintf(stderr, "File %s is not a valid tsf file\n", path);
+		tsp_tsf_close(obj);
+		return NULL;
+	}
+	obj->column = 0;
+	obj->pos = 0;
+	obj->end = obj->rows;
+	return obj;
+}
+
+/* Unmap the file and free the reader */
+void tsp_tsf_close(struct tsp_tsf_reader *r) {
+	munmap((void *)r->data, r->size);
+	free(r);
+}
+
+long tsp_tsf_rows(struct tsp_tsf_reader *r) { return r->rows; }
+
+int tsp_tsf_ncolumns(struct tsp_tsf_reader *r) { return r->ncolumns; }
+
+int tsp_tsf_column_type(struct tsp_tsf_reader *r, int column) {
+	return column >= 0 && column < r->ncolumns ? (int)r->types[column] : -1;
+}
+
+long tsp_tsf_nchunks(struct tsp_tsf_reader *r) { return r->nchunks; }
+
+/*
+ * Reads an index entry: rows, first and last timestamps, min and max of every column
+ * min and max must have room for ncolumns values
+ *
+ * return: 0 on success, -1 if chunk is out of range
+ */
+int tsp_tsf_chunk_info(struct tsp_tsf_reader *r, long chunk, long *rows, int64_t *first,
+		       int64_t *last, double *min, double *max) {
+	if (chunk < 0 || chunk >= r->nchunks) {
+		return -1;
+	}
+	*rows = r->index[chunk].rows;
+	*first = r->index[chunk].first;
+	*last = r->index[chunk].last;
+	for (int j = 0; j < r->ncolumns; j++) {
+		min[j] = r->stats[2 * (r->ncolumns * chunk + j)];
+		max[j] = r->stats[2 * (r->ncolumns * chunk + j) + 1];
+	}
+	return 0;
+}
+
+/* Pointer to the timestamps (column -1) or the values of a column in a chunk */
+static const char *tsp_tsf_column_data(struct tsp_tsf_reader *r, long chunk, int column) {
+	const struct tsp_tsf_chunk *c = &r->index[chunk];
+	return r->data + c->offset + tsp_tsf_align(sizeof(double) * c->rows) * (column + 1);
+}
+
+/*
+ * Finds the first row with timestamp >= ts
+ * Binary search over the index, then inside one chunk, no data is scanned
+ *
+ * return: Row number, the number of rows if all timestamps are smaller
+ */
+long tsp_tsf_lower_bound(struct tsp_tsf_reader *r, int64_t ts) {
+	long lo = 0, hi = r->nchunks;
+	while (lo < hi) {
+		long mid = lo + (hi - lo) / 2;
+		if (r->index[mid].last < ts) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == r->nchunks) {
+		return r->rows;
+	}
+	const int64_t *stamps = (const int64_t *)tsp_tsf_column_data(r, lo, -1);
+	long first = 0, last = r->index[lo].rows;
+	while (first < last) {
+		long mid = first + (last - first) / 2;
+		if (stamps[mid] < ts) {
+			first = mid + 1;
+		} else {
+			last = mid;
+		}
+	}
+	return lo * r->chunk_rows + first;
+}
+
+/*
+ * Selects the column and the rows [start, end) served by tsp_fill_tsf
+ * column -1 selects timestamps (converted to double)
+ *
+ * return: 0 on success, -1 on invalid arguments
+ */
+int tsp_tsf_select(struct tsp_tsf_reader *r, int column, long start, long end) {
+	if (column < -1 || column >= r->ncolumns || start < 0 || start > end || end > r->rows) {
+		return -1;
+	}
+	r->column = column;
+	r->pos = start;
+	r->end = end;
+	return 0;
+}
+
+/* Converts n values of a column from row first of a chunk to double */
+static void tsp_tsf_convert(struct tsp_tsf_reader *r, long chunk, int column, long first, long n,
+			    double *out) {
+	const char *data = tsp_tsf_column_data(r, chunk, column);
+	if (column >= 0 && r->types[column] == TSP_TSF_FLOAT64) {
+		memcpy(out, (const double *)data + first, sizeof(double) * n);
+	} else {
+		const int64_t *values = (const int64_t *)data + first;
+		for (long i = 0; i < n; i++) {
+			out[i] = (double)values[i];
+		}
+	}
+}
+
+/*
+ * Copies n values of a column starting at row start to out, converted to double
+ * column -1 reads timestamps
+ *
+ * return: Number of copied values
+ */
+long tsp_tsf_read(struct tsp_tsf_reader *r, int column, long start, long n, double *out) {
+	if (column < -1 || column >= r->ncolumns || start < 0) {
+		return 0;
+	}
+	long done = 0;
+	while (done < n && start + done < r->rows) {
+		long row = start + done;
+		long chunk = row / r->chunk_rows;
+		long first = row % r->chunk_rows;
+		long count = r->index[chunk].rows - first;
+		count = count < n - done ? count : n - done;
+		tsp_tsf_convert(r, chunk, column, first, count, out + done);
+		done += count;
+	}
+	return done;
+}
+
+/*
+ * Copies n values of an int64 column starting at row start to out, without conversion
+ *
+ * return: Number of copied values, 0 if the column is not an int64 column
+ */
+long tsp_tsf_read_int64(struct tsp_tsf_reader *r, int column, long start, long n, int64_t *out) {
+	if (column < 0 || column >= r->ncolumns || r->types[column] != TSP_TSF_INT64) {
+		return 0;
+	}
+	long done = 0;
+	while (start >= 0 && done < n && start + done < r->rows) {
+		long row = start + done;
+		long chunk = row / r->chunk_rows;
+		long first = row % r->chunk_rows;
+		long count = r->index[chunk].rows - first;
+		count = count < n - done ? count : n - done;
+		memcpy(out + done, (const int64_t *)tsp_tsf_column_data(r, chunk, column) + first,
+		       sizeof(int64_t) * count);
+		done += count;
+	}
+	return done;
+}
+
+/*
+ * Copies n timestamps starting at row start to out
+ *
+ * return: Number of copied timestamps
+ */
+long tsp_tsf_read_timestamps(struct tsp_tsf_reader *r, long start, long n, int64_t *out) {
+	long done = 0;
+	while (start >= 0 && done < n && start + done < r->rows) {
+		long row = start + done;
+		long chunk = row / r->chunk_rows;
+		long first = row % r->chunk_rows;
+		long count = r->index[chunk].rows - first;
+		count = count < n - done ? count : n - done;
+		memcpy(out + done, (const int64_t *)tsp_tsf_column_data(r, chunk, -1) + first,
+		       sizeof(int64_t) * count);
+		done += count;
+	}
+	return done;
+}
+
+/*
+ * Serves the next block of the selected range, at most capacity values, never crossing a chunk
+ * float64 columns are served directly from the mapped file, other columns
+ * are converted into *block
+ *
+ * return: Number of values, 0 at the end of the range
+ */
+int tsp_tsf_next_block(struct tsp_tsf_reader *r, double **block, int capacity) {
+	if (r->pos >= r->end) {
+		return 0;
+	}
+	long chunk = r->pos / r->chunk_rows;
+	long first = r->pos % r->chunk_rows;
+	long count = r->index[chunk].rows - first;
+	count = count < r->end - r->pos ? count : r->end - r->pos;
+	count = count < capacity ? count : capacity;
+	if (r->column >= 0 && r->types[r->column] == TSP_TSF_FLOAT64) {
+		*block = (double *)tsp_tsf_column_data(r, chunk, r->column) + first;
+	} else {
+		tsp_tsf_convert(r, chunk, r->column, first, count, *block);
+	}
+	r->pos += count;
+	return (int)count;
+}
+
+/* Fill function of the tsf source handler (see tsp_init_source) */
+int tsp_fill_tsf(struct tsp_handler *handler, double **block, int capacity) {
+	return tsp_tsf_next_block((struct tsp_tsf_reader *)handler->data, block, capacity);
+}
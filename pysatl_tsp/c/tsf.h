@@ -0,0 +1,114 @@
+#define TSP_API_START
+#define TSP_API_END
+#ifndef TSF_H
+#define TSF_H
+#include "handler.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * TSF: chunked columnar time series file
+ *
+ * [header][chunk 0]...[chunk k][index][stats][trailer], native byte order
+ *
+ * header:  tsp_tsf_header, then ncolumns uint32 column types, padded to 64 bytes
+ * chunk:   int64 timestamps of the chunk rows, then every column of the chunk rows
+ *          (double or int64), each array starts at a 64-byte aligned offset
+ * index:   nchunks tsp_tsf_chunk entries
+ * stats:   nchunks * ncolumns pairs of double (min, max), NaN values are ignored
+ * trailer: tsp_tsf_trailer
+ *
+ * All chunks except the last one contain exactly chunk_rows rows, so row number i
+ * lives in chunk i / chunk_rows. Timestamps are non-decreasing.
+ */
+#define TSP_TSF_MAGIC "TSPTSF01"
+#define TSP_TSF_ALIGN 64
+
+struct tsp_tsf_header {
+	char magic[8];
+	uint32_t ncolumns;
+	uint32_t chunk_rows;
+};
+
+struct tsp_tsf_chunk {
+	uint64_t offset; // Offset of the chunk timestamps
+	uint64_t rows;	 // Rows in the chunk
+	int64_t first;	 // First timestamp of the chunk
+	int64_t last;	 // Last timestamp of the chunk
+};
+
+struct tsp_tsf_trailer {
+	uint64_t index_offset;
+	uint64_t nchunks;
+	char magic[8];
+};
+
+/* Writer of a TSF file, rows are buffered until a chunk is full */
+struct tsp_tsf_writer {
+	FILE *file;
+	int ncolumns;
+	int chunk_rows;
+	uint32_t *types;		// Column types (TSP_TSF_*)
+	int64_t *ts;			// Timestamps of the pending chunk
+	uint64_t *values;		// Pending chunk, column-major, chunk_rows per column,
+					// bits of double or int64 depending on the column type
+	int rows;			// Rows in the pending chunk
+	uint64_t offset;		// Current end of file
+	struct tsp_tsf_chunk *index;	// Index of written chunks
+	double *stats;			// Min/max of written chunks
+	long nchunks;			// Written chunks
+	long index_capacity;		// Allocated index entries
+	int64_t last;			// Last written timestamp
+};
+
+/* Memory-mapped TSF reader, also a native source (see tsp_fill_tsf) */
+struct tsp_tsf_reader {
+	const char *data;
+	size_t size;
+	int ncolumns;
+	int chunk_rows;
+	const uint32_t *types;
+	const struct tsp_tsf_chunk *index;
+	const double *stats;
+	long nchunks;
+	long rows;   // Total rows
+	int column;  // Column served by tsp_fill_tsf, -1 for timestamps
+	long pos;    // Next row served by tsp_fill_tsf
+	long end;    // End row (exclusive) of the served range
+};
+
+int tsp_tsf_next_block(struct tsp_tsf_reader *r, double **block, int capacity);
+
+TSP_API_START
+#define TSP_TSF_FLOAT64 0
+#define TSP_TSF_INT64 1
+
+/* Result of writes of a double that an int64 column cannot hold (NaN, inf, beyond 2^63), -1 is any other failure */
+#define TSP_TSF_UNREPRESENTABLE -2
+
+struct tsp_tsf_writer *tsp_tsf_writer_open(const char *path, int ncolumns, const int *types,
+					   int chunk_rows);
+int tsp_tsf_write_rows(struct tsp_tsf_writer *w, const int64_t *ts, const double *values, long n);
+int tsp_tsf_write_columns(struct tsp_tsf_writer *w, const int64_t *ts, const void *const *columns,
+			  long n);
+long tsp_tsf_drain(struct tsp_tsf_writer *w, struct tsp_handler *handler, int64_t start,
+		   int64_t step);
+int tsp_tsf_writer_close(struct tsp_tsf_writer *w);
+
+struct tsp_tsf_reader *tsp_tsf_open(const char *path);
+void tsp_tsf_close(struct tsp_tsf_reader *r);
+long tsp_tsf_rows(struct tsp_tsf_reader *r);
+int tsp_tsf_ncolumns(struct tsp_tsf_reader *r);
+int tsp_tsf_column_type(struct tsp_tsf_reader *r, int column);
+long tsp_tsf_nchunks(struct tsp_tsf_reader *r);
+int tsp_tsf_chunk_info(struct tsp_tsf_reader *r, long chunk, long *rows, int64_t *first,
+		       int64_t *last, double *min, double *max);
+long tsp_tsf_lower_bound(struct tsp_tsf_reader *r, int64_t ts);
+int tsp_tsf_select(struct tsp_tsf_reader *r, int column, long start, long end);
+long tsp_tsf_read(struct tsp_tsf_reader *r, int column, long start, long n, double *out);
+long tsp_tsf_read_int64(struct tsp_tsf_reader *r, int column, long start, long n, int64_t *out);
+long tsp_tsf_read_timestamps(struct tsp_tsf_reader *r, long start, long n, int64_t *out);
+
+int tsp_fill_tsf(struct tsp_handler *handler, double **block, int capacity);
+TSP_API_END
+#endif /* TSF_H */
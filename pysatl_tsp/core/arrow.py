@@ -0,0 +1,113 @@
+import ctypes
+from typing import Any
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    tsp_arrow_array_capsule_free,
+    tsp_arrow_array_new,
+    tsp_arrow_export_array,
+    tsp_arrow_export_chain,
+    tsp_arrow_export_free,
+    tsp_arrow_export_length,
+    tsp_arrow_export_null_count,
+    tsp_arrow_export_schema,
+    tsp_arrow_schema_capsule_free,
+    tsp_arrow_schema_new,
+)
+from pysatl_tsp.core import Handler
+
+__all__ = ["ArrowArrayExport", "capsule_pointer", "to_arrow"]
+
+# Capsule names of the Arrow PyCapsule interface, module constants keep them alive for the capsules
+SCHEMA_CAPSULE = b"arrow_schema"
+ARRAY_CAPSULE = b"arrow_array"
+STREAM_CAPSULE = b"arrow_array_stream"
+
+_capsule_new = ctypes.pythonapi.PyCapsule_New
+_capsule_new.restype = ctypes.py_object
+_capsule_new.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+_capsule_get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+_capsule_get_pointer.restype = ctypes.c_void_p
+_capsule_get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+
+def capsule_pointer(capsule: Any, name: bytes, ctype: str) -> Any:
+    """Get the C structure stored in an Arrow PyCapsule.
+
+    :param capsule: Capsule produced by ``__arrow_c_array__``/``__arrow_c_stream__``
+    :param name: Capsule name
+    :param ctype: C type of the pointer, e.g. "struct ArrowArray *"
+    :return: Pointer to the structure, valid while the capsule is alive
+    :raises ValueError: If the object is not a capsule with this name
+    """
+    return ffi.cast(ctype, _capsule_get_pointer(capsule, name))
+
+
+def _capsule(pointer: Any, name: bytes, destructor: Any) -> Any:
+    return _capsule_new(int(ffi.cast("uintptr_t", pointer)), name, int(ffi.cast("uintptr_t", destructor)))
+
+
+class ArrowArrayExport:
+    """Arrow float64 array produced by a native pipeline.
+
+    Implements the Arrow PyCapsule interface (``__arrow_c_array__``), so it can be
+    consumed without copying by pyarrow (``pyarrow.array(export)``), polars, pandas
+    and :class:`~pysatl_tsp.core.data_providers.ArrowDataProvider`. Every call gives
+    new capsules sharing the buffers, so the array can be consumed any number of times;
+    the buffers are freed when the export and all consumers have released them.
+
+    :param export: Pointer to the exported buffers (``struct tsp_arrow_export *``), owned by this object
+    """
+
+    def __init__(self, export: Any) -> None:
+        self._export = ffi.gc(export, tsp_arrow_export_free)
+        self.length = int(tsp_arrow_export_length(export))
+        self.null_count = int(tsp_arrow_export_null_count(export))
+
+    def __len__(self) -> int:
+        return self.length
+
+    def __arrow_c_schema__(self) -> Any:
+        schema = tsp_arrow_schema_new()
+        if schema == ffi.NULL:
+            raise MemoryError("Could not allocate Arrow schema")
+        tsp_arrow_export_schema(schema)
+        return _capsule(schema, SCHEMA_CAPSULE, tsp_arrow_schema_capsule_free)
+
+    def __arrow_c_array__(self, requested_schema: Any = None) -> tuple[Any, Any]:
+        """Export the array through the Arrow PyCapsule interface.
+
+        :param requested_schema: Ignored, the array is always float64
+        :return: New schema and array capsules, each released independently
+        """
+        schema, array = tsp_arrow_schema_new(), tsp_arrow_array_new()
+        if ffi.NULL in (schema, array):
+            raise MemoryError("Could not allocate Arrow array")
+        tsp_arrow_export_array(self._export, schema, array)
+        return (
+            _capsule(schema, SCHEMA_CAPSULE, tsp_arrow_schema_capsule_free),
+            _capsule(array, ARRAY_CAPSULE, tsp_arrow_array_capsule_free),
+        )
+
+
+def to_arrow(source: Handler[Any, float | None], size_hint: int = 0) -> ArrowArrayExport:
+    """Collect the output of a native pipeline into an Arrow float64 array.
+
+    The values are written by the C library straight into the Arrow buffer, which is
+    then handed to the consumer without copying. Missing values (None) become nulls.
+
+    :param source: Native handler or pipeline (with a ``handler`` attribute)
+    :param size_hint: Expected number of values, defaults to 0 (unknown)
+    :return: Exported array
+    :raises ValueError: If the source is not native or the export fails
+    :raises Exception: The error of a failed native source (see :meth:`Handler.check`)
+    """
+    if not hasattr(source, "handler"):
+        raise ValueError("Only native handlers can be exported to Arrow")
+    iter(source)
+    export = tsp_arrow_export_chain(source.handler, size_hint)
+    if export == ffi.NULL:
+        raise ValueError("Could not export values to Arrow")
+    result = ArrowArrayExport(export)
+    source.check()
+    return result
@@ -1,15 +1,31 @@
 from .abstract import DataProvider, T
-from .database_data_provider import DatabaseAdapter, DataBaseDataProvider
-from .file_data_provider import FileDataProvider
+from .arrow_data_provider import ArrowDataProvider
+from .block_data_provider import BlockDataProvider
+from .database_data_provider import DatabaseAdapter, DataBaseDataProvider, SQLiteAdapter
+from .file_data_provider import CFileDataProvider, FileDataProvider
+from .gorilla_data_provider import GorillaDataProvider, GorillaWriter
+from .replay_data_provider import ReplayDataProvider, ReplayStats
 from .simple_data_provider import SimpleDataProvider
+from .tsf_data_provider import TSFChunk, TSFDataProvider, TSFWriter
 from .websocket_data_provider import WebSocketDataProvider
 
 __all__ = [
+    "ArrowDataProvider",
+    "BlockDataProvider",
+    "CFileDataProvider",
     "DataBaseDataProvider",
     "DataProvider",
     "DatabaseAdapter",
     "FileDataProvider",
+    "GorillaDataProvider",
+    "GorillaWriter",
+    "ReplayDataProvider",
+    "ReplayStats",
+    "SQLiteAdapter",
     "SimpleDataProvider",
     "T",
+    "TSFChunk",
+    "TSFDataProvider",
+    "TSFWriter",
     "WebSocketDataProvider",
 ]
@@ -0,0 +1,85 @@
+from collections.abc import Iterator
+from typing import Any, cast
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    tsp_arrow_source_failed,
+    tsp_arrow_source_init,
+    tsp_arrow_stream_source_init,
+    tsp_fill_arrow,
+    tsp_free_arrow_source,
+    tsp_free_handler,
+    tsp_init_source,
+    tsp_next_chain,
+)
+from pysatl_tsp.core.arrow import ARRAY_CAPSULE, SCHEMA_CAPSULE, STREAM_CAPSULE, capsule_pointer
+
+from .abstract import DataProvider
+
+
+class ArrowDataProvider(DataProvider[float]):
+    """A data provider that serves an Arrow float64 array to native handlers.
+
+    Accepts any object implementing the Arrow PyCapsule interface: ``__arrow_c_array__``
+    (e.g. ``pyarrow.Array``) or ``__arrow_c_stream__`` (e.g. ``pyarrow.ChunkedArray``,
+    a table column). Arrays without nulls are passed to native handlers (``C*Handler``)
+    directly from the Arrow buffers, so the exchange costs O(1) instead of one Python
+    object per value. Nulls are served as NaN.
+
+    The data is moved out of the exported capsules and can be iterated once. A stream
+    that fails ends the data, the failure is raised when the iteration or the native
+    chain reading it ends.
+
+    :param data: Arrow float64 array or stream of arrays
+
+    :raises TypeError: If data does not implement the Arrow PyCapsule interface
+    :raises ValueError: If data is not float64
+    """
+
+    def __init__(self, data: Any) -> None:
+        super().__init__()
+        if hasattr(data, "__arrow_c_array__"):
+            schema_capsule, array_capsule = data.__arrow_c_array__()
+            source = tsp_arrow_source_init(
+                capsule_pointer(schema_capsule, SCHEMA_CAPSULE, "struct ArrowSchema *"),
+                capsule_pointer(array_capsule, ARRAY_CAPSULE, "struct ArrowArray *"),
+            )
+        elif hasattr(data, "__arrow_c_stream__"):
+            stream_capsule = data.__arrow_c_stream__()
+            source = tsp_arrow_stream_source_init(
+                capsule_pointer(stream_capsule, STREAM_CAPSULE, "struct ArrowArrayStream *")
+            )
+        else:
+            raise TypeError(f"{type(data).__name__} does not implement the Arrow PyCapsule interface")
+        if source == ffi.NULL:
+            raise ValueError("Arrow data must be a float64 array")
+        self._arrow = source
+        self.handler = tsp_init_source(ffi.cast("void *", source), tsp_fill_arrow)
+
+    def __iter__(self) -> Iterator[float]:
+        """Create an iterator over the array.
+
+        :return: An iterator yielding values of the array
+        """
+        return self
+
+    def __next__(self) -> float:
+        res = tsp_next_chain(self.handler, 4096)
+        if res != ffi.NULL:
+            return cast(float, res[0])
+        self.check()
+        raise StopIteration
+
+    def check(self) -> None:
+        """Raise if the Arrow stream failed.
+
+        :raises OSError: If the stream reported an error or gave an invalid array
+        """
+        if tsp_arrow_source_failed(self._arrow):
+            raise OSError("Could not read arrow stream, see the reported error")
+
+    def __del__(self) -> None:
+        if not hasattr(self, "handler"):
+            return
+        tsp_free_handler(self.handler)
+        tsp_free_arrow_source(self._arrow)
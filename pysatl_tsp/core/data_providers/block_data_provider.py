@@ -0,0 +1,89 @@
+from collections.abc import Iterable, Iterator
+from typing import cast
+
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    tsp_block_source_failed,
+    tsp_block_source_init,
+    tsp_block_source_set_iter,
+    tsp_fill_blocks,
+    tsp_free_block_source,
+    tsp_free_handler,
+    tsp_init_source,
+    tsp_next_chain,
+    tsp_reset_handler,
+)
+
+from .abstract import DataProvider
+
+
+class BlockDataProvider(DataProvider[float]):
+    """A data provider that serves blocks of values to native handlers.
+
+    Each block (a numpy array, a list, any array-like of numbers) is converted to a
+    contiguous float64 array once and then passed to native handlers (``C*Handler``)
+    without creating a Python object per value. Use it to feed batched sources, such as
+    database cursors or message batches, into native pipelines.
+
+    The blocks are iterated again every time the provider is iterated, so pass a
+    re-iterable (e.g. a list) to iterate more than once.
+
+    :param blocks: Iterable of blocks of numbers
+    """
+
+    def __init__(self, blocks: Iterable[npt.ArrayLike]) -> None:
+        super().__init__()
+        self.blocks = blocks
+        self._error: BaseException | None = None
+        self._blocks_itr: Iterator[npt.NDArray[np.float64]] | None = None
+        self._blocks = tsp_block_source_init()
+        if self._blocks == ffi.NULL:
+            raise MemoryError("Could not allocate block source")
+        self.handler = tsp_init_source(ffi.cast("void *", self._blocks), tsp_fill_blocks)
+
+    def _float_blocks(self) -> Iterator[npt.NDArray[np.float64]]:
+        # Errors can't cross the C library, they are kept and raised by check
+        try:
+            for block in self.blocks:
+                yield np.ascontiguousarray(block, dtype=np.float64).reshape(-1)
+        except (Exception, KeyboardInterrupt) as error:
+            self._error = error
+
+    def __iter__(self) -> Iterator[float]:
+        """Start serving the blocks from the beginning.
+
+        :return: An iterator yielding values of all blocks
+        """
+        self._error = None
+        self._blocks_itr = self._float_blocks()
+        tsp_block_source_set_iter(self._blocks, ffi.cast("void *", id(self._blocks_itr)))
+        tsp_reset_handler(self.handler)
+        return self
+
+    def __next__(self) -> float:
+        res = tsp_next_chain(self.handler, 4096)
+        if res != ffi.NULL:
+            return cast(float, res[0])
+        self.check()
+        raise StopIteration
+
+    def check(self) -> None:
+        """Raise the error of the block iterator or of a block that was rejected.
+
+        :raises Exception: The error raised by the block iterator
+        :raises RuntimeError: If a block could not be served
+        """
+        if self._error is not None:
+            error, self._error = self._error, None
+            raise error
+        if tsp_block_source_failed(self._blocks):
+            raise RuntimeError("Block iterator failed, see the reported error")
+
+    def __del__(self) -> None:
+        if not hasattr(self, "handler"):
+            return
+        tsp_free_handler(self.handler)
+        tsp_free_block_source(self._blocks)
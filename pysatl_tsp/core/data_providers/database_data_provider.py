@@ -1,14 +1,20 @@
 from __future__ import annotations
 
+import sqlite3
 from abc import ABC, abstractmethod
 from collections.abc import Iterator
 from contextlib import contextmanager
+from itertools import chain
 from typing import (
     Any,
     Generic,
 )
 
+import numpy as np
+import numpy.typing as npt
+
 from .abstract import DataProvider, T
+from .block_data_provider import BlockDataProvider
 
 
 class DatabaseAdapter(ABC, Generic[T]):
@@ -91,6 +97,32 @@ class DatabaseAdapter(ABC, Generic[T]):
         """
         pass
 
+    def fetch_batch(self, cursor: Any, n: int) -> list[npt.NDArray[np.float64]] | None:
+        """Fetch up to n rows of the query result as numeric column arrays.
+
+        Used by the batched mode of :class:`DataBaseDataProvider`. The default
+        implementation relies on the DB-API ``fetchmany`` (with ``arraysize`` set to n)
+        and converts the rows to float64 columns, NULL values become NaN. Adapters can
+        override it to use a driver's native columnar fetching.
+
+        :param cursor: Query result cursor
+        :param n: Maximum number of rows to fetch
+        :return: One float64 array per selected column, or None when no rows are left
+        :raises ValueError: If a selected value is not numeric
+        """
+        if getattr(cursor, "arraysize", n) != n:
+            cursor.arraysize = n
+        rows = cursor.fetchmany(n)
+        if not rows:
+            return None
+        width = len(rows[0])
+        try:
+            table = np.fromiter(chain.from_iterable(rows), np.float64, len(rows) * width).reshape(len(rows), width)
+        except TypeError:
+            # NULL values, slower conversion that maps None to NaN
+            table = np.array(rows, dtype=np.float64).reshape(len(rows), width)
+        return list(table.T)
+
     @abstractmethod
     def close_cursor(self, cursor: Any) -> None:
         """Close the query cursor.
@@ -198,3 +230,67 @@ class DataBaseDataProvider(DataProvider[T], Generic[T]):
         """
         with self._connection_context() as cursor:
             yield from self._adapter.fetch_data(cursor)
+
+    def iter_batches(self, batch_size: int = 10_000) -> Iterator[list[npt.NDArray[np.float64]]]:
+        """Execute the query and yield the results as batches of column arrays.
+
+        :param batch_size: Number of rows per batch, defaults to 10000
+        :return: An iterator yielding one float64 array per selected column
+        :raises Exception: If database operations fail
+        """
+        with self._connection_context() as cursor:
+            while (batch := self._adapter.fetch_batch(cursor, batch_size)) is not None:
+                yield batch
+
+    def column_source(self, column: int = 0, batch_size: int = 10_000) -> BlockDataProvider:
+        """Create a native source serving one column of the query result.
+
+        The rows are fetched in batches with the adapter's ``fetch_batch`` and handed to
+        native handlers (``C*Handler``) as blocks, without a Python object per row.
+        The query is executed again every time the source is iterated.
+
+        :param column: Index of the column in the select list, defaults to 0
+        :param batch_size: Number of rows per batch, defaults to 10000
+        :return: Native data provider of the column values
+        """
+        return BlockDataProvider(_ColumnBatches(self, column, batch_size))
+
+
+class _ColumnBatches:
+    """Re-iterable sequence of one column of the query result, batch by batch."""
+
+    def __init__(self, provider: DataBaseDataProvider[Any], column: int, batch_size: int) -> None:
+        self.provider = provider
+        self.column = column
+        self.batch_size = batch_size
+
+    def __iter__(self) -> Iterator[npt.NDArray[np.float64]]:
+        for batch in self.provider.iter_batches(self.batch_size):
+            yield batch[self.column]
+
+
+class SQLiteAdapter(DatabaseAdapter[tuple[Any, ...]]):
+    """Reference adapter for SQLite databases (the standard sqlite3 module).
+
+    Rows are yielded as tuples; batched fetching uses the default ``fetch_batch``.
+
+    Connection parameters: ``database`` (path or ":memory:"), other keys are passed to
+    ``sqlite3.connect``.
+    """
+
+    def connect(self, connection_params: dict[str, Any]) -> sqlite3.Connection:
+        params = dict(connection_params)
+        connection: sqlite3.Connection = sqlite3.connect(params.pop("database"), **params)
+        return connection
+
+    def execute_query(self, connection: sqlite3.Connection, query: str, params: tuple[Any, ...] = ()) -> sqlite3.Cursor:
+        return connection.execute(query, params)
+
+    def fetch_data(self, cursor: sqlite3.Cursor) -> Iterator[tuple[Any, ...]]:
+        yield from cursor
+
+    def close_cursor(self, cursor: sqlite3.Cursor) -> None:
+        cursor.close()
+
+    def close_connection(self, connection: sqlite3.Connection) -> None:
+        connection.close()
@@ -1,10 +1,30 @@
-from collections.abc import Iterator
-from typing import Callable, TypeVar
+import os
+from collections.abc import Iterator, Sequence
+from typing import Callable, TypeVar, cast
+
+import cffi
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c.lib import (
+    tsp_csv_count_rows,
+    tsp_csv_read_columns,
+    tsp_csv_source_init,
+    tsp_csv_source_rewind,
+    tsp_fill_csv,
+    tsp_free_csv_source,
+    tsp_free_handler,
+    tsp_init_source,
+    tsp_next_chain,
+    tsp_reset_handler,
+)
 
 from .abstract import DataProvider
 
 X = TypeVar("X")
 
+ffi = cffi.FFI()
+
 
 class FileDataProvider(DataProvider[X]):
     """A data provider that reads time series data from a text file.
@@ -44,3 +64,94 @@ class FileDataProvider(DataProvider[X]):
         with open(self.filename) as f:
             for line in f:
                 yield self.handler(line)
+
+
+class CFileDataProvider(DataProvider[float]):
+    """A data provider that reads a numeric column of a delimited text file natively.
+
+    The file is memory-mapped and parsed by the C library: rows are never turned into
+    Python strings, and when the provider is followed by native handlers (``C*Handler``)
+    the values go from the file to the handler chain without passing through Python.
+    Empty lines are skipped. Missing fields (blank, or beyond the end of a row) are
+    returned as infinity, the value native handlers treat as None; non-numeric fields
+    are returned as NaN. :meth:`read_columns` stores missing fields as NaN.
+
+    :param filename: Path to the file containing time series data
+    :param column: Zero-based index of the column to read, defaults to 0
+    :param delimiter: Single-character field delimiter, defaults to ","
+    :param skip_rows: Number of leading rows to skip, e.g. a header, defaults to 0
+
+    :raises FileNotFoundError: If the specified file does not exist
+    :raises ValueError: If the delimiter is not a single character or column is negative
+    :raises OSError: If the file cannot be opened or read
+    """
+
+    def __init__(self, filename: str, column: int = 0, delimiter: str = ",", skip_rows: int = 0) -> None:
+        """Initialize a native file data provider.
+
+        :param filename: Path to the file containing time series data
+        :param column: Zero-based index of the column to read, defaults to 0
+        :param delimiter: Single-character field delimiter, defaults to ","
+        :param skip_rows: Number of leading rows to skip, e.g. a header, defaults to 0
+        """
+        super().__init__()
+        if len(delimiter) != 1:
+            raise ValueError(f"Delimiter must be a single character, got {delimiter!r}")
+        if column < 0:
+            raise ValueError(f"Column must be non-negative, got {column}")
+        if not os.path.exists(filename):
+            raise FileNotFoundError(filename)
+        self.filename = filename
+        self.column = column
+        self.delimiter = delimiter
+        self.skip_rows = skip_rows
+        self._csv = tsp_csv_source_init(os.fsencode(filename), column, delimiter.encode(), max(skip_rows, 0))
+        if self._csv == ffi.NULL:
+            raise OSError(f"Could not read file {filename}")
+        self.handler = tsp_init_source(ffi.cast("void *", self._csv), tsp_fill_csv)
+
+    def __iter__(self) -> Iterator[float]:
+        """Start reading the file from the first row after the skipped ones.
+
+        :return: An iterator yielding values of the selected column
+        """
+        tsp_csv_source_rewind(self._csv)
+        tsp_reset_handler(self.handler)
+        return self
+
+    def __next__(self) -> float:
+        res = tsp_next_chain(self.handler, 4096)
+        if res != ffi.NULL:
+            return cast(float, res[0])
+        else:
+            raise StopIteration
+
+    def __len__(self) -> int:
+        """Count non-empty rows after the skipped ones.
+
+        :return: Number of values the provider yields
+        """
+        return int(tsp_csv_count_rows(self._csv))
+
+    def read_columns(self, columns: Sequence[int]) -> npt.NDArray[np.float64]:
+        """Parse several columns of the whole file at once.
+
+        Independent of the iteration position, useful to load a file into memory.
+
+        :param columns: Zero-based indices of the columns to read
+        :return: Array of shape (rows, len(columns))
+        :raises ValueError: If a column index is negative
+        """
+        if any(column < 0 for column in columns):
+            raise ValueError(f"Columns must be non-negative, got {list(columns)}")
+        rows = len(self)
+        out = np.empty((rows, len(columns)), dtype=np.float64)
+        selected = ffi.new("int[]", list(columns))
+        written = tsp_csv_read_columns(self._csv, selected, len(columns), ffi.from_buffer("double[]", out), rows)
+        return out[:written]
+
+    def __del__(self) -> None:
+        if not hasattr(self, "handler"):
+            return
+        tsp_free_handler(self.handler)
+        tsp_free_csv_source(self._csv)
@@ -0,0 +1,227 @@
+import os
+from collections.abc import Iterable, Iterator, Sequence
+from types import TracebackType
+from typing import Any, cast
+
+import cffi
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c.lib import (
+    tsp_fill_gorilla,
+    tsp_free_handler,
+    tsp_gorilla_close,
+    tsp_gorilla_drain,
+    tsp_gorilla_failed,
+    tsp_gorilla_open,
+    tsp_gorilla_points,
+    tsp_gorilla_read,
+    tsp_gorilla_rewind,
+    tsp_gorilla_write,
+    tsp_gorilla_writer_close,
+    tsp_gorilla_writer_open,
+    tsp_init_source,
+    tsp_next_chain,
+    tsp_reset_handler,
+)
+from pysatl_tsp.core import Handler
+
+from .abstract import DataProvider
+from .tsf_data_provider import Timestamp, to_timestamp
+
+ffi = cffi.FFI()
+
+__all__ = ["GorillaDataProvider", "GorillaWriter"]
+
+
+class GorillaWriter:
+    """Writer of Gorilla-compressed tick files.
+
+    Timestamps are stored as delta-of-delta and values as XOR with the previous value,
+    bit-packed as in Facebook's Gorilla. Regular ticks take about one bit per timestamp
+    and slowly changing prices a few bits per value, instead of 16 bytes per point.
+    Values are restored bit-exactly, NaN and infinities included. Files are read back
+    by :class:`GorillaDataProvider`.
+
+    Points are compressed in independent chunks; the writer is a context manager,
+    the last chunk is written when it is closed.
+
+    :param filename: Path to the file, an existing file is overwritten
+    :param chunk_points: Number of points per chunk, defaults to 65536
+    :raises ValueError: If chunk_points is not positive
+    :raises OSError: If the file cannot be created
+    """
+
+    def __init__(self, filename: str, chunk_points: int = 65536) -> None:
+        if chunk_points < 1:
+            raise ValueError("Gorilla file needs at least one point per chunk")
+        self.filename = filename
+        self.chunk_points = chunk_points
+        self._writer = None
+        writer = tsp_gorilla_writer_open(os.fsencode(filename), chunk_points)
+        if writer == ffi.NULL:
+            raise OSError(f"Could not create file {filename}")
+        self._writer = writer
+
+    def _check_open(self) -> None:
+        if self._writer is None:
+            raise ValueError("Writer is closed")
+
+    def write(self, timestamps: Sequence[Timestamp] | npt.ArrayLike, values: npt.ArrayLike) -> None:
+        """Append points.
+
+        :param timestamps: Timestamps of the points, regular ones compress best
+        :param values: Values of the points
+        :raises ValueError: If the lengths don't match
+        :raises MemoryError: If a chunk cannot be allocated
+        """
+        self._check_open()
+        if isinstance(timestamps, np.ndarray) and timestamps.dtype == np.int64:
+            stamps = np.ascontiguousarray(timestamps)
+        else:
+            stamps = np.ascontiguousarray([to_timestamp(t) for t in cast(Iterable[Timestamp], timestamps)], np.int64)
+        data = np.ascontiguousarray(values, dtype=np.float64).reshape(-1)
+        if len(data) != len(stamps):
+            raise ValueError(f"Expected {len(stamps)} values, got {len(data)}")
+        if tsp_gorilla_write(
+            self._writer, ffi.from_buffer("int64_t[]", stamps), ffi.from_buffer("double[]", data), len(stamps)
+        ):
+            raise MemoryError("Could not write points")
+
+    def drain(self, source: Handler[Any, float | None], start: Timestamp = 0, step: int = 1) -> int:
+        """Write all values produced by a handler.
+
+        Native pipelines (handlers with a ``handler`` attribute) are drained by the C
+        library without Python per value. Missing values (None) are stored as NaN.
+
+        :param source: Handler producing the values
+        :param start: Timestamp of the first value, defaults to 0
+        :param step: Difference between consecutive timestamps, defaults to 1
+        :return: Number of written values
+        :raises MemoryError: If writing fails
+        :raises Exception: The error of a failed native source (see :meth:`Handler.check`)
+        """
+        self._check_open()
+        first = to_timestamp(start)
+        iterator = iter(source)
+        if hasattr(source, "handler"):
+            count = int(tsp_gorilla_drain(self._writer, source.handler, first, step))
+            if count < 0:
+                raise MemoryError("Could not write values")
+            source.check()
+            return count
+        count = 0
+        block: list[float] = []
+        for value in iterator:
+            block.append(np.nan if value is None else value)
+            if len(block) == self.chunk_points:
+                self.write(np.arange(len(block), dtype=np.int64) * step + first + count * step, block)
+                count += len(block)
+                block = []
+        self.write(np.arange(len(block), dtype=np.int64) * step + first + count * step, block)
+        return count + len(block)
+
+    def close(self) -> None:
+        """Write the pending chunk and close the file.
+
+        :raises OSError: If the file cannot be written
+        """
+        if self._writer is None:
+            return
+        writer, self._writer = self._writer, None
+        if tsp_gorilla_writer_close(writer) != 0:
+            raise OSError(f"Could not write file {self.filename}")
+
+    def __enter__(self) -> "GorillaWriter":
+        return self
+
+    def __exit__(
+        self, exc_type: type[BaseException] | None, exc: BaseException | None, traceback: TracebackType | None
+    ) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        if getattr(self, "_writer", None) is not None:
+            self.close()
+
+
+class GorillaDataProvider(DataProvider[float]):
+    """A data provider that serves the values of a Gorilla-compressed tick file.
+
+    The file is memory-mapped and decoded in C straight into the blocks passed
+    to native handlers (``C*Handler``), so a compressed file is replayed without
+    materializing it and without Python per value.
+
+    :param filename: Path to a file written by :class:`GorillaWriter`
+
+    :raises FileNotFoundError: If the specified file does not exist
+    :raises OSError: If the file is not a valid Gorilla file, or while iterating if a chunk is corrupt
+    """
+
+    def __init__(self, filename: str) -> None:
+        super().__init__()
+        if not os.path.exists(filename):
+            raise FileNotFoundError(filename)
+        self.filename = filename
+        reader = tsp_gorilla_open(os.fsencode(filename))
+        if reader == ffi.NULL:
+            raise OSError(f"File {filename} is not a valid Gorilla file")
+        self._reader = reader
+        self.handler = tsp_init_source(ffi.cast("void *", self._reader), tsp_fill_gorilla)
+
+    def read(self) -> tuple[npt.NDArray[np.int64], npt.NDArray[np.float64]]:
+        """Decode the whole file into arrays.
+
+        Rewinds the provider, an iteration in progress starts over.
+
+        :return: Timestamps and values of all points
+        :raises OSError: If a chunk of the file is corrupt
+        """
+        points = tsp_gorilla_points(self._reader)
+        stamps = np.empty(points, dtype=np.int64)
+        values = np.empty(points, dtype=np.float64)
+        tsp_gorilla_rewind(self._reader)
+        count = tsp_gorilla_read(
+            self._reader, ffi.from_buffer("int64_t[]", stamps), ffi.from_buffer("double[]", values), points
+        )
+        tsp_gorilla_rewind(self._reader)
+        if count != points:
+            raise OSError(f"File {self.filename} is corrupt")
+        return stamps, values
+
+    def __len__(self) -> int:
+        return int(tsp_gorilla_points(self._reader))
+
+    def __iter__(self) -> Iterator[float]:
+        """Start decoding the file from the beginning.
+
+        :return: An iterator yielding values of the file
+        """
+        tsp_gorilla_rewind(self._reader)
+        tsp_reset_handler(self.handler)
+        return self
+
+    def __next__(self) -> float:
+        res = tsp_next_chain(self.handler, 4096)
+        if res != ffi.NULL:
+            return cast(float, res[0])
+        self.check()
+        raise StopIteration
+
+    def check(self) -> None:
+        """Raise if decoding stopped at a corrupt chunk.
+
+        Native chains reading the provider end at the corrupt chunk, they call this
+        method when they end (see :meth:`Handler.check`).
+
+        :raises OSError: If a chunk of the file is corrupt
+        """
+        if tsp_gorilla_failed(self._reader):
+            raise OSError(f"File {self.filename} is corrupt")
+
+    def __del__(self) -> None:
+        if not hasattr(self, "_reader"):
+            return
+        if hasattr(self, "handler"):
+            tsp_free_handler(self.handler)
+        tsp_gorilla_close(self._reader)
@@ -0,0 +1,130 @@
+from collections.abc import Iterator
+from dataclasses import dataclass
+
+import cffi
+
+from pysatl_tsp._c.lib import (
+    tsp_fill_replay,
+    tsp_free_handler,
+    tsp_free_replay,
+    tsp_init_source,
+    tsp_replay_init,
+    tsp_replay_reset,
+    tsp_replay_stats,
+)
+from pysatl_tsp.core.native import resolve_option
+
+from .tsf_data_provider import Timestamp, TSFDataProvider
+
+ffi = cffi.FFI()
+
+__all__ = ["ReplayDataProvider", "ReplayStats"]
+
+# Nanoseconds per unit of recording timestamps
+TIME_UNITS = {"s": 1_000_000_000, "ms": 1_000_000, "us": 1_000, "ns": 1}
+
+
+@dataclass(frozen=True)
+class ReplayStats:
+    """How far a paced replay fell behind its schedule.
+
+    The lag of a value is the time between its scheduled and its actual emission.
+    It stays around a microsecond while the consumer keeps up and grows when it doesn't.
+
+    :param emitted: Number of emitted values
+    :param max_lag: Largest lag of a value, seconds
+    :param mean_lag: Mean lag of the emitted values, seconds
+    :param last_lag: Lag of the last emitted value, seconds
+    """
+
+    emitted: int
+    max_lag: float
+    mean_lag: float
+    last_lag: float
+
+
+class ReplayDataProvider(TSFDataProvider):
+    """A data provider that replays a TSF recording at a controlled speed.
+
+    Values are served from the memory-mapped file like by :class:`TSFDataProvider`.
+    With a speed factor, every value is held back until its timestamp, scaled by the
+    speed, is reached on the monotonic clock: the replay sleeps until shortly before
+    the due time and spins for the rest. Values that are already due are served in one
+    block, so a consumer that falls behind catches up in larger blocks, and its delay
+    is reported by :attr:`stats`. Pacing runs in C, without the GIL.
+
+    :param filename: Path to a file written by :class:`TSFWriter`
+    :param column: Zero-based index of the value column to serve, defaults to 0
+    :param speed: Replay speed factor (1 is real time, 10 is ten times faster),
+                  None replays as fast as possible, defaults to 1
+    :param start: First timestamp to serve (inclusive), defaults to the beginning of the file
+    :param end: Last timestamp to serve (exclusive), defaults to the end of the file
+    :param time_unit: Unit of the recording timestamps, "s", "ms", "us" or "ns" (datetimes
+                      are stored as nanoseconds), defaults to "ns"
+    :param spin: Final part of every wait spent spinning instead of sleeping, seconds;
+                 higher values give more precise pacing at the cost of CPU, defaults to 0.0002
+
+    :raises FileNotFoundError: If the specified file does not exist
+    :raises OSError: If the file is not a valid TSF file
+    :raises ValueError: If the column does not exist, the speed is not positive or the unit is unknown
+
+    Example:
+        ```python
+        # Check whether a pipeline keeps up with ten times the recorded rate
+        replay = ReplayDataProvider("btcusdt.tsf", speed=10)
+        for value in replay | CEMAHandler(length=20):
+            pass
+        print(replay.stats.max_lag)
+        ```
+    """
+
+    def __init__(
+        self,
+        filename: str,
+        column: int = 0,
+        speed: float | None = 1.0,
+        start: Timestamp | None = None,
+        end: Timestamp | None = None,
+        time_unit: str = "ns",
+        spin: float = 0.0002,
+    ) -> None:
+        super().__init__(filename, column, start, end)
+        if speed is not None and speed <= 0:
+            raise ValueError("Replay speed must be positive")
+        if spin < 0:
+            raise ValueError("Spin time must not be negative")
+        self.speed = speed
+        self.time_unit = time_unit
+        ns_per_unit = resolve_option("time unit", time_unit, TIME_UNITS)
+        replay = tsp_replay_init(self._reader, speed or 0.0, ns_per_unit, int(spin * 1e9))
+        if replay == ffi.NULL:
+            raise MemoryError("Could not initialize replay")
+        self._replay = replay
+        tsp_free_handler(self.handler)
+        self.handler = tsp_init_source(ffi.cast("void *", self._replay), tsp_fill_replay)
+
+    @property
+    def stats(self) -> ReplayStats:
+        """Get the lag statistics of the current replay.
+
+        :return: Statistics since the replay was (re)started
+        """
+        emitted, max_lag = ffi.new("long *"), ffi.new("int64_t *")
+        mean_lag, last_lag = ffi.new("double *"), ffi.new("int64_t *")
+        tsp_replay_stats(self._replay, emitted, max_lag, mean_lag, last_lag)
+        return ReplayStats(emitted[0], max_lag[0] / 1e9, mean_lag[0] / 1e9, last_lag[0] / 1e9)
+
+    def __iter__(self) -> Iterator[float]:
+        """Start the replay from the beginning of the selected range.
+
+        The schedule and the statistics are restarted, the first value is served at once.
+
+        :return: An iterator yielding values of the selected column
+        """
+        tsp_replay_reset(self._replay)
+        return super().__iter__()
+
+    def __del__(self) -> None:
+        if hasattr(self, "_replay"):
+            tsp_free_replay(self._replay)
+        super().__del__()
@@ -1,4 +1,8 @@
-from collections.abc import Iterable, Iterator
+import asyncio
+from collections.abc import AsyncIterator, Iterable, Iterator
+from itertools import islice
+
+from pysatl_tsp.core.handler import ASYNC_BATCH_SIZE
 
 from .abstract import DataProvider, T
 
@@ -32,3 +36,16 @@ class SimpleDataProvider(DataProvider[T]):
         :return: An iterator yielding items from the data collection
         """
         yield from self.data
+
+    async def abatches(self) -> AsyncIterator[list[T]]:
+        """Create an asynchronous iterator over the data collection in batches.
+
+        The data is already in memory, so batches of ``ASYNC_BATCH_SIZE`` items are
+        yielded at once, giving control back to the event loop between them.
+
+        :return: An asynchronous iterator yielding lists of items from the data collection
+        """
+        iterator = iter(self.data)
+        while batch := list(islice(iterator, ASYNC_BATCH_SIZE)):
+            yield batch
+            await asyncio.sleep(0)
@@ -0,0 +1,369 @@
+import contextlib
+import os
+from collections.abc import Iterable, Iterator, Sequence
+from dataclasses import dataclass
+from datetime import datetime, timedelta
+from types import TracebackType
+from typing import Any, cast
+
+import cffi
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c.lib import (
+    TSP_TSF_FLOAT64,
+    TSP_TSF_INT64,
+    TSP_TSF_UNREPRESENTABLE,
+    tsp_fill_tsf,
+    tsp_free_handler,
+    tsp_init_source,
+    tsp_next_chain,
+    tsp_reset_handler,
+    tsp_tsf_chunk_info,
+    tsp_tsf_close,
+    tsp_tsf_column_type,
+    tsp_tsf_drain,
+    tsp_tsf_lower_bound,
+    tsp_tsf_nchunks,
+    tsp_tsf_ncolumns,
+    tsp_tsf_open,
+    tsp_tsf_read,
+    tsp_tsf_read_int64,
+    tsp_tsf_read_timestamps,
+    tsp_tsf_rows,
+    tsp_tsf_select,
+    tsp_tsf_write_columns,
+    tsp_tsf_writer_close,
+    tsp_tsf_writer_open,
+)
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.native import resolve_option
+
+from .abstract import DataProvider
+
+ffi = cffi.FFI()
+
+__all__ = ["TSFChunk", "TSFDataProvider", "TSFWriter", "Timestamp"]
+
+# Column types of TSF files
+TSF_TYPES = {"float64": TSP_TSF_FLOAT64, "int64": TSP_TSF_INT64}
+
+Timestamp = int | datetime | np.datetime64
+
+
+def to_timestamp(value: Timestamp) -> int:
+    """Convert a timestamp to the integer stored in TSF files.
+
+    Integers are stored as is; datetimes are converted to nanoseconds since the epoch
+    (naive datetimes are taken as UTC).
+
+    :param value: Integer timestamp or datetime
+    :return: Integer timestamp
+    """
+    if isinstance(value, np.datetime64):
+        return int(value.astype("datetime64[ns]").astype(np.int64))
+    if isinstance(value, datetime):
+        utc = value.replace(tzinfo=None) - (value.utcoffset() or timedelta(0))
+        return int(np.datetime64(utc, "ns").astype(np.int64))
+    return int(value)
+
+
+@dataclass(frozen=True)
+class TSFChunk:
+    """Index entry of a TSF chunk.
+
+    :param rows: Number of rows in the chunk
+    :param first: First timestamp of the chunk
+    :param last: Last timestamp of the chunk
+    :param min: Minimum of every column, NaN values ignored
+    :param max: Maximum of every column, NaN values ignored
+    """
+
+    rows: int
+    first: int
+    last: int
+    min: tuple[float, ...]
+    max: tuple[float, ...]
+
+
+def _to_int64(column: npt.NDArray[Any]) -> npt.NDArray[np.int64]:
+    """Convert a column to int64, rejecting values that int64 cannot hold instead of wrapping them."""
+    # Python ints of object columns are exact, only the other values are checked as floats
+    if column.dtype == object:
+        checked = np.array([v for v in column if not isinstance(v, (int, np.integer))], dtype=np.float64)
+    else:
+        checked = column
+    if checked.dtype.kind == "f" and not np.all((checked >= -(2.0**63)) & (checked < 2.0**63)):
+        raise ValueError("Missing or out-of-range values cannot be stored in an int64 column")
+    return column.astype(np.int64)
+
+
+class TSFWriter:
+    """Writer of chunked columnar time series files (TSF).
+
+    A TSF file stores int64 timestamps and float64/int64 columns in chunks of a fixed
+    number of rows, followed by an index of chunk offsets, first/last timestamps and
+    per-chunk min/max. Files are read back by :class:`TSFDataProvider`. Timestamps must
+    be non-decreasing; their unit is up to the user (datetimes are stored as nanoseconds).
+
+    The writer is a context manager, the index is written when it is closed.
+
+    :param filename: Path to the file, an existing file is overwritten
+    :param dtypes: Types of the value columns, "float64" or "int64", defaults to one float64 column
+    :param chunk_rows: Number of rows per chunk, defaults to 65536
+    :raises ValueError: If a column type is unknown or chunk_rows is not positive
+    :raises OSError: If the file cannot be created
+    """
+
+    def __init__(self, filename: str, dtypes: Sequence[str] = ("float64",), chunk_rows: int = 65536) -> None:
+        if not dtypes or chunk_rows < 1:
+            raise ValueError("TSF file needs at least one column and one row per chunk")
+        types = [resolve_option("column type", dtype, TSF_TYPES) for dtype in dtypes]
+        self.filename = filename
+        self.dtypes = tuple(dtypes)
+        self.chunk_rows = chunk_rows
+        self._writer = None
+        writer = tsp_tsf_writer_open(os.fsencode(filename), len(types), types, chunk_rows)
+        if writer == ffi.NULL:
+            raise OSError(f"Could not create file {filename}")
+        self._writer = writer
+
+    def _check_open(self) -> None:
+        if self._writer is None:
+            raise ValueError("Writer is closed")
+
+    def write(self, timestamps: Sequence[Timestamp] | npt.ArrayLike, values: npt.ArrayLike) -> None:
+        """Append rows.
+
+        Every column is passed to the file in its own type, so int64 columns keep integers
+        beyond 2**53 exactly (when values is an integer array, or a list of Python ints).
+
+        :param timestamps: Non-decreasing timestamps of the rows
+        :param values: Values of shape (rows,) for a single column or (rows, columns)
+        :raises ValueError: If shapes don't match, timestamps decrease or an int64 column gets
+                            a missing, infinite or out-of-range value
+        """
+        self._check_open()
+        stamps = np.ascontiguousarray([to_timestamp(t) for t in cast(Iterable[Timestamp], timestamps)], np.int64)
+        # Lists keep Python ints as objects, converting them to float64 first would round them
+        data = values if isinstance(values, np.ndarray) else np.array(values, dtype=object)
+        if not len(stamps) and not data.size:
+            return
+        data = data.reshape(len(stamps), -1)
+        if data.shape[1] != len(self.dtypes):
+            raise ValueError(f"Expected {len(self.dtypes)} columns, got {data.shape[1]}")
+        columns = [
+            np.ascontiguousarray(_to_int64(data[:, j]) if dtype == "int64" else data[:, j].astype(np.float64))
+            for j, dtype in enumerate(self.dtypes)
+        ]
+        pointers = ffi.new("void *[]", [ffi.from_buffer(column) for column in columns])
+        if tsp_tsf_write_columns(self._writer, ffi.from_buffer("int64_t[]", stamps), pointers, len(stamps)):
+            raise ValueError("Could not write rows, timestamps must be non-decreasing")
+
+    def drain(self, source: Handler[Any, float | None], start: Timestamp = 0, step: int = 1) -> int:
+        """Write all values produced by a handler to a single-column file.
+
+        Native pipelines (handlers with a ``handler`` attribute) are drained by the C
+        library without Python per value. Missing values (None) are stored as NaN.
+
+        :param source: Handler producing the values
+        :param start: Timestamp of the first value, defaults to 0
+        :param step: Difference between consecutive timestamps, defaults to 1
+        :return: Number of written values
+        :raises ValueError: If the file has more than one column or writing fails
+        :raises Exception: The error of a failed native source (see :meth:`Handler.check`)
+        """
+        self._check_open()
+        if len(self.dtypes) != 1:
+            raise ValueError("Only single-column files can be drained into")
+        first = to_timestamp(start)
+        iterator = iter(source)
+        if hasattr(source, "handler"):
+            count = int(tsp_tsf_drain(self._writer, source.handler, first, step))
+            if count == TSP_TSF_UNREPRESENTABLE:
+                raise ValueError("Missing or out-of-range values cannot be stored in an int64 column")
+            if count < 0:
+                raise ValueError("Could not write values, timestamps must be non-decreasing")
+            source.check()
+            return count
+        count = 0
+        block: list[float] = []
+        for value in iterator:
+            block.append(np.nan if value is None else value)
+            if len(block) == self.chunk_rows:
+                self.write(np.arange(len(block), dtype=np.int64) * step + first + count * step, np.array(block))
+                count += len(block)
+                block = []
+        self.write(np.arange(len(block), dtype=np.int64) * step + first + count * step, np.array(block, np.float64))
+        return count + len(block)
+
+    def close(self) -> None:
+        """Write the pending chunk and the index, and close the file.
+
+        :raises OSError: If the file cannot be written
+        """
+        if self._writer is None:
+            return
+        writer, self._writer = self._writer, None
+        if tsp_tsf_writer_close(writer) != 0:
+            raise OSError(f"Could not write file {self.filename}")
+
+    def __enter__(self) -> "TSFWriter":
+        return self
+
+    def __exit__(
+        self, exc_type: type[BaseException] | None, exc: BaseException | None, traceback: TracebackType | None
+    ) -> None:
+        self.close()
+
+    def __del__(self) -> None:
+        if getattr(self, "_writer", None) is not None:
+            # Finalizers must not raise, an unwritable file is reported by an explicit close()
+            with contextlib.suppress(OSError):
+                self.close()
+
+
+class TSFDataProvider(DataProvider[float]):
+    """A data provider that serves a column of a chunked columnar time series file (TSF).
+
+    The file is memory-mapped. Float64 columns are passed to native handlers
+    (``C*Handler``) straight from the mapping, in blocks, without copying. A time range
+    is located with a binary search over the chunk index, so reading one hour of a
+    multi-year file doesn't scan the rest of it.
+
+    :param filename: Path to a file written by :class:`TSFWriter`
+    :param column: Zero-based index of the value column to serve, defaults to 0
+    :param start: First timestamp to serve (inclusive), defaults to the beginning of the file
+    :param end: Last timestamp to serve (exclusive), defaults to the end of the file
+
+    :raises FileNotFoundError: If the specified file does not exist
+    :raises OSError: If the file is not a valid TSF file
+    :raises ValueError: If the column does not exist
+    """
+
+    def __init__(
+        self,
+        filename: str,
+        column: int = 0,
+        start: Timestamp | None = None,
+        end: Timestamp | None = None,
+    ) -> None:
+        super().__init__()
+        if not os.path.exists(filename):
+            raise FileNotFoundError(filename)
+        self.filename = filename
+        reader = tsp_tsf_open(os.fsencode(filename))
+        if reader == ffi.NULL:
+            raise OSError(f"File {filename} is not a valid TSF file")
+        self._reader = reader
+        self.handler = tsp_init_source(ffi.cast("void *", self._reader), tsp_fill_tsf)
+        if not 0 <= column < tsp_tsf_ncolumns(self._reader):
+            raise ValueError(f"Column {column} does not exist")
+        self.column = column
+        self.start = start
+        self.end = end
+
+    @property
+    def dtypes(self) -> tuple[str, ...]:
+        """Get the types of the value columns.
+
+        :return: "float64" or "int64" for every column
+        """
+        names = {code: name for name, code in TSF_TYPES.items()}
+        return tuple(names[tsp_tsf_column_type(self._reader, j)] for j in range(tsp_tsf_ncolumns(self._reader)))
+
+    @property
+    def chunks(self) -> list[TSFChunk]:
+        """Get the chunk index of the file.
+
+        :return: Index entries in file order
+        """
+        ncolumns = tsp_tsf_ncolumns(self._reader)
+        rows, first, last = ffi.new("long *"), ffi.new("int64_t *"), ffi.new("int64_t *")
+        low, high = ffi.new("double[]", ncolumns), ffi.new("double[]", ncolumns)
+        chunks = []
+        for i in range(tsp_tsf_nchunks(self._reader)):
+            tsp_tsf_chunk_info(self._reader, i, rows, first, last, low, high)
+            chunks.append(TSFChunk(rows[0], first[0], last[0], tuple(low), tuple(high)))
+        return chunks
+
+    def rows(self, start: Timestamp | None = None, end: Timestamp | None = None) -> tuple[int, int]:
+        """Locate a time range in the file using the chunk index.
+
+        :param start: First timestamp (inclusive), defaults to the beginning of the file
+        :param end: Last timestamp (exclusive), defaults to the end of the file
+        :return: Row numbers [first, last) of the range
+        """
+        first = 0 if start is None else int(tsp_tsf_lower_bound(self._reader, to_timestamp(start)))
+        last = tsp_tsf_rows(self._reader) if end is None else int(tsp_tsf_lower_bound(self._reader, to_timestamp(end)))
+        return first, max(first, last)
+
+    def read(
+        self, start: Timestamp | None = None, end: Timestamp | None = None, columns: Sequence[int] | None = None
+    ) -> tuple[npt.NDArray[np.int64], npt.NDArray[np.float64]]:
+        """Read a time range into arrays.
+
+        :param start: First timestamp (inclusive), defaults to the beginning of the file
+        :param end: Last timestamp (exclusive), defaults to the end of the file
+        :param columns: Columns to read, defaults to all columns
+        :return: Timestamps of shape (rows,) and values of shape (rows, len(columns)),
+                 int64 columns are converted to float64, see :meth:`read_column` to read them exactly
+        """
+        selected = range(tsp_tsf_ncolumns(self._reader)) if columns is None else columns
+        first, last = self.rows(start, end)
+        stamps = np.empty(last - first, dtype=np.int64)
+        tsp_tsf_read_timestamps(self._reader, first, len(stamps), ffi.from_buffer("int64_t[]", stamps))
+        values = np.empty((len(selected), last - first), dtype=np.float64)
+        for k, column in enumerate(selected):
+            tsp_tsf_read(self._reader, column, first, last - first, ffi.from_buffer("double[]", values[k]))
+        return stamps, values.T
+
+    def read_column(
+        self, column: int, start: Timestamp | None = None, end: Timestamp | None = None
+    ) -> npt.NDArray[Any]:
+        """Read a time range of one column in its own type.
+
+        :param column: Zero-based index of the value column
+        :param start: First timestamp (inclusive), defaults to the beginning of the file
+        :param end: Last timestamp (exclusive), defaults to the end of the file
+        :return: float64 or int64 array of the column values
+        :raises ValueError: If the column does not exist
+        """
+        if not 0 <= column < tsp_tsf_ncolumns(self._reader):
+            raise ValueError(f"Column {column} does not exist")
+        first, last = self.rows(start, end)
+        if self.dtypes[column] == "int64":
+            values = np.empty(last - first, dtype=np.int64)
+            tsp_tsf_read_int64(self._reader, column, first, len(values), ffi.from_buffer("int64_t[]", values))
+        else:
+            values = np.empty(last - first, dtype=np.float64)
+            tsp_tsf_read(self._reader, column, first, len(values), ffi.from_buffer("double[]", values))
+        return values
+
+    def __len__(self) -> int:
+        first, last = self.rows(self.start, self.end)
+        return last - first
+
+    def __iter__(self) -> Iterator[float]:
+        """Start serving the selected column and time range from the beginning.
+
+        :return: An iterator yielding values of the selected column
+        """
+        first, last = self.rows(self.start, self.end)
+        tsp_tsf_select(self._reader, self.column, first, last)
+        tsp_reset_handler(self.handler)
+        return self
+
+    def __next__(self) -> float:
+        res = tsp_next_chain(self.handler, 4096)
+        if res != ffi.NULL:
+            return cast(float, res[0])
+        else:
+            raise StopIteration
+
+    def __del__(self) -> None:
+        if not hasattr(self, "_reader"):
+            return
+        if hasattr(self, "handler"):
+            tsp_free_handler(self.handler)
+        tsp_tsf_close(self._reader)
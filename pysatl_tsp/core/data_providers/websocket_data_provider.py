@@ -1,14 +1,16 @@
 import asyncio
+import contextlib
 import json
-import queue
 import threading
-from collections.abc import Iterator
+from collections.abc import AsyncIterator, Iterator
 from typing import (
     Any,
 )
 
 import websockets
 
+from pysatl_tsp.core.ring import MessageRing
+
 from .abstract import DataProvider
 
 
@@ -20,8 +22,22 @@ class WebSocketDataProvider(DataProvider[str]):
     in a separate thread to avoid blocking the main processing flow and provides
     a clean streaming interface through the standard iterator protocol.
 
+    Messages are passed from the receiver thread to the iterator through a bounded
+    lock-free ring (:class:`~pysatl_tsp.core.ring.MessageRing`) and drained in batches.
+    When the pipeline can't keep up, the overflow policy decides whether the receiver
+    waits ("block"), drops the oldest messages ("drop_oldest") or drops the whole
+    backlog ("conflate").
+
+    Under ``async for`` no thread is involved: the connection is served by the
+    running event loop, messages are handed to the pipeline as soon as it awaits
+    them, together with all the messages that arrived in the meantime. Up to
+    ``capacity`` messages wait for the pipeline, then the connection is not read
+    further until it catches up.
+
     :param uri: WebSocket endpoint URI
     :param subscribe_message: Optional message to send after connection to subscribe to specific data streams
+    :param capacity: Maximum number of queued messages, defaults to 65536
+    :param overflow: Overflow policy of the queue, defaults to "block"
 
     Example:
         ```python
@@ -43,18 +59,30 @@ class WebSocketDataProvider(DataProvider[str]):
         ```
     """
 
-    def __init__(self, uri: str, subscribe_message: dict[str, Any] | None = None) -> None:
+    def __init__(
+        self,
+        uri: str,
+        subscribe_message: dict[str, Any] | None = None,
+        capacity: int = 65536,
+        overflow: str = "block",
+    ) -> None:
         """Initialize a WebSocket data provider.
 
         :param uri: WebSocket endpoint URI
         :param subscribe_message: Optional message to send after connection to subscribe to specific data streams
+        :param capacity: Maximum number of queued messages, defaults to 65536
+        :param overflow: Overflow policy of the queue, defaults to "block"
+        :raises ValueError: If the capacity is not positive or the policy is unknown
         """
         super().__init__()
         self._uri = uri
         self._subscribe_message = subscribe_message
-        self._iterator_queue: queue.Queue[str] = queue.Queue()
+        self._iterator_queue = MessageRing(capacity, overflow)
+        self._capacity = capacity
         self._stop_event = threading.Event()
         self._thread: threading.Thread | None = None
+        # Receiving tasks of asynchronous iterations and their loops, cancelled by close()
+        self._readers: set[tuple[asyncio.AbstractEventLoop, asyncio.Task[None]]] = set()
 
     def __iter__(self) -> Iterator[str]:
         """Create an iterator over the messages received from the WebSocket.
@@ -64,15 +92,96 @@ class WebSocketDataProvider(DataProvider[str]):
 
         :return: An iterator yielding message strings from the WebSocket
         """
+        self._start()
+        while not self._stop_event.is_set():
+            yield from self._iterator_queue.get_batch(timeout=1)
+
+    async def abatches(self) -> AsyncIterator[list[str]]:
+        """Create an asynchronous iterator over the messages received from the WebSocket.
+
+        The connection is opened in the running event loop, so messages are awaited
+        directly instead of being passed through the receiver thread. A task of the
+        loop receives them while the pipeline is busy, every batch holds all the
+        messages received since the previous one. Iteration ends when the connection
+        is closed or :meth:`close` is called, even while no messages arrive.
+
+        :return: An asynchronous iterator yielding batches of messages
+        :raises websockets.exceptions.WebSocketException: If the connection fails
+        """
+        if self._stop_event.is_set():
+            return
+        async with websockets.connect(self._uri) as ws:
+            if self._subscribe_message is not None:
+                await ws.send(json.dumps(self._subscribe_message))
+            messages: asyncio.Queue[str] = asyncio.Queue(self._capacity)
+            reader = asyncio.create_task(self._areceive(ws, messages))
+            registration = (asyncio.get_running_loop(), reader)
+            self._readers.add(registration)
+            try:
+                while not self._stop_event.is_set():
+                    getter = asyncio.ensure_future(messages.get())
+                    await asyncio.wait((getter, reader), return_when=asyncio.FIRST_COMPLETED)
+                    if not getter.done():
+                        # The connection is closed, hand over what it delivered before
+                        getter.cancel()
+                        if not messages.empty() and not self._stop_event.is_set():
+                            yield self._drain(messages, [])
+                        break
+                    yield self._drain(messages, [getter.result()])
+                if reader.done() and not reader.cancelled():
+                    reader.result()  # Raises the error that ended the connection
+            finally:
+                self._readers.discard(registration)
+                if not reader.done():
+                    reader.cancel()
+                    with contextlib.suppress(asyncio.CancelledError):
+                        await reader
+
+    @staticmethod
+    async def _areceive(ws: Any, messages: "asyncio.Queue[str]") -> None:
+        """Receive messages of an asynchronous iteration, waiting while the queue is full.
+
+        :param ws: The open connection
+        :param messages: Queue the iteration takes the messages from
+        """
+        async for msg in ws:
+            if msg is not None:
+                await messages.put(str(msg))
+
+    @staticmethod
+    def _drain(messages: "asyncio.Queue[str]", batch: list[str]) -> list[str]:
+        """Append the messages already queued to a batch.
+
+        :param messages: Queue of received messages
+        :param batch: Messages taken so far
+        :return: The batch
+        """
+        while not messages.empty():
+            batch.append(messages.get_nowait())
+        return batch
+
+    def iter_raw_batches(self, batch_size: int = 1024) -> Iterator[tuple[Any, int]]:
+        """Create an iterator over batches of native messages, for consumers written in C.
+
+        Like iteration, starts the receiver thread if needed. The consumer owns the
+        messages of every batch and frees them with ``tsp_ring_free_msg``.
+
+        :param batch_size: Maximum number of messages per batch, defaults to 1024
+        :return: An iterator yielding arrays of ``struct tsp_ring_msg *`` and their lengths
+        """
+        self._start()
+        while not self._stop_event.is_set():
+            batch, count = self._iterator_queue.get_raw_batch(batch_size, timeout=1)
+            if count < 0:
+                return
+            if count > 0:
+                yield batch, count
+
+    def _start(self) -> None:
+        """Start the background thread if it's not running."""
         if self._thread is None or not self._thread.is_alive():
             self._thread = threading.Thread(target=self._thread_main, daemon=True)
             self._thread.start()
-        while not self._stop_event.is_set():
-            try:
-                item = self._iterator_queue.get(timeout=1)
-                yield item
-            except queue.Empty:
-                continue
 
     def _thread_main(self) -> None:
         """Entry point for the background thread.
@@ -107,5 +216,10 @@ class WebSocketDataProvider(DataProvider[str]):
         to release resources properly.
         """
         self._stop_event.set()
+        self._iterator_queue.close()
+        for loop, reader in list(self._readers):
+            # The loop may be gone already, then there is nothing left to wake
+            with contextlib.suppress(RuntimeError):
+                loop.call_soon_threadsafe(reader.cancel)
         if self._thread is not None:
             self._thread.join(timeout=2)
@@ -0,0 +1,141 @@
+import os
+from dataclasses import dataclass
+from typing import Any
+
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import tsp_executor_run, tsp_free_values
+from pysatl_tsp.core import Handler
+
+__all__ = ["JobResult", "PipelineExecutor"]
+
+
+@dataclass(frozen=True)
+class JobResult:
+    """Output and timing of a job run by :class:`PipelineExecutor`.
+
+    :param values: Output values of the pipeline, missing values (None) as NaN
+    :param worker: Index of the worker thread that ran the job
+    :param start: Seconds from the start of the first job of the run to the start of this one
+    :param seconds: Time the job took, in seconds
+    """
+
+    values: npt.NDArray[np.float64]
+    worker: int
+    start: float
+    seconds: float
+
+
+class PipelineExecutor:
+    """Runs many independent native pipelines to completion on a pool of threads.
+
+    Jobs are submitted as native pipelines (with a ``handler`` attribute, e.g. built from
+    ``C*Handler``) and run by :meth:`run` on native worker threads, each job drained into
+    its own output array like :meth:`Handler.to_numpy`. Every worker has a deque of jobs,
+    dealt in order of decreasing ``size_hint``; a worker that runs out of jobs steals from
+    the worker with the most jobs left, so series of uneven lengths keep all cores busy
+    without a shared queue. The GIL is released for the whole run.
+
+    Pipelines reading a native source (``CFileDataProvider``, ``ArrowDataProvider``,
+    ``TSFDataProvider``, ``GorillaDataProvider``...) run in parallel from the source to the
+    output. Pipelines reading a Python source still run, but take the GIL for every block
+    of the source, which serializes that part. Every job must have its own handlers: a
+    pipeline, or a handler of it, must not be shared by two jobs of a run.
+
+    :param workers: Number of worker threads, defaults to None (the number of CPUs)
+    :raises ValueError: If workers is not positive
+
+    Example:
+        ```python
+        executor = PipelineExecutor()
+        for path in symbol_files:
+            executor.submit(CEMAHandler(length=20), source=CFileDataProvider(path, column=4, skip_rows=1))
+        for path, result in zip(symbol_files, executor.run()):
+            np.save(path + ".ema.npy", result.values)
+            print(path, result.seconds)
+        ```
+    """
+
+    def __init__(self, workers: int | None = None) -> None:
+        if workers is not None and workers < 1:
+            raise ValueError("Number of workers must be positive")
+        self.workers = workers or os.cpu_count() or 1
+        self._pipelines: list[Handler[Any, Any]] = []
+        self._handlers: list[Any] = []
+        self._size_hints: list[int] = []
+        self._chains: set[int] = set()
+
+    def __len__(self) -> int:
+        """Get the number of jobs waiting for :meth:`run`.
+
+        :return: Number of submitted jobs
+        """
+        return len(self._pipelines)
+
+    def submit(self, pipeline: Handler[Any, Any], source: Handler[Any, Any] | None = None, size_hint: int = 0) -> int:
+        """Add a job for the next :meth:`run`.
+
+        :param pipeline: Native pipeline to run, with its source unless source is given
+        :param source: Source to connect the pipeline to, defaults to None (already connected)
+        :param size_hint: Expected number of output values, preallocates the output and
+                          runs larger jobs first, defaults to 0 (unknown)
+        :return: Index of the job's result in the list returned by :meth:`run`
+        :raises ValueError: If the pipeline is not native, or it or one of its handlers is already submitted
+        """
+        if source is not None:
+            pipeline = source | pipeline
+        if not hasattr(pipeline, "handler"):
+            raise ValueError(f"Only native pipelines can be submitted, {type(pipeline).__name__} is not native")
+        # Every native handler of the chain, down to its native source
+        chain: set[int] = set()
+        handler = pipeline.handler
+        while handler != ffi.NULL:
+            chain.add(int(ffi.cast("uintptr_t", handler)))
+            handler = handler.src
+        if not self._chains.isdisjoint(chain):
+            raise ValueError("Pipeline or one of its handlers is already submitted")
+        self._chains |= chain
+        self._pipelines.append(pipeline)
+        self._handlers.append(pipeline.handler)
+        self._size_hints.append(size_hint)
+        return len(self._pipelines) - 1
+
+    def run(self) -> list[JobResult]:
+        """Run all submitted jobs to completion and forget them.
+
+        :return: Results of the jobs, in submission order
+        :raises MemoryError: If the jobs or an output cannot be allocated
+        :raises Exception: The error of a failed native source of a job (see :meth:`Handler.check`)
+        """
+        pipelines, self._pipelines = self._pipelines, []
+        handlers, self._handlers = self._handlers, []
+        size_hints, self._size_hints = self._size_hints, []
+        self._chains = set()
+        # Iterating connects every chain to its source, the iterators must live until the end of the run
+        iterators = [iter(pipeline) for pipeline in pipelines]
+        jobs = ffi.new("struct tsp_job[]", len(pipelines))
+        for job, handler, size_hint in zip(jobs, handlers, size_hints):
+            job.chain = handler
+            job.size_hint = size_hint
+        if tsp_executor_run(jobs, len(pipelines), self.workers) < 0:
+            raise MemoryError("Could not allocate memory to run the jobs")
+        iterators.clear()
+
+        # Outputs are owned by the arrays, also when a later job failed
+        outputs = [ffi.gc(job.values, tsp_free_values) for job in jobs if job.values != ffi.NULL]
+        if len(outputs) < len(pipelines):
+            raise MemoryError("Could not allocate memory for the output values")
+        for pipeline in pipelines:
+            pipeline.check()
+        first = min((job.start_ns for job in jobs), default=0)
+        return [
+            JobResult(
+                values=np.frombuffer(ffi.buffer(values, ffi.sizeof("double") * job.length), np.float64),
+                worker=job.worker,
+                start=(job.start_ns - first) / 1e9,
+                seconds=(job.end_ns - job.start_ns) / 1e9,
+            )
+            for job, values in zip(jobs, outputs)
+        ]
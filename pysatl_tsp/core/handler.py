@@ -1,23 +1,29 @@
 from __future__ import annotations
 
+import asyncio
 from abc import ABC, abstractmethod
-from collections.abc import Iterator
+from collections.abc import AsyncIterator, Iterator
 from typing import (
     Any,
     Generic,
     TypeVar,
 )
 
-import cffi
+import numpy as np
+import numpy.typing as npt
 
-ffi = cffi.FFI()
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import tsp_drain_chain, tsp_free_values
 
-__all__ = ["Handler", "T", "U", "V"]
+__all__ = ["ASYNC_BATCH_SIZE", "Handler", "T", "U", "V"]
 
 T = TypeVar("T")
 U = TypeVar("U")
 V = TypeVar("V")
 
+# Items a synchronous stage may produce during asynchronous iteration before yielding to the event loop
+ASYNC_BATCH_SIZE = 1024
+
 
 class Handler(ABC, Generic[T, U]):
     """Abstract base class for time series processing handlers.
@@ -65,6 +71,76 @@ class Handler(ABC, Generic[T, U]):
         """
         pass
 
+    def __aiter__(self) -> AsyncIterator[U]:
+        """Create an asynchronous iterator over the output data produced by this handler.
+
+        Items are taken from :meth:`abatches`, so ``async for`` works with every handler.
+
+        :return: An asynchronous iterator yielding processed data items
+        """
+        return self._aiter_items()
+
+    async def _aiter_items(self) -> AsyncIterator[U]:
+        """Flatten the batches of :meth:`abatches` into single items."""
+        async for batch in self.abatches():
+            for item in batch:
+                yield item
+
+    async def abatches(self) -> AsyncIterator[list[U]]:
+        """Create an asynchronous iterator over batches of output data.
+
+        Handlers that can await their source override this method: providers await
+        incoming data, processors transform whatever batch their source has ready.
+        The default implementation runs the synchronous iterator, yields every item
+        as soon as it is produced and gives control back to the event loop every
+        ``ASYNC_BATCH_SIZE`` items. It blocks the loop while the synchronous source
+        waits for data, so handlers on live sources should override it.
+
+        :return: An asynchronous iterator yielding non-empty lists of processed items
+        """
+        for count, item in enumerate(self, 1):
+            yield [item]
+            if count % ASYNC_BATCH_SIZE == 0:
+                await asyncio.sleep(0)
+
+    def check(self) -> None:
+        """Raise the error a native source hit while the C library pulled values from it.
+
+        A native source can't raise while a chain runs in C: when it fails, it ends its
+        data and keeps the error. Consumers that run chains in C (:meth:`to_numpy`, native
+        handlers, the executor...) call this method once the chain has ended, so a failure
+        is not mistaken for the end of the data. Handlers check their source, native
+        sources override it to raise their own error.
+
+        :raises Exception: The error of a failed source
+        """
+        if self.source is not None:
+            self.source.check()
+
+    def to_numpy(self, n_hint: int = 0) -> npt.NDArray[np.float64]:
+        """Run the handler to completion and collect its output into one array.
+
+        Native handlers and pipelines (with a ``handler`` attribute) are drained by the
+        C library: one loop from the source to a growable buffer, which becomes the
+        array without copying and without a Python float per value. Other handlers
+        are iterated in Python. Missing values (None) are stored as NaN.
+
+        :param n_hint: Expected number of values, preallocates the buffer, defaults to 0 (unknown)
+        :return: Array of the output values
+        :raises MemoryError: If the buffer cannot be allocated
+        :raises Exception: The error of a native source that failed (see :meth:`check`)
+        """
+        iterator = iter(self)
+        if not hasattr(self, "handler"):
+            return np.fromiter((np.nan if value is None else value for value in iterator), np.float64)
+        length = ffi.new("long *")
+        values = tsp_drain_chain(self.handler, n_hint, length)
+        if values == ffi.NULL:
+            raise MemoryError("Could not allocate memory for the output values")
+        values = ffi.gc(values, tsp_free_values)
+        self.check()
+        return np.frombuffer(ffi.buffer(values, ffi.sizeof("double") * length[0]), np.float64)
+
     def __or__(self, other: Handler[U, V]) -> Pipeline[T, V]:
         """Combine this handler with another handler using the pipe operator.
 
@@ -122,3 +198,20 @@ class Pipeline(Handler[T, V]):
         """
         self.second_iterator = iter(self.second)
         return self.second_iterator
+
+    def check(self) -> None:
+        """Raise the error a native source of the pipeline hit (see :meth:`Handler.check`).
+
+        :raises Exception: The error of a failed source
+        """
+        self.second.check()
+
+    def abatches(self) -> AsyncIterator[list[V]]:
+        """Create an asynchronous iterator over batches processed by both handlers.
+
+        The second handler awaits the batches of the first one, so asynchronous
+        sources are consumed without a bridge thread.
+
+        :return: An asynchronous iterator yielding batches processed by both handlers
+        """
+        return self.second.abatches()
@@ -0,0 +1,125 @@
+from collections.abc import Sequence
+
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_MS_EMA,
+    TSP_MS_RMA,
+    TSP_MS_SMA,
+    TSP_MS_WMA,
+    tsp_free_multiseries,
+    tsp_multiseries_init,
+    tsp_multiseries_process,
+    tsp_multiseries_reset,
+)
+from pysatl_tsp.core.native import resolve_option
+
+__all__ = ["MULTISERIES_INDICATORS", "MultiSeriesEngine"]
+
+# Indicators the engine computes, matching SMAHandler, EMAHandler, RMAHandler and WMAHandler
+MULTISERIES_INDICATORS = {"sma": TSP_MS_SMA, "ema": TSP_MS_EMA, "rma": TSP_MS_RMA, "wma": TSP_MS_WMA}
+
+
+class MultiSeriesEngine:
+    """Computes one set of indicators for many series at once.
+
+    Instead of one handler chain per series, the engine keeps the state of every
+    indicator for all series in contiguous arrays (structure of arrays) and advances
+    all series by a timestamp with a few SIMD loops, using the vector kernels selected
+    for the CPU (see :func:`pysatl_tsp.core.native.isa`). Thousands of instruments cost
+    one engine and one native call per block of timestamps.
+
+    Indicators are given as ``(kind, length)`` pairs, kinds are:
+
+    - ``"sma"``: simple moving average, like :class:`SMAHandler`
+    - ``"ema"``: exponential moving average seeded with the SMA of the first values,
+      like :class:`EMAHandler` with its defaults
+    - ``"rma"``: Wilder's moving average, like :class:`RMAHandler`
+    - ``"wma"``: linearly weighted moving average, like :class:`WMAHandler`
+
+    Results match the single-series handlers on data without missing values; values
+    not available yet (warm-up) are NaN. Non-finite inputs are not skipped: an SMA or
+    WMA is NaN (or infinite) while such a value is in its window and recovers once it
+    leaves, an EMA or RMA keeps it in its state for good. The state persists between
+    calls, so a long history can be fed in chunks or one timestamp at a time.
+
+    :param n_series: Number of series
+    :param indicators: ``(kind, length)`` of every indicator
+    :raises ValueError: If there are no series, a kind is unknown or a length is not positive
+
+    Example:
+        ```python
+        engine = MultiSeriesEngine(5000, [("sma", 20), ("ema", 20), ("rma", 14), ("wma", 10)])
+
+        # Whole histories: (n_series, n_samples) -> (n_indicators, n_series, n_samples)
+        result = engine.run(closes)
+        sma_20 = result[engine.names.index("sma_20")]
+
+        # Live: the closes of all instruments at one timestamp -> (n_indicators, n_series)
+        latest = engine.step(tick_closes)
+        ```
+    """
+
+    def __init__(self, n_series: int, indicators: Sequence[tuple[str, int]]) -> None:
+        if n_series < 1:
+            raise ValueError("Number of series must be positive")
+        if any(length < 1 for _, length in indicators):
+            raise ValueError("Indicator lengths must be positive")
+        self.n_series = n_series
+        self.indicators = list(indicators)
+        kinds = [resolve_option("indicator", kind, MULTISERIES_INDICATORS) for kind, _ in self.indicators]
+        engine = tsp_multiseries_init(
+            n_series, len(kinds), ffi.new("int[]", kinds), ffi.new("long[]", [length for _, length in self.indicators])
+        )
+        if engine == ffi.NULL:
+            raise MemoryError("Could not allocate multi-series engine")
+        self._engine = ffi.gc(engine, tsp_free_multiseries)
+
+    @property
+    def names(self) -> list[str]:
+        """Get the names of the indicators, ``"<kind>_<length>"``, in result order.
+
+        :return: Indicator names
+        """
+        return [f"{kind}_{length}" for kind, length in self.indicators]
+
+    def _process(self, steps: npt.NDArray[np.float64]) -> npt.NDArray[np.float64]:
+        """Advance all series by the rows of steps, one timestamp per row."""
+        out = np.empty((len(steps), len(self.indicators), self.n_series), dtype=np.float64)
+        tsp_multiseries_process(
+            self._engine, ffi.from_buffer("double[]", steps), len(steps), ffi.from_buffer("double[]", out)
+        )
+        return out
+
+    def run(self, values: npt.ArrayLike) -> npt.NDArray[np.float64]:
+        """Advance all series by a block of samples.
+
+        :param values: Array of shape (n_series, n_samples)
+        :return: Indicator values of shape (n_indicators, n_series, n_samples)
+        :raises ValueError: If the number of series doesn't match
+        """
+        data = np.asarray(values, dtype=np.float64)
+        if data.shape[:-1] != (self.n_series,):
+            raise ValueError(f"Expected an array of shape ({self.n_series}, n_samples), got {data.shape}")
+        # Timestamps become contiguous rows of all series, the layout the kernels work on
+        out = self._process(np.ascontiguousarray(data.T))
+        return out.transpose(1, 2, 0)
+
+    def step(self, values: npt.ArrayLike) -> npt.NDArray[np.float64]:
+        """Advance all series by one timestamp.
+
+        :param values: Values of all series at the timestamp, of shape (n_series,)
+        :return: Indicator values of shape (n_indicators, n_series)
+        :raises ValueError: If the number of series doesn't match
+        """
+        data = np.ascontiguousarray(values, dtype=np.float64)
+        if data.shape != (self.n_series,):
+            raise ValueError(f"Expected an array of shape ({self.n_series},), got {data.shape}")
+        out: npt.NDArray[np.float64] = self._process(data.reshape(1, -1))[0]
+        return out
+
+    def reset(self) -> None:
+        """Forget the history of all series."""
+        tsp_multiseries_reset(self._engine)
@@ -0,0 +1,109 @@
+from collections.abc import AsyncIterator
+from typing import Any
+
+import numpy as np
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_PRECISION_F32,
+    TSP_PRECISION_F64,
+    TSP_SUM_KAHAN,
+    TSP_SUM_NAIVE,
+    TSP_SUM_RESUM,
+    tsp_apply_batch,
+    tsp_kernels_isa,
+    tsp_kernels_select,
+    tsp_kernels_supported,
+)
+
+__all__ = [
+    "ISAS",
+    "PRECISIONS",
+    "SUM_MODES",
+    "apply_batches",
+    "isa",
+    "resolve_option",
+    "select_isa",
+    "supported_isas",
+]
+
+# Storage precision of native windows: float32 halves the window footprint, accumulators stay double
+PRECISIONS = {"float64": TSP_PRECISION_F64, "float32": TSP_PRECISION_F32}
+
+# Accumulation modes of running sums kept by native queues
+SUM_MODES = {"naive": TSP_SUM_NAIVE, "kahan": TSP_SUM_KAHAN, "resum": TSP_SUM_RESUM}
+
+
+def resolve_option(name: str, value: str, options: dict[str, int]) -> int:
+    """Translate a string option of a native handler into its C constant.
+
+    :param name: Human-readable option name used in the error message
+    :param value: Option value passed by the user
+    :param options: Mapping of accepted values to C constants
+    :return: The C constant corresponding to value
+    :raises ValueError: If value is not one of the accepted options
+    """
+    if value not in options:
+        raise ValueError(f"Unknown {name} {value!r}, expected one of {sorted(options)}")
+    return options[value]
+
+
+# Instruction set variants of the native kernels, from the most portable to the widest
+ISAS = ("generic", "sse2", "avx2", "avx512")
+
+
+def isa() -> str:
+    """Get the instruction set variant used by the native kernels.
+
+    The variant is detected from cpuid when the library is loaded, or forced by
+    the ``PYSATL_TSP_ISA`` environment variable.
+
+    :return: One of ISAS
+    """
+    return str(ffi.string(tsp_kernels_isa()).decode())
+
+
+def supported_isas() -> list[str]:
+    """Get instruction set variants of the native kernels that can run on this CPU.
+
+    :return: Supported variants, from the most portable to the widest
+    """
+    return [name for name in ISAS if tsp_kernels_supported(name.encode())]
+
+
+def select_isa(name: str) -> None:
+    """Switch the native kernels to another instruction set variant.
+
+    Intended for benchmarking and testing, the switch affects the whole process.
+
+    :param name: One of ISAS
+    :raises ValueError: If the variant is unknown or not supported by this CPU
+    """
+    if tsp_kernels_select(name.encode()) != 0:
+        raise ValueError(f"Kernels {name!r} are not available, supported: {supported_isas()}")
+
+
+async def apply_batches(handler: Any, source: Any, inf_as_none: bool = True) -> AsyncIterator[list[Any]]:
+    """Apply the operation of a native handler to batches awaited from its source.
+
+    Used by native handlers under ``async for``: instead of pulling values through
+    the chain, every batch the source has ready is processed by one C call.
+    None values are passed to the operation as infinity, the value native handlers
+    exchange for missing results in a chain.
+
+    :param handler: The ``struct tsp_handler *`` whose operation is applied
+    :param source: Handler providing the input batches
+    :param inf_as_none: Whether infinite results (warm-up values of native handlers) become None
+    :return: An asynchronous iterator yielding processed batches
+    :raises RuntimeError: If the handler has no operation
+    """
+    async for batch in source.abatches():
+        values = np.fromiter((np.inf if value is None else value for value in batch), np.float64, len(batch))
+        if tsp_apply_batch(
+            handler, ffi.from_buffer("double[]", values), len(values), ffi.from_buffer("double[]", values)
+        ):
+            raise RuntimeError("Native handler has no operation to apply")
+        result: list[Any] = values.tolist()
+        if inf_as_none:
+            result = [None if value == np.inf else value for value in result]
+        yield result
@@ -1,10 +1,13 @@
-from .filter_handler import OfflineFilterHandler, OnlineFilterHandler
+from .filter_handler import IncrementalFilter, OfflineFilterHandler, OnlineFilterHandler
 from .inductive.inductive_handler import InductiveHandler
+from .json_extract_handler import JSONExtractHandler
 from .mapping_handler import MappingHandler
 from .sampling_handler import OfflineSamplingHandler, OnlineSamplingHandler
 
 __all__ = [
+    "IncrementalFilter",
     "InductiveHandler",
+    "JSONExtractHandler",
     "MappingHandler",
     "OfflineFilterHandler",
     "OfflineSamplingHandler",
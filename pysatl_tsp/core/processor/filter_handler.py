@@ -1,9 +1,71 @@
 from collections import deque
-from collections.abc import Iterator
-from typing import Any, Callable
+from collections.abc import AsyncIterator, Iterator
+from typing import Any, Callable, Generic, cast
 
 from pysatl_tsp.core import Handler, T, U
-from pysatl_tsp.core.scrubber import ScrubberWindow
+from pysatl_tsp.core.scrubber import NativeScrubberWindow, ScrubberWindow
+from pysatl_tsp.core.spill import spill
+
+
+class IncrementalFilter(Generic[T, U]):
+    """Base class of online filters that update a state with every new value.
+
+    An incremental filter can be passed as ``filter_func`` of :class:`OnlineFilterHandler`
+    wherever a window function is accepted. The handler then keeps no history: it creates
+    the state once per pass with :meth:`init_state` and calls :meth:`step` with the newest
+    value only, so every step costs O(1) and memory doesn't grow with the stream. Called
+    on a window directly, the filter runs over it from a fresh state, so it behaves like
+    the equivalent window function.
+
+    Example:
+        ```python
+        class RunningMean(IncrementalFilter[float, float]):
+            def init_state(self, config: None) -> tuple[int, float]:
+                return 0, 0.0
+
+            def step(self, state: tuple[int, float], value: float, config: None) -> tuple[tuple[int, float], float]:
+                count, mean = state
+                count += 1
+                mean += (value - mean) / count
+                return (count, mean), mean
+
+
+        means = OnlineFilterHandler(RunningMean(), source=data_source)
+        ```
+    """
+
+    def init_state(self, config: Any) -> Any:
+        """Create the state of the filter before the first value.
+
+        :param config: Configuration parameters of the handler
+        :return: Initial state
+        """
+        raise NotImplementedError
+
+    def step(self, state: Any, value: T, config: Any) -> tuple[Any, U]:
+        """Update the state with a new value.
+
+        :param state: Current state, created by init_state or returned by the previous step
+        :param value: The new value from the data source
+        :param config: Configuration parameters of the handler
+        :return: Updated state and the filtered value
+        """
+        raise NotImplementedError
+
+    def __call__(self, window: ScrubberWindow[T], config: Any) -> U:
+        """Filter the last value of a window, stepping through the window from a fresh state.
+
+        :param window: Window of historical data
+        :param config: Configuration parameters of the filter
+        :return: Filtered value of the last value of the window
+        :raises ValueError: If the window is empty
+        """
+        if not len(window):
+            raise ValueError("Window is empty")
+        state = self.init_state(config)
+        for value in window.values:
+            state, result = self.step(state, value, config)
+        return result
 
 
 class OnlineFilterHandler(Handler[T, U]):
@@ -16,9 +78,20 @@ class OnlineFilterHandler(Handler[T, U]):
     The filter function receives the current history window and configuration parameters,
     and produces a filtered value for each input value.
 
+    By default the whole history is kept. ``max_history`` bounds it to the newest values,
+    so memory stays constant on long-running streams. The bounded history is a
+    :class:`ScrubberWindow` that keeps the values as they are; with ``float_history``
+    it is a :class:`NativeScrubberWindow` ring of that capacity instead, which stores
+    every value as float64 (None becomes NaN) and gives the filter numpy views of it.
+    Filters that only need the newest value and a running state should be written as
+    an :class:`IncrementalFilter`, no history is kept for them.
+
     :param filter_func: Function that applies filtering on the history window
     :param filter_config: Configuration parameters for the filter function, defaults to None
     :param source: The handler providing input data, defaults to None
+    :param max_history: Number of newest values kept in the history, defaults to None (all)
+    :param float_history: Whether to keep the bounded history as float64, defaults to False
+    :raises ValueError: If max_history is not positive, or float_history is set without max_history
 
     Example:
         ```python
@@ -72,16 +145,53 @@ class OnlineFilterHandler(Handler[T, U]):
         filter_func: Callable[[ScrubberWindow[T], Any], U],
         filter_config: Any = None,
         source: Handler[Any, T] | None = None,
+        max_history: int | None = None,
+        float_history: bool = False,
     ):
         """Initialize an online filter handler.
 
         :param filter_func: Function that applies filtering on the history window
         :param filter_config: Configuration parameters for the filter function, defaults to None
         :param source: The handler providing input data, defaults to None
+        :param max_history: Number of newest values kept in the history, defaults to None (all)
+        :param float_history: Whether to keep the bounded history as float64, defaults to False
+        :raises ValueError: If max_history is not positive, or float_history is set without max_history
         """
+        if max_history is not None and max_history < 1:
+            raise ValueError("Maximum history length must be positive")
+        if float_history and max_history is None:
+            raise ValueError("Float history requires a maximum history length")
         super().__init__(source)
         self.filter_func = filter_func
         self.filter_config = filter_config
+        self.max_history = max_history
+        self.float_history = float_history
+
+    def _reset(self) -> None:
+        """Prepare the filter for a new pass over the source."""
+        self._position = 0
+        if isinstance(self.filter_func, IncrementalFilter):
+            self._state = self.filter_func.init_state(self.filter_config)
+        elif self.float_history:
+            ring = NativeScrubberWindow(capacity=cast(int, self.max_history))
+            self._history: ScrubberWindow[T] = cast(ScrubberWindow[T], ring)
+        else:
+            self._history = ScrubberWindow()
+
+    def _process(self, item: T) -> U:
+        """Filter the next item of the source."""
+        if isinstance(self.filter_func, IncrementalFilter):
+            self._state, result = self.filter_func.step(self._state, item, self.filter_config)
+            return cast(U, result)
+
+        if self.max_history is None:
+            self._history.append(item)
+        else:
+            if len(self._history) == self.max_history:
+                self._history.popleft()
+            self._history.append(item, self._position)
+        self._position += 1
+        return self.filter_func(self._history, self.filter_config)
 
     def __iter__(self) -> Iterator[U]:
         """Create an iterator that yields filtered values in real-time.
@@ -95,11 +205,22 @@ class OnlineFilterHandler(Handler[T, U]):
         if self.source is None:
             raise ValueError("Source is not set")
 
-        self._history: ScrubberWindow[T] = ScrubberWindow()
-
+        self._reset()
         for item in self.source:
-            self._history.append(item)
-            yield self.filter_func(self._history, self.filter_config)
+            yield self._process(item)
+
+    async def abatches(self) -> AsyncIterator[list[U]]:
+        """Create an asynchronous iterator over batches of filtered values.
+
+        :return: An asynchronous iterator yielding filtered batches of the source
+        :raises ValueError: If no source has been set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+
+        self._reset()
+        async for batch in self.source.abatches():
+            yield [self._process(item) for item in batch]
 
 
 class OfflineFilterHandler(Handler[T, U]):
@@ -110,9 +231,15 @@ class OfflineFilterHandler(Handler[T, U]):
     the entire context of the time series, such as spectral filters, Savitzky-Golay filters,
     or other techniques that need to process the data as a whole.
 
+    With ``out_of_core=True`` the series is spilled to a memory-mapped float64 file
+    (see :func:`spill`) instead of a deque of Python objects, and the filter receives
+    a :class:`NativeScrubberWindow` whose ``values`` is a read-only numpy view of it.
+    Filters written with numpy then run on series larger than RAM.
+
     :param filter_func: Function that processes the entire series and returns filtered values
     :param filter_config: Configuration parameters for the filter function, defaults to None
     :param source: The handler providing input data, defaults to None
+    :param out_of_core: Whether to spill numeric input to a memory-mapped file, defaults to False
 
     Example:
         ```python
@@ -163,16 +290,19 @@ class OfflineFilterHandler(Handler[T, U]):
         filter_func: Callable[[ScrubberWindow[T], Any], list[U]],
         filter_config: Any = None,
         source: Handler[Any, T] | None = None,
+        out_of_core: bool = False,
     ):
         """Initialize an offline filter handler.
 
         :param filter_func: Function that processes the entire series and returns filtered values
         :param filter_config: Configuration parameters for the filter function, defaults to None
         :param source: The handler providing input data, defaults to None
+        :param out_of_core: Whether to spill numeric input to a memory-mapped file, defaults to False
         """
         super().__init__(source)
         self.filter_func = filter_func
         self.filter_config = filter_config
+        self.out_of_core = out_of_core
 
     def __iter__(self) -> Iterator[U]:
         """Create an iterator that yields filtered values after processing the entire series.
@@ -186,7 +316,10 @@ class OfflineFilterHandler(Handler[T, U]):
         if self.source is None:
             raise ValueError("Source is not set")
 
-        full_series = ScrubberWindow(deque(self.source))
+        if self.out_of_core:
+            full_series = cast(ScrubberWindow[T], NativeScrubberWindow.wrap(spill(self.source)))
+        else:
+            full_series = ScrubberWindow(deque(self.source))
         filtered_series = self.filter_func(full_series, self.filter_config)
 
         yield from filtered_series
@@ -1,5 +1,5 @@
 from abc import ABC, abstractmethod
-from collections.abc import Iterator
+from collections.abc import AsyncIterator, Iterator
 from typing import Any
 
 from pysatl_tsp.core import Handler, T, U
@@ -150,3 +150,22 @@ class InductiveHandler(Handler[T, U], ABC):
             self._state = self._update_state(self._state, value)
             next_value = self._compute_result(self._state)
             yield next_value
+
+    async def abatches(self) -> AsyncIterator[list[U]]:
+        """Create an asynchronous iterator over batches of computed results.
+
+        The state is updated exactly as in synchronous iteration, batch by batch.
+
+        :return: An asynchronous iterator yielding results for each batch of the source
+        :raises ValueError: If no source has been set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+
+        self._state = self._initialize_state()
+        async for batch in self.source.abatches():
+            result = []
+            for value in batch:
+                self._state = self._update_state(self._state, value)
+                result.append(self._compute_result(self._state))
+            yield result
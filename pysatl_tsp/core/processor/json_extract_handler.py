@@ -0,0 +1,217 @@
+from collections.abc import Iterator, Sequence
+from itertools import islice
+from typing import Any, cast
+
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_JSON_FLOAT64,
+    TSP_JSON_INT64,
+    TSP_JSON_MISSING_INT,
+    tsp_free_json_extractor,
+    tsp_json_extract,
+    tsp_json_extract_joined,
+    tsp_json_extract_ring,
+    tsp_json_extractor_init,
+)
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.data_providers import BlockDataProvider, WebSocketDataProvider
+from pysatl_tsp.core.native import resolve_option
+
+__all__ = ["MISSING_INT", "JSONExtractHandler"]
+
+# Output types of extracted fields
+JSON_TYPES = {"float64": TSP_JSON_FLOAT64, "int64": TSP_JSON_INT64}
+
+# Value of int64 fields missing from a message, float64 fields get NaN
+MISSING_INT = TSP_JSON_MISSING_INT
+
+# Paths are tracked in a 64-bit mask by the C library
+MAX_PATHS = 64
+
+
+class JSONExtractHandler(Handler[str | bytes, tuple[float | int, ...]]):
+    """A handler that extracts numeric fields from JSON messages natively.
+
+    Replaces ``MappingHandler(json.loads ...)`` for the common case of pulling a few
+    numbers out of every message: the messages are scanned once by the C library,
+    values outside of the requested paths are skipped without being parsed, and no
+    Python dicts are built. Numbers encoded as strings (``"lastPrice": "67000.5"``)
+    are accepted; booleans give 1/0.
+
+    Paths are dotted keys, numeric segments index arrays: ``"data.lastPrice"``,
+    ``"data.0.p"``. Missing fields are NaN for float64 and :data:`MISSING_INT` for
+    int64 fields; so are fields whose value is not a number (an object, or a string
+    that doesn't parse, or an integer outside of the int64 range). Messages without any of the fields (e.g. subscription
+    acknowledgements) are skipped, or messages without all of them if require_all.
+
+    Connected to a :class:`~pysatl_tsp.core.data_providers.WebSocketDataProvider`,
+    the handler drains the provider's ring directly, without creating Python strings.
+
+    :param paths: Paths of the fields to extract
+    :param dtypes: Type of every field, "float64" or "int64", defaults to float64 for all
+    :param require_all: Skip messages missing any of the fields, defaults to False
+    :param batch_size: Number of messages extracted by one native call, defaults to 1024
+    :param source: The handler providing messages, defaults to None
+    :raises ValueError: If there are no paths, more than 64, or a type is unknown
+
+    Example:
+        ```python
+        provider = WebSocketDataProvider(
+            uri="wss://stream.bybit.com/v5/public/spot",
+            subscribe_message={"op": "subscribe", "args": ["tickers.BTCUSDT"]},
+        )
+        ticks = provider | JSONExtractHandler(["ts", "data.lastPrice"], dtypes=["int64", "float64"])
+        for timestamp, price in ticks:
+            print(timestamp, price)
+
+        # Or feed the prices to native handlers in blocks
+        extractor = JSONExtractHandler(["data.lastPrice"], source=provider)
+        for value in extractor.column_source("data.lastPrice") | CMAHandler(length=20):
+            print(value)
+        ```
+    """
+
+    def __init__(
+        self,
+        paths: Sequence[str],
+        dtypes: Sequence[str] | None = None,
+        require_all: bool = False,
+        batch_size: int = 1024,
+        source: Handler[Any, str | bytes] | None = None,
+    ):
+        super().__init__(source)
+        if not 1 <= len(paths) <= MAX_PATHS:
+            raise ValueError("JSON extractor needs between 1 and 64 paths")
+        self.paths = tuple(paths)
+        self.dtypes = tuple(dtypes) if dtypes is not None else ("float64",) * len(paths)
+        if len(self.dtypes) != len(self.paths):
+            raise ValueError("Number of dtypes must match number of paths")
+        types = [resolve_option("field type", dtype, JSON_TYPES) for dtype in self.dtypes]
+        self.require_all = require_all
+        self.batch_size = batch_size
+        encoded = [ffi.new("char[]", path.encode()) for path in self.paths]
+        extractor = tsp_json_extractor_init(encoded, types, len(types))
+        if extractor == ffi.NULL:
+            raise MemoryError("Could not allocate JSON extractor")
+        self._extractor = extractor
+        self._float_columns = [i for i, dtype in enumerate(self.dtypes) if dtype == "float64"]
+        self._int_columns = [i for i, dtype in enumerate(self.dtypes) if dtype == "int64"]
+
+    def extract(self, message: str | bytes) -> tuple[float | int, ...] | None:
+        """Extract the fields of a single message.
+
+        :param message: JSON text
+        :return: Values in the order of paths, None if the message is skipped
+        """
+        data = message.encode() if isinstance(message, str) else message
+        floats = ffi.new("double[]", max(len(self._float_columns), 1))
+        ints = ffi.new("int64_t[]", max(len(self._int_columns), 1))
+        found = tsp_json_extract(self._extractor, data, len(data), floats, ints)
+        if found <= 0 or (self.require_all and found != len(self.paths)):
+            return None
+        values: list[float | int] = [0] * len(self.paths)
+        for j, i in enumerate(self._float_columns):
+            values[i] = floats[j]
+        for j, i in enumerate(self._int_columns):
+            values[i] = ints[j]
+        return tuple(values)
+
+    def _empty_batch(self, rows: int) -> tuple[npt.NDArray[np.float64], npt.NDArray[np.int64]]:
+        return (
+            np.empty((rows, len(self._float_columns)), dtype=np.float64),
+            np.empty((rows, len(self._int_columns)), dtype=np.int64),
+        )
+
+    def _columns(self, floats: npt.NDArray[np.float64], ints: npt.NDArray[np.int64], rows: int) -> dict[str, Any]:
+        columns: dict[str, Any] = {}
+        for j, i in enumerate(self._float_columns):
+            columns[self.paths[i]] = floats[:rows, j]
+        for j, i in enumerate(self._int_columns):
+            columns[self.paths[i]] = ints[:rows, j]
+        return {path: columns[path] for path in self.paths}
+
+    def _ring_batches(self, provider: WebSocketDataProvider) -> Iterator[dict[str, Any]]:
+        for batch, count in provider.iter_raw_batches(self.batch_size):
+            floats, ints = self._empty_batch(count)
+            rows = tsp_json_extract_ring(
+                self._extractor,
+                batch,
+                count,
+                ffi.from_buffer("double[]", floats),
+                ffi.from_buffer("int64_t[]", ints),
+                self.require_all,
+            )
+            yield self._columns(floats, ints, rows)
+
+    def _text_batches(self, messages: Iterator[str | bytes]) -> Iterator[dict[str, Any]]:
+        while True:
+            texts = list(islice(messages, self.batch_size))
+            if not texts:
+                return
+            # One buffer per batch, messages separated by NUL
+            if all(isinstance(text, str) for text in texts):
+                data = "\0".join(cast(list[str], texts)).encode()
+            else:
+                data = b"\0".join(text.encode() if isinstance(text, str) else text for text in texts)
+            floats, ints = self._empty_batch(len(texts))
+            rows = tsp_json_extract_joined(
+                self._extractor,
+                data,
+                len(data),
+                ffi.from_buffer("double[]", floats),
+                ffi.from_buffer("int64_t[]", ints),
+                self.require_all,
+            )
+            yield self._columns(floats, ints, rows)
+
+    def iter_batches(self) -> Iterator[dict[str, Any]]:
+        """Extract the fields of the source messages batch by batch.
+
+        :return: An iterator yielding a column array per path, in the order of paths
+        :raises ValueError: If no source has been set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+        if isinstance(self.source, WebSocketDataProvider):
+            yield from self._ring_batches(self.source)
+        else:
+            yield from self._text_batches(iter(self.source))
+
+    def column_source(self, path: str) -> BlockDataProvider:
+        """Create a native source serving one extracted field.
+
+        :param path: One of paths
+        :return: Native data provider of the field values, in blocks
+        :raises ValueError: If the path is not extracted by this handler
+        """
+        if path not in self.paths:
+            raise ValueError(f"Path {path!r} is not extracted by this handler")
+        return BlockDataProvider(_FieldBatches(self, path))
+
+    def __iter__(self) -> Iterator[tuple[float | int, ...]]:
+        """Create an iterator that yields the extracted fields of every message.
+
+        :return: Iterator yielding tuples of values in the order of paths
+        :raises ValueError: If no source has been set
+        """
+        for columns in self.iter_batches():
+            yield from zip(*(column.tolist() for column in columns.values()))
+
+    def __del__(self) -> None:
+        if hasattr(self, "_extractor"):
+            tsp_free_json_extractor(self._extractor)
+
+
+class _FieldBatches:
+    """Re-iterable sequence of one extracted field, batch by batch."""
+
+    def __init__(self, handler: JSONExtractHandler, path: str) -> None:
+        self.handler = handler
+        self.path = path
+
+    def __iter__(self) -> Iterator[npt.NDArray[Any]]:
+        for columns in self.handler.iter_batches():
+            yield columns[self.path]
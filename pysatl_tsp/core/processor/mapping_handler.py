@@ -1,4 +1,4 @@
-from collections.abc import Iterator
+from collections.abc import AsyncIterator, Iterator
 from typing import Any, Callable
 
 from pysatl_tsp.core import Handler, T, U
@@ -69,6 +69,8 @@ class MappingHandler(Handler[T, U]):
         # Time: 2023-09-01T10:00:00, Value: 42.5
         # Time: 2023-09-01T10:01:00, Value: 43.2
         # Time: 2023-09-01T10:02:00, Value: 41.8
+
+        # To pull numeric fields only, JSONExtractHandler does it natively without json.loads
         ```
     """
 
@@ -95,3 +97,14 @@ class MappingHandler(Handler[T, U]):
 
         for segment in self.source:
             yield self.map_func(segment)
+
+    async def abatches(self) -> AsyncIterator[list[U]]:
+        """Create an asynchronous iterator over batches of transformed items.
+
+        :return: An asynchronous iterator yielding transformed batches of the source
+        :raises ValueError: If no source has been set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+        async for batch in self.source.abatches():
+            yield [self.map_func(segment) for segment in batch]
@@ -91,6 +91,8 @@ class OfflineSamplingHandler(Handler[T, T]):
 
     :param sampling_rule: Function that analyzes the entire series and returns indices of points to sample
     :param source: The handler providing input data, defaults to None
+    :param out_of_core: Whether to spill numeric input to a memory-mapped file instead of
+                        materializing it (see :class:`OfflineSegmentationScrubber`), defaults to False
 
     Example:
         ```python
@@ -155,14 +157,21 @@ class OfflineSamplingHandler(Handler[T, T]):
         ```
     """
 
-    def __init__(self, sampling_rule: Callable[[ScrubberWindow[T]], list[int]], source: Handler[Any, T] | None = None):
+    def __init__(
+        self,
+        sampling_rule: Callable[[ScrubberWindow[T]], list[int]],
+        source: Handler[Any, T] | None = None,
+        out_of_core: bool = False,
+    ):
         """Initialize an offline sampling handler.
 
         :param sampling_rule: Function that analyzes the entire series and returns indices of points to sample
         :param source: The handler providing input data, defaults to None
+        :param out_of_core: Whether to spill numeric input to a memory-mapped file, defaults to False
         """
         super().__init__(source)
         self.sampling_rule = sampling_rule
+        self.out_of_core = out_of_core
 
     def __iter__(self) -> Iterator[T]:
         """Create an iterator that yields sampled values based on the indices identified by the sampling rule.
@@ -175,7 +184,10 @@ class OfflineSamplingHandler(Handler[T, T]):
         """
         mapping_handler: MappingHandler[ScrubberWindow[T], T] = MappingHandler(map_func=lambda window: window[-1])
         pipeline = (
-            OfflineSegmentationScrubber(segmentation_rule=self.sampling_rule, source=self.source) | mapping_handler
+            OfflineSegmentationScrubber(
+                segmentation_rule=self.sampling_rule, source=self.source, out_of_core=self.out_of_core
+            )
+            | mapping_handler
         )
 
         yield from pipeline
@@ -0,0 +1,119 @@
+import queue
+from typing import Any
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_RING_BLOCK,
+    TSP_RING_CONFLATE,
+    TSP_RING_DROP_OLDEST,
+    tsp_free_ring,
+    tsp_ring_close,
+    tsp_ring_dropped,
+    tsp_ring_free_msg,
+    tsp_ring_init,
+    tsp_ring_pop_batch,
+    tsp_ring_push,
+    tsp_ring_size,
+)
+from pysatl_tsp.core.native import resolve_option
+
+__all__ = ["OVERFLOW_POLICIES", "MessageRing"]
+
+# What the producer does when the ring is full
+OVERFLOW_POLICIES = {"block": TSP_RING_BLOCK, "drop_oldest": TSP_RING_DROP_OLDEST, "conflate": TSP_RING_CONFLATE}
+
+
+class MessageRing:
+    """Bounded lock-free single-producer/single-consumer queue of text messages.
+
+    Messages are copied into a native ring buffer, so put and get don't take a lock
+    and don't hold the GIL while waiting. One thread may put and one thread may get.
+    When the ring is full the overflow policy decides what happens:
+
+    - ``"block"``: put waits for free space, which slows down the producer
+    - ``"drop_oldest"``: the oldest queued message is dropped
+    - ``"conflate"``: the whole backlog is dropped, the consumer continues from the newest message
+
+    The interface follows :class:`queue.Queue` (put, get, qsize) and adds batch draining.
+
+    :param capacity: Maximum number of queued messages (rounded up to a power of two), defaults to 65536
+    :param overflow: Overflow policy, defaults to "block"
+    :param batch_size: Maximum number of messages taken by one get_batch call, defaults to 1024
+    :raises ValueError: If the capacity is not positive or the policy is unknown
+    """
+
+    def __init__(self, capacity: int = 65536, overflow: str = "block", batch_size: int = 1024) -> None:
+        if capacity < 1 or batch_size < 1:
+            raise ValueError("Capacity and batch size must be positive")
+        self.overflow = overflow
+        ring = tsp_ring_init(capacity, resolve_option("overflow policy", overflow, OVERFLOW_POLICIES))
+        if ring == ffi.NULL:
+            raise MemoryError("Could not allocate ring")
+        self._ring = ring
+        self._batch = ffi.new("struct tsp_ring_msg *[]", batch_size)
+        self._batch_size = batch_size
+
+    def put(self, item: str | bytes) -> None:
+        """Add a message; bytes are taken as UTF-8 text.
+
+        :param item: Message
+        :raises RuntimeError: If the ring is closed
+        """
+        data = item.encode() if isinstance(item, str) else item
+        if tsp_ring_push(self._ring, data, len(data)) != 0:
+            raise RuntimeError("Ring is closed")
+
+    def get_raw_batch(self, max_items: int | None = None, timeout: float | None = None) -> tuple[Any, int]:
+        """Take native messages, for consumers written in C.
+
+        The caller owns the returned messages and frees them with ``tsp_ring_free_msg``.
+
+        :param max_items: Maximum number of messages, defaults to batch_size
+        :param timeout: Seconds to wait for the first message, None to wait without limit
+        :return: Array of ``struct tsp_ring_msg *`` and the number of messages, 0 on timeout, -1 if closed
+        """
+        count = min(max_items or self._batch_size, self._batch_size)
+        return self._batch, tsp_ring_pop_batch(self._ring, self._batch, count, -1.0 if timeout is None else timeout)
+
+    def get_batch(self, max_items: int | None = None, timeout: float | None = None) -> list[str]:
+        """Take all queued messages, up to max_items, waiting for at least one.
+
+        :param max_items: Maximum number of messages, defaults to batch_size
+        :param timeout: Seconds to wait for the first message, None to wait without limit
+        :return: Messages in order, empty on timeout or if the ring is closed
+        """
+        batch, count = self.get_raw_batch(max_items, timeout)
+        messages = []
+        for i in range(count):
+            messages.append(ffi.unpack(batch[i].data, batch[i].len).decode(errors="replace"))
+            tsp_ring_free_msg(batch[i])
+        return messages
+
+    def get(self, timeout: float | None = None) -> str:
+        """Take the oldest message.
+
+        :param timeout: Seconds to wait, None to wait without limit
+        :return: Message
+        :raises queue.Empty: If there is no message in time or the ring is closed
+        """
+        messages = self.get_batch(1, timeout)
+        if not messages:
+            raise queue.Empty
+        return messages[0]
+
+    def qsize(self) -> int:
+        """Get the number of queued messages."""
+        return int(tsp_ring_size(self._ring))
+
+    @property
+    def dropped(self) -> int:
+        """Get the number of messages dropped by the overflow policy."""
+        return int(tsp_ring_dropped(self._ring))
+
+    def close(self) -> None:
+        """Close the ring: waiting put and get calls return, new puts fail."""
+        tsp_ring_close(self._ring)
+
+    def __del__(self) -> None:
+        if hasattr(self, "_ring"):
+            tsp_free_ring(self._ring)
@@ -1,13 +1,45 @@
 from .abstract import Scrubber, ScrubberWindow
-from .linear_scrubber import LinearScrubber, SlidingScrubber
+from .aggregate_scrubber import AggregateScrubber
+from .changepoint import BinarySegmentation, ChangepointRule, Pelt
+from .conditions import (
+    AbsSumCondition,
+    ChangeCondition,
+    CountCondition,
+    NativeCondition,
+    SpanCondition,
+    SumCondition,
+)
+from .linear_scrubber import LinearScrubber, SlidingScrubber, StridedScrubber
+from .native_window import NativeScrubberWindow
+from .segmentation_rules import CusumRule, JumpRule, MaxSizeRule, NativeSegmentationRule, PageHinkleyRule
 from .segmentation_scrubber import OfflineSegmentationScrubber, OnlineSegmentationScrubber
+from .time_scrubber import TimeWindow, TimeWindowScrubber
 
 __all__ = [
+    "AbsSumCondition",
+    "AggregateScrubber",
+    "BinarySegmentation",
+    "ChangeCondition",
+    "ChangepointRule",
+    "CountCondition",
+    "CusumRule",
+    "JumpRule",
     "LinearScrubber",
+    "MaxSizeRule",
+    "NativeCondition",
+    "NativeScrubberWindow",
+    "NativeSegmentationRule",
     "OfflineSegmentationScrubber",
     "OnlineSegmentationScrubber",
+    "PageHinkleyRule",
+    "Pelt",
     "Scrubber",
     "ScrubberWindow",
     "SegmentationScrubber",
     "SlidingScrubber",
+    "SpanCondition",
+    "StridedScrubber",
+    "SumCondition",
+    "TimeWindow",
+    "TimeWindowScrubber",
 ]
@@ -0,0 +1,161 @@
+from __future__ import annotations
+
+from collections.abc import Iterator, Sequence
+from datetime import timedelta
+from typing import Any
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_AGG_ELEMENTS,
+    TSP_AGG_MAX,
+    TSP_AGG_MIN,
+    TSP_AGG_TIME,
+    TSP_TW_UNORDERED,
+    tsp_aggregator_flush,
+    tsp_aggregator_init,
+    tsp_aggregator_max_windows,
+    tsp_aggregator_process,
+    tsp_free_aggregator,
+)
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.data_providers.tsf_data_provider import Timestamp, to_timestamp
+from pysatl_tsp.core.native import resolve_option
+
+__all__ = ["AGGREGATE_UNITS", "WINDOW_AGGREGATES", "AggregateScrubber"]
+
+# What window sizes are measured in
+AGGREGATE_UNITS = {"elements": TSP_AGG_ELEMENTS, "time": TSP_AGG_TIME}
+
+# Aggregates a window record can hold, with the native flags they need
+WINDOW_AGGREGATES = {
+    "count": 0,
+    "sum": 0,
+    "mean": 0,
+    "min": TSP_AGG_MIN,
+    "max": TSP_AGG_MAX,
+    "first": 0,
+    "last": 0,
+}
+
+
+def _to_units(length: int | timedelta) -> int:
+    """Convert a window length to timestamp units, timedelta to nanoseconds."""
+    if isinstance(length, timedelta):
+        return int(length / timedelta(microseconds=1)) * 1000
+    return length
+
+
+class AggregateScrubber(Handler[Any, dict[str, float]]):
+    """A scrubber that emits a record of aggregates per tumbling or hopping window.
+
+    Windows of ``size`` start every ``hop`` (``hop == size`` gives tumbling windows,
+    a smaller hop overlapping ones) and are measured either in elements or in time:
+
+    - ``"elements"``: the source yields values, window ``k`` holds the values at
+      positions ``[k * hop, k * hop + size)``; only complete windows are emitted
+    - ``"time"``: the source yields ``(timestamp, value)`` pairs with non-decreasing
+      timestamps, window ``k`` covers ``[origin + k * hop, origin + k * hop + size)``;
+      windows without points are skipped, the open ones are emitted when the stream ends
+
+    Every window is emitted once, as a dict with its ``"start"`` and ``"end"`` and the
+    requested aggregates. All of them are computed by one native operator in one pass
+    over the values: the axis is cut into panes of ``gcd(size, hop)`` that overlapping
+    windows share, count and sum are maintained by adding entering and subtracting
+    leaving panes, minimum and maximum with monotonic deques of panes. A record costs
+    O(1) amortized whatever the window size, instead of a walk over a copied window.
+    Minimum and maximum are only maintained when requested. Points are passed to the
+    operator one at a time, a window is emitted as soon as its last point arrives.
+
+    Datetime timestamps are converted to nanoseconds since the epoch, sizes and hops
+    given as timedelta are converted to nanoseconds as well. Missing values (None) are
+    aggregated as NaN.
+
+    :param size: Length of the windows
+    :param hop: Distance between the starts of consecutive windows, defaults to None (size, tumbling)
+    :param aggregates: Names of the aggregates to emit, from "count", "sum", "mean", "min",
+                       "max", "first" and "last"; defaults to all of them
+    :param units: What size and hop are measured in, "elements" or "time", defaults to "elements"
+    :param origin: Timestamp the time windows are aligned to, defaults to 0
+    :param source: The handler providing values or ``(timestamp, value)`` pairs, defaults to None
+    :raises ValueError: If the size or hop is not positive, or the units or an aggregate is unknown
+
+    Example:
+        ```python
+        # Hopping windows of 4 values every 2 values
+        stats = AggregateScrubber(4, hop=2, aggregates=["mean", "max"], source=SimpleDataProvider(range(8)))
+        for record in stats:
+            print(record)
+
+        # Output:
+        # {'start': 0, 'end': 4, 'mean': 1.5, 'max': 3.0}
+        # {'start': 2, 'end': 6, 'mean': 3.5, 'max': 5.0}
+        # {'start': 4, 'end': 8, 'mean': 5.5, 'max': 7.0}
+
+        # One-minute OHLC bars every 10 seconds from timestamped ticks
+        bars = ticks | AggregateScrubber(
+            timedelta(minutes=1), hop=timedelta(seconds=10), aggregates=["first", "max", "min", "last"], units="time"
+        )
+        ```
+    """
+
+    def __init__(
+        self,
+        size: int | timedelta,
+        hop: int | timedelta | None = None,
+        aggregates: Sequence[str] = tuple(WINDOW_AGGREGATES),
+        units: str = "elements",
+        origin: Timestamp = 0,
+        source: Handler[Any, Any] | None = None,
+    ) -> None:
+        super().__init__(source)
+        self.size = _to_units(size)
+        self.hop = self.size if hop is None else _to_units(hop)
+        if self.size < 1 or self.hop < 1:
+            raise ValueError("Window size and hop must be positive")
+        self.aggregates = list(aggregates)
+        self.units = units
+        self.origin = to_timestamp(origin)
+        self._units = resolve_option("units", units, AGGREGATE_UNITS)
+        self._flags = 0
+        for name in self.aggregates:
+            self._flags |= resolve_option("aggregate", name, WINDOW_AGGREGATES)
+
+    def __iter__(self) -> Iterator[dict[str, float]]:
+        """Create an iterator over the aggregate records of the windows.
+
+        :return: Iterator yielding one record per window
+        :raises ValueError: If no source has been set or timestamps decrease
+        :raises MemoryError: If the aggregator cannot be allocated
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+
+        aggregator = tsp_aggregator_init(self._units, self._flags, self.size, self.hop, self.origin)
+        if aggregator == ffi.NULL:
+            raise MemoryError("Could not allocate window aggregator")
+        aggregator = ffi.gc(aggregator, tsp_free_aggregator)
+        out_size = tsp_aggregator_max_windows(aggregator)
+        out = ffi.new("struct tsp_time_agg[]", out_size)
+        consumed = ffi.new("long *")
+        stamp = ffi.new("int64_t[1]")
+        value = ffi.new("double[1]")
+
+        timed = self._units == TSP_AGG_TIME
+        for point in self.source:
+            if timed:
+                stamp[0] = to_timestamp(point[0])
+                point = point[1]
+            value[0] = float("nan") if point is None else point
+            emitted = tsp_aggregator_process(aggregator, stamp, value, 1, out, out_size, consumed)
+            if emitted == TSP_TW_UNORDERED:
+                raise ValueError("Timestamps of the points must be non-decreasing")
+            for i in range(emitted):
+                yield self._record(out[i])
+        for i in range(tsp_aggregator_flush(aggregator, out)):
+            yield self._record(out[i])
+
+    def _record(self, agg: Any) -> dict[str, float]:
+        record: dict[str, float] = {"start": agg.start, "end": agg.end}
+        for name in self.aggregates:
+            record[name] = agg.sum / agg.count if name == "mean" else getattr(agg, name)
+        return record
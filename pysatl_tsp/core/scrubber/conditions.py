@@ -0,0 +1,143 @@
+from __future__ import annotations
+
+from typing import Any
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_COND_ABS_SUM,
+    TSP_COND_CHANGE,
+    TSP_COND_COUNT,
+    TSP_COND_SPAN,
+    TSP_COND_SUM,
+    tsp_condition_init,
+    tsp_free_condition,
+)
+
+from .abstract import ScrubberWindow
+
+__all__ = [
+    "AbsSumCondition",
+    "ChangeCondition",
+    "CountCondition",
+    "NativeCondition",
+    "SpanCondition",
+    "SumCondition",
+]
+
+
+class NativeCondition:
+    """Base class of take-conditions evaluated incrementally in C.
+
+    A native condition can be passed as ``take_condition`` of :class:`SlidingScrubber`
+    wherever a callable is accepted. The scrubber then doesn't call back into Python
+    on the whole window after every value: the condition keeps the aggregate it needs
+    (count, sum, oldest and newest value) and updates it in O(1) when a value enters
+    or leaves the window. Called on a window directly, the condition is evaluated from
+    scratch, so it behaves like the equivalent lambda.
+
+    :param kind: Kind of the condition (``TSP_COND_*``)
+    :param threshold: Value the aggregate of the window is compared with
+    """
+
+    # Whether the condition reads window values, which must then be numbers
+    uses_values = True
+
+    def __init__(self, kind: int, threshold: float) -> None:
+        self.kind = kind
+        self.threshold = threshold
+
+    def init_state(self) -> Any:
+        """Create the native state of the condition for an empty window.
+
+        :return: ``struct tsp_condition *``, freed when garbage collected
+        :raises MemoryError: If the state cannot be allocated
+        """
+        state = tsp_condition_init(self.kind, self.threshold)
+        if state == ffi.NULL:
+            raise MemoryError("Could not allocate condition")
+        return ffi.gc(state, tsp_free_condition)
+
+    def __call__(self, window: ScrubberWindow[Any]) -> bool:
+        """Evaluate the condition on a whole window.
+
+        :param window: Window to check
+        :return: True if the window should be taken
+        """
+        raise NotImplementedError
+
+    def __repr__(self) -> str:
+        return f"{type(self).__name__}({self.threshold})"
+
+
+class CountCondition(NativeCondition):
+    """Take the window when it holds at least ``count`` values, for windows of any type.
+
+    :param count: Number of values
+    """
+
+    uses_values = False
+
+    def __init__(self, count: int) -> None:
+        super().__init__(TSP_COND_COUNT, count)
+
+    def __call__(self, window: ScrubberWindow[Any]) -> bool:
+        return len(window) >= self.threshold
+
+
+class SumCondition(NativeCondition):
+    """Take the window when the sum of its values reaches ``threshold``.
+
+    The running sum is compensated, it doesn't drift however long the stream is.
+
+    :param threshold: Sum to reach
+    """
+
+    def __init__(self, threshold: float) -> None:
+        super().__init__(TSP_COND_SUM, threshold)
+
+    def __call__(self, window: ScrubberWindow[Any]) -> bool:
+        return len(window) > 0 and sum(window.values) >= self.threshold
+
+
+class AbsSumCondition(NativeCondition):
+    """Take the window when the sum of absolute values reaches ``threshold``.
+
+    :param threshold: Sum to reach
+    """
+
+    def __init__(self, threshold: float) -> None:
+        super().__init__(TSP_COND_ABS_SUM, threshold)
+
+    def __call__(self, window: ScrubberWindow[Any]) -> bool:
+        return len(window) > 0 and sum(abs(value) for value in window.values) >= self.threshold
+
+
+class SpanCondition(NativeCondition):
+    """Take the window when its indices span at least ``span``.
+
+    The span is the difference between the index of the newest and the oldest value,
+    so for timestamped indices it is the covered time.
+
+    :param span: Span to reach, in index units
+    """
+
+    uses_values = False
+
+    def __init__(self, span: float) -> None:
+        super().__init__(TSP_COND_SPAN, span)
+
+    def __call__(self, window: ScrubberWindow[Any]) -> bool:
+        return len(window) > 0 and window.indices[-1] - window.indices[0] >= self.threshold
+
+
+class ChangeCondition(NativeCondition):
+    """Take the window when its newest value differs from the oldest one by ``threshold`` or more.
+
+    :param threshold: Absolute change to reach
+    """
+
+    def __init__(self, threshold: float) -> None:
+        super().__init__(TSP_COND_CHANGE, threshold)
+
+    def __call__(self, window: ScrubberWindow[Any]) -> bool:
+        return len(window) > 0 and abs(window.values[-1] - window.values[0]) >= self.threshold
@@ -1,9 +1,12 @@
 from collections.abc import Iterator
-from typing import Any, Callable
+from typing import Any, Callable, cast
 
+from pysatl_tsp._c.lib import TSP_COND_COUNT, tsp_condition_pop, tsp_condition_push
 from pysatl_tsp.core import Handler
 
 from .abstract import Scrubber, ScrubberWindow, T
+from .conditions import CountCondition, NativeCondition
+from .native_window import NativeScrubberWindow
 
 
 class SlidingScrubber(Scrubber[T]):
@@ -13,7 +16,8 @@ class SlidingScrubber(Scrubber[T]):
     slide the window after each emission. It accumulates data points in a buffer and yields
     the current window whenever the take condition evaluates to True.
 
-    :param take_condition: Function that determines when to emit the current window
+    :param take_condition: Function that determines when to emit the current window, or a
+                           :class:`NativeCondition` that is evaluated incrementally in C
     :param shift: Number of points to shift the window after each emission
     :param source: The handler providing input data, defaults to None
 
@@ -43,6 +47,9 @@ class SlidingScrubber(Scrubber[T]):
 
         for window in sum_scrubber:
             print(f"Window with sum >= 10: {list(window.values)}, sum: {sum(window.values)}")
+
+        # The same condition without a Python call and an O(window) sum per value
+        native_scrubber = SlidingScrubber(take_condition=SumCondition(10), shift=1, source=data_source)
         ```
     """
 
@@ -73,6 +80,13 @@ class SlidingScrubber(Scrubber[T]):
         if self.source is None:
             raise ValueError("Source is not set")
 
+        if isinstance(self._take_condition, NativeCondition):
+            if self._take_condition.kind == TSP_COND_COUNT:
+                yield from self._iter_count(self.source, self._take_condition.threshold)
+            else:
+                yield from self._iter_native(self.source, self._take_condition)
+            return
+
         for i, item in enumerate(self.source):
             self._buffer.append(item, i)
             if self._take_condition(self._buffer):
@@ -82,12 +96,47 @@ class SlidingScrubber(Scrubber[T]):
                     if self._buffer:
                         self._buffer.popleft()
 
+    def _iter_count(self, source: Handler[Any, T], count: float) -> Iterator[ScrubberWindow[T]]:
+        """Run the scrubber with a count condition, which is the length of the buffer."""
+        buffer = self._buffer
+        for i, item in enumerate(source):
+            buffer.append(item, i)
+            if len(buffer) >= count:
+                yield buffer[:]
+
+                for _ in range(min(self._shift, len(buffer))):
+                    buffer.popleft()
+
+    def _iter_native(self, source: Handler[Any, T], condition: NativeCondition) -> Iterator[ScrubberWindow[T]]:
+        """Run the scrubber with a condition that is updated incrementally in C."""
+        state = condition.init_state()
+
+        def key(item: T) -> float:
+            return float(cast(float, item)) if condition.uses_values else 0.0
+
+        values, indices = self._buffer.values, self._buffer.indices
+        for value, index in zip(values, indices):
+            tsp_condition_push(state, key(value), index)
+
+        for i, item in enumerate(source):
+            self._buffer.append(item, i)
+            if tsp_condition_push(state, key(item), i):
+                yield self._buffer[:]
+
+                for _ in range(min(self._shift, len(self._buffer))):
+                    removed = values.popleft()
+                    indices.popleft()
+                    front, front_index = (key(values[0]), indices[0]) if values else (0.0, 0)
+                    tsp_condition_pop(state, key(removed), front, front_index)
+
 
 class LinearScrubber(SlidingScrubber[T]):
     """A scrubber that creates fixed-size sliding windows with configurable overlap.
 
     This is a specialized sliding scrubber that emits windows of a fixed size and
     allows controlling the overlap between consecutive windows through a shift factor.
+    For numeric data, :class:`StridedScrubber` emits the same windows as views
+    instead of copies.
 
     :param window_length: Number of points in each window, defaults to 100
     :param shift_factor: Fraction of window to shift after each emission, defaults to 1/3
@@ -124,4 +173,96 @@ class LinearScrubber(SlidingScrubber[T]):
         :param source: The handler providing input data, defaults to None
         """
         shift = max(1, int(shift_factor * window_length))
-        super().__init__(take_condition=lambda buffer: len(buffer) >= window_length, shift=shift, source=source)
+        super().__init__(take_condition=CountCondition(window_length), shift=shift, source=source)
+
+
+class StridedScrubber(Handler[float, NativeScrubberWindow]):
+    """A fixed-size sliding window scrubber that emits read-only views instead of copies.
+
+    Produces the same windows as :class:`LinearScrubber` for numeric data, as
+    :class:`NativeScrubberWindow` views into a shared contiguous buffer: emitting a window
+    and shifting it (moving the start of the buffer) are O(1), whatever the window length.
+    Windows can be passed to numpy or to the native kernels without copying.
+
+    Online, values are kept in a ring buffer and an emitted window stays valid until the
+    buffer overwrites it, accessing it afterwards raises RuntimeError. Windows that have
+    to outlive the following ``capacity - window_length`` values must be retained with
+    ``window.copy()``. Offline, the source is drained into one array first and every
+    window is a strided view of it that stays valid forever.
+
+    Like in :class:`LinearScrubber`, a shift longer than the window doesn't skip values:
+    the next window starts right after the emitted one.
+
+    It is a separate class rather than a mode of :class:`LinearScrubber` because its
+    windows are a different type: :class:`LinearScrubber` is a :class:`Scrubber` of
+    any values and yields :class:`ScrubberWindow` copies, while views need the values
+    in one float64 buffer, so this scrubber only accepts numbers and yields
+    :class:`NativeScrubberWindow`. A flag switching the window type would make the
+    output type of :class:`LinearScrubber` depend on an argument.
+
+    :param window_length: Number of points in each window, defaults to 100
+    :param shift_factor: Fraction of window to shift after each emission, defaults to 1/3
+    :param source: The handler providing input data, defaults to None
+    :param offline: Whether to drain the whole source into a backing array before
+                    emitting windows, defaults to False
+    :param capacity: Size of the online ring buffer, defaults to twice the window length
+    :raises ValueError: If the window length is not positive or the capacity is smaller than it
+
+    Example:
+        ```python
+        scrubber = StridedScrubber(window_length=1000, shift_factor=0.1, source=data_source)
+
+        features = [np.std(window) for window in scrubber]  # No copies of the windows
+        kept = [window.copy() for window in scrubber if window[-1] > 100]
+        ```
+    """
+
+    def __init__(
+        self,
+        window_length: int = 100,
+        shift_factor: float = 1.0 / 3.0,
+        source: Handler[Any, float] | None = None,
+        offline: bool = False,
+        capacity: int | None = None,
+    ) -> None:
+        """Initialize a strided scrubber with fixed window size and overlap.
+
+        :param window_length: Number of points in each window, defaults to 100
+        :param shift_factor: Fraction of window to shift after each emission, defaults to 1/3
+        :param source: The handler providing input data, defaults to None
+        :param offline: Whether to drain the source into a backing array first, defaults to False
+        :param capacity: Size of the online ring buffer, defaults to twice the window length
+        """
+        super().__init__(source)
+        if window_length < 1:
+            raise ValueError("Window length must be positive")
+        self.window_length = window_length
+        self.shift = max(1, int(shift_factor * window_length))
+        # Shifting drops at most the emitted window, the offline path has to step the same way
+        self._step = min(self.shift, window_length)
+        self.offline = offline
+        self.capacity = 2 * window_length if capacity is None else capacity
+        if self.capacity < window_length:
+            raise ValueError("Capacity must not be smaller than the window length")
+
+    def __iter__(self) -> Iterator[NativeScrubberWindow]:
+        """Create an iterator that yields views of consecutive windows.
+
+        :return: Iterator yielding NativeScrubberWindow views
+        :raises ValueError: If no source has been set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+
+        if self.offline:
+            backing = NativeScrubberWindow.wrap(self.source.to_numpy())
+            for start in range(0, len(backing) - self.window_length + 1, self._step):
+                yield backing[start : start + self.window_length]
+            return
+
+        buffer = NativeScrubberWindow(capacity=self.capacity)
+        for i, item in enumerate(self.source):
+            buffer.append(item, i)
+            if len(buffer) >= self.window_length:
+                yield buffer[:]
+                buffer.popleft(self._step)
@@ -0,0 +1,327 @@
+from __future__ import annotations
+
+from collections.abc import Iterable, Iterator
+from typing import Any, overload
+
+import numpy as np
+import numpy.typing as npt
+
+__all__ = ["NativeScrubberWindow"]
+
+
+class _Ring:
+    """Mirrored ring storage shared by a window and its views.
+
+    Every value is written twice, at slot ``p % capacity`` and ``p % capacity + capacity``
+    for absolute stream position ``p``, so any run of at most ``capacity`` consecutive
+    positions is one contiguous slice of the arrays. A storage wrapped without indices
+    is ``implicit``: it has no index array, the index of every value is its position.
+    """
+
+    __slots__ = ("capacity", "implicit", "indices", "values", "written")
+
+    def __init__(self, capacity: int) -> None:
+        self.capacity = capacity
+        self.values = np.empty(2 * capacity, dtype=np.float64)
+        self.indices = np.empty(2 * capacity, dtype=np.int64)
+        self.implicit = False
+        self.written = 0  # Absolute position of the next appended value
+
+    @classmethod
+    def over(cls, values: npt.NDArray[np.float64], indices: npt.NDArray[np.int64] | None) -> _Ring:
+        """Wrap existing arrays as a full storage that is never written to."""
+        ring = cls.__new__(cls)
+        ring.capacity = max(len(values), 1)
+        ring.values = values
+        ring.indices = indices if indices is not None else np.empty(0, dtype=np.int64)
+        ring.implicit = indices is None
+        ring.written = len(values)
+        return ring
+
+
+class NativeScrubberWindow:
+    """A sliding window of float64 values backed by a contiguous ring buffer.
+
+    Numeric counterpart of :class:`ScrubberWindow` with the same methods, but not a
+    subclass of it: values are stored as float64 and indices as int64 in a mirrored ring
+    instead of two deques, so the window is always one contiguous block of memory.
+    :attr:`values` and :attr:`indices` are read-only numpy views that expose the buffer
+    protocol and can be passed to numpy or to the native kernels (``ffi.from_buffer``)
+    without copying. It is used where the data is known to be numeric: the float history
+    of :class:`~pysatl_tsp.core.processor.OnlineFilterHandler`, the windows of
+    :class:`StridedScrubber`, spilled series and the splits of the cross validator.
+
+    Slicing with step 1 returns a view window in O(1), sharing the storage. A view stays
+    valid until the window it was taken from overwrites its slots with new values
+    (after more than ``capacity`` appends), accessing its data afterwards raises
+    RuntimeError; :meth:`copy` detaches a view to retain it. Appending to a view
+    detaches it first. The storage grows by doubling when the window is full.
+
+    :param values: Initial values, defaults to None (empty window)
+    :param indices: Indices corresponding to values, defaults to None
+                   (if not provided, sequential indices starting from 0 are used)
+    :param capacity: Initial number of values the storage can hold, defaults to 64
+    :raises ValueError: If the lengths of values and indices don't match
+
+    Example:
+        ```python
+        window = NativeScrubberWindow()
+        for i, value in enumerate([10.5, 11.2, 9.8, 12.1]):
+            window.append(value, i)
+
+        tail = window[1:]  # O(1) view
+        print(tail.values.mean())  # numpy view, no copy
+        retained = tail.copy()  # survives further appends to window
+        ```
+    """
+
+    def __init__(
+        self, values: Iterable[float] | None = None, indices: Iterable[int] | None = None, capacity: int = 64
+    ) -> None:
+        data = np.fromiter(values if values is not None else (), dtype=np.float64)
+        positions = np.arange(len(data), dtype=np.int64) if indices is None else np.fromiter(indices, dtype=np.int64)
+        if len(data) != len(positions):
+            raise ValueError("Values and indices of ScrubberWindow must be same length")
+        self._ring = _Ring(max(capacity, len(data), 1))
+        self._start = 0
+        self._stop = 0
+        self._owner = True
+        self._extend(data, positions)
+
+    @classmethod
+    def _view(cls, ring: _Ring, start: int, stop: int) -> NativeScrubberWindow:
+        view = cls.__new__(cls)
+        view._ring = ring
+        view._start = start
+        view._stop = stop
+        view._owner = False
+        return view
+
+    @classmethod
+    def wrap(cls, values: npt.ArrayLike, indices: npt.ArrayLike | None = None) -> NativeScrubberWindow:
+        """Create a window over existing arrays without copying them.
+
+        The window and its slices are read-only views of the arrays, appending to them
+        copies the data first. Contiguous float64 values and int64 indices are not copied.
+        Without indices no index array is allocated, the index of a value is its position
+        and :attr:`indices` of a window builds only the range it covers.
+
+        :param values: Values of the window
+        :param indices: Indices corresponding to values, defaults to None
+                       (if not provided, sequential indices starting from 0 are used)
+        :return: Window viewing the arrays
+        :raises ValueError: If the lengths of values and indices don't match
+        """
+        data = np.ascontiguousarray(values, dtype=np.float64).reshape(-1)
+        positions = None if indices is None else np.ascontiguousarray(indices, dtype=np.int64).reshape(-1)
+        if positions is not None and len(data) != len(positions):
+            raise ValueError("Values and indices of ScrubberWindow must be same length")
+        return cls._view(_Ring.over(data, positions), 0, len(data))
+
+    def _extend(self, data: npt.NDArray[np.float64], positions: npt.NDArray[np.int64]) -> None:
+        """Append values to an owned window with room for them."""
+        ring = self._ring
+        for offset in range(0, len(data), ring.capacity):
+            count = min(ring.capacity, len(data) - offset)
+            for first, chunk in self._slots(self._stop, count):
+                for base in (first, first + ring.capacity):
+                    ring.values[base : base + len(chunk)] = data[offset + chunk.start : offset + chunk.stop]
+                    ring.indices[base : base + len(chunk)] = positions[offset + chunk.start : offset + chunk.stop]
+            self._stop += count
+        ring.written = self._stop
+
+    def _slots(self, position: int, count: int) -> list[tuple[int, range]]:
+        """Split count positions starting at position into runs of consecutive slots."""
+        first = position % self._ring.capacity
+        head = min(count, self._ring.capacity - first)
+        runs = [(first, range(head))]
+        if head < count:
+            runs.append((0, range(head, count)))
+        return runs
+
+    def _check(self) -> None:
+        if self._ring.written - self._ring.capacity > self._start:
+            raise RuntimeError("Window view has been overwritten by new values, copy() views to retain them")
+
+    def _detach(self, capacity: int) -> None:
+        """Move the window into its own storage of the given capacity."""
+        self._check()
+        data, positions = self.values.copy(), self.indices.copy()
+        self._ring = _Ring(capacity)
+        self._start = self._stop = 0
+        self._owner = True
+        self._extend(data, positions)
+
+    @property
+    def values(self) -> npt.NDArray[np.float64]:
+        """Get the values of the window.
+
+        :return: Read-only view of the window values
+        :raises RuntimeError: If the view has been overwritten
+        """
+        self._check()
+        first = self._start % self._ring.capacity
+        view = self._ring.values[first : first + len(self)]
+        view.flags.writeable = False
+        return view
+
+    @property
+    def indices(self) -> npt.NDArray[np.int64]:
+        """Get the indices of the window values in the original data stream.
+
+        :return: Read-only view of the window indices
+        :raises RuntimeError: If the view has been overwritten
+        """
+        self._check()
+        if self._ring.implicit:
+            view = np.arange(self._start, self._stop, dtype=np.int64)
+        else:
+            first = self._start % self._ring.capacity
+            view = self._ring.indices[first : first + len(self)]
+        view.flags.writeable = False
+        return view
+
+    @property
+    def capacity(self) -> int:
+        """Get the number of values the storage can hold before growing.
+
+        :return: Storage capacity
+        """
+        return self._ring.capacity
+
+    def append(self, value: float, index: int | None = None) -> None:
+        """Add a new value to the end of the window.
+
+        :param value: The data value to append
+        :param index: The index/position of the value in the original data stream,
+                     defaults to None (auto-assigned as len(self) after appending, as in ScrubberWindow)
+        """
+        if index is None:
+            index = len(self) + 1
+        if not self._owner or len(self) == self._ring.capacity:
+            self._detach(2 * max(len(self), self._ring.capacity // 2, 1))
+        ring = self._ring
+        slot = self._stop % ring.capacity
+        ring.values[slot] = ring.values[slot + ring.capacity] = value
+        ring.indices[slot] = ring.indices[slot + ring.capacity] = index
+        self._stop += 1
+        ring.written = self._stop
+
+    def popleft(self, count: int = 1) -> None:
+        """Remove the oldest (leftmost) values from the window.
+
+        Only the start of the window moves, so removing any number of values is O(1).
+
+        :param count: Number of values to remove, defaults to 1
+        :raises IndexError: If the window has fewer values than count
+        """
+        if not 0 <= count <= len(self):
+            raise IndexError("pop from an empty window" if not len(self) else "pop more values than the window has")
+        self._start += count
+
+    def clear(self) -> None:
+        """Remove all values from the window."""
+        self._start = self._stop
+
+    def copy(self) -> NativeScrubberWindow:
+        """Create a copy of the window with its own storage.
+
+        :return: A new window with copies of the values and indices
+        :raises RuntimeError: If the view has been overwritten
+        """
+        return NativeScrubberWindow(self.values, self.indices, capacity=self._ring.capacity)
+
+    @overload
+    def __getitem__(self, key: int) -> float: ...
+
+    @overload
+    def __getitem__(self, key: slice) -> NativeScrubberWindow: ...
+
+    def __getitem__(self, key: int | slice) -> float | NativeScrubberWindow:
+        """Get a value or sub-window by index or slice.
+
+        Slices with step 1 are O(1) views sharing the storage, other slices are copies.
+
+        :param key: Integer index or slice to retrieve
+        :return: Single value (if key is int) or sub-window (if key is slice)
+        :raises IndexError: If the index is out of range
+        :raises TypeError: If key is not an int or slice
+        :raises RuntimeError: If the view has been overwritten
+        """
+        match key:
+            case int() as idx:
+                if not -len(self) <= idx < len(self):
+                    raise IndexError("window index out of range")
+                self._check()
+                slot = (self._start + idx % len(self)) % self._ring.capacity
+                return float(self._ring.values[slot])
+
+            case slice() as s:
+                start, stop, step = s.indices(len(self))
+                if step != 1:
+                    return NativeScrubberWindow(self.values[s], self.indices[s])
+                return self._view(self._ring, self._start + start, self._start + max(start, stop))
+
+            case _:
+                raise TypeError(f"Unsupported key type: {type(key).__name__}")
+
+    def __len__(self) -> int:
+        """Get the number of values in the window.
+
+        :return: Number of values
+        """
+        return self._stop - self._start
+
+    def __bool__(self) -> bool:
+        """Check whether the window has values.
+
+        :return: True if the window is not empty
+        """
+        return self._stop > self._start
+
+    def __eq__(self, other: object) -> bool:
+        """Check equality with another window.
+
+        Windows are equal if they have the same values and indices, whatever their storage.
+
+        :param other: Another ScrubberWindow or NativeScrubberWindow
+        :return: True if the windows are equal
+        """
+        values = getattr(other, "values", None)
+        indices = getattr(other, "indices", None)
+        if values is None or indices is None:
+            return NotImplemented
+        return list(self.values) == list(values) and list(self.indices) == list(indices)
+
+    def __hash__(self) -> int:
+        """Get window's hash code.
+
+        :return: The hash value of the object
+        """
+        return hash((self.values.tobytes(), self.indices.tobytes()))
+
+    def __repr__(self) -> str:
+        """Get a string representation of the window.
+
+        :return: String representation showing values and indices
+        """
+        return f"NativeScrubberWindow(values: {self.values.tolist()}, indices: {self.indices.tolist()})"
+
+    def __iter__(self) -> Iterator[float]:
+        """Create an iterator over the values in the window.
+
+        :return: Iterator yielding window values
+        """
+        return iter(self.values.tolist())
+
+    def __array__(self, dtype: Any = None, copy: bool | None = None) -> npt.NDArray[Any]:
+        """Convert the window to a numpy array, without copying unless requested.
+
+        :param dtype: Requested data type, defaults to float64
+        :param copy: Whether a copy is required
+        :return: The window values
+        """
+        values = self.values
+        if copy or (dtype is not None and np.dtype(dtype) != values.dtype):
+            return np.array(values, dtype=dtype)
+        return values
@@ -0,0 +1,126 @@
+from __future__ import annotations
+
+from typing import Any
+
+import numpy as np
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_SEG_CUSUM,
+    TSP_SEG_JUMP,
+    TSP_SEG_MAX_SIZE,
+    TSP_SEG_PAGE_HINKLEY,
+    tsp_free_segmenter,
+    tsp_segmenter_init,
+    tsp_segmenter_process,
+)
+
+from .abstract import ScrubberWindow
+
+__all__ = ["CusumRule", "JumpRule", "MaxSizeRule", "NativeSegmentationRule", "PageHinkleyRule"]
+
+# Largest maximum segment size the native rules accept
+MAX_SEGMENT_SIZE = 2**63 - 1
+
+
+class NativeSegmentationRule:
+    """Base class of online segmentation rules that run in C.
+
+    A native rule can be passed as ``segmentation_rule`` of
+    :class:`OnlineSegmentationScrubber` wherever a callable is accepted. The scrubber
+    then pushes every value into the native state of the rule, which keeps O(1) state
+    about the current segment and starts over when a segment ends, instead of calling a
+    Python rule on the whole window per value. Called on a window directly, the rule runs
+    over its values in one native call as a fresh segment and reports whether the
+    segment ends with its last value.
+
+    :param kind: Kind of the rule (``TSP_SEG_*``)
+    :param threshold: Detection threshold
+    :param param: Rule-specific parameter, defaults to 0
+    """
+
+    def __init__(self, kind: int, threshold: float, param: float = 0.0) -> None:
+        self.kind = kind
+        self.threshold = threshold
+        self.param = param
+
+    def init_state(self, max_size: int = MAX_SEGMENT_SIZE) -> Any:
+        """Create the native state of the rule for an empty segment.
+
+        :param max_size: Segment size that ends the segment regardless of the rule
+        :return: ``struct tsp_segmenter *``, freed when garbage collected
+        :raises MemoryError: If the state cannot be allocated
+        """
+        state = tsp_segmenter_init(self.kind, self.threshold, self.param, min(max_size, MAX_SEGMENT_SIZE))
+        if state == ffi.NULL:
+            raise MemoryError("Could not allocate segmentation rule")
+        return ffi.gc(state, tsp_free_segmenter)
+
+    def __call__(self, window: ScrubberWindow[Any]) -> bool:
+        """Check whether a segment ends with the last value of the window.
+
+        :param window: The current segment
+        :return: True if the segment should end
+        """
+        values = np.fromiter(window.values, np.float64, len(window))
+        ends = ffi.new("long[]", max(len(values), 1))
+        count = tsp_segmenter_process(self.init_state(), ffi.from_buffer("double[]", values), len(values), ends)
+        return count > 0 and ends[count - 1] == len(values) - 1
+
+    def __repr__(self) -> str:
+        return f"{type(self).__name__}({self.threshold}, {self.param})"
+
+
+class JumpRule(NativeSegmentationRule):
+    """End the segment when a value differs from the previous one by more than ``threshold``.
+
+    The jumping value is the last one of the segment.
+
+    :param threshold: Largest allowed jump between consecutive values
+    """
+
+    def __init__(self, threshold: float) -> None:
+        super().__init__(TSP_SEG_JUMP, threshold)
+
+
+class CusumRule(NativeSegmentationRule):
+    """End the segment when a two-sided CUSUM detects a shift of its mean.
+
+    Deviations of every value from the mean of the preceding values of the segment,
+    reduced by ``drift``, are accumulated in an upper and a lower sum clipped at zero.
+    The segment ends when either sum exceeds ``threshold``.
+
+    :param threshold: Detection threshold of the sums
+    :param drift: Deviation tolerated without accumulating, defaults to 0
+    """
+
+    def __init__(self, threshold: float, drift: float = 0.0) -> None:
+        super().__init__(TSP_SEG_CUSUM, threshold, drift)
+
+
+class PageHinkleyRule(NativeSegmentationRule):
+    """End the segment when the Page-Hinkley test detects a change of its mean.
+
+    The test accumulates deviations of the values from the running mean of the segment,
+    reduced by ``delta``, and ends the segment when the cumulative deviation rises above
+    its minimum by more than ``threshold``, upwards or downwards.
+
+    :param threshold: Detection threshold (lambda)
+    :param delta: Magnitude of changes tolerated without accumulating, defaults to 0.005
+    """
+
+    def __init__(self, threshold: float, delta: float = 0.005) -> None:
+        super().__init__(TSP_SEG_PAGE_HINKLEY, threshold, delta)
+
+
+class MaxSizeRule(NativeSegmentationRule):
+    """End the segment when it holds ``size`` values.
+
+    :param size: Number of values per segment
+    :raises ValueError: If the size is not positive
+    """
+
+    def __init__(self, size: int) -> None:
+        if size < 1:
+            raise ValueError("Segment size must be positive")
+        super().__init__(TSP_SEG_MAX_SIZE, size)
@@ -1,10 +1,15 @@
 from collections import deque
 from collections.abc import Iterator
-from typing import Any, Callable
+from itertools import pairwise
+from typing import Any, Callable, cast
 
+from pysatl_tsp._c.lib import tsp_segmenter_push
 from pysatl_tsp.core import Handler, T
+from pysatl_tsp.core.spill import spill
 
 from .abstract import Scrubber, ScrubberWindow
+from .native_window import NativeScrubberWindow
+from .segmentation_rules import NativeSegmentationRule
 
 
 class OfflineSegmentationScrubber(Scrubber[T]):
@@ -17,8 +22,19 @@ class OfflineSegmentationScrubber(Scrubber[T]):
     This approach is suitable for scenarios where the entire dataset is available upfront
     and the segmentation logic requires global context or multiple passes over the data.
 
+    Native changepoint detectors (:class:`Pelt`, :class:`BinarySegmentation`) can be
+    passed as the rule. For long series with few changepoints use
+    :class:`BinarySegmentation`: the run time of :class:`Pelt` grows with the square
+    of the segment length.
+
+    With ``out_of_core=True`` numeric input is spilled to a memory-mapped float64 file
+    (see :func:`spill`) instead of being collected into lists and deques: the rule
+    receives a :class:`NativeScrubberWindow` over the file and the segments are
+    read-only views of it, which keeps series larger than RAM off the heap.
+
     :param segmentation_rule: Function that analyzes the complete series and returns a list of changepoint indices
     :param source: The handler providing input data, defaults to None
+    :param out_of_core: Whether to spill numeric input to a memory-mapped file, defaults to False
 
     Example:
         ```python
@@ -53,15 +69,20 @@ class OfflineSegmentationScrubber(Scrubber[T]):
     """
 
     def __init__(
-        self, segmentation_rule: Callable[[ScrubberWindow[T]], list[int]], source: Handler[Any, T] | None = None
+        self,
+        segmentation_rule: Callable[[ScrubberWindow[T]], list[int]],
+        source: Handler[Any, T] | None = None,
+        out_of_core: bool = False,
     ):
         """Initialize an offline segmentation scrubber.
 
         :param segmentation_rule: Function that analyzes the complete series and returns a list of changepoint indices
         :param source: The handler providing input data, defaults to None
+        :param out_of_core: Whether to spill numeric input to a memory-mapped file, defaults to False
         """
         super().__init__(source)
         self.segmentation_rule = segmentation_rule
+        self.out_of_core = out_of_core
 
     def __iter__(self) -> Iterator[ScrubberWindow[T]]:
         """Create an iterator that yields segments based on detected changepoints.
@@ -75,13 +96,21 @@ class OfflineSegmentationScrubber(Scrubber[T]):
         if self.source is None:
             raise ValueError("Source is not set")
 
+        if self.out_of_core:
+            series = NativeScrubberWindow.wrap(spill(self.source))
+            bounds = [0, *self.segmentation_rule(cast(ScrubberWindow[T], series)), len(series)]
+            for start, end in pairwise(bounds):
+                yield cast(ScrubberWindow[T], series[start:end])
+            return
+
         full_series_list = list(iter(self.source))
         full_series_deque = deque(full_series_list)
         series_window = ScrubberWindow(full_series_deque)
         change_points = self.segmentation_rule(series_window)
         segments = [0, *change_points, len(full_series_deque)]
         for start, end in zip(segments[:-1], segments[1:]):
-            yield series_window[start:end]
+            # Sliced from the list, slicing the deque would walk it from the start for every segment
+            yield ScrubberWindow(deque(full_series_list[start:end]), deque(range(start, end)))
 
 
 class OnlineSegmentationScrubber(Scrubber[T]):
@@ -92,6 +121,12 @@ class OnlineSegmentationScrubber(Scrubber[T]):
     is reached. It's designed for streaming data where segments need to be identified
     in real-time without waiting for the complete dataset.
 
+    Segments are handed over to the consumer as they are, without copying; the scrubber
+    continues in a new window. Built-in rules (:class:`JumpRule`, :class:`CusumRule`,
+    :class:`PageHinkleyRule`, :class:`MaxSizeRule`) keep O(1) state in C and are updated
+    with one native call per value, which keeps up with tick feeds; other callables are
+    called on the whole window per value.
+
     :param segmentation_rule: Function that evaluates the current window and returns True when a segment should end
     :param max_segment_size: Maximum number of points in a segment before forcing a split, defaults to 2^64
     :param source: The handler providing input data, defaults to None
@@ -130,6 +165,9 @@ class OnlineSegmentationScrubber(Scrubber[T]):
         # Segment values: [9, 8, 2]        # Split due to jump from 8 to 2
         # Segment values: [2, 3, 10]       # Split due to jump from 3 to 10
         # Segment values: [10, 9, 9]       # Remaining data
+
+        # The same segmentation in C
+        segmenter = OnlineSegmentationScrubber(JumpRule(3), max_segment_size=5, source=data_source)
         ```
     """
 
@@ -161,13 +199,33 @@ class OnlineSegmentationScrubber(Scrubber[T]):
         """
         if self.source is None:
             raise ValueError("Source is not set")
+        if isinstance(self.segmentation_rule, NativeSegmentationRule):
+            yield from self._iter_native(self.source, self.segmentation_rule)
+            return
+
         current_window: ScrubberWindow[T] = ScrubberWindow(deque())
         for index, item in enumerate(self.source):
             current_window.append(item, index)
 
             if self.segmentation_rule(current_window) or len(current_window) >= self.max_segment_size:
-                yield current_window.copy()
-                current_window.clear()
+                # The segment is handed over to the consumer, the next one starts in a new window
+                yield current_window
+                current_window = ScrubberWindow(deque())
 
         if current_window:
-            yield current_window.copy()
+            yield current_window
+
+    def _iter_native(self, source: Handler[Any, T], rule: NativeSegmentationRule) -> Iterator[ScrubberWindow[T]]:
+        """Segment values with a rule that runs in C, a segment is emitted with the value that ends it."""
+        state = rule.init_state(self.max_segment_size)
+        segment: list[T] = []
+        first = 0  # Index of the first value of the segment
+        for index, item in enumerate(source):
+            segment.append(item)
+            if tsp_segmenter_push(state, float(cast(float, item))):
+                yield ScrubberWindow(deque(segment), deque(range(first, index + 1)))
+                segment = []
+                first = index + 1
+
+        if segment:
+            yield ScrubberWindow(deque(segment), deque(range(first, first + len(segment))))
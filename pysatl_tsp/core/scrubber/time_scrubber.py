@@ -0,0 +1,157 @@
+from __future__ import annotations
+
+from collections.abc import Iterator
+from dataclasses import dataclass
+from datetime import timedelta
+from typing import Any
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    TSP_TW_SLIDING,
+    TSP_TW_TUMBLING,
+    TSP_TW_UNORDERED,
+    tsp_free_time_window,
+    tsp_time_window_flush,
+    tsp_time_window_init,
+    tsp_time_window_process,
+)
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.data_providers.tsf_data_provider import Timestamp, to_timestamp
+from pysatl_tsp.core.native import resolve_option
+
+__all__ = ["TIME_WINDOW_MODES", "TimeWindow", "TimeWindowScrubber"]
+
+# How windows are placed on the time axis
+TIME_WINDOW_MODES = {"sliding": TSP_TW_SLIDING, "tumbling": TSP_TW_TUMBLING}
+
+
+@dataclass(frozen=True)
+class TimeWindow:
+    """Aggregates of the points of an event-time window.
+
+    The window covers timestamps in ``[start, end)``.
+
+    :param start: First timestamp covered by the window
+    :param end: Timestamp after the window
+    :param count: Number of points in the window
+    :param sum: Sum of the values
+    :param min: Smallest value
+    :param max: Largest value
+    :param first: Value of the oldest point
+    :param last: Value of the newest point
+    """
+
+    start: int
+    end: int
+    count: int
+    sum: float
+    min: float
+    max: float
+    first: float
+    last: float
+
+    @property
+    def mean(self) -> float:
+        """Get the mean of the values.
+
+        :return: Mean value
+        """
+        return self.sum / self.count
+
+
+class TimeWindowScrubber(Handler[tuple[Timestamp, float], TimeWindow]):
+    """A scrubber of irregular time series that windows points by their timestamps.
+
+    Consumes ``(timestamp, value)`` pairs with non-decreasing timestamps and emits the
+    aggregates of event-time windows instead of the points themselves:
+
+    - ``"sliding"``: after every point, the window of the preceding ``duration``,
+      ``(t - duration, t]`` for a point at ``t``
+    - ``"tumbling"``: one window per non-empty bucket ``[k * duration, (k + 1) * duration)``
+      (shifted by ``origin``), emitted when a later point arrives or the stream ends
+
+    Windows are maintained in C: points are evicted by time and the count, sum, minimum
+    and maximum are kept up to date in O(1) amortized per point, so a "last 5 seconds"
+    statistic doesn't rescan the window. Every point is passed on as soon as the source
+    yields it, so a window is emitted without waiting for later points of a live source.
+
+    Datetime timestamps are converted to nanoseconds since the epoch, durations given as
+    timedelta are converted to nanoseconds as well; integer durations are in the units of
+    the timestamps.
+
+    :param duration: Length of the windows
+    :param mode: Window placement, "sliding" or "tumbling", defaults to "sliding"
+    :param origin: Timestamp the tumbling buckets are aligned to, defaults to 0
+    :param source: The handler providing ``(timestamp, value)`` pairs, defaults to None
+    :raises ValueError: If the duration is not positive or the mode is unknown
+
+    Example:
+        ```python
+        ticks = SimpleDataProvider([(0, 1.0), (400, 3.0), (1100, 2.0), (2600, 5.0)])
+
+        # 1-second tumbling bars of millisecond ticks
+        bars = TimeWindowScrubber(1000, mode="tumbling", source=ticks)
+        for bar in bars:
+            print(bar.start, bar.first, bar.max, bar.min, bar.last)
+
+        # Output:
+        # 0 1.0 3.0 1.0 3.0
+        # 1000 2.0 2.0 2.0 2.0
+        # 2000 5.0 5.0 5.0 5.0
+
+        # Mean of the last 5 seconds after every tick
+        means = ticks | TimeWindowScrubber(timedelta(seconds=5)) | MappingHandler(lambda w: w.mean)
+        ```
+    """
+
+    def __init__(
+        self,
+        duration: int | timedelta,
+        mode: str = "sliding",
+        origin: Timestamp = 0,
+        source: Handler[Any, tuple[Timestamp, float]] | None = None,
+    ) -> None:
+        super().__init__(source)
+        if isinstance(duration, timedelta):
+            duration = int(duration / timedelta(microseconds=1)) * 1000
+        if duration < 1:
+            raise ValueError("Window duration must be positive")
+        self.duration = duration
+        self.mode = mode
+        self.origin = to_timestamp(origin)
+        self._mode = resolve_option("window mode", mode, TIME_WINDOW_MODES)
+
+    def __iter__(self) -> Iterator[TimeWindow]:
+        """Create an iterator over the windows of the source points.
+
+        :return: Iterator yielding window aggregates
+        :raises ValueError: If no source has been set or timestamps decrease
+        :raises MemoryError: If the window cannot grow
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+
+        window = tsp_time_window_init(self._mode, self.duration, self.origin)
+        if window == ffi.NULL:
+            raise MemoryError("Could not allocate time window")
+        window = ffi.gc(window, tsp_free_time_window)
+        stamp = ffi.new("int64_t[1]")
+        value = ffi.new("double[1]")
+        out = ffi.new("struct tsp_time_agg[1]")
+
+        for ts, point_value in self.source:
+            stamp[0] = to_timestamp(ts)
+            value[0] = point_value
+            emitted = tsp_time_window_process(window, stamp, value, 1, out)
+            if emitted == TSP_TW_UNORDERED:
+                raise ValueError("Timestamps of the points must be non-decreasing")
+            if emitted < 0:
+                raise MemoryError("Could not allocate memory for time window")
+            if emitted:
+                yield self._window(out[0])
+        if tsp_time_window_flush(window, out):
+            yield self._window(out[0])
+
+    @staticmethod
+    def _window(agg: Any) -> TimeWindow:
+        return TimeWindow(agg.start, agg.end, agg.count, agg.sum, agg.min, agg.max, agg.first, agg.last)
@@ -0,0 +1,69 @@
+import os
+import tempfile
+from collections.abc import Iterable
+from itertools import islice
+from typing import Any
+
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import (
+    tsp_spill_append,
+    tsp_spill_close,
+    tsp_spill_data,
+    tsp_spill_drain,
+    tsp_spill_open,
+    tsp_spill_size,
+)
+
+__all__ = ["SPILL_BATCH", "spill"]
+
+# Values converted and appended per call for sources that are not native
+SPILL_BATCH = 65536
+
+
+def spill(source: Iterable[Any], directory: str | None = None, size_hint: int = 0) -> npt.NDArray[np.float64]:
+    """Collect a series into a float64 array backed by a memory-mapped temporary file.
+
+    Offline handlers use it to avoid materializing the whole series as Python objects:
+    the values are stored once, as doubles, in an unlinked file that the OS pages out
+    to disk under memory pressure, so series larger than RAM can be processed. Native
+    pipelines (with a ``handler`` attribute) are drained by the C library without
+    Python per value, other sources are converted in batches. Missing values (None)
+    are stored as NaN.
+
+    The returned array is read-only and owns the mapping: the file space is freed when
+    the array and all views of it are garbage collected.
+
+    :param source: Handler or iterable of numbers
+    :param directory: Directory of the temporary file, defaults to the system temporary directory
+    :param size_hint: Expected number of values, preallocates the file, defaults to 0 (unknown)
+    :return: Array of the series values
+    :raises OSError: If the temporary file cannot be created or grown
+    :raises Exception: The error of a failed native source (see :meth:`Handler.check`)
+    """
+    buffer = tsp_spill_open(os.fsencode(directory or tempfile.gettempdir()), size_hint)
+    if buffer == ffi.NULL:
+        raise OSError("Could not create spill file")
+    try:
+        iterator = iter(source)
+        if hasattr(source, "handler"):
+            if tsp_spill_drain(buffer, source.handler) < 0:
+                raise OSError("Could not grow spill file")
+            source.check()
+        else:
+            while batch := list(islice(iterator, SPILL_BATCH)):
+                values = np.fromiter((np.nan if value is None else value for value in batch), np.float64, len(batch))
+                if tsp_spill_append(buffer, ffi.from_buffer("double[]", values), len(values)) != 0:
+                    raise OSError("Could not grow spill file")
+    except BaseException:
+        tsp_spill_close(buffer)
+        raise
+
+    size = tsp_spill_size(buffer)
+    # The data pointer owns the buffer from now on, it is closed when the last view goes away
+    data = ffi.gc(tsp_spill_data(buffer), lambda _: tsp_spill_close(buffer))
+    array = np.frombuffer(ffi.buffer(data, ffi.sizeof("double") * size), np.float64)
+    array.flags.writeable = False
+    return array
@@ -1,17 +1,21 @@
-from collections.abc import Iterator
+from collections.abc import AsyncIterator, Iterator
 from typing import Any, cast
 
 import cffi
 
 from pysatl_tsp._c.lib import (
+    tsp_batch_EMA,
     tsp_ema_data_init,
+    tsp_ema_data_reset,
     tsp_free_ema_data,
     tsp_free_handler,
     tsp_init_handler,
     tsp_next_chain,
     tsp_op_EMA,
+    tsp_reset_handler,
 )
 from pysatl_tsp.core import Handler
+from pysatl_tsp.core.native import PRECISIONS, apply_batches, resolve_option
 from pysatl_tsp.core.processor import InductiveHandler
 from pysatl_tsp.core.scrubber import ScrubberWindow
 
@@ -146,6 +150,18 @@ class EMAHandler(InductiveHandler[float | None, float | None]):
 
 
 class CEMAHandler(Handler[float | None, float | None]):
+    """Exponential Moving Average (EMA) handler computed by the native C library.
+
+    :param length: The period for EMA calculation, defaults to 10
+    :param adjust: Whether to use adjusted weights in calculation, defaults to False
+    :param sma: Whether to use SMA for initial value, defaults to True
+    :param alpha: Custom smoothing factor, defaults to 2/(length+1) if None
+    :param source: Input data source, defaults to None
+    :param precision: Storage precision of the SMA warm-up window, "float64" or "float32",
+                      the EMA state is always double, defaults to "float64"
+    :raises ValueError: If precision is unknown
+    """
+
     def __init__(
         self,
         length: int = 10,
@@ -153,9 +169,12 @@ class CEMAHandler(Handler[float | None, float | None]):
         sma: bool = True,
         alpha: float | None = None,
         source: Handler[Any, float | None] | None = None,
+        precision: str = "float64",
     ):
         super().__init__(source)
         self.length = length if length and length > 0 else 10
+        self.precision = precision
+        self._precision = resolve_option("precision", precision, PRECISIONS)
         if adjust:
             self.adjust = 1
         else:
@@ -172,29 +191,41 @@ class CEMAHandler(Handler[float | None, float | None]):
         if source is not None:
             if hasattr(source, "handler"):
                 self.handler = tsp_init_handler(
-                    ffi.cast("void *", tsp_ema_data_init(self.length, self.sma, self.alpha, self.adjust)),
+                    ffi.cast(
+                        "void *", tsp_ema_data_init(self.length, self.sma, self.alpha, self.adjust, self._precision)
+                    ),
                     source.handler,
                     tsp_op_EMA,
                     ffi.NULL,
                 )
             else:
                 self.handler = tsp_init_handler(
-                    ffi.cast("void *", tsp_ema_data_init(self.length, self.sma, self.alpha, self.adjust)),
+                    ffi.cast(
+                        "void *", tsp_ema_data_init(self.length, self.sma, self.alpha, self.adjust, self._precision)
+                    ),
                     ffi.NULL,
                     tsp_op_EMA,
                     ffi.NULL,
                 )
         else:
             self.handler = tsp_init_handler(
-                ffi.cast("void *", tsp_ema_data_init(self.length, self.sma, self.alpha, self.adjust)),
+                ffi.cast("void *", tsp_ema_data_init(self.length, self.sma, self.alpha, self.adjust, self._precision)),
                 ffi.NULL,
                 tsp_op_EMA,
                 ffi.NULL,
             )
+        # Blocks of values are processed without one operation call per value
+        self.handler.batch = tsp_batch_EMA
 
     def __iter__(self) -> Iterator[float | None]:
+        """Start a new pass over the source.
+
+        :return: The handler itself, computing from an empty window
+        :raises ValueError: If the source is not set
+        """
         if self.source is None:
             raise ValueError("Source is not set")
+        self._reset()
         self.src_itr = iter(self.source)
         self.handler.py_iter = ffi.cast("void*", id(self.src_itr))
         return self
@@ -206,9 +237,27 @@ class CEMAHandler(Handler[float | None, float | None]):
                 return cast(float, res[0])
             else:
                 return None
-        else:
-            raise StopIteration
+        self.check()
+        raise StopIteration
+
+    def abatches(self) -> AsyncIterator[list[float | None]]:
+        """Start a new asynchronous pass, every batch of the source is processed by one native call.
+
+        :return: An asynchronous iterator yielding processed batches
+        :raises ValueError: If the source is not set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+        self._reset()
+        return apply_batches(self.handler, self.source)
+
+    def _reset(self) -> None:
+        """Drop the window and buffered results of a previous pass."""
+        tsp_reset_handler(self.handler)
+        tsp_ema_data_reset(self.handler.data, self.sma)
 
     def __del__(self) -> None:
+        if not hasattr(self, "handler"):
+            return
         tsp_free_ema_data(self.handler.data)
         tsp_free_handler(self.handler)
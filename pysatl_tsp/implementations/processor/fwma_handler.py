@@ -1,4 +1,4 @@
-from collections.abc import Iterator
+from collections.abc import AsyncIterator, Iterator
 from typing import Any, cast
 
 import cffi
@@ -7,11 +7,14 @@ from pysatl_tsp._c.lib import (
     tsp_free_fwma_data,
     tsp_free_handler,
     tsp_fwma_data_init,
+    tsp_fwma_data_reset,
     tsp_init_handler,
     tsp_next_chain,
     tsp_op_FWMA,
+    tsp_reset_handler,
 )
 from pysatl_tsp.core import Handler
+from pysatl_tsp.core.native import PRECISIONS, apply_batches, resolve_option
 from pysatl_tsp.core.processor.inductive.weighted_moving_average_handler import WeightedMovingAverageHandler
 
 ffi = cffi.FFI()
@@ -93,14 +96,27 @@ class FWMAHandler(WeightedMovingAverageHandler):
 
 
 class CFWMAHandler(Handler[float | None, float | None]):
+    """Fibonacci Weighted Moving Average (FWMA) handler computed by the native C library.
+
+    :param length: The period for FWMA calculation, defaults to 10
+    :param asc: Whether weights should be in ascending order, defaults to False
+    :param source: Input data source, defaults to None
+    :param precision: Storage precision of the price window, "float64" or "float32",
+                      weights and the weighted sum are always double, defaults to "float64"
+    :raises ValueError: If precision is unknown
+    """
+
     def __init__(
         self,
         length: int = 10,
         asc: bool = False,
         source: Handler[Any, float | None] | None = None,
+        precision: str = "float64",
     ):
         super().__init__(source)
         self.length = length if length and length > 0 else 10
+        self.precision = precision
+        self._precision = resolve_option("precision", precision, PRECISIONS)
         if asc:
             self.asc = 1
         else:
@@ -109,29 +125,35 @@ class CFWMAHandler(Handler[float | None, float | None]):
         if source is not None:
             if hasattr(source, "handler"):
                 self.handler = tsp_init_handler(
-                    ffi.cast("void *", tsp_fwma_data_init(self.length, self.asc)),
+                    ffi.cast("void *", tsp_fwma_data_init(self.length, self.asc, self._precision)),
                     source.handler,
                     tsp_op_FWMA,
                     ffi.NULL,
                 )
             else:
                 self.handler = tsp_init_handler(
-                    ffi.cast("void *", tsp_fwma_data_init(self.length, self.asc)),
+                    ffi.cast("void *", tsp_fwma_data_init(self.length, self.asc, self._precision)),
                     ffi.NULL,
                     tsp_op_FWMA,
                     ffi.NULL,
                 )
         else:
             self.handler = tsp_init_handler(
-                ffi.cast("void *", tsp_fwma_data_init(self.length, self.asc)),
+                ffi.cast("void *", tsp_fwma_data_init(self.length, self.asc, self._precision)),
                 ffi.NULL,
                 tsp_op_FWMA,
                 ffi.NULL,
             )
 
     def __iter__(self) -> Iterator[float | None]:
+        """Start a new pass over the source.
+
+        :return: The handler itself, computing from an empty window
+        :raises ValueError: If the source is not set
+        """
         if self.source is None:
             raise ValueError("Source is not set")
+        self._reset()
         self.src_itr = iter(self.source)
         self.handler.py_iter = ffi.cast("void*", id(self.src_itr))
         return self
@@ -143,9 +165,27 @@ class CFWMAHandler(Handler[float | None, float | None]):
                 return cast(float, res[0])
             else:
                 return None
-        else:
-            raise StopIteration
+        self.check()
+        raise StopIteration
+
+    def abatches(self) -> AsyncIterator[list[float | None]]:
+        """Start a new asynchronous pass, every batch of the source is processed by one native call.
+
+        :return: An asynchronous iterator yielding processed batches
+        :raises ValueError: If the source is not set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+        self._reset()
+        return apply_batches(self.handler, self.source)
+
+    def _reset(self) -> None:
+        """Drop the window and buffered results of a previous pass."""
+        tsp_reset_handler(self.handler)
+        tsp_fwma_data_reset(self.handler.data)
 
     def __del__(self) -> None:
+        if not hasattr(self, "handler"):
+            return
         tsp_free_fwma_data(self.handler.data)
         tsp_free_handler(self.handler)
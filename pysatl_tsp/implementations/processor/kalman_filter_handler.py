@@ -3,8 +3,7 @@ from typing import Any, Union
 import numpy as np
 
 from pysatl_tsp.core import Handler
-from pysatl_tsp.core.processor import OnlineFilterHandler
-from pysatl_tsp.core.scrubber import ScrubberWindow
+from pysatl_tsp.core.processor import IncrementalFilter, OnlineFilterHandler
 
 
 class KalmanFilterHandler(OnlineFilterHandler[float, float]):
@@ -14,6 +13,9 @@ class KalmanFilterHandler(OnlineFilterHandler[float, float]):
     noisy time series data. It estimates the underlying state of a system based on
     a sequence of noisy measurements.
 
+    The filter is incremental (see :class:`IncrementalFilter`): every measurement only
+    updates the state estimate ``x`` and covariance ``P``, no history is kept.
+
     :param F: State transition matrix
     :param H: Measurement matrix
     :param B: Control input matrix, defaults to 0
@@ -92,7 +94,7 @@ class KalmanFilterHandler(OnlineFilterHandler[float, float]):
 
         self.x: np.ndarray[Any, np.dtype[np.float64]] = np.zeros((self.n, 1)) if x0 is None else x0
 
-        super().__init__(filter_func=self._apply_kalman_filter, filter_config=None, source=source)
+        super().__init__(filter_func=_KalmanStep(self), filter_config=None, source=source)
 
     def predict(
         self, u: Union[float, np.ndarray[Any, np.dtype[np.float64]]] = 0
@@ -126,21 +128,27 @@ class KalmanFilterHandler(OnlineFilterHandler[float, float]):
             np.dot(K, self.R), K.T
         )
 
-    def _apply_kalman_filter(self, window: ScrubberWindow[float], _: Any) -> float:
-        """Apply the Kalman filter to the latest point in the window.
 
-        :param window: Window of historical data
-        :param _: Unused configuration parameter
-        :return: Filtered value
-        """
-        if not window:
-            return 0.0
+class _KalmanStep(IncrementalFilter[float, float]):
+    """Incremental step of a Kalman filter handler, the state lives in the handler."""
+
+    def __init__(self, kalman: KalmanFilterHandler) -> None:
+        self.kalman = kalman
 
-        measurement: float = window[-1]
+    def init_state(self, config: Any) -> None:
+        return None
 
-        prediction_array = np.dot(self.H, self.predict())
+    def step(self, state: None, value: float, config: Any) -> tuple[None, float]:
+        """Predict the next measurement, then correct the state with the actual one.
+
+        :param state: Unused, the state is kept in the handler
+        :param value: Measurement
+        :param config: Unused configuration parameter
+        :return: Unchanged state and the predicted measurement
+        """
+        prediction_array = np.dot(self.kalman.H, self.kalman.predict())
         prediction: float = float(prediction_array.item())
 
-        self.update(measurement)
+        self.kalman.update(value)
 
-        return prediction
+        return None, prediction
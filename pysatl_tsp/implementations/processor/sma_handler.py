@@ -1,17 +1,22 @@
-from collections.abc import Iterator
+from collections.abc import AsyncIterator, Iterator
 from typing import Any, cast
 
 import cffi
 
 from pysatl_tsp._c.lib import (
+    tsp_batch_MA,
     tsp_free_handler,
     tsp_free_queue,
     tsp_init_handler,
     tsp_next_chain,
     tsp_op_MA,
-    tsp_queue_init,
+    tsp_queue_init_precision,
+    tsp_queue_reset,
+    tsp_queue_set_sum_mode,
+    tsp_reset_handler,
 )
 from pysatl_tsp.core import Handler
+from pysatl_tsp.core.native import PRECISIONS, SUM_MODES, apply_batches, resolve_option
 from pysatl_tsp.core.processor.inductive.moving_window_handler import MovingWindowHandler
 
 ffi = cffi.FFI()
@@ -150,26 +155,63 @@ class MAHandler(MovingWindowHandler[float | None, float | None]):
 
 
 class CMAHandler(Handler[float, float]):
-    def __init__(self, length: int = 10, source: Handler[Any, float] | None = None):
+    """Moving Average handler computed by the native C library.
+
+    The running sum of the window is kept by the native queue. Over very long streams
+    a naive running sum accumulates floating-point drift, so the accumulation mode
+    can be selected per handler:
+
+    - ``"naive"``: plain running sum, fastest
+    - ``"kahan"``: Neumaier compensated running sum, error bounded by the window contents
+    - ``"resum"``: naive running sum, replaced once per window length by an exactly
+      re-summed shadow sum maintained in O(1) per value
+
+    The window itself can be stored as ``"float64"`` or ``"float32"``. Float32 storage
+    halves the memory of long windows; the running sum stays double and accounts values
+    exactly as they were stored, so it does not drift because of the narrowing.
+
+    :param length: The period for the MA calculation, defaults to 10
+    :param source: Input data source, defaults to None
+    :param sum_mode: Accumulation mode of the running sum, defaults to "naive"
+    :param precision: Storage precision of the window, defaults to "float64"
+    :raises ValueError: If sum_mode or precision is unknown
+    """
+
+    def __init__(
+        self,
+        length: int = 10,
+        source: Handler[Any, float] | None = None,
+        sum_mode: str = "naive",
+        precision: str = "float64",
+    ):
         super().__init__(source=source)
         self.length = length if length and length > 0 else 10
+        self.sum_mode = sum_mode
+        self.precision = precision
+        # Options are resolved before the queue is allocated, so an invalid one leaks nothing
+        queue_precision = resolve_option("precision", precision, PRECISIONS)
+        queue_sum_mode = resolve_option("sum mode", sum_mode, SUM_MODES)
+        queue = tsp_queue_init_precision(self.length, queue_precision)
+        tsp_queue_set_sum_mode(queue, queue_sum_mode)
         if source is not None:
             if hasattr(source, "handler"):
-                self.handler = tsp_init_handler(
-                    ffi.cast("void *", tsp_queue_init(self.length)), source.handler, tsp_op_MA, ffi.NULL
-                )
+                self.handler = tsp_init_handler(ffi.cast("void *", queue), source.handler, tsp_op_MA, ffi.NULL)
             else:
-                self.handler = tsp_init_handler(
-                    ffi.cast("void *", tsp_queue_init(self.length)), ffi.NULL, tsp_op_MA, ffi.NULL
-                )
+                self.handler = tsp_init_handler(ffi.cast("void *", queue), ffi.NULL, tsp_op_MA, ffi.NULL)
         else:
-            self.handler = tsp_init_handler(
-                ffi.cast("void *", tsp_queue_init(self.length)), ffi.NULL, tsp_op_MA, ffi.NULL
-            )
+            self.handler = tsp_init_handler(ffi.cast("void *", queue), ffi.NULL, tsp_op_MA, ffi.NULL)
+        # Blocks of values go through the vectorized MA kernel
+        self.handler.batch = tsp_batch_MA
 
     def __iter__(self) -> Iterator[float]:
+        """Start a new pass over the source.
+
+        :return: The handler itself, computing from an empty window
+        :raises ValueError: If the source is not set
+        """
         if self.source is None:
             raise ValueError("Source is not set")
+        self._reset()
         self.src_itr = iter(self.source)
         self.handler.py_iter = ffi.cast("void*", id(self.src_itr))
         return self
@@ -178,9 +220,27 @@ class CMAHandler(Handler[float, float]):
         res = tsp_next_chain(self.handler, 64)
         if res != ffi.NULL:
             return cast(float, res[0])
-        else:
-            raise StopIteration
+        self.check()
+        raise StopIteration
+
+    def abatches(self) -> AsyncIterator[list[float]]:
+        """Start a new asynchronous pass, every batch of the source is processed by one native call.
+
+        :return: An asynchronous iterator yielding processed batches
+        :raises ValueError: If the source is not set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
+        self._reset()
+        return apply_batches(self.handler, self.source, inf_as_none=False)
+
+    def _reset(self) -> None:
+        """Drop the window and buffered results of a previous pass."""
+        tsp_reset_handler(self.handler)
+        tsp_queue_reset(self.handler.data)
 
     def __del__(self) -> None:
+        if not hasattr(self, "handler"):
+            return
         tsp_free_queue(self.handler.data)
         tsp_free_handler(self.handler)
@@ -1,9 +1,43 @@
+import os
 from collections.abc import Iterator
-from typing import Any, Optional
+from concurrent.futures import ProcessPoolExecutor
+from multiprocessing.shared_memory import SharedMemory
+from typing import Any, Callable, cast
 
-from pysatl_tsp.core import Handler, T
-from pysatl_tsp.core.processor import MappingHandler
-from pysatl_tsp.core.scrubber import ScrubberWindow, SlidingScrubber
+import numpy as np
+import numpy.typing as npt
+
+from pysatl_tsp.core import Handler, T, U
+from pysatl_tsp.core.scrubber import NativeScrubberWindow, ScrubberWindow
+
+# State of the worker processes of TimeSeriesCrossValidator.evaluate: the fold function,
+# the shared memory block and the series array viewing it
+_worker_state: dict[str, Any] = {}
+
+
+def _attach_series(name: str, length: int, fold: Callable[[NativeScrubberWindow, NativeScrubberWindow], Any]) -> None:
+    """Attach a worker process to the shared series (pool initializer)."""
+    memory = SharedMemory(name=name)
+    _worker_state["fold"] = fold
+    _worker_state["memory"] = memory
+    _worker_state["series"] = np.ndarray((length,), dtype=np.float64, buffer=memory.buf)
+
+
+def _evaluate_split(bounds: tuple[int, int]) -> Any:
+    """Run the fold function of a worker process on one split."""
+    return _worker_state["fold"](*_split_windows(_worker_state["series"], *bounds))
+
+
+def _split_windows(
+    series: npt.NDArray[np.float64], train_end: int, val_end: int
+) -> tuple[NativeScrubberWindow, NativeScrubberWindow]:
+    """View a split of the series as train and validation windows, without copying.
+
+    Both windows are slices of one window over the series, their indices are the
+    positions of the values and are not stored.
+    """
+    split = NativeScrubberWindow.wrap(series[:val_end])
+    return split[:train_end], split[train_end:]
 
 
 class TimeSeriesCrossValidator(Handler[T, tuple[ScrubberWindow[T], ScrubberWindow[T]]]):
@@ -23,9 +57,17 @@ class TimeSeriesCrossValidator(Handler[T, tuple[ScrubberWindow[T], ScrubberWindo
     This approach respects the temporal nature of time series data and prevents
     data leakage from future to past.
 
+    Splits are ranges of positions over the series history, see :meth:`split_ranges`.
+    By default every split is copied into a pair of :class:`ScrubberWindow`. With
+    ``views=True`` the numeric series is kept in one growing float64 array and splits
+    are :class:`NativeScrubberWindow` views of it, so producing a split costs O(1)
+    instead of O(n). :meth:`evaluate` runs a fold function over all splits in worker
+    processes that share the series instead of receiving copies of it.
+
     :param min_train_size: Minimum number of points in the initial training set
     :param val_size: Number of points in each validation set
     :param source: The handler providing input data, defaults to None
+    :param views: Whether to yield zero-copy views of a float64 series, defaults to False
 
     Example:
         ```python
@@ -104,19 +146,44 @@ class TimeSeriesCrossValidator(Handler[T, tuple[ScrubberWindow[T], ScrubberWindo
             mse = np.mean((val_pred - val_y) ** 2)
 
             print(f"Split {i + 1} - Validation MSE: {mse:.4f}")
+
+
+        # The same evaluation in parallel, the fold function must be picklable
+        def naive_forecast_mse(train, val):
+            return float(np.mean((val.values - train.values[-1]) ** 2))
+
+
+        scores = cv.evaluate(naive_forecast_mse, workers=4)
         ```
     """
 
-    def __init__(self, min_train_size: int, val_size: int, source: Optional[Handler[Any, T]] = None):
+    def __init__(self, min_train_size: int, val_size: int, source: Handler[Any, T] | None = None, views: bool = False):
         """Initialize a time series cross-validator.
 
         :param min_train_size: Minimum number of points in the initial training set
         :param val_size: Number of points in each validation set
         :param source: The handler providing input data, defaults to None
+        :param views: Whether to yield zero-copy views of a float64 series, defaults to False
         """
         super().__init__(source)
         self.min_train_size = min_train_size
         self.val_size = val_size
+        self.views = views
+
+    def split_ranges(self, length: int) -> list[tuple[range, range]]:
+        """Get the positions of the splits of a series.
+
+        :param length: Number of points in the series
+        :return: Pairs of (training positions, validation positions) for every split
+        """
+        return [
+            (range(val_start), range(val_start, val_start + self.val_size))
+            for val_start in range(self.min_train_size, length - self.val_size + 1, self.val_size)
+        ]
+
+    def _is_split_end(self, length: int) -> bool:
+        """Check whether a split ends with the point at position ``length - 1``."""
+        return length > self.min_train_size and (length - self.min_train_size) % self.val_size == 0
 
     def __iter__(self) -> Iterator[tuple[ScrubberWindow[T], ScrubberWindow[T]]]:
         """Create an iterator that yields train-validation splits for time series cross-validation.
@@ -126,20 +193,84 @@ class TimeSeriesCrossValidator(Handler[T, tuple[ScrubberWindow[T], ScrubberWindo
         2. Each subsequent split adds val_size points to the training set
         3. Each validation set has exactly val_size points and follows the training set
 
+        Splits are yielded as soon as their last point arrives from the source.
+
         :return: Iterator yielding tuples of (training_window, validation_window)
         :raises ValueError: If no source has been set
         """
         if self.source is None:
             raise ValueError("Source is not set")
 
-        scrubber = SlidingScrubber(
-            lambda buffer: len(buffer) > self.min_train_size
-            and (len(buffer) - self.min_train_size) % self.val_size == 0,
-            shift=0,
-            source=self.source,
-        )
-        handler: MappingHandler[ScrubberWindow[T], tuple[ScrubberWindow[T], ScrubberWindow[T]]] = MappingHandler(
-            map_func=lambda window: (window[: -self.val_size], window[-self.val_size :])
-        )
+        if self.views:
+            yield from self._iter_views(self.source)
+            return
+
+        # Every split gets its own copy of the training set, the validation set is handed
+        # over and a new one is started
+        train: ScrubberWindow[T] = ScrubberWindow()
+        val: ScrubberWindow[T] = ScrubberWindow()
+        for position, value in enumerate(self.source):
+            (train if position < self.min_train_size else val).append(value, position)
+            if self._is_split_end(position + 1):
+                split = (train.copy(), val)
+                train.values.extend(val.values)
+                train.indices.extend(val.indices)
+                val = ScrubberWindow()
+                yield split
+
+    def _iter_views(self, source: Handler[Any, T]) -> Iterator[tuple[ScrubberWindow[T], ScrubberWindow[T]]]:
+        """Yield splits as views of one growing float64 array.
+
+        The array is reallocated by doubling; views of the old array stay valid since
+        positions that have been written are never overwritten.
+        """
+        series = np.empty(max(self.min_train_size + self.val_size, 16), dtype=np.float64)
+        for position, value in enumerate(source):
+            if position == len(series):
+                series = np.concatenate([series, np.empty(len(series), dtype=np.float64)])
+            series[position] = np.nan if value is None else cast(float, value)
+            if self._is_split_end(position + 1):
+                train, val = _split_windows(series, position + 1 - self.val_size, position + 1)
+                yield cast(ScrubberWindow[T], train), cast(ScrubberWindow[T], val)
+
+    def evaluate(
+        self, fold: Callable[[NativeScrubberWindow, NativeScrubberWindow], U], workers: int | None = None
+    ) -> list[U]:
+        """Evaluate a function on every split in parallel worker processes.
+
+        The numeric series is collected once into shared memory, each worker attaches
+        to it and calls ``fold(train, validation)`` on :class:`NativeScrubberWindow`
+        views of its splits, so neither the series nor the splits are copied to the
+        workers. The function is sent to every worker once and must be picklable
+        (e.g. defined at module level), unless ``workers`` is 1.
+
+        :param fold: Function of the training and validation windows of a split
+        :param workers: Number of worker processes, defaults to None (the number of CPUs);
+                        1 evaluates the splits in the current process
+        :return: Results of the function for every split, in split order
+        :raises ValueError: If no source has been set
+        """
+        if self.source is None:
+            raise ValueError("Source is not set")
 
-        yield from (scrubber | handler)
+        values = np.fromiter((np.nan if value is None else value for value in self.source), dtype=np.float64)
+        bounds = [(val.start, val.stop) for _, val in self.split_ranges(len(values))]
+        if not bounds:
+            return []
+        if workers == 1:
+            return [fold(*_split_windows(values, *split)) for split in bounds]
+
+        memory = SharedMemory(create=True, size=values.nbytes)
+        try:
+            np.ndarray(values.shape, dtype=np.float64, buffer=memory.buf)[:] = values
+            with ProcessPoolExecutor(
+                max_workers=workers, initializer=_attach_series, initargs=(memory.name, len(values), fold)
+            ) as pool:
+                return list(
+                    pool.map(
+                        _evaluate_split, bounds, chunksize=max(1, len(bounds) // (4 * (workers or os.cpu_count() or 1)))
+                    )
+                )
+        finally:
+            memory.close()
+            memory.unlink()
@@ -0,0 +1,69 @@
+import math
+
+import pytest
+from hypothesis import given
+from hypothesis import strategies as st
+
+from pysatl_tsp.core.arrow import to_arrow
+from pysatl_tsp.core.data_providers import ArrowDataProvider, SimpleDataProvider
+from pysatl_tsp.implementations.processor.ema_handler import CEMAHandler
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler
+from tests.utils import safe_allclose
+
+
+@given(st.lists(st.floats(-100, 100, allow_nan=False)), st.integers(min_value=1, max_value=20))
+def test_round_trip_through_arrow(data: list[float], length: int) -> None:
+    exported = to_arrow(SimpleDataProvider(data) | CMAHandler(length=1), size_hint=len(data) // 2)
+    assert len(exported) == len(data)
+    assert exported.null_count == 0
+
+    native = list(ArrowDataProvider(exported) | CMAHandler(length=length))
+    python = list(SimpleDataProvider(data) | CMAHandler(length=length))
+    assert safe_allclose(python, native)
+
+
+def test_missing_values_become_nulls() -> None:
+    warm_up = 2
+    exported = to_arrow(SimpleDataProvider([1.0, 2.0, 3.0, 4.0]) | CEMAHandler(length=warm_up + 1))
+    assert exported.null_count == warm_up
+
+    result = list(ArrowDataProvider(exported))
+    assert all(math.isnan(value) for value in result[:warm_up])
+    assert (
+        result[warm_up:] == list(SimpleDataProvider([1.0, 2.0, 3.0, 4.0]) | CEMAHandler(length=warm_up + 1))[warm_up:]
+    )
+
+
+def test_every_export_call_gives_new_capsules() -> None:
+    exported = to_arrow(SimpleDataProvider([1.0, 2.0, 3.0]) | CMAHandler(length=1))
+    first = ArrowDataProvider(exported)
+    second = ArrowDataProvider(exported)
+    assert exported.__arrow_c_array__()[1] is not exported.__arrow_c_array__()[1]
+    del exported
+    assert list(first) == list(second) == [1.0, 2.0, 3.0]
+
+
+def test_invalid_arguments() -> None:
+    with pytest.raises(TypeError):
+        ArrowDataProvider([1.0, 2.0])
+    with pytest.raises(ValueError):
+        to_arrow(SimpleDataProvider([1.0]))
+
+
+def test_pyarrow_interop() -> None:
+    pa = pytest.importorskip("pyarrow")
+
+    array = pa.array([1.0, None, 3.0, 4.0], type=pa.float64())
+    result = list(ArrowDataProvider(array))
+    assert math.isnan(result[1])
+    assert result[::2] == [1.0, 3.0]
+
+    chunked = pa.chunked_array([[1.0, 2.0], [], [3.0]], type=pa.float64())
+    assert list(ArrowDataProvider(chunked)) == [1.0, 2.0, 3.0]
+
+    exported = pa.array(to_arrow(SimpleDataProvider([1.0, 2.0, 3.0]) | CEMAHandler(length=2)))
+    assert exported.null_count == 1
+    assert exported.to_pylist()[1:] == list(SimpleDataProvider([1.0, 2.0, 3.0]) | CEMAHandler(length=2))[1:]
+
+    with pytest.raises(ValueError):
+        ArrowDataProvider(pa.array([1, 2, 3], type=pa.int64()))
@@ -0,0 +1,173 @@
+import asyncio
+import json
+from collections.abc import AsyncIterator, Iterator
+from typing import Any
+from unittest.mock import AsyncMock, patch
+
+import pytest
+
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.data_providers import SimpleDataProvider, WebSocketDataProvider
+from pysatl_tsp.core.handler import ASYNC_BATCH_SIZE
+from pysatl_tsp.core.processor import MappingHandler, OnlineFilterHandler
+from pysatl_tsp.core.scrubber import ScrubberWindow
+from pysatl_tsp.implementations.processor.ema_handler import CEMAHandler
+from pysatl_tsp.implementations.processor.fwma_handler import CFWMAHandler
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler, MAHandler
+from tests.utils import safe_allclose
+
+
+async def collect(handler: Handler[Any, Any]) -> list[Any]:
+    return [item async for item in handler]
+
+
+class DoubleHandler(Handler[float, float]):
+    """Synchronous-only handler, served by the default asynchronous fallback."""
+
+    def __iter__(self) -> Iterator[float]:
+        if self.source is None:
+            raise ValueError("Source is not set")
+        for value in self.source:
+            yield value * 2
+
+
+class AwaitingProvider(Handler[None, float]):
+    """Provider that awaits every value, like a live source."""
+
+    def __init__(self, data: list[float]) -> None:
+        super().__init__()
+        self.data = data
+
+    def __iter__(self) -> Iterator[float]:
+        raise AssertionError("Synchronous iteration must not be used")
+
+    async def abatches(self) -> AsyncIterator[list[float]]:
+        for value in self.data:
+            await asyncio.sleep(0)
+            yield [value]
+
+
+DATA = [float(i % 17) - 3.5 for i in range(3000)]
+
+
+def last_filter(window: ScrubberWindow[float], config: Any) -> float:
+    return window[-1] + config
+
+
+def test_async_simple_provider_in_batches() -> None:
+    async def run() -> list[list[float]]:
+        return [batch async for batch in SimpleDataProvider(DATA).abatches()]
+
+    batches = asyncio.run(run())
+    assert [x for batch in batches for x in batch] == DATA
+    assert max(len(batch) for batch in batches) == ASYNC_BATCH_SIZE
+
+
+def test_async_pipeline_matches_sync() -> None:
+    def build(provider: Handler[Any, float]) -> Handler[Any, Any]:
+        return provider | MappingHandler(lambda x: x + 1) | OnlineFilterHandler(last_filter, 0.5) | MAHandler(length=5)
+
+    expected = list(build(SimpleDataProvider(DATA)))
+    assert asyncio.run(collect(build(SimpleDataProvider(DATA)))) == expected
+    assert asyncio.run(collect(build(AwaitingProvider(DATA)))) == expected
+
+
+def test_async_falls_back_to_sync_iteration() -> None:
+    expected = list(SimpleDataProvider(DATA) | DoubleHandler())
+    assert asyncio.run(collect(SimpleDataProvider(DATA) | DoubleHandler())) == expected
+
+
+def test_async_native_handlers_match_sync() -> None:
+    def build(provider: Handler[Any, float]) -> Handler[Any, Any]:
+        return provider | CMAHandler(length=4) | CEMAHandler(length=6) | CFWMAHandler(length=5)
+
+    expected = list(build(SimpleDataProvider(DATA)))
+    assert safe_allclose(asyncio.run(collect(build(AwaitingProvider(DATA)))), expected)
+
+
+def test_async_native_handler_after_python_stage() -> None:
+    data = [None, *DATA[:100]]
+
+    def fill(x: float | None) -> float:
+        return 0.0 if x is None else x
+
+    expected = list(SimpleDataProvider(data) | MappingHandler(fill) | CEMAHandler(length=3))
+    pipeline = AwaitingProvider(data) | MappingHandler(fill) | CEMAHandler(length=3)
+    assert safe_allclose(asyncio.run(collect(pipeline)), expected)
+
+
+def test_async_requires_source() -> None:
+    with pytest.raises(ValueError, match="Source is not set"):
+        CMAHandler(length=3).abatches()
+    with pytest.raises(ValueError, match="Source is not set"):
+        asyncio.run(collect(MappingHandler(lambda x: x)))
+
+
+@pytest.mark.asyncio
+async def test_async_websocket_without_thread() -> None:
+    provider = WebSocketDataProvider("ws://test", {"action": "subscribe"})
+    fake_msgs = [json.dumps({"p": 1.5}), json.dumps({"p": 2.5})]
+
+    fake_ws = AsyncMock()
+    fake_ws.__aenter__.return_value = fake_ws
+    fake_ws.__aiter__.return_value = (m for m in fake_msgs)
+    with patch("websockets.connect", return_value=fake_ws):
+        prices = await collect(provider | MappingHandler(lambda msg: json.loads(msg)["p"]))
+
+    assert prices == [1.5, 2.5]
+    assert provider._thread is None
+    assert provider._iterator_queue.qsize() == 0
+    fake_ws.send.assert_called_once_with(json.dumps({"action": "subscribe"}))
+
+
+class IdleSocket:
+    """Fake connection that delivers some messages at once, then stays silent."""
+
+    def __init__(self, messages: list[str]) -> None:
+        self.messages = messages
+        self.send = AsyncMock()
+
+    async def __aenter__(self) -> "IdleSocket":
+        return self
+
+    async def __aexit__(self, *args: object) -> None:
+        pass
+
+    async def __aiter__(self) -> AsyncIterator[str]:
+        for message in self.messages:
+            yield message
+        await asyncio.Event().wait()
+
+
+@pytest.mark.asyncio
+async def test_async_websocket_coalesces_and_closes_when_idle() -> None:
+    provider = WebSocketDataProvider("ws://test")
+    fake_msgs = [str(i) for i in range(5)]
+
+    batches: list[list[str]] = []
+    with patch("websockets.connect", return_value=IdleSocket(fake_msgs)):
+        async for batch in provider.abatches():
+            batches.append(batch)
+            asyncio.get_running_loop().call_later(0.05, provider.close)
+
+    assert batches == [fake_msgs]
+
+
+@pytest.mark.asyncio
+async def test_async_websocket_close_from_other_thread() -> None:
+    provider = WebSocketDataProvider("ws://test")
+
+    with patch("websockets.connect", return_value=IdleSocket([])):
+        consumer = asyncio.ensure_future(collect(provider))
+        await asyncio.sleep(0.05)
+        await asyncio.to_thread(provider.close)
+        assert await asyncio.wait_for(consumer, timeout=5) == []
+
+
+def test_async_native_handlers_restart_after_sync_pass() -> None:
+    for handler in [CMAHandler(length=5), CEMAHandler(length=5), CFWMAHandler(length=5)]:
+        pipeline = SimpleDataProvider(DATA) | handler
+        expected = list(pipeline)
+
+        assert safe_allclose(asyncio.run(collect(pipeline)), expected)
+        assert safe_allclose(list(pipeline), expected)
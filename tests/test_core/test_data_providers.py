@@ -1,15 +1,45 @@
+import math
+import os
+import sys
+import time
+from collections.abc import Iterator
+from datetime import datetime, timedelta
 from tempfile import NamedTemporaryFile
 from typing import Any, TypeVar
 
+import numpy as np
 import pytest
 from hypothesis import given
 from hypothesis import strategies as st
 
-from pysatl_tsp.core.data_providers import DataProvider, FileDataProvider, SimpleDataProvider
+from pysatl_tsp.core.arrow import to_arrow
+from pysatl_tsp.core.data_providers import (
+    BlockDataProvider,
+    CFileDataProvider,
+    DataProvider,
+    FileDataProvider,
+    GorillaDataProvider,
+    GorillaWriter,
+    ReplayDataProvider,
+    SimpleDataProvider,
+    TSFDataProvider,
+    TSFWriter,
+)
+from pysatl_tsp.core.executor import PipelineExecutor
+from pysatl_tsp.core.spill import spill
+from pysatl_tsp.implementations.processor.ema_handler import CEMAHandler
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler, MAHandler
+from tests.utils import safe_allclose
 
 T = TypeVar("T")
 
 
+def run_job(pipeline: Any) -> Any:
+    executor = PipelineExecutor(workers=1)
+    executor.submit(pipeline)
+    return executor.run()
+
+
 class TestListDataProvider:
     @given(st.lists(st.integers()))
     def test_iter_returns_same_elements(self, data: list[int]) -> None:
@@ -78,6 +108,444 @@ class TestFileDataProvider:
         assert issubclass(FileDataProvider, DataProvider)
 
 
+class TestCFileDataProvider:
+    @given(st.lists(st.floats(allow_nan=False)))
+    def test_parses_floats_exactly(self, data: list[float]) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write("\n".join(map(repr, data)))
+            tmp.flush()
+
+            assert list(CFileDataProvider(tmp.name)) == data
+
+    @given(st.lists(st.tuples(st.integers(), st.floats(-1e6, 1e6, allow_nan=False)), min_size=1))
+    def test_selected_column(self, rows: list[tuple[int, float]]) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write("time;value\r\n" + "".join(f"{t}; {v}\r\n" for t, v in rows))
+            tmp.flush()
+
+            provider = CFileDataProvider(tmp.name, column=1, delimiter=";", skip_rows=1)
+            assert list(provider) == [v for _, v in rows]
+            assert len(provider) == len(rows)
+            assert provider.read_columns([1, 0]).tolist() == [[v, float(t)] for t, v in rows]
+
+    def test_invalid_and_missing_fields(self) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write('1,"0.5"\n\n2,abc\n3\n4,-inf\n5, \n')
+            tmp.flush()
+
+            provider = CFileDataProvider(tmp.name, column=1)
+            result = list(provider)
+            assert result[0] == 1 / 2
+            assert math.isnan(result[1])
+            assert result[2] == math.inf and result[4] == math.inf  # Missing, None for native handlers
+            assert result[3] == -math.inf
+            assert np.isnan(provider.read_columns([1])[[2, 4], 0]).all()
+
+    def test_long_mantissa(self) -> None:
+        text = "1." + "1" * 70 + "e-300"
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write(f"{text}\n-{text}\n")
+            tmp.flush()
+
+            assert list(CFileDataProvider(tmp.name)) == [float(text), -float(text)]
+
+    def test_reiteration_starts_over(self) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write("\n".join(map(str, range(1000))))
+            tmp.flush()
+
+            provider = CFileDataProvider(tmp.name)
+            iterator = iter(provider)
+            next(iterator)
+            assert list(provider) == list(map(float, range(1000)))
+
+    @given(st.lists(st.floats(-100, 100, allow_nan=False)), st.integers(min_value=1, max_value=20))
+    def test_feeds_native_chain(self, data: list[float], length: int) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write("\n".join(map(repr, data)))
+            tmp.flush()
+
+            native = list(CFileDataProvider(tmp.name) | CMAHandler(length=length))
+            python = list(SimpleDataProvider(data) | MAHandler(length=length))
+            assert safe_allclose(python, native)
+
+    def test_empty_file(self) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            assert list(CFileDataProvider(tmp.name)) == []
+            assert CFileDataProvider(tmp.name).read_columns([0]).shape == (0, 1)
+
+    def test_invalid_arguments(self) -> None:
+        with pytest.raises(FileNotFoundError):
+            CFileDataProvider("nonexistent.file")
+        with NamedTemporaryFile(mode="w") as tmp, pytest.raises(ValueError):
+            CFileDataProvider(tmp.name, delimiter=", ")
+
+    def test_inheritance(self) -> None:
+        assert issubclass(CFileDataProvider, DataProvider)
+
+
+class TestTSFDataProvider:
+    @given(
+        st.lists(st.tuples(st.floats(allow_nan=False), st.integers(-(2**53), 2**53)), min_size=1, max_size=100),
+        st.integers(min_value=1, max_value=16),
+    )
+    def test_round_trip(self, rows: list[tuple[float, int]], chunk_rows: int) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name, dtypes=("float64", "int64"), chunk_rows=chunk_rows) as writer:
+                writer.write(range(len(rows)), rows)
+
+            provider = TSFDataProvider(tmp.name)
+            assert provider.dtypes == ("float64", "int64")
+            assert list(provider) == [value for value, _ in rows]
+            assert list(TSFDataProvider(tmp.name, column=1)) == [float(count) for _, count in rows]
+            assert sum(chunk.rows for chunk in provider.chunks) == len(rows)
+
+    @given(
+        st.lists(st.integers(0, 50), min_size=1, max_size=100).map(sorted),
+        st.integers(-5, 55),
+        st.integers(-5, 55),
+        st.integers(min_value=1, max_value=8),
+    )
+    def test_range_matches_scan(self, stamps: list[int], start: int, end: int, chunk_rows: int) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name, chunk_rows=chunk_rows) as writer:
+                writer.write(stamps, [float(i) for i in range(len(stamps))])
+
+            expected = [float(i) for i, t in enumerate(stamps) if start <= t < end]
+            assert list(TSFDataProvider(tmp.name, start=start, end=end)) == expected
+            assert TSFDataProvider(tmp.name).read(start, end)[1][:, 0].tolist() == expected
+
+    @given(st.lists(st.integers(-(2**63), 2**63 - 1), min_size=1, max_size=50), st.booleans())
+    def test_int64_columns_are_exact(self, ids: list[int], as_array: bool) -> None:
+        values = np.array(ids, dtype=np.int64) if as_array else [(0.5, i) for i in ids]
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            dtypes = ("int64",) if as_array else ("float64", "int64")
+            with TSFWriter(tmp.name, dtypes=dtypes, chunk_rows=7) as writer:
+                writer.write(range(len(ids)), values)
+
+            provider = TSFDataProvider(tmp.name)
+            assert provider.read_column(len(dtypes) - 1).tolist() == ids
+            assert [c.min[-1] for c in provider.chunks][0] == float(min(ids[:7]))
+
+    def test_chunk_index(self) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name, chunk_rows=3) as writer:
+                writer.write(range(10, 17), [5.0, np.nan, -1.0, 2.0, 8.0, 3.0, 4.0])
+
+            chunks = TSFDataProvider(tmp.name).chunks
+            assert [(c.rows, c.first, c.last) for c in chunks] == [(3, 10, 12), (3, 13, 15), (1, 16, 16)]
+            assert [(c.min[0], c.max[0]) for c in chunks] == [(-1.0, 5.0), (2.0, 8.0), (4.0, 4.0)]
+
+    def test_datetime_range(self) -> None:
+        begin = datetime(2024, 3, 3)
+        stamps = [begin + timedelta(minutes=i) for i in range(24 * 60)]
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name, chunk_rows=100) as writer:
+                writer.write(stamps, range(len(stamps)))
+
+            provider = TSFDataProvider(tmp.name, start=datetime(2024, 3, 3, 10), end=datetime(2024, 3, 3, 11))
+            assert list(provider) == [float(i) for i in range(600, 660)]
+
+    @given(st.lists(st.floats(-100, 100, allow_nan=False)), st.integers(min_value=1, max_value=20))
+    def test_drain_and_feed_native_chain(self, data: list[float], length: int) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name, chunk_rows=7) as writer:
+                assert writer.drain(SimpleDataProvider(data) | CMAHandler(length=1)) == len(data)
+
+            native = list(TSFDataProvider(tmp.name) | CMAHandler(length=length))
+            python = list(SimpleDataProvider(data) | MAHandler(length=length))
+            assert safe_allclose(python, native)
+
+    def test_drain_python_source(self) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name) as writer:
+                writer.drain(SimpleDataProvider([1.0, None, 3.0]), start=100, step=10)
+
+            stamps, values = TSFDataProvider(tmp.name).read()
+            assert stamps.tolist() == [100, 110, 120]
+            assert np.isnan(values[1, 0])
+            assert values[[0, 2], 0].tolist() == [1.0, 3.0]
+
+    @pytest.mark.parametrize("length", [0, 4, 8])
+    def test_drain_python_source_of_whole_chunks(self, length: int) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name, chunk_rows=4) as writer:
+                assert writer.drain(SimpleDataProvider([float(i) for i in range(length)])) == length
+                writer.write([], [])
+
+            assert list(TSFDataProvider(tmp.name)) == [float(i) for i in range(length)]
+
+    @pytest.mark.parametrize("value", [np.nan, np.inf, 2.0**63, None])
+    def test_int64_columns_reject_unrepresentable_values(self, value: float | None) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp, TSFWriter(tmp.name, dtypes=("int64",)) as writer:
+            with pytest.raises(ValueError, match="int64"):
+                writer.write([0, 1], [1, value])
+            if value is not None:
+                with pytest.raises(ValueError, match="int64"):
+                    writer.write([0, 1], np.array([1.0, value]))
+            with pytest.raises(ValueError, match="int64"):
+                writer.drain(SimpleDataProvider([1.0, value]))
+            if value is not None:
+                with pytest.raises(ValueError, match="int64"):
+                    writer.drain(SimpleDataProvider([1.0, value]) | CMAHandler(length=1))
+
+    def test_decreasing_timestamps(self) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp, TSFWriter(tmp.name) as writer, pytest.raises(ValueError):
+            writer.write([2, 1], [1.0, 2.0])
+
+    def test_invalid_file(self) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write("not a tsf file")
+            tmp.flush()
+            with pytest.raises(OSError):
+                TSFDataProvider(tmp.name)
+
+    @pytest.mark.parametrize(("field", "value"), [("nchunks", 2**62), ("nchunks", 2**64 - 1), ("offset", 3)])
+    def test_corrupt_index(self, field: str, value: int) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            with TSFWriter(tmp.name, chunk_rows=4) as writer:
+                writer.write(range(10), np.arange(10.0))
+            with open(tmp.name, "rb") as f:
+                data = bytearray(f.read())
+            # Trailer: index offset, chunk count, magic; index entry: chunk offset, rows, timestamps
+            index_offset = int.from_bytes(data[-24:-16], "little")
+            position = len(data) - 16 if field == "nchunks" else index_offset
+            if field == "offset":
+                value += int.from_bytes(data[position : position + 8], "little")
+            data[position : position + 8] = value.to_bytes(8, "little")
+            with open(tmp.name, "wb") as f:
+                f.write(data)
+            with pytest.raises(OSError):
+                TSFDataProvider(tmp.name)
+
+
+class TestGorillaDataProvider:
+    @given(
+        st.lists(st.tuples(st.integers(-(2**63), 2**63 - 1), st.floats()), min_size=1, max_size=200),
+        st.integers(min_value=1, max_value=16),
+    )
+    def test_round_trip_is_bit_exact(self, points: list[tuple[int, float]], chunk_points: int) -> None:
+        stamps = np.array([t for t, _ in points], dtype=np.int64)
+        values = np.array([v for _, v in points], dtype=np.float64)
+        with NamedTemporaryFile(suffix=".grl") as tmp:
+            with GorillaWriter(tmp.name, chunk_points=chunk_points) as writer:
+                writer.write(stamps, values)
+
+            provider = GorillaDataProvider(tmp.name)
+            assert len(provider) == len(points)
+            read_stamps, read_values = provider.read()
+            assert read_stamps.tolist() == stamps.tolist()
+            assert read_values.view(np.int64).tolist() == values.view(np.int64).tolist()
+            assert np.array(list(provider)).view(np.int64).tolist() == values.view(np.int64).tolist()
+
+    def test_regular_ticks_compress(self) -> None:
+        rng = np.random.default_rng(7)
+        points = 100_000
+        stamps = np.arange(points, dtype=np.int64) * 1_000_000_000 + 1_700_000_000_000_000_000
+        moving = 0.3  # share of ticks that change the price
+        changes = rng.normal(0, 1, points) * (rng.random(points) < moving)
+        prices = np.round(30_000 + np.cumsum(changes), 2)
+        with NamedTemporaryFile(suffix=".grl") as tmp:
+            with GorillaWriter(tmp.name) as writer:
+                writer.write(stamps, prices)
+
+            min_ratio = 5
+            assert 16 * points / os.path.getsize(tmp.name) > min_ratio
+            assert GorillaDataProvider(tmp.name).read()[1].tolist() == prices.tolist()
+
+    @given(st.lists(st.floats(-100, 100, allow_nan=False)), st.integers(min_value=1, max_value=20))
+    def test_drain_and_feed_native_chain(self, data: list[float], length: int) -> None:
+        with NamedTemporaryFile(suffix=".grl") as tmp:
+            with GorillaWriter(tmp.name, chunk_points=7) as writer:
+                assert writer.drain(SimpleDataProvider(data) | CMAHandler(length=1), start=5, step=3) == len(data)
+
+            provider = GorillaDataProvider(tmp.name)
+            assert provider.read()[0].tolist() == [5 + 3 * i for i in range(len(data))]
+            native = list(provider | CMAHandler(length=length))
+            python = list(SimpleDataProvider(data) | MAHandler(length=length))
+            assert safe_allclose(python, native)
+
+    def test_drain_python_source(self) -> None:
+        with NamedTemporaryFile(suffix=".grl") as tmp:
+            with GorillaWriter(tmp.name) as writer:
+                writer.drain(SimpleDataProvider([1.0, None, 3.0]), start=datetime(2024, 3, 3), step=10)
+
+            stamps, values = GorillaDataProvider(tmp.name).read()
+            assert (stamps - stamps[0]).tolist() == [0, 10, 20]
+            assert np.isnan(values[1])
+
+    def test_invalid_file(self) -> None:
+        with NamedTemporaryFile(mode="w") as tmp:
+            tmp.write("not a gorilla file")
+            tmp.flush()
+            with pytest.raises(OSError):
+                GorillaDataProvider(tmp.name)
+
+    @given(st.binary(min_size=1, max_size=64), st.integers(min_value=0))
+    def test_corrupt_chunk(self, garbage: bytes, offset: int) -> None:
+        with NamedTemporaryFile(suffix=".grl") as tmp:
+            with GorillaWriter(tmp.name, chunk_points=50) as writer:
+                writer.write(list(range(100)), [math.sin(i) for i in range(100)])
+            # Overwrite part of the bit stream of the first chunk (after the 16 + 24 bytes of headers)
+            with open(tmp.name, "r+b") as file:
+                file.seek(20)
+                stream = int.from_bytes(file.read(4), sys.byteorder)
+                file.seek(40 + offset % stream)
+                file.write(garbage[: stream - offset % stream])
+
+            provider = GorillaDataProvider(tmp.name)
+            try:
+                stamps, values = provider.read()
+            except OSError:
+                with pytest.raises(OSError, match="corrupt"):
+                    list(provider)
+            else:
+                assert list(provider) == pytest.approx(values.tolist(), nan_ok=True)
+                assert len(stamps) == 100
+
+    def test_all_ones_chunk_is_corrupt(self) -> None:
+        with NamedTemporaryFile(suffix=".grl") as tmp:
+            with GorillaWriter(tmp.name) as writer:
+                writer.write([1, 2, 3], [1.0, 2.0, 3.0])
+            with open(tmp.name, "r+b") as file:
+                stream = file.seek(0, os.SEEK_END) - 40
+                file.seek(40)
+                file.write(b"\xff" * stream)
+
+            with pytest.raises(OSError, match="corrupt"):
+                GorillaDataProvider(tmp.name).read()
+            with pytest.raises(OSError, match="corrupt"):
+                list(GorillaDataProvider(tmp.name))
+            # Native chains end at the corrupt chunk and report it when drained
+            with pytest.raises(OSError, match="corrupt"):
+                (GorillaDataProvider(tmp.name) | CMAHandler(length=3)).to_numpy()
+            with pytest.raises(OSError, match="corrupt"):
+                (GorillaDataProvider(tmp.name) | CMAHandler(length=3) | CEMAHandler(length=2)).to_numpy()
+
+    def test_unclosed_writer_is_rejected(self) -> None:
+        with NamedTemporaryFile(suffix=".grl") as tmp:
+            writer = GorillaWriter(tmp.name, chunk_points=2)
+            writer.write([1, 2, 3], [1.0, 2.0, 3.0])
+            with pytest.raises(OSError):
+                GorillaDataProvider(tmp.name)
+            writer.close()
+            assert list(GorillaDataProvider(tmp.name)) == [1.0, 2.0, 3.0]
+
+
+class TestReplayDataProvider:
+    @staticmethod
+    def record(filename: str, points: int, step: int) -> None:
+        with TSFWriter(filename, chunk_rows=300) as writer:
+            writer.write(np.arange(points) * step, np.arange(points, dtype=np.float64))
+
+    def test_unpaced_replay(self) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            self.record(tmp.name, 1000, 1)
+            provider = ReplayDataProvider(tmp.name, speed=None, start=100, end=200, time_unit="s")
+            assert list(provider) == [float(i) for i in range(100, 200)]
+            assert provider.stats.emitted == len(provider)
+            assert provider.stats.max_lag == 0
+
+    def test_paced_replay_follows_schedule(self) -> None:
+        duration = 0.1  # 1000 ticks of 1 ms at 10x
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            self.record(tmp.name, 1001, 1)
+            provider = ReplayDataProvider(tmp.name, speed=10, time_unit="ms")
+            started = time.perf_counter()
+            result = (provider | CMAHandler(length=1)).to_numpy()
+            elapsed = time.perf_counter() - started
+
+            assert result.tolist() == [float(i) for i in range(1001)]
+            # Values are never early, the upper bounds only catch a schedule that is off by far
+            assert duration <= elapsed < 50 * duration
+            assert provider.stats.emitted == len(result)
+            assert provider.stats.mean_lag < 10 * duration
+
+    def test_slow_consumer_falls_behind(self) -> None:
+        pause = 0.5
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            self.record(tmp.name, 100, 1)
+            provider = ReplayDataProvider(tmp.name, speed=1, time_unit="ms")
+            for value in provider:
+                if value == 0:
+                    time.sleep(pause)
+            assert provider.stats.max_lag >= pause / 2
+            assert provider.stats.emitted == len(provider)
+
+            list(provider)
+            assert provider.stats.max_lag < pause / 2
+
+    def test_invalid_options(self) -> None:
+        with NamedTemporaryFile(suffix=".tsf") as tmp:
+            self.record(tmp.name, 10, 1)
+            with pytest.raises(ValueError, match="speed"):
+                ReplayDataProvider(tmp.name, speed=0)
+            with pytest.raises(ValueError, match="Unknown time unit"):
+                ReplayDataProvider(tmp.name, time_unit="minutes")
+
+
+class TestBlockDataProvider:
+    @given(st.lists(st.lists(st.floats(-100, 100, allow_nan=False), max_size=10)), st.integers(1, 10))
+    def test_blocks_feed_native_chain(self, blocks: list[list[float]], length: int) -> None:
+        data = [value for block in blocks for value in block]
+        provider = BlockDataProvider([np.array(block) for block in blocks])
+
+        assert list(provider) == data
+        native = list(provider | CMAHandler(length=length))
+        python = list(SimpleDataProvider(data) | MAHandler(length=length))
+        assert safe_allclose(python, native)
+
+    def test_converts_blocks(self) -> None:
+        provider = BlockDataProvider([[1, 2], np.array([3], dtype=np.int32), np.arange(6.0).reshape(2, 3)[:, 1]])
+        assert list(provider) == [1.0, 2.0, 3.0, 1.0, 4.0]
+
+    def test_errors_are_raised(self) -> None:
+        def blocks() -> Iterator[list[float]]:
+            yield [1.0]
+            raise RuntimeError("broken source")
+
+        iterator = iter(BlockDataProvider(blocks()))
+        assert next(iterator) == 1.0
+        with pytest.raises(RuntimeError, match="broken source"):
+            next(iterator)
+
+    def test_escaped_errors_are_reported(self, monkeypatch: pytest.MonkeyPatch) -> None:
+        class Escaping(BaseException):
+            pass
+
+        def blocks() -> Iterator[list[float]]:
+            yield [1.0]
+            raise Escaping
+
+        reported: list[Any] = []
+        monkeypatch.setattr(sys, "unraisablehook", reported.append)
+        iterator = iter(BlockDataProvider(blocks()))
+        assert next(iterator) == 1.0
+        with pytest.raises(RuntimeError, match="Block iterator failed"):
+            next(iterator)
+        assert [type(report.exc_value) for report in reported] == [Escaping]
+
+    @pytest.mark.parametrize(
+        "consume",
+        [
+            list,
+            lambda chain: chain.to_numpy(),
+            spill,
+            to_arrow,
+            lambda chain: run_job(chain),
+            lambda chain: TSFWriter(os.devnull).drain(chain),
+            lambda chain: GorillaWriter(os.devnull).drain(chain),
+        ],
+    )
+    def test_errors_reach_native_consumers(self, consume: Any) -> None:
+        def blocks() -> Iterator[list[float]]:
+            yield [1.0, 2.0, 3.0]
+            raise OSError("broken source")
+
+        with pytest.raises(OSError, match="broken source"):
+            consume(BlockDataProvider(blocks()) | CMAHandler(length=2))
+
+
 class TestDataProvider:
     def test_generic_type(self) -> None:
         provider = SimpleDataProvider([1, 2, 3])
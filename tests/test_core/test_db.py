@@ -1,11 +1,20 @@
+import sqlite3
 from collections.abc import Iterator
+from pathlib import Path
 from typing import Any
 from unittest.mock import Mock
 
+import numpy as np
 import pytest
 from pytest_mock import MockerFixture
 
-from pysatl_tsp.core.data_providers import DatabaseAdapter, DataBaseDataProvider  # скорректируйте импорт!
+from pysatl_tsp.core.data_providers import (  # скорректируйте импорт!
+    DatabaseAdapter,
+    DataBaseDataProvider,
+    SimpleDataProvider,
+    SQLiteAdapter,
+)
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler
 
 QUERY: str = "SELECT * FROM table WHERE foo=?"
 PARAMS: tuple[str, ...] = ("bar",)
@@ -91,3 +100,55 @@ def test_context_manager_closes_even_if_execute_query_fails(
 
     adapter.close_cursor.assert_not_called()  # type: ignore[attr-defined]
     adapter.close_connection.assert_called_once_with(connection)  # type: ignore[attr-defined]
+
+
+NULL_ROW = 3
+
+
+@pytest.fixture
+def sqlite_provider(tmp_path: Path) -> DataBaseDataProvider[tuple[Any, ...]]:
+    database = str(tmp_path / "bars.sqlite")
+    with sqlite3.connect(database) as connection:
+        connection.execute("CREATE TABLE bars (ts INTEGER, close REAL)")
+        connection.executemany(
+            "INSERT INTO bars VALUES (?, ?)", [(i, None if i == NULL_ROW else i * 0.5) for i in range(25)]
+        )
+    return DataBaseDataProvider({"database": database}, "SELECT ts, close FROM bars ORDER BY ts", SQLiteAdapter())
+
+
+def test_sqlite_adapter_rows(sqlite_provider: DataBaseDataProvider[tuple[Any, ...]]) -> None:
+    rows = list(sqlite_provider)
+    assert rows[:3] == [(0, 0.0), (1, 0.5), (2, 1.0)]
+    assert rows[NULL_ROW] == (NULL_ROW, None)
+
+
+def test_fetch_batch_columns(sqlite_provider: DataBaseDataProvider[tuple[Any, ...]]) -> None:
+    batches = list(sqlite_provider.iter_batches(batch_size=10))
+    assert [len(ts) for ts, _ in batches] == [10, 10, 5]
+
+    ts = np.concatenate([ts for ts, _ in batches])
+    close = np.concatenate([close for _, close in batches])
+    assert ts.tolist() == list(range(25))
+    assert np.isnan(close[NULL_ROW])
+    assert np.delete(close, NULL_ROW).tolist() == [i * 0.5 for i in range(25) if i != NULL_ROW]
+
+
+def test_column_source_feeds_native_chain(sqlite_provider: DataBaseDataProvider[tuple[Any, ...]]) -> None:
+    source = sqlite_provider.column_source(column=0, batch_size=7)
+    expected = list(SimpleDataProvider([float(i) for i in range(25)]) | CMAHandler(length=4))
+
+    assert list(source | CMAHandler(length=4)) == expected
+    assert list(source) == [float(i) for i in range(25)]
+
+
+def test_fetch_batch_default_uses_fetchmany(mocker: MockerFixture) -> None:
+    cursor: Mock = mocker.Mock()
+    cursor.fetchmany.return_value = [(1, 2.5), (2, 3.5)]
+
+    batch_size = 100
+    columns = DummyAdapter().fetch_batch(cursor, batch_size)
+
+    assert columns is not None
+    assert [column.tolist() for column in columns] == [[1.0, 2.0], [2.5, 3.5]]
+    assert cursor.arraysize == batch_size
+    cursor.fetchmany.assert_called_once_with(batch_size)
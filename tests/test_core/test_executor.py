@@ -0,0 +1,100 @@
+from pathlib import Path
+from typing import Any
+
+import numpy as np
+import pytest
+from hypothesis import given, settings
+from hypothesis import strategies as st
+
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.data_providers import BlockDataProvider, CFileDataProvider, SimpleDataProvider
+from pysatl_tsp.core.executor import PipelineExecutor
+from pysatl_tsp.core.processor import MappingHandler
+from pysatl_tsp.implementations.processor.ema_handler import CEMAHandler
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler
+
+
+def pipeline(source: Handler[Any, Any], length: int) -> Handler[Any, Any]:
+    return source | CMAHandler(length=length) | CEMAHandler(length=length)
+
+
+@settings(max_examples=30, deadline=None)
+@given(
+    lengths=st.lists(st.integers(0, 3000), max_size=12),
+    workers=st.integers(1, 5),
+    hinted=st.booleans(),
+)
+def test_matches_to_numpy(lengths: list[int], workers: int, hinted: bool) -> None:
+    rng = np.random.default_rng(len(lengths))
+    series = [rng.normal(size=n) for n in lengths]
+    executor = PipelineExecutor(workers)
+    for i, values in enumerate(series):
+        index = executor.submit(pipeline(BlockDataProvider([values]), 1 + i % 7), size_hint=len(values) * hinted)
+        assert index == i
+    assert len(executor) == len(series)
+
+    results = executor.run()
+    assert len(executor) == 0
+    assert len(results) == len(series)
+    for i, (values, result) in enumerate(zip(series, results)):
+        expected = pipeline(BlockDataProvider([values]), 1 + i % 7).to_numpy()
+        assert np.array_equal(result.values, expected, equal_nan=True)
+        assert 0 <= result.worker < workers
+        assert result.start >= 0
+        assert result.seconds >= 0
+
+
+def test_uneven_file_sources(tmp_path: Path) -> None:
+    lengths = [200_000, 10, 5000, 1, 0, 70_000, 300, 3, 120_000]
+    paths = []
+    for i, n in enumerate(lengths):
+        path = tmp_path / f"series_{i}.csv"
+        path.write_text("value\n" + "".join(f"{v}\n" for v in range(n)))
+        paths.append(str(path))
+
+    executor = PipelineExecutor(4)
+    for path in paths:
+        executor.submit(CMAHandler(length=10), CFileDataProvider(path, skip_rows=1))
+    results = executor.run()
+
+    for path, result in zip(paths, results):
+        expected = (CFileDataProvider(path, skip_rows=1) | CMAHandler(length=10)).to_numpy()
+        assert np.array_equal(result.values, expected, equal_nan=True)
+
+
+def test_python_sources_and_reruns() -> None:
+    executor = PipelineExecutor(3)
+    executor.submit(pipeline(SimpleDataProvider([1.0, 2.0, 3.0, 4.0]), 3))
+    executor.submit(CMAHandler(length=1), SimpleDataProvider([5.0, 6.0]))
+    first = executor.run()
+    assert np.array_equal(first[1].values, [5.0, 6.0])
+
+    executor.submit(pipeline(SimpleDataProvider([1.0, 2.0, 3.0, 4.0]), 3))
+    second = executor.run()
+    assert np.array_equal(second[0].values, first[0].values, equal_nan=True)
+    assert PipelineExecutor().run() == []
+
+
+def test_invalid_jobs() -> None:
+    with pytest.raises(ValueError):
+        PipelineExecutor(0)
+    executor = PipelineExecutor(2)
+    with pytest.raises(ValueError, match="native"):
+        executor.submit(MappingHandler(lambda x: x), SimpleDataProvider([1.0]))
+    job = SimpleDataProvider([1.0]) | CMAHandler(length=1)
+    executor.submit(job)
+    with pytest.raises(ValueError, match="already submitted"):
+        executor.submit(job)
+
+
+def test_shared_handlers_are_rejected(tmp_path: Path) -> None:
+    path = tmp_path / "series.csv"
+    path.write_text("\n".join(str(i) for i in range(100)))
+    executor = PipelineExecutor(2)
+    shared = CFileDataProvider(str(path)) | CMAHandler(length=3)
+    executor.submit(shared | CMAHandler(length=2))
+    with pytest.raises(ValueError, match="already submitted"):
+        executor.submit(shared | CMAHandler(length=4))
+    with pytest.raises(ValueError, match="already submitted"):
+        executor.submit(CMAHandler(length=5), source=shared)
+    assert len(executor) == 1
@@ -0,0 +1,117 @@
+import json
+import math
+from typing import Any
+from unittest.mock import patch
+
+import pytest
+from hypothesis import given
+from hypothesis import strategies as st
+
+from pysatl_tsp.core.data_providers import SimpleDataProvider, WebSocketDataProvider
+from pysatl_tsp.core.processor import JSONExtractHandler
+from pysatl_tsp.core.processor.json_extract_handler import MISSING_INT
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler
+
+noise = st.recursive(
+    st.none() | st.booleans() | st.integers() | st.floats(allow_nan=False, allow_infinity=False) | st.text(),
+    lambda children: st.lists(children, max_size=3) | st.dictionaries(st.text(max_size=5), children, max_size=3),
+    max_leaves=10,
+)
+
+
+@given(
+    price=st.floats(allow_nan=False, allow_infinity=False),
+    ts=st.integers(-(2**63) + 1, 2**63 - 1),
+    as_string=st.booleans(),
+    extra=st.dictionaries(st.text(max_size=5).filter(lambda key: key not in {"ts", "data"}), noise, max_size=3),
+)
+def test_matches_json_loads(price: float, ts: int, as_string: bool, extra: dict[str, Any]) -> None:
+    message = json.dumps(
+        {**extra, "data": {"x": [1, {"y": "}"}], "lastPrice": repr(price) if as_string else price}, "ts": ts}
+    )
+    handler = JSONExtractHandler(["data.lastPrice", "ts"], dtypes=["float64", "int64"])
+
+    assert handler.extract(message) == (price, ts)
+    assert handler.extract(message.encode()) == (price, ts)
+
+
+def test_paths_and_missing_fields() -> None:
+    handler = JSONExtractHandler(["a.1", "a.2.b", "c", "d"], dtypes=["float64", "float64", "int64", "float64"])
+    result = handler.extract('{"a": [1.5, "2.5", {"b": true}], "c": null, "e": {"d": 1}}')
+
+    assert result is not None
+    assert result[:2] == (2.5, 1.0)
+    assert result[2] == MISSING_INT
+    assert math.isnan(result[3])
+
+
+def test_skips_messages_without_fields() -> None:
+    messages = ['{"op": "subscribe"}', '{"p": 1, "q": 2}', '{"p": 3}', "not json", ""]
+
+    assert list(SimpleDataProvider(messages) | JSONExtractHandler(["p", "q"], require_all=True)) == [(1.0, 2.0)]
+    result = list(SimpleDataProvider(messages) | JSONExtractHandler(["p", "q"], batch_size=2))
+    assert [row[0] for row in result] == [1.0, 3.0]
+
+
+def test_batches_feed_native_chain() -> None:
+    messages = [json.dumps({"data": {"lastPrice": str(i)}}) for i in range(100)]
+    handler = JSONExtractHandler(["data.lastPrice"], batch_size=16, source=SimpleDataProvider(messages))
+
+    batches = list(handler.iter_batches())
+    assert [len(batch["data.lastPrice"]) for batch in batches] == [16] * 6 + [4]
+    expected = list(SimpleDataProvider([float(i) for i in range(100)]) | CMAHandler(length=5))
+    assert list(handler.column_source("data.lastPrice") | CMAHandler(length=5)) == expected
+
+
+def test_drains_websocket_ring() -> None:
+    provider = WebSocketDataProvider("ws://test")
+    for i in range(10):
+        provider._iterator_queue.put(json.dumps({"ts": i, "data": {"lastPrice": f"{i}.5"}}))
+    provider._iterator_queue.put('{"success": true}')
+    provider._iterator_queue.close()
+
+    handler = JSONExtractHandler(["ts", "data.lastPrice"], dtypes=["int64", "float64"], source=provider)
+    with patch.object(provider, "_start"):
+        assert list(handler) == [(i, i + 0.5) for i in range(10)]
+
+
+def test_invalid_arguments() -> None:
+    with pytest.raises(ValueError):
+        JSONExtractHandler([])
+    with pytest.raises(ValueError):
+        JSONExtractHandler(["a"], dtypes=["str"])
+    with pytest.raises(ValueError):
+        JSONExtractHandler(["a"]).column_source("b")
+    with pytest.raises(ValueError, match="Source is not set"):
+        list(JSONExtractHandler(["a"]))
+
+
+@pytest.mark.parametrize(
+    ("literal", "expected"),
+    [
+        ("9223372036854775807", 2**63 - 1),
+        ("-9223372036854775808", -(2**63)),
+        ("12345678901234567890", MISSING_INT),
+        ("-9223372036854775809", MISSING_INT),
+        ("99999999999999999999", MISSING_INT),
+        ("1e30", MISSING_INT),
+        ("1.5e3", 1500),
+    ],
+)
+def test_int64_range(literal: str, expected: int) -> None:
+    handler = JSONExtractHandler(["v", "k"], dtypes=["int64", "int64"])
+
+    assert handler.extract(f'{{"v": {literal}, "k": 1}}') == (expected, 1)
+    assert handler.extract(f'{{"v": "{literal}", "k": 1}}') == (expected, 1)
+
+
+def test_overlapping_paths() -> None:
+    handler = JSONExtractHandler(["a", "a.b", "a.b", "c"], dtypes=["float64", "float64", "int64", "float64"])
+
+    result = handler.extract('{"a": {"b": "7"}, "c": "n/a"}')
+    assert result is not None
+    assert math.isnan(result[0])
+    assert result[1:3] == (7.0, 7)
+    assert math.isnan(result[3])
+    assert handler.extract('{"c": "1.5", "a": "2"}') == (2.0, pytest.approx(math.nan, nan_ok=True), MISSING_INT, 1.5)
+    assert JSONExtractHandler(["a", "b"], require_all=True).extract('{"a": 1, "b": "x"}') is None
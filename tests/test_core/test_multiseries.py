@@ -0,0 +1,107 @@
+from typing import Any
+
+import numpy as np
+import pytest
+from hypothesis import given, settings
+from hypothesis import strategies as st
+
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.data_providers import SimpleDataProvider
+from pysatl_tsp.core.multiseries import MultiSeriesEngine
+from pysatl_tsp.core.native import isa, select_isa, supported_isas
+from pysatl_tsp.implementations.processor.ema_handler import EMAHandler
+from pysatl_tsp.implementations.processor.rma_handler import RMAHandler
+from pysatl_tsp.implementations.processor.sma_handler import SMAHandler
+from pysatl_tsp.implementations.processor.wma_handler import WMAHandler
+
+HANDLERS = {"sma": SMAHandler, "ema": EMAHandler, "rma": RMAHandler, "wma": WMAHandler}
+
+
+def reference(kind: str, length: int, series: np.ndarray[Any, Any]) -> list[float]:
+    handler: Handler[Any, float | None] = HANDLERS[kind](length=length, source=SimpleDataProvider(series.tolist()))
+    return [np.nan if value is None else float(value) for value in handler]
+
+
+indicator_sets = st.lists(st.tuples(st.sampled_from(sorted(HANDLERS)), st.integers(1, 12)), min_size=1, max_size=6)
+
+
+@settings(max_examples=100, deadline=None)
+@given(indicators=indicator_sets, n_series=st.integers(1, 9), n_samples=st.integers(0, 40), seed=st.integers(0, 100))
+def test_matches_single_series_handlers(
+    indicators: list[tuple[str, int]], n_series: int, n_samples: int, seed: int
+) -> None:
+    data = np.random.default_rng(seed).normal(100, 10, size=(n_series, n_samples))
+    result = MultiSeriesEngine(n_series, indicators).run(data)
+    assert result.shape == (len(indicators), n_series, n_samples)
+    for k, (kind, length) in enumerate(indicators):
+        for i in range(n_series):
+            np.testing.assert_allclose(result[k, i], reference(kind, length, data[i]), rtol=1e-9)
+
+
+@pytest.mark.parametrize("kernels", supported_isas())
+def test_chunks_steps_and_kernels_agree(kernels: str) -> None:
+    indicators = [("sma", 20), ("ema", 20), ("rma", 14), ("wma", 10)]
+    data = np.cumsum(np.random.default_rng(1).normal(size=(37, 300)), axis=1)
+    previous = isa()
+    select_isa(kernels)
+    try:
+        engine = MultiSeriesEngine(37, indicators)
+        whole = engine.run(data)
+        engine.reset()
+        chunks = np.concatenate([engine.run(data[:, :120]), engine.run(data[:, 120:])], axis=2)
+        engine.reset()
+        steps = np.stack([engine.step(data[:, t]) for t in range(data.shape[1])], axis=2)
+    finally:
+        select_isa(previous)
+    np.testing.assert_allclose(chunks, whole, rtol=1e-12)
+    np.testing.assert_allclose(steps, whole, rtol=1e-12)
+    assert engine.names == ["sma_20", "ema_20", "rma_14", "wma_10"]
+
+
+def rolling(kind: str, length: int, series: np.ndarray[Any, Any]) -> list[float]:
+    weights = np.arange(1, length + 1) if kind == "wma" else np.ones(length)
+    return [
+        np.nan if t + 1 < length else float(np.dot(series[t + 1 - length : t + 1], weights) / weights.sum())
+        for t in range(len(series))
+    ]
+
+
+def test_non_finite_values_leave_the_window() -> None:
+    result = MultiSeriesEngine(1, [("sma", 2), ("wma", 2)]).run(np.array([[1, np.nan, 3, 4, 5, 6, 7]]))
+    np.testing.assert_allclose(result[:, 0, 3:], [[3.5, 4.5, 5.5, 6.5], [11 / 3, 14 / 3, 17 / 3, 20 / 3]])
+
+    data = np.random.default_rng(2).normal(size=(5, 80))
+    data[0, 10] = np.nan
+    data[1, [20, 23]] = np.inf
+    data[2, 30] = -np.inf
+    data[3, [40, 41]] = [np.inf, -np.inf]
+    indicators = [("sma", 4), ("wma", 3), ("sma", 1)]
+    result = MultiSeriesEngine(5, indicators).run(data)
+    for k, (kind, length) in enumerate(indicators):
+        for i in range(5):
+            with np.errstate(invalid="ignore"):
+                expected = rolling(kind, length, data[i])
+            np.testing.assert_allclose(result[k, i], expected, rtol=1e-9)
+
+
+def test_running_sums_do_not_drift() -> None:
+    data = 1e4 + np.random.default_rng(3).normal(size=(2, 1_000_000)) * 100
+    result = MultiSeriesEngine(2, [("wma", 10), ("sma", 10)]).run(data)
+    for k, kind in enumerate(["wma", "sma"]):
+        for i in range(2):
+            expected = rolling(kind, 10, data[i, -100:])
+            np.testing.assert_allclose(result[k, i, -91:], expected[9:], rtol=0, atol=1e-9)
+
+
+def test_invalid_parameters() -> None:
+    with pytest.raises(ValueError):
+        MultiSeriesEngine(0, [("sma", 3)])
+    with pytest.raises(ValueError):
+        MultiSeriesEngine(2, [("sma", 0)])
+    with pytest.raises(ValueError):
+        MultiSeriesEngine(2, [("hma", 3)])
+    engine = MultiSeriesEngine(2, [("sma", 3)])
+    with pytest.raises(ValueError):
+        engine.run(np.zeros((3, 5)))
+    with pytest.raises(ValueError):
+        engine.step(np.zeros(3))
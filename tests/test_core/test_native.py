@@ -0,0 +1,190 @@
+import gc
+from typing import Any
+
+import numpy as np
+import pytest
+from hypothesis import given
+from hypothesis import strategies as st
+from pysatl_tsp._c import ffi
+from pysatl_tsp._c.lib import tsp_kernel_dot, tsp_kernel_ema, tsp_kernel_ma, tsp_kernel_minmax, tsp_kernel_sum
+
+from pysatl_tsp.core import Handler
+from pysatl_tsp.core.data_providers import BlockDataProvider, SimpleDataProvider
+from pysatl_tsp.core.native import ISAS, isa, select_isa, supported_isas
+from pysatl_tsp.core.processor import MappingHandler
+from pysatl_tsp.core.spill import spill
+from pysatl_tsp.implementations.processor.ema_handler import CEMAHandler
+from pysatl_tsp.implementations.processor.fwma_handler import CFWMAHandler
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler
+
+float_arrays = st.lists(st.floats(min_value=-1e3, max_value=1e3, allow_nan=False, allow_infinity=False), max_size=70)
+
+
+def as_ptr(array: np.ndarray) -> object:  # type: ignore[type-arg]
+    return ffi.from_buffer("double[]", array)
+
+
+def test_detected_isa_is_supported() -> None:
+    assert isa() in ISAS
+    assert "generic" in supported_isas()
+    assert isa() == supported_isas()[-1]
+
+
+def test_select_unknown_isa() -> None:
+    with pytest.raises(ValueError, match="not available"):
+        select_isa("neon")
+
+
+@pytest.mark.parametrize("kernels", supported_isas())
+@given(data=float_arrays)
+def test_reductions(kernels: str, data: list[float]) -> None:
+    x = np.array(data, dtype=np.float64)
+    w = np.linspace(0.5, 1.5, len(x))
+    lo, hi = ffi.new("double *"), ffi.new("double *")
+    previous = isa()
+    select_isa(kernels)
+    try:
+        total = tsp_kernel_sum(as_ptr(x), len(x))
+        weighted = tsp_kernel_dot(as_ptr(x), as_ptr(w), len(x))
+        if len(x):
+            tsp_kernel_minmax(as_ptr(x), len(x), lo, hi)
+    finally:
+        select_isa(previous)
+
+    assert total == pytest.approx(x.sum(), abs=1e-6)
+    assert weighted == pytest.approx(float(x @ w), abs=1e-6)
+    if len(x):
+        assert (lo[0], hi[0]) == (x.min(), x.max())
+
+
+@pytest.mark.parametrize("kernels", supported_isas())
+@given(data=float_arrays)
+def test_multi_series_updates(kernels: str, data: list[float]) -> None:
+    x = np.array(data, dtype=np.float64)
+    old = x[::-1].copy()
+    sums = np.ones_like(x)
+    state = np.full_like(x, 2.0)
+    previous = isa()
+    select_isa(kernels)
+    try:
+        tsp_kernel_ma(as_ptr(sums), as_ptr(x), as_ptr(old), len(x))
+        tsp_kernel_ema(as_ptr(state), as_ptr(x), 0.25, len(x))
+    finally:
+        select_isa(previous)
+
+    assert np.allclose(sums, 1 + x - old)
+    assert np.allclose(state, 2.0 + 0.25 * (x - 2.0))
+
+
+def test_fwma_same_for_all_isas() -> None:
+    data = [float(i % 17) for i in range(500)]
+    results = {}
+    previous = isa()
+    try:
+        for name in supported_isas():
+            select_isa(name)
+            results[name] = list(SimpleDataProvider(data) | CFWMAHandler(length=21))
+    finally:
+        select_isa(previous)
+    reference = results["generic"]
+    for values in results.values():
+        assert np.allclose([v for v in values if v is not None], [v for v in reference if v is not None])
+
+
+@pytest.mark.parametrize("kernels", supported_isas())
+@pytest.mark.parametrize("position", [0, 1, 5, 8, 16, 22])
+def test_minmax_nan(kernels: str, position: int) -> None:
+    x = np.arange(23, dtype=np.float64)
+    x[position] = np.nan
+    lo, hi = ffi.new("double *"), ffi.new("double *")
+    previous = isa()
+    select_isa(kernels)
+    try:
+        tsp_kernel_minmax(as_ptr(x), len(x), lo, hi)
+    finally:
+        select_isa(previous)
+    assert np.isnan(lo[0]) and np.isnan(hi[0])
+
+
+def unbatched(handler: Any) -> Any:
+    handler.handler.batch = ffi.NULL
+    return handler
+
+
+@given(data=float_arrays, length=st.integers(1, 10), sma=st.booleans())
+def test_batch_operations_match_per_value(data: list[float], length: int, sma: bool) -> None:
+    data = data * 5  # Long enough to wrap the rings a few times
+    assert list(SimpleDataProvider(data) | CMAHandler(length=length)) == list(
+        SimpleDataProvider(data) | unbatched(CMAHandler(length=length))
+    )
+    assert list(SimpleDataProvider(data) | CEMAHandler(length=length, sma=sma)) == list(
+        SimpleDataProvider(data) | unbatched(CEMAHandler(length=length, sma=sma))
+    )
+
+
+def as_array(values: list[float | None]) -> np.ndarray:  # type: ignore[type-arg]
+    return np.array([np.nan if value is None else value for value in values], dtype=np.float64)
+
+
+@given(data=float_arrays, length=st.integers(1, 10), n_hint=st.sampled_from([0, 1, 10_000]))
+def test_to_numpy_matches_iteration(data: list[float], length: int, n_hint: int) -> None:
+    def pipeline() -> Handler[Any, Any]:
+        return SimpleDataProvider(data) | CMAHandler(length=length) | CEMAHandler(length=length)
+
+    result = pipeline().to_numpy(n_hint)
+    assert result.dtype == np.float64
+    assert np.array_equal(result, as_array(list(pipeline())), equal_nan=True)
+
+
+def test_to_numpy_python_handlers() -> None:
+    result = (SimpleDataProvider([1.0, -2.0, 3.0]) | MappingHandler(lambda x: x if x > 0 else None)).to_numpy()
+    assert np.array_equal(result, [1.0, np.nan, 3.0], equal_nan=True)
+
+
+def test_to_numpy_after_iteration_with_smaller_blocks() -> None:
+    data = np.arange(10_000, dtype=np.float64)
+    provider = BlockDataProvider([data])
+    assert list(provider | CMAHandler(length=1)) == data.tolist()
+    assert np.array_equal(provider.to_numpy(), data)
+
+
+class FailedProvider(BlockDataProvider):
+    """Native source that reports a failure once its data ends."""
+
+    def check(self) -> None:
+        raise OSError("source failed")
+
+
+def test_to_numpy_checks_native_sources() -> None:
+    with pytest.raises(OSError, match="source failed"):
+        (FailedProvider([np.arange(5.0)]) | CMAHandler(length=2) | CEMAHandler(length=2)).to_numpy()
+    with pytest.raises(OSError, match="source failed"):
+        FailedProvider([np.arange(5.0)]).to_numpy()
+
+
+@given(data=float_arrays, length=st.integers(1, 10))
+def test_spill_matches_to_numpy(data: list[float], length: int) -> None:
+    def pipeline() -> Handler[Any, Any]:
+        return SimpleDataProvider(data) | CMAHandler(length=length)
+
+    spilled = spill(pipeline())
+    assert not spilled.flags.writeable
+    assert np.array_equal(spilled, pipeline().to_numpy(), equal_nan=True)
+    assert np.array_equal(spill(data), data)
+
+
+def test_spill_grows_and_outlives_views(tmp_path: Any) -> None:
+    size = 1_000_003
+    spilled = spill((float(i) if i % 7 else None for i in range(size)), directory=str(tmp_path))
+    assert len(spilled) == size
+    assert np.isnan(spilled[::7]).all()
+    assert list(tmp_path.iterdir()) == []  # The file is unlinked, only the mapping keeps it
+    tail = spilled[-3:]
+    del spilled
+    gc.collect()
+    assert tail.tolist() == [float(size - 3), float(size - 2), float(size - 1)]
+
+
+def test_spill_missing_directory() -> None:
+    with pytest.raises(OSError):
+        spill([1.0], directory="/nonexistent/directory")
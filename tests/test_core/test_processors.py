@@ -1,3 +1,4 @@
+from collections import deque
 from typing import Any, Callable
 
 import numpy as np
@@ -8,13 +9,14 @@ from hypothesis.strategies import DrawFn
 
 from pysatl_tsp.core.data_providers import DataProvider, SimpleDataProvider
 from pysatl_tsp.core.processor import (
+    IncrementalFilter,
     MappingHandler,
     OfflineFilterHandler,
     OfflineSamplingHandler,
     OnlineFilterHandler,
     OnlineSamplingHandler,
 )
-from pysatl_tsp.core.scrubber import ScrubberWindow
+from pysatl_tsp.core.scrubber import NativeScrubberWindow, ScrubberWindow
 
 
 class TestMappingHandlerWithHypothesis:
@@ -210,6 +212,95 @@ class TestOnlineFilterHandler:
         with pytest.raises(ValueError, match="Source is not set"):
             list(handler)
 
+    @given(data=st.lists(st.floats(-1e6, 1e6), max_size=50), max_history=st.integers(1, 10))
+    def test_max_history(self, data: list[float], max_history: int) -> None:
+        def tail_sum(history: ScrubberWindow[float], _: None) -> float:
+            assert len(history) <= max_history
+            return float(sum(history.values))
+
+        handler: OnlineFilterHandler[float, float] = OnlineFilterHandler(
+            tail_sum, source=SimpleDataProvider(data), max_history=max_history
+        )
+        expected = [float(sum(data[max(0, i + 1 - max_history) : i + 1])) for i in range(len(data))]
+        np.testing.assert_allclose(list(handler), expected)
+
+    def test_max_history_storage(self) -> None:
+        histories: list[ScrubberWindow[Any]] = []
+        max_history = 3
+
+        def newest_indices(history: ScrubberWindow[Any], _: None) -> list[int]:
+            histories.append(history)
+            return [int(index) for index in history.indices]
+
+        floats: OnlineFilterHandler[float, list[int]] = OnlineFilterHandler(
+            newest_indices,
+            source=SimpleDataProvider([float(i) for i in range(100)]),
+            max_history=max_history,
+            float_history=True,
+        )
+        assert list(floats)[-1] == [97, 98, 99]
+        # Float histories are kept in one native ring that doesn't grow
+        assert isinstance(histories[-1], NativeScrubberWindow)
+        assert histories[-1].capacity == max_history
+        assert all(history is histories[0] for history in histories)
+
+        words: OnlineFilterHandler[str, list[int]] = OnlineFilterHandler(
+            newest_indices, source=SimpleDataProvider(list("abcde")), max_history=2
+        )
+        assert list(words) == [[0], [0, 1], [1, 2], [2, 3], [3, 4]]
+
+        with pytest.raises(ValueError):
+            OnlineFilterHandler(newest_indices, max_history=0)
+        with pytest.raises(ValueError):
+            OnlineFilterHandler(newest_indices, float_history=True)
+
+    def test_bounded_history_keeps_values(self) -> None:
+        # Mixed data starting with a float is kept as it is unless float storage is requested
+        data: list[Any] = [1.5, None, 2, "x"]
+        handler: OnlineFilterHandler[Any, list[Any]] = OnlineFilterHandler(
+            lambda history, _: list(history.values), source=SimpleDataProvider(data), max_history=2
+        )
+        assert list(handler) == [[1.5], [1.5, None], [None, 2], [2, "x"]]
+        assert type(list(handler)[-1][0]) is int
+
+
+class RunningMean(IncrementalFilter[float, float]):
+    def init_state(self, config: None) -> tuple[int, float]:
+        return 0, 0.0
+
+    def step(self, state: tuple[int, float], value: float, config: None) -> tuple[tuple[int, float], float]:
+        count, mean = state
+        count += 1
+        mean += (value - mean) / count
+        return (count, mean), mean
+
+
+class TestIncrementalFilter:
+    @given(data=st.lists(st.floats(-1e6, 1e6), max_size=50))
+    def test_matches_window_filter(self, data: list[float]) -> None:
+        handler: OnlineFilterHandler[float, float] = OnlineFilterHandler(RunningMean(), source=SimpleDataProvider(data))
+        result = list(handler)
+
+        expected = [float(np.mean(data[: i + 1])) for i in range(len(data))]
+        np.testing.assert_allclose(result, expected, atol=1e-6)
+        # Called on a window, the filter steps through it from scratch
+        np.testing.assert_allclose(
+            [RunningMean()(ScrubberWindow(deque(data[: i + 1])), None) for i in range(len(data))], expected, atol=1e-6
+        )
+        # No history is kept
+        assert not hasattr(handler, "_history")
+
+    def test_state_resets(self) -> None:
+        handler: OnlineFilterHandler[float, float] = OnlineFilterHandler(
+            RunningMean(), source=SimpleDataProvider([2.0, 4.0])
+        )
+        assert list(handler) == [2.0, 3.0]
+        assert list(handler) == [2.0, 3.0]
+
+    def test_empty_window(self) -> None:
+        with pytest.raises(ValueError, match="empty"):
+            RunningMean()(ScrubberWindow(), None)
+
 
 class TestOfflineFilterHandler:
     def test_initialization(self) -> None:
@@ -254,6 +345,24 @@ class TestOfflineFilterHandler:
         result: list[float] = list(handler)
         assert result == []
 
+    def test_out_of_core(self) -> None:
+        data = np.sin(np.linspace(0, 20, 5000))
+
+        def detrend(series: ScrubberWindow[float], _: None) -> list[float]:
+            values = np.asarray(series.values)
+            return (values - values.mean()).tolist()
+
+        in_memory: OfflineFilterHandler[float, float] = OfflineFilterHandler(detrend, source=SimpleDataProvider(data))
+        spilled: OfflineFilterHandler[float, float] = OfflineFilterHandler(
+            detrend, source=SimpleDataProvider(data), out_of_core=True
+        )
+        np.testing.assert_allclose(list(spilled), list(in_memory))
+
+        def check_array(series: ScrubberWindow[float], _: None) -> list[bool]:
+            return [isinstance(series.values, np.ndarray) and not series.values.flags.writeable]
+
+        assert list(OfflineFilterHandler(check_array, source=SimpleDataProvider(data), out_of_core=True)) == [True]
+
 
 class TestOnlineSamplingHandler:
     def test_initialization(self) -> None:
@@ -356,6 +465,11 @@ class TestOfflineSamplingHandler:
         expected: list[int] = [3, 9, 2, 10]
         assert result == expected
 
+        spilled: OfflineSamplingHandler[int] = OfflineSamplingHandler(
+            sampling_rule=segment_on_big_difference, source=SimpleDataProvider(data), out_of_core=True
+        )
+        assert list(spilled) == expected
+
     def test_source_not_set(self) -> None:
         def empty_rule(w: ScrubberWindow[int]) -> list[int]:
             return []
@@ -0,0 +1,75 @@
+import queue
+import threading
+
+import pytest
+from hypothesis import given
+from hypothesis import strategies as st
+
+from pysatl_tsp.core.ring import MessageRing
+
+
+@given(st.lists(st.text(), max_size=50))
+def test_messages_keep_order(messages: list[str]) -> None:
+    ring = MessageRing(capacity=64)
+    for message in messages:
+        ring.put(message)
+
+    assert ring.qsize() == len(messages)
+    assert ring.get_batch(timeout=0) == messages[:1024]
+    assert ring.qsize() == 0
+
+
+def test_blocking_producer_delivers_everything() -> None:
+    total = 100_000
+    ring = MessageRing(capacity=16, overflow="block")
+
+    def produce() -> None:
+        for i in range(total):
+            ring.put(str(i))
+
+    producer = threading.Thread(target=produce)
+    producer.start()
+    received: list[str] = []
+    while len(received) < total:
+        received.extend(ring.get_batch(timeout=5))
+    producer.join()
+
+    assert received == [str(i) for i in range(total)]
+    assert ring.dropped == 0
+
+
+@pytest.mark.parametrize(("overflow", "expected"), [("drop_oldest", ["6", "7", "8", "9"]), ("conflate", ["8", "9"])])
+def test_overflow_drops_old_messages(overflow: str, expected: list[str]) -> None:
+    ring = MessageRing(capacity=4, overflow=overflow)
+    for i in range(10):
+        ring.put(str(i))
+
+    received = ring.get_batch(timeout=0)
+    assert received == expected
+    assert ring.dropped == 10 - len(expected)
+
+
+def test_get_timeout_and_close() -> None:
+    ring = MessageRing(capacity=4)
+    with pytest.raises(queue.Empty):
+        ring.get(timeout=0.01)
+
+    ring.put("last")
+    ring.close()
+    assert ring.get() == "last"
+    assert ring.get_batch() == []
+    with pytest.raises(RuntimeError):
+        ring.put("closed")
+
+
+def test_close_wakes_blocked_consumer() -> None:
+    ring = MessageRing(capacity=4)
+    closer = threading.Timer(0.05, ring.close)
+    closer.start()
+    assert ring.get_batch() == []
+    closer.join()
+
+
+def test_unknown_overflow_policy() -> None:
+    with pytest.raises(ValueError, match="Unknown overflow policy"):
+        MessageRing(overflow="grow")
@@ -1,20 +1,58 @@
+import math
 from collections import deque
-from typing import Any
+from datetime import datetime, timedelta
+from collections.abc import Iterator
+from itertools import pairwise
+from typing import Any, TypeVar
 
 import hypothesis.strategies as st
 import numpy as np
+import pytest
 from hypothesis import given, settings
 
 from pysatl_tsp.core.data_providers import SimpleDataProvider
 from pysatl_tsp.core.scrubber import (
+    AbsSumCondition,
+    AggregateScrubber,
+    BinarySegmentation,
+    ChangeCondition,
+    CountCondition,
+    CusumRule,
+    JumpRule,
     LinearScrubber,
+    MaxSizeRule,
+    NativeCondition,
+    NativeScrubberWindow,
+    NativeSegmentationRule,
     OfflineSegmentationScrubber,
     OnlineSegmentationScrubber,
+    PageHinkleyRule,
+    Pelt,
     ScrubberWindow,
+    SlidingScrubber,
+    SpanCondition,
+    StridedScrubber,
+    SumCondition,
+    TimeWindowScrubber,
 )
 
 numeric_lists = st.lists(st.floats(allow_nan=False, allow_infinity=False))
 
+T = TypeVar("T")
+
+
+class LiveProvider(SimpleDataProvider[T]):
+    """Provider that counts the items taken from it, to check what a live source would have sent."""
+
+    def __init__(self, data: list[T]) -> None:
+        super().__init__(data)
+        self.pulled = 0
+
+    def __iter__(self) -> Iterator[T]:
+        for item in self.data:
+            self.pulled += 1
+            yield item
+
 
 class TestLinearScrubber:
     @settings(max_examples=1000)
@@ -63,6 +101,104 @@ class TestOfflineSegmentationScrubber:
         assert output[0].values == deque([])
 
 
+def segmentation_score(values: list[float], bounds: list[int], cost: str, penalty: float) -> float:
+    """Penalized cost of the segmentation of values by segment bounds."""
+    variance_floor = 1e-12
+    data = np.asarray(values)
+    centered = data - data.mean()
+    score = penalty * (len(bounds) - 2)
+    for start, end in pairwise(bounds):
+        segment = data[start:end]
+        if cost == "l2":
+            score += float(np.sum((segment - segment.mean()) ** 2))
+        elif cost == "variance":
+            score += len(segment) * np.log(max(np.mean(centered[start:end] ** 2), variance_floor))
+        else:
+            score += len(segment) * np.log(max(np.var(segment), variance_floor))
+    return score
+
+
+def optimal_segmentation_score(values: list[float], cost: str, penalty: float, min_size: int) -> float:
+    """Score of the optimal segmentation, found by exhaustive dynamic programming."""
+    best: dict[int, tuple[float, list[int]]] = {0: (0.0, [0])}
+    for end in range(min_size, len(values) + 1):
+        options = [
+            segmentation_score(values, [*best[start][1], end], cost, penalty)
+            for start in [0, *range(min_size, end - min_size + 1)]
+            if start in best
+        ]
+        starts = [start for start in [0, *range(min_size, end - min_size + 1)] if start in best]
+        choice = int(np.argmin(options))
+        best[end] = (options[choice], [*best[starts[choice]][1], end])
+    return best[len(values)][0]
+
+
+class TestChangepointRules:
+    @settings(max_examples=100, deadline=None)
+    @given(
+        st.lists(st.integers(-5, 5).map(float), max_size=30),
+        st.sampled_from(["l2", "variance", "normal"]),
+        st.floats(0, 20),
+        st.integers(1, 4),
+    )
+    def test_pelt_is_optimal(self, values: list[float], cost: str, penalty: float, min_size: int) -> None:
+        changepoints = Pelt(cost, penalty, min_size).detect(values)
+        if len(values) < 2 * min_size:
+            assert changepoints == []
+            return
+        bounds = [0, *changepoints, len(values)]
+        assert all(end - start >= min_size for start, end in pairwise(bounds))
+        assert np.isclose(
+            segmentation_score(values, bounds, cost, penalty),
+            optimal_segmentation_score(values, cost, penalty, min_size),
+            atol=1e-6,
+        )
+
+    def test_mean_and_variance_shifts(self) -> None:
+        rng = np.random.default_rng(0)
+        means = np.concatenate([rng.normal(0, 1, 300), rng.normal(5, 1, 300), rng.normal(-2, 1, 300)])
+        scales = np.concatenate([rng.normal(0, 1, 400), rng.normal(0, 6, 400)])
+        for rule in (Pelt(min_size=5), BinarySegmentation(min_size=5)):
+            assert rule.detect(means) == [300, 600]
+        tolerance = 20
+        for rule in (Pelt("variance", min_size=20), BinarySegmentation("normal", min_size=20)):
+            (changepoint,) = rule.detect(scales)
+            assert abs(changepoint - len(scales) // 2) < tolerance
+
+    def test_binseg_max_changepoints(self) -> None:
+        values = [0.0] * 50 + [10.0] * 50 + [0.0] * 50 + [3.0] * 50
+        assert BinarySegmentation(max_changepoints=2).detect(values) == [50, 100]
+        assert BinarySegmentation(penalty=1).detect(values) == [50, 100, 150]
+
+    def test_offline_scrubber(self) -> None:
+        data = [1, 1, 2, 2, 1, 9, 9, 8, 9, 1, 1, 2, 1]
+        segments = list(OfflineSegmentationScrubber(Pelt(penalty=5), SimpleDataProvider(data)))
+        assert [list(segment.values) for segment in segments] == [data[:5], data[5:9], data[9:]]
+        assert list(segments[1].indices) == [5, 6, 7, 8]
+
+        spilled = list(OfflineSegmentationScrubber(Pelt(penalty=5), SimpleDataProvider(data), out_of_core=True))
+        assert spilled == segments
+        assert np.shares_memory(spilled[0].values, spilled[1].values) or spilled[0].values.base is not None
+
+    def test_large_series(self) -> None:
+        size, regimes, tolerance = 1_000_000, 2000, 3
+        regime_length = size // regimes
+        expected = np.arange(regime_length, size, regime_length)
+        rng = np.random.default_rng(1)
+        levels = np.repeat(np.arange(regimes) % 2 * 5.0, regime_length)
+        changepoints = Pelt(min_size=10).detect(levels + rng.normal(0, 1, size))
+        assert len(changepoints) == len(expected)
+        assert np.all(np.abs(np.array(changepoints) - expected) <= tolerance)
+
+    def test_invalid_parameters(self) -> None:
+        with pytest.raises(ValueError):
+            Pelt("l1")
+        with pytest.raises(ValueError):
+            Pelt(penalty=-1)
+        with pytest.raises(ValueError):
+            BinarySegmentation(min_size=0)
+
+
 class TestOnlineSegmentationScrubber:
     @given(numeric_lists)
     def test_fixed_window_size(self, data: list[float]) -> None:
@@ -117,6 +253,50 @@ class TestOnlineSegmentationScrubber:
         scrubber.source = SimpleDataProvider(source_data)
         assert list(scrubber) == [ScrubberWindow(deque(source_data))]
 
+    def test_segments_are_moved_out(self) -> None:
+        segment_size = 2
+        scrubber = OnlineSegmentationScrubber(
+            lambda window: len(window) >= segment_size, source=SimpleDataProvider(range(6))
+        )
+        segments = list(scrubber)
+        assert [list(segment.values) for segment in segments] == [[0, 1], [2, 3], [4, 5]]
+        assert len({id(segment.values) for segment in segments}) == len(segments)
+
+    @settings(max_examples=200)
+    @given(
+        st.lists(st.floats(-100, 100), max_size=200),
+        st.sampled_from([JumpRule(30), CusumRule(50, 1), PageHinkleyRule(40, 0.5), MaxSizeRule(7)]),
+        st.integers(1, 12),
+    )
+    def test_native_rules_match_callable(self, data: list[float], rule: NativeSegmentationRule, max_size: int) -> None:
+        native = OnlineSegmentationScrubber(rule, max_size, SimpleDataProvider(data))
+        fallback = OnlineSegmentationScrubber(rule.__call__, max_size, SimpleDataProvider(data))
+        assert list(native) == list(fallback)
+
+    def test_native_rules_over_long_segments(self) -> None:
+        data = [float(i // 5000 * 100) for i in range(12000)]
+        segments = list(OnlineSegmentationScrubber(JumpRule(50), source=SimpleDataProvider(data)))
+        assert [segment.indices[-1] for segment in segments] == [5000, 10000, 11999]
+        assert [len(segment) for segment in segments] == [5001, 5000, 1999]
+
+    def test_mean_shift_rules(self) -> None:
+        shift_at, detection_delay = 100, 10
+        data = [0.0] * shift_at + [5.0] * shift_at
+        for rule in (CusumRule(10, 0.5), PageHinkleyRule(10, 0.5)):
+            first = next(iter(OnlineSegmentationScrubber(rule, source=SimpleDataProvider(data))))
+            assert shift_at <= first.indices[-1] < shift_at + detection_delay
+
+    def test_jump_rule(self) -> None:
+        data = [1, 1, 2, 3, 8, 9, 8, 2, 2, 3, 10, 10, 9, 9]
+        segments = OnlineSegmentationScrubber(JumpRule(3), max_segment_size=5, source=SimpleDataProvider(data))
+        assert [list(segment.values) for segment in segments] == [[1, 1, 2, 3, 8], [9, 8, 2], [2, 3, 10], [10, 9, 9]]
+
+    def test_native_segments_are_not_delayed(self) -> None:
+        source = LiveProvider([0.0] * 10 + [100.0] * 10)
+        segments = iter(OnlineSegmentationScrubber(JumpRule(50), source=source))
+        assert list(next(segments).indices) == list(range(11))
+        assert source.pulled == 11
+
 
 def test_scrubber_window_slicing() -> None:
     window = ScrubberWindow(values=deque([0.1, 0.2, 0.3, 0.4]), indices=deque([10, 11, 12, 13]))
@@ -128,6 +308,380 @@ def test_scrubber_window_slicing() -> None:
     assert window[2] == window.values[2]
 
 
+class TestNativeScrubberWindow:
+    @given(numeric_lists, st.integers(0, 20), st.integers(1, 8))
+    def test_matches_scrubber_window(self, data: list[float], window_length: int, capacity: int) -> None:
+        native = NativeScrubberWindow(capacity=capacity)
+        reference: ScrubberWindow[float] = ScrubberWindow()
+        for i, value in enumerate(data):
+            native.append(value, i)
+            reference.append(value, i)
+            if len(reference) > window_length:
+                native.popleft()
+                reference.popleft()
+            assert native == reference
+            assert native[1:] == reference[1:]
+            assert list(native[::2]) == list(reference.values)[::2]
+
+    @given(numeric_lists, st.integers(0, 20))
+    def test_default_indices_match_scrubber_window(self, data: list[float], window_length: int) -> None:
+        native = NativeScrubberWindow(capacity=2)
+        reference: ScrubberWindow[float] = ScrubberWindow()
+        for value in data:
+            native.append(value)
+            reference.append(value)
+            if len(reference) > window_length:
+                native.popleft()
+                reference.popleft()
+            assert native == reference
+
+    def test_slices_are_views(self) -> None:
+        window = NativeScrubberWindow([0.1, 0.2, 0.3, 0.4], [10, 11, 12, 13])
+
+        sliced = window[1:3]
+        assert np.shares_memory(np.asarray(sliced), window.values)
+        assert list(sliced.values) == [0.2, 0.3]
+        assert list(sliced.indices) == [11, 12]
+        assert memoryview(sliced.values).contiguous
+        assert window[2] == window.values[2] == window[-2]
+
+        with pytest.raises(ValueError, match="read-only"):
+            sliced.values[0] = 1.0
+
+    def test_appending_to_view_detaches(self) -> None:
+        window = NativeScrubberWindow([1.0, 2.0, 3.0])
+        head = window[:2]
+        head.append(5.0, 7)
+        assert list(head.values) == [1.0, 2.0, 5.0]
+        assert list(window.values) == [1.0, 2.0, 3.0]
+        assert not np.shares_memory(head.values, window.values)
+
+    def test_overwritten_view_raises(self) -> None:
+        capacity = 4
+        window = NativeScrubberWindow(capacity=capacity)
+        for i in range(capacity):
+            window.append(float(i), i)
+        view = window[:2]
+        retained = view.copy()
+        for i in range(capacity, 2 * capacity):
+            window.popleft()
+            window.append(float(i), i)
+        with pytest.raises(RuntimeError, match="copy"):
+            _ = view.values
+        assert list(retained.values) == [0.0, 1.0]
+        assert list(window.values) == [4.0, 5.0, 6.0, 7.0]
+
+    def test_wrap_has_implicit_indices(self) -> None:
+        data = np.arange(10, dtype=np.float64)
+        window = NativeScrubberWindow.wrap(data)
+        assert np.shares_memory(window.values, data)
+        assert window[3:6] == NativeScrubberWindow([3.0, 4.0, 5.0], [3, 4, 5])
+        assert list(window[7:].indices) == [7, 8, 9]
+        assert list(window[::3].indices) == [0, 3, 6, 9]
+        tail = window[8:]
+        tail.append(10.0)
+        assert list(tail.indices) == [8, 9, 3]
+
+    def test_popleft_many(self) -> None:
+        window = NativeScrubberWindow([1.0, 2.0, 3.0, 4.0], [5, 6, 7, 8])
+        window.popleft(3)
+        assert window == NativeScrubberWindow([4.0], [8])
+        window.popleft(0)
+        assert len(window) == 1
+        with pytest.raises(IndexError):
+            window.popleft(2)
+        window.popleft()
+        with pytest.raises(IndexError, match="empty"):
+            window.popleft()
+
+    def test_growth_keeps_views(self) -> None:
+        window = NativeScrubberWindow([1.0, 2.0], capacity=2)
+        view = window[:]
+        window.append(3.0)
+        assert window.capacity > len(view)
+        assert list(view.values) == [1.0, 2.0]
+        assert list(window.values) == [1.0, 2.0, 3.0]
+
+
+class TestNativeConditions:
+    @settings(max_examples=300)
+    @given(
+        st.lists(st.floats(-100, 100)),
+        st.sampled_from(
+            [CountCondition(4), SumCondition(50), AbsSumCondition(120), SpanCondition(3), ChangeCondition(40)]
+        ),
+        st.integers(1, 5),
+    )
+    def test_matches_callable(self, data: list[float], condition: NativeCondition, shift: int) -> None:
+        native = SlidingScrubber(condition, shift, SimpleDataProvider(data))
+        fallback = SlidingScrubber(condition.__call__, shift, SimpleDataProvider(data))
+        assert list(native) == list(fallback)
+
+    def test_sum_is_compensated(self) -> None:
+        # Plain float addition loses the 1.0 next to 1e16 and never reaches the threshold
+        data = [-1e16, 1.0, 1e16, 0.0]
+        windows = list(SlidingScrubber(SumCondition(1.0), 1, SimpleDataProvider(data)))
+        assert [list(window.values) for window in windows] == [data[:3], data[1:4]]
+
+    @pytest.mark.parametrize("condition", [SumCondition(10), AbsSumCondition(10)])
+    @pytest.mark.parametrize("shift", [1, 2, 3])
+    def test_non_finite_values_leave_the_sum(self, condition: NativeCondition, shift: int) -> None:
+        # The infinite value is taken at once, the windows after it must see finite sums again
+        data = [1.0, math.inf, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 1.0, 1.0, 1.0]
+        native = SlidingScrubber(condition, shift, SimpleDataProvider(data))
+        fallback = SlidingScrubber(condition.__call__, shift, SimpleDataProvider(data))
+        native_indices = [list(window.indices) for window in native]
+        assert native_indices == [list(window.indices) for window in fallback]
+        assert native_indices[-1][-1] >= 8
+
+    def test_count_condition_on_windows(self) -> None:
+        scrubber = SimpleDataProvider(range(10)) | LinearScrubber(window_length=3) | LinearScrubber(window_length=2)
+        assert [len(window) for window in scrubber] == [2] * 7
+
+
+class TestStridedScrubber:
+    @settings(max_examples=200)
+    @given(st.integers(0, 100), st.integers(1, 30), st.floats(0.01, 5), st.booleans())
+    def test_matches_linear_scrubber(
+        self, data_length: int, window_length: int, shift_factor: float, offline: bool
+    ) -> None:
+        data = [float(i) for i in range(data_length)]
+        expected = list(LinearScrubber(window_length, shift_factor, SimpleDataProvider(data)))
+        scrubber = StridedScrubber(window_length, shift_factor, SimpleDataProvider(data), offline=offline)
+        windows = [window.copy() for window in scrubber]
+        assert windows == expected
+
+    def test_long_shift_does_not_skip_values(self) -> None:
+        data = [float(i) for i in range(12)]
+        for offline in (False, True):
+            scrubber = StridedScrubber(3, 2.0, SimpleDataProvider(data), offline=offline)
+            assert [list(window.values) for window in scrubber] == [data[i : i + 3] for i in range(0, 12, 3)]
+
+    def test_windows_share_buffer(self) -> None:
+        data = np.arange(50, dtype=np.float64)
+        windows = list(StridedScrubber(10, 0.5, SimpleDataProvider(data), offline=True))
+        assert all(np.shares_memory(a.values, b.values) for a, b in pairwise(windows))
+        assert list(windows[-1].indices) == list(range(40, 50))
+
+        online = iter(StridedScrubber(10, 0.5, SimpleDataProvider(data)))
+        first, second = next(online), next(online)
+        assert np.shares_memory(first.values, second.values)
+
+    def test_retained_windows_need_copy(self) -> None:
+        window_length = 4
+        scrubber = StridedScrubber(window_length, 1.0, SimpleDataProvider(range(20)), capacity=window_length)
+        windows = iter(scrubber)
+        first = next(windows)
+        kept = first.copy()
+        next(windows)
+        with pytest.raises(RuntimeError):
+            _ = first.values
+        assert list(kept.values) == [0.0, 1.0, 2.0, 3.0]
+
+    def test_invalid_parameters(self) -> None:
+        with pytest.raises(ValueError):
+            StridedScrubber(0)
+        with pytest.raises(ValueError):
+            StridedScrubber(10, capacity=5)
+
+
+class TestTimeWindowScrubber:
+    @settings(max_examples=300)
+    @given(st.lists(st.tuples(st.integers(0, 50), st.floats(-100, 100))), st.integers(1, 20))
+    def test_sliding_matches_rescan(self, points: list[tuple[int, float]], duration: int) -> None:
+        ticks = sorted(points, key=lambda point: point[0])
+        windows = list(TimeWindowScrubber(duration, source=SimpleDataProvider(ticks)))
+        assert len(windows) == len(ticks)
+        for i, window in enumerate(windows):
+            values = [value for ts, value in ticks[: i + 1] if ts > ticks[i][0] - duration]
+            assert (window.start, window.end) == (ticks[i][0] - duration + 1, ticks[i][0] + 1)
+            assert window.count == len(values)
+            assert window.min == min(values)
+            assert window.max == max(values)
+            assert (window.first, window.last) == (values[0], values[-1])
+            assert np.isclose(window.sum, sum(values), atol=1e-9)
+
+    @settings(max_examples=300)
+    @given(st.lists(st.tuples(st.integers(-50, 50), st.floats(-100, 100))), st.integers(1, 20), st.integers(-5, 5))
+    def test_tumbling_matches_groups(self, points: list[tuple[int, float]], duration: int, origin: int) -> None:
+        ticks = sorted(points, key=lambda point: point[0])
+        groups: dict[int, list[float]] = {}
+        for ts, value in ticks:
+            groups.setdefault((ts - origin) // duration * duration + origin, []).append(value)
+        windows = list(TimeWindowScrubber(duration, "tumbling", origin, SimpleDataProvider(ticks)))
+        assert [window.start for window in windows] == list(groups)
+        for window, values in zip(windows, groups.values()):
+            assert window.end == window.start + duration
+            assert (window.count, window.min, window.max) == (len(values), min(values), max(values))
+            assert (window.first, window.last) == (values[0], values[-1])
+            assert np.isclose(window.mean, sum(values) / len(values), atol=1e-9)
+
+    @pytest.mark.parametrize("bad", [[math.nan], [math.inf], [-math.inf], [math.inf, -math.inf]])
+    @pytest.mark.parametrize("mode", ["sliding", "tumbling"])
+    def test_non_finite_values_leave_the_sum(self, bad: list[float], mode: str) -> None:
+        ticks = [(100 * i, float(i)) for i in range(40)]
+        for offset, value in enumerate(bad):
+            ticks[5 + offset] = (ticks[5 + offset][0], value)
+        windows = list(TimeWindowScrubber(1000, mode, source=SimpleDataProvider(ticks)))
+        for window in windows:
+            values = [value for ts, value in ticks if window.start <= ts < window.end]
+            assert window.count == len(values)
+            assert window.sum == pytest.approx(sum(values), nan_ok=True)
+        assert math.isfinite(windows[-1].sum)
+
+    def test_datetime_timestamps(self) -> None:
+        start = datetime(2024, 1, 1)
+        ticks = [(start + timedelta(seconds=s), float(s)) for s in (0, 1, 2, 6, 7)]
+        windows = list(TimeWindowScrubber(timedelta(seconds=5), source=SimpleDataProvider(ticks)))
+        assert [window.count for window in windows] == [1, 2, 3, 2, 2]
+        assert [window.min for window in windows] == [0.0, 0.0, 0.0, 2.0, 6.0]
+
+    def test_decreasing_timestamps(self) -> None:
+        with pytest.raises(ValueError, match="non-decreasing"):
+            list(TimeWindowScrubber(10, source=SimpleDataProvider([(5, 1.0), (3, 2.0)])))
+
+    def test_windows_are_not_delayed(self) -> None:
+        source = LiveProvider([(i, float(i)) for i in range(100)])
+        windows = iter(TimeWindowScrubber(10, source=source))
+        assert next(windows).count == 1
+        assert source.pulled == 1
+
+        source = LiveProvider([(i, float(i)) for i in range(100)])
+        bars = iter(TimeWindowScrubber(10, "tumbling", source=source))
+        assert next(bars).count == 10
+        assert source.pulled == 11
+
+    def test_invalid_parameters(self) -> None:
+        with pytest.raises(ValueError):
+            TimeWindowScrubber(0)
+        with pytest.raises(ValueError):
+            TimeWindowScrubber(10, mode="hopping")
+
+
+def expected_record(start: int, end: int, values: list[float]) -> dict[str, float]:
+    return {
+        "start": start,
+        "end": end,
+        "count": len(values),
+        "sum": sum(values),
+        "mean": sum(values) / len(values),
+        "min": min(values),
+        "max": max(values),
+        "first": values[0],
+        "last": values[-1],
+    }
+
+
+def assert_records_equal(records: list[dict[str, float]], expected: list[dict[str, float]]) -> None:
+    assert len(records) == len(expected)
+    for record, reference in zip(records, expected):
+        assert record.keys() == reference.keys()
+        for name, value in reference.items():
+            assert np.isclose(record[name], value, atol=1e-6), name
+
+
+class TestAggregateScrubber:
+    @settings(max_examples=300)
+    @given(st.lists(st.floats(-1e6, 1e6), max_size=60), st.integers(1, 12), st.integers(1, 12))
+    def test_elements_match_rescan(self, data: list[float], size: int, hop: int) -> None:
+        records = list(AggregateScrubber(size, hop, source=SimpleDataProvider(data)))
+        expected = [
+            expected_record(start, start + size, data[start : start + size])
+            for start in range(0, len(data) - size + 1, hop)
+        ]
+        assert_records_equal(records, expected)
+
+    @settings(max_examples=300)
+    @given(
+        st.lists(st.tuples(st.integers(-60, 60), st.floats(-100, 100))),
+        st.integers(1, 12),
+        st.integers(1, 12),
+        st.integers(-5, 5),
+    )
+    def test_time_matches_rescan(self, points: list[tuple[int, float]], size: int, hop: int, origin: int) -> None:
+        ticks = sorted(points, key=lambda point: point[0])
+        records = list(AggregateScrubber(size, hop, units="time", origin=origin, source=SimpleDataProvider(ticks)))
+        expected = []
+        if ticks:
+            first_window = (ticks[0][0] - size - origin) // hop + 1
+            for k in range(first_window, (ticks[-1][0] - origin) // hop + 1):
+                start = origin + k * hop
+                values = [value for ts, value in ticks if start <= ts < start + size]
+                if values:
+                    expected.append(expected_record(start, start + size, values))
+        assert_records_equal(records, expected)
+
+    def test_selected_aggregates(self) -> None:
+        records = list(AggregateScrubber(4, 2, ["mean", "max"], source=SimpleDataProvider(range(8))))
+        assert records == [
+            {"start": 0, "end": 4, "mean": 1.5, "max": 3.0},
+            {"start": 2, "end": 6, "mean": 3.5, "max": 5.0},
+            {"start": 4, "end": 8, "mean": 5.5, "max": 7.0},
+        ]
+
+    def test_long_windows_and_gaps(self) -> None:
+        # Many panes per window, and a gap that spans many windows
+        start = datetime(2024, 1, 1)
+        ticks = [(start + timedelta(seconds=s), float(s)) for s in [*range(0, 100_000, 7), 10_000_000]]
+        records = list(
+            AggregateScrubber(
+                timedelta(hours=1),
+                timedelta(seconds=10),
+                ["count", "last"],
+                units="time",
+                source=SimpleDataProvider(ticks),
+            )
+        )
+        assert records[-1]["count"] == 1
+        assert records[-1]["last"] == ticks[-1][1]
+        assert sum(record["count"] for record in records) == 360 * len(ticks)  # Every tick is in size / hop windows
+
+    def test_non_finite_values_leave_the_sum(self) -> None:
+        data = [1.0, math.inf, 3.0, 4.0, 5.0, 6.0]
+        records = list(AggregateScrubber(2, hop=1, aggregates=["sum", "max"], source=SimpleDataProvider(data)))
+        assert [record["sum"] for record in records] == [math.inf, math.inf, 7.0, 9.0, 11.0]
+
+        data = [3.0, 4.0, -math.inf, math.inf, 5.0, math.nan, 6.0, 7.0, 8.0]
+        records = list(AggregateScrubber(2, hop=1, aggregates=["sum"], source=SimpleDataProvider(data)))
+        expected = [7.0, -math.inf, math.nan, math.inf, math.nan, math.nan, 13.0, 15.0]
+        assert [record["sum"] for record in records] == pytest.approx(expected, nan_ok=True)
+
+    def test_missing_values_are_nan(self) -> None:
+        data = [1.0, None, 3.0, 4.0]
+        records = list(AggregateScrubber(2, aggregates=["count", "sum"], source=SimpleDataProvider(data)))
+        assert records[0]["count"] == 2 and math.isnan(records[0]["sum"])
+        assert records[1] == {"start": 2, "end": 4, "count": 2, "sum": 7.0}
+
+        ticks = list(enumerate(data))
+        scrubber = AggregateScrubber(2, aggregates=["count", "sum"], units="time", source=SimpleDataProvider(ticks))
+        records = list(scrubber)
+        assert records[0]["count"] == 2 and math.isnan(records[0]["sum"])
+        assert records[1] == {"start": 2, "end": 4, "count": 2, "sum": 7.0}
+
+    def test_records_are_not_delayed(self) -> None:
+        source = LiveProvider([float(i) for i in range(100)])
+        records = iter(AggregateScrubber(4, source=source))
+        assert next(records)["count"] == 4
+        assert source.pulled == 4
+
+        source = LiveProvider([(i, float(i)) for i in range(100)])
+        bars = iter(AggregateScrubber(10, units="time", source=source))
+        assert next(bars)["count"] == 10
+        assert source.pulled == 11
+
+    def test_invalid_parameters(self) -> None:
+        with pytest.raises(ValueError):
+            AggregateScrubber(0)
+        with pytest.raises(ValueError):
+            AggregateScrubber(4, hop=0)
+        with pytest.raises(ValueError):
+            AggregateScrubber(4, aggregates=["median"])
+        with pytest.raises(ValueError):
+            AggregateScrubber(4, units="bytes")
+        with pytest.raises(ValueError, match="non-decreasing"):
+            list(AggregateScrubber(10, units="time", source=SimpleDataProvider([(5, 1.0), (3, 2.0)])))
+
+
 def test_pipe() -> None:
     data = list(range(20))
     scrubber1 = SimpleDataProvider(data) | LinearScrubber(window_length=3) | LinearScrubber(window_length=2)
@@ -59,3 +59,18 @@ def test_close_stops_thread(provider: WebSocketDataProvider) -> None:
 async def test_receiver_swallows_exceptions(provider: WebSocketDataProvider) -> None:
     with patch("websockets.connect", side_effect=Exception("fail")):
         await provider._receiver()
+
+
+@pytest.mark.asyncio
+async def test_receiver_respects_overflow_policy() -> None:
+    provider = WebSocketDataProvider("ws://test", capacity=2, overflow="drop_oldest")
+    fake_msgs = ["a", "b", "c"]
+
+    fake_ws = AsyncMock()
+    fake_ws.__aenter__.return_value = fake_ws
+    fake_ws.__aiter__.return_value = (m for m in fake_msgs)
+    with patch("websockets.connect", return_value=fake_ws):
+        await provider._receiver()
+
+    assert provider._iterator_queue.get_batch(timeout=0) == ["b", "c"]
+    assert provider._iterator_queue.dropped == 1
@@ -0,0 +1,45 @@
+import numpy as np
+import pytest
+from hypothesis import given
+from hypothesis import strategies as st
+
+from pysatl_tsp.core.data_providers import SimpleDataProvider
+from pysatl_tsp.implementations.processor.ema_handler import CEMAHandler
+from pysatl_tsp.implementations.processor.fwma_handler import CFWMAHandler
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler
+from tests.utils import safe_allclose
+
+HANDLERS = [
+    lambda precision: CMAHandler(length=5, precision=precision),
+    lambda precision: CEMAHandler(length=5, precision=precision),
+    lambda precision: CFWMAHandler(length=5, precision=precision),
+]
+
+float_lists = st.lists(st.floats(min_value=-1e4, max_value=1e4, allow_nan=False, allow_infinity=False), min_size=1)
+
+
+@pytest.mark.parametrize("make_handler", HANDLERS)
+@given(data=float_lists)
+def test_float32_storage_close_to_float64(make_handler, data: list[float]) -> None:  # type: ignore[no-untyped-def]
+    f64 = list(SimpleDataProvider(data) | make_handler("float64"))
+    f32 = list(SimpleDataProvider(data) | make_handler("float32"))
+
+    assert len(f64) == len(f32)
+    assert safe_allclose(f64, f32, rtol=1e-5, atol=1e-3)
+
+
+@pytest.mark.parametrize("make_handler", HANDLERS)
+@given(data=float_lists)
+def test_float32_storage_equals_float64_on_narrowed_input(make_handler, data: list[float]) -> None:  # type: ignore[no-untyped-def]
+    narrowed = [float(x) for x in np.array(data, dtype=np.float32)]
+
+    f64 = list(SimpleDataProvider(narrowed) | make_handler("float64"))
+    f32 = list(SimpleDataProvider(narrowed) | make_handler("float32"))
+
+    assert f64 == f32
+
+
+@pytest.mark.parametrize("handler_type", [CMAHandler, CEMAHandler, CFWMAHandler])
+def test_unknown_precision(handler_type: type) -> None:
+    with pytest.raises(ValueError, match="Unknown precision"):
+        handler_type(length=3, precision="float16")
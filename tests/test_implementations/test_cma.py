@@ -0,0 +1,47 @@
+import math
+import random
+
+import pytest
+from hypothesis import given
+from hypothesis import strategies as st
+
+from pysatl_tsp.core.data_providers import SimpleDataProvider
+from pysatl_tsp.implementations.processor.sma_handler import CMAHandler, MAHandler
+from tests.utils import safe_allclose
+
+
+def exact_moving_average(data: list[float], length: int) -> list[float]:
+    return [math.fsum(data[max(0, i - length + 1) : i + 1]) / min(i + 1, length) for i in range(len(data))]
+
+
+@given(
+    data=st.lists(st.floats(min_value=-100, max_value=100, allow_nan=False, allow_infinity=False), min_size=1),
+    length=st.integers(min_value=1, max_value=20),
+    sum_mode=st.sampled_from(["naive", "kahan", "resum"]),
+)
+def test_cma_matches_python_ma(data: list[float], length: int, sum_mode: str) -> None:
+    python_result: list[float | None] = list(SimpleDataProvider(data) | MAHandler(length=length))
+    c_result: list[float | None] = list(SimpleDataProvider(data) | CMAHandler(length=length, sum_mode=sum_mode))
+
+    assert len(python_result) == len(c_result)
+    assert safe_allclose(python_result, c_result)
+
+
+@pytest.mark.parametrize("sum_mode", ["kahan", "resum"])
+def test_cma_compensated_sum_does_not_drift(sum_mode: str) -> None:
+    random.seed(42)
+    length = 16
+    data = [random.choice([1e12, -1e12, 0.0]) + random.random() for _ in range(100_000)]
+    expected = exact_moving_average(data[-1000:], length)[length:]
+
+    naive = list(SimpleDataProvider(data) | CMAHandler(length=length))[-1000 + length :]
+    compensated = list(SimpleDataProvider(data) | CMAHandler(length=length, sum_mode=sum_mode))[-1000 + length :]
+
+    naive_error = max(abs(a - b) for a, b in zip(naive, expected))
+    compensated_error = max(abs(a - b) for a, b in zip(compensated, expected))
+    assert compensated_error < naive_error
+
+
+def test_cma_unknown_sum_mode() -> None:
+    with pytest.raises(ValueError, match="Unknown sum mode"):
+        CMAHandler(length=3, sum_mode="pairwise")
@@ -1,10 +1,12 @@
 from typing import Any
 
+import numpy as np
 import pytest
 from hypothesis import given
 from hypothesis import strategies as st
 
 from pysatl_tsp.core.data_providers import SimpleDataProvider
+from pysatl_tsp.core.scrubber import NativeScrubberWindow
 from pysatl_tsp.implementations import TimeSeriesCrossValidator
 
 
@@ -107,3 +109,59 @@ def test_exact_data_for_one_split() -> None:
     assert len(val) == val_size
     assert list(train.values) == list(range(10))
     assert list(val.values) == [10, 11]
+
+
+def naive_forecast_error(train: NativeScrubberWindow, val: NativeScrubberWindow) -> float:
+    return float(np.abs(val.values - train.values[-1]).sum())
+
+
+@given(
+    min_train_size=st.integers(min_value=1, max_value=20),
+    val_size=st.integers(min_value=1, max_value=10),
+    length=st.integers(min_value=0, max_value=100),
+)
+def test_views_match_copies(min_train_size: int, val_size: int, length: int) -> None:
+    data = [float(i * i) for i in range(length)]
+    copies = list(TimeSeriesCrossValidator(min_train_size, val_size, source=SimpleDataProvider(data)))
+    views = list(TimeSeriesCrossValidator(min_train_size, val_size, source=SimpleDataProvider(data), views=True))
+    ranges = TimeSeriesCrossValidator(min_train_size, val_size).split_ranges(length)
+
+    assert len(views) == len(copies) == len(ranges)
+    for (train, val), (train_copy, val_copy), (train_range, val_range) in zip(views, copies, ranges):
+        assert train == train_copy
+        assert val == val_copy
+        assert list(train.indices) == list(train_range)
+        assert list(val.indices) == list(val_range)
+
+
+def test_views_share_memory() -> None:
+    cv = TimeSeriesCrossValidator(min_train_size=4, val_size=2, source=SimpleDataProvider(range(12)), views=True)
+    splits = list(cv)
+
+    assert all(isinstance(window, NativeScrubberWindow) for split in splits for window in split)
+    train, val = splits[0]
+    # Splits view the same series: the next training set overlaps both windows of this split
+    assert np.shares_memory(train.values, splits[1][0].values)
+    assert np.shares_memory(val.values, splits[1][0].values)
+    assert list(val.indices) == [4, 5]
+    assert not train.values.flags.writeable
+    # Views taken before the series grew keep their values
+    assert list(train.values) == [0, 1, 2, 3]
+    assert list(splits[-1][1].values) == [10, 11]
+
+
+@pytest.mark.parametrize("workers", [1, 2])
+def test_evaluate(workers: int) -> None:
+    data = np.cumsum(np.random.default_rng(0).normal(size=200))
+    cv = TimeSeriesCrossValidator(min_train_size=50, val_size=10, source=SimpleDataProvider(data))
+
+    expected = [float(np.abs(np.asarray(val.values) - train.values[-1]).sum()) for train, val in cv]
+    assert cv.evaluate(naive_forecast_error, workers=workers) == pytest.approx(expected)
+
+
+def test_evaluate_without_splits() -> None:
+    cv = TimeSeriesCrossValidator(min_train_size=10, val_size=2, source=SimpleDataProvider([1.0, 2.0]))
+    assert cv.evaluate(naive_forecast_error, workers=2) == []
+
+    with pytest.raises(ValueError, match="Source is not set"):
+        TimeSeriesCrossValidator(min_train_size=10, val_size=2).evaluate(naive_forecast_error)